@@ -0,0 +1,224 @@
+/// @file content.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Measures the memory saved by sharing content between characters.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "../src/character.hh"
+#include "../src/content.hh"
+#include "../src/memory_accounting.hh"
+#include "../src/persistent_map.hh"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+using gelcube::Character;
+using gelcube::MemoryAccounting;
+
+/// @brief Details which every NPC of a kind has in common.
+struct Archetype
+{
+    const char* name;
+    std::vector<std::pair<const char*, const char*>> details;
+};
+
+const std::vector<Archetype> archetypes = {
+    {"Guard", {
+        {"race", "Human"},
+        {"class", "Fighter"},
+        {"item_longsword", "Longsword; weight 3; value 15 gp"},
+        {"item_shield", "Shield; weight 6; value 10 gp"},
+        {"item_chain_mail", "Chain mail; weight 55; value 75 gp"},
+        {"item_backpack", "Backpack; weight 5; value 2 gp"},
+        {"item_rations", "Rations (1 day); weight 2; value 5 sp; count 3; "
+                         "in item_backpack"},
+        {"item_torch", "Torch; weight 1; value 1 cp; count 5; "
+                       "in item_backpack"},
+        {"attack_longsword", "Longsword +3 1d8+1 slashing"},
+        {"feature_second_wind", "Second Wind: on your turn, regain 1d10 + "
+                                "fighter level hit points as a bonus action"},
+        {"feature_fighting_style", "Fighting Style (Defense): +1 AC while "
+                                   "wearing armor"}}},
+    {"Cultist", {
+        {"race", "Human"},
+        {"class", "Cleric"},
+        {"item_scimitar", "Scimitar; weight 3; value 25 gp"},
+        {"item_leather_armor", "Leather armor; weight 10; value 10 gp"},
+        {"item_holy_symbol", "Holy symbol (amulet); weight 1; value 5 gp"},
+        {"item_robes", "Robes; weight 4; value 1 gp"},
+        {"attack_scimitar", "Scimitar +3 1d6+1 slashing"},
+        {"spell_1", "Sacred Flame: 1d8 radiant, DEX save, 60 ft"},
+        {"spell_2", "Command: one-word command, WIS save, 60 ft"},
+        {"spell_3", "Inflict Wounds: 3d10 necrotic, melee spell attack"},
+        {"spell_4", "Shield of Faith: +2 AC, concentration, 10 minutes"},
+        {"feature_dark_devotion", "Dark Devotion: advantage on saving throws "
+                                  "against being charmed or frightened"}}},
+    {"Goblin", {
+        {"race", "Goblin"},
+        {"class", "Rogue"},
+        {"item_scimitar", "Scimitar; weight 3; value 25 gp"},
+        {"item_shortbow", "Shortbow; weight 2; value 25 gp"},
+        {"item_quiver", "Quiver; weight 1; value 1 gp"},
+        {"item_arrows", "Arrows; weight 0.05; value 1 cp; count 20; "
+                        "in item_quiver"},
+        {"item_leather_armor", "Leather armor; weight 10; value 10 gp"},
+        {"attack_scimitar", "Scimitar +4 1d6+2 slashing"},
+        {"attack_shortbow", "Shortbow +4 1d6+2 piercing, range 80/320"},
+        {"feature_darkvision", "Darkvision: see in dim light within 60 feet "
+                               "as if it were bright light"},
+        {"feature_nimble_escape", "Nimble Escape: Disengage or Hide as a "
+                                  "bonus action on each of your turns"}}},
+    {"Acolyte", {
+        {"race", "Half-Elf"},
+        {"class", "Wizard"},
+        {"item_quarterstaff", "Quarterstaff; weight 4; value 2 sp"},
+        {"item_spellbook", "Spellbook; weight 3; value 50 gp"},
+        {"item_component_pouch", "Component pouch; weight 2; value 25 gp"},
+        {"attack_quarterstaff", "Quarterstaff +2 1d6 bludgeoning"},
+        {"spell_1", "Fire Bolt: 1d10 fire, ranged spell attack, 120 ft"},
+        {"spell_2", "Mage Armor: AC 13 + DEX modifier for 8 hours"},
+        {"spell_3", "Magic Missile: three darts of 1d4+1 force, 120 ft"},
+        {"spell_4", "Shield: +5 AC until the start of your next turn"},
+        {"spell_5", "Sleep: 5d8 hit points of creatures fall asleep, 90 ft"},
+        {"feature_darkvision", "Darkvision: see in dim light within 60 feet "
+                               "as if it were bright light"},
+        {"feature_fey_ancestry", "Fey Ancestry: advantage on saving throws "
+                                 "against being charmed, and magic cannot "
+                                 "put you to sleep"},
+        {"feature_arcane_recovery", "Arcane Recovery: once per day after a "
+                                    "short rest, recover spell slots of "
+                                    "combined level up to half your wizard "
+                                    "level"}}}};
+
+/// @brief Details of an NPC as each character stored them before they were
+///        shared: one copy of every string per character.
+typedef gelcube::PersistentMap<std::string, std::string> Strings;
+
+/// @brief Gets the heap memory in use.
+int64_t get_live_bytes()
+{
+    return MemoryAccounting::get_total().live_bytes;
+}
+
+/// @brief Gets the unique name of an NPC.
+std::string get_name(size_t number)
+{
+    return std::string(archetypes[number % archetypes.size()].name) + " "
+           + std::to_string(number);
+}
+
+/// @brief Sets the scores which every NPC has, varied by its number.
+/// @param set Callable taking (const std::string& key, int value).
+template <typename Function>
+void set_scores(size_t number, Function&& set)
+{
+    set("level", 1 + number % 5);
+    set("hp", 5 + number % 12);
+    set("max_hp", 16);
+    set("ac", 12 + number % 5);
+    for (const char* ability : {"str", "dex", "con", "int", "wis", "cha"})
+        set(ability, 8 + (number + ability[0]) % 8);
+}
+
+/// @brief Reports memory in use by a roster.
+void report(const char* layout, int64_t bytes, size_t count, double seconds)
+{
+    std::printf("%-24s %10.1f MiB %8.0f bytes/NPC %8.3f s\n", layout,
+                bytes / 1048576.0, static_cast<double>(bytes) / count,
+                seconds);
+}
+
+}; // namespace
+
+int main(int argc, char* argv[])
+{
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    if (count == 0)
+    {
+        std::fprintf(stderr, "usage: %s [NPC_COUNT]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    using Clock = std::chrono::steady_clock;
+    std::printf("%zu synthetic NPCs of %zu kinds\n", count,
+                archetypes.size());
+
+    // Scores are stored the same way by both layouts.
+    int64_t start = get_live_bytes();
+    auto started = Clock::now();
+    std::vector<std::pair<Character::Scores, Strings>> before(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        Character::Scores& scores = before[i].first;
+        Strings& details = before[i].second;
+        details = details.insert("name", get_name(i));
+        for (auto& detail : archetypes[i % archetypes.size()].details)
+            details = details.insert(detail.first, detail.second);
+        set_scores(i, [&](const std::string& key, int value)
+        {
+            scores = scores.insert(key, value);
+        });
+    }
+    std::chrono::duration<double> elapsed = Clock::now() - started;
+    report("per-character strings", get_live_bytes() - start, count,
+           elapsed.count());
+    before.clear();
+    before.shrink_to_fit();
+
+    start = get_live_bytes();
+    started = Clock::now();
+    std::vector<Character> after(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        Character& character = after[i];
+        character.set_detail("name", get_name(i));
+        for (auto& detail : archetypes[i % archetypes.size()].details)
+            character.set_detail(detail.first, detail.second);
+        set_scores(i, [&](const std::string& key, int value)
+        {
+            character.set_score(key, value);
+        });
+    }
+    elapsed = Clock::now() - started;
+    report("shared content", get_live_bytes() - start, count,
+           elapsed.count());
+    std::printf("%zu distinct texts, %.1f KiB\n", gelcube::Content::get_count(),
+                gelcube::Content::get_size() / 1024.0);
+
+    // Customizing one NPC's sword gives it its own entry and leaves the
+    // others sharing the original.
+    size_t distinct = gelcube::Content::get_count();
+    after[0].set_detail("item_longsword",
+                        "Longsword +1; weight 3; value 1000 gp");
+    size_t other = archetypes.size();
+    if (*after[other].get_detail("item_longsword")
+            != "Longsword; weight 3; value 15 gp"
+        || gelcube::Content::get_count() != distinct + 1)
+    {
+        std::fprintf(stderr, "copy-on-write failed\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,112 @@
+/// @file formula.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Benchmarks compiled rules formulas against walking their syntax
+///        trees.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "../src/character.hh"
+#include "../src/formula.hh"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+using gelcube::Character;
+using gelcube::Formula;
+
+// Formulas typical of feats, items and class features.
+const char* const sources[] = {
+    "proficiency + wis_mod, minimum 1",
+    "8 + proficiency + int_mod",
+    "max(0, (level - 5) / 2)d8",
+    "1d8 + str_mod + 2",
+    "10 + dex_mod + min(con_mod, 2) + 1",
+    "(level / 2) * 5 + hp / 4, maximum 100"
+};
+
+const long iterations = 2000000;
+
+/// @brief Measures evaluations per second of a callable.
+template <typename Function>
+double measure(Function&& evaluate, long& checksum)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; ++i)
+        checksum += evaluate();
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return iterations / elapsed.count();
+}
+
+}; // namespace
+
+int main()
+{
+    Character character;
+    const char* abilities[] = {"str", "dex", "con", "int", "wis", "cha"};
+    for (const char* ability : abilities)
+    {
+        character.set_score(ability, 14);
+        character.set_score(std::string(ability) + "_mod", 2);
+    }
+    character.set_score("level", 9);
+    character.set_score("proficiency", 4);
+    character.set_score("hp", 58);
+
+    auto constants = [&](const std::string& key) -> const int*
+    {
+        return key == "hp" ? nullptr : character.get_score(key);
+    };
+
+    long checksum = 0;
+    std::printf("%-40s %14s %14s %14s %14s\n", "formula", "walk/s",
+                "compiled/s", "inputs/s", "folded/s");
+    for (const char* source : sources)
+    {
+        std::unique_ptr<Formula::Node> tree = Formula::parse(source);
+        Formula compiled = Formula::compile(source);
+        Formula folded = Formula::compile(source, constants);
+
+        std::vector<int> inputs;
+        for (auto& key : compiled.get_inputs())
+            inputs.push_back(*character.get_score(key));
+
+        double walk = measure([&] { return Formula::walk(*tree, character); },
+                              checksum);
+        double by_character = measure(
+            [&] { return compiled.evaluate(character); }, checksum);
+        double by_inputs = measure(
+            [&] { return compiled.evaluate(inputs.data()); }, checksum);
+        double by_folded = measure(
+            [&] { return folded.evaluate(character); }, checksum);
+
+        std::printf("%-40s %14.0f %14.0f %14.0f %14.0f\n", source, walk,
+                    by_character, by_inputs, by_folded);
+    }
+
+    // Keeps the evaluations from being optimized away.
+    std::fprintf(stderr, "checksum %ld\n", checksum);
+    return EXIT_SUCCESS;
+}
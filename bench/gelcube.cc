@@ -0,0 +1,711 @@
+/// @file gelcube.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Benchmarks the UI, option parsing and logging, and runs headless
+///        end-to-end scenarios.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "../src/character.hh"
+#include "../src/character_table.hh"
+#include "../src/derived_stats.hh"
+#include "../src/encounter.hh"
+#include "../src/intl.hh"
+#include "../src/json_reader.hh"
+#include "../src/logger.hh"
+#include "../src/memory_accounting.hh"
+#include "../src/options.hh"
+#include "../src/query.hh"
+#include "../src/roster.hh"
+#include "../src/symbol.hh"
+#include "../src/text_layout.hh"
+#include "../src/trace.hh"
+#include "../src/tui.hh"
+#include "../src/tui/dimensions.hh"
+#include "../src/tui/key_bindings.hh"
+#include "../src/tui/main_loop.hh"
+#include "../src/tui/panel.hh"
+#include "../src/tui/panel_manager.hh"
+#include "../src/worker_pool.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/parsers.hpp>
+#include <boost/program_options/value_semantic.hpp>
+#include <boost/program_options/variables_map.hpp>
+
+#include <ncurses.h>
+#include <unistd.h>
+
+namespace po = boost::program_options;
+
+namespace gelcube
+{
+
+namespace
+{
+
+/// @brief Timing of one benchmark.
+struct Result
+{
+    std::string name;
+    long iterations;
+    double ns_per_op;
+    double allocs_per_op;
+};
+
+/// @brief Gets the number of heap allocations made by the program.
+inline long allocation_count() noexcept
+{
+    return static_cast<long>(MemoryAccounting::get_total().allocations);
+}
+
+// Benchmarks which must not allocate once warmed up.
+const char* const allocation_free[] = {"main_loop_frame",
+                                       "derived_stats_update"};
+
+// Number of timed samples per benchmark; the median is reported.
+const int samples = 5;
+
+// Number of characters in the roster.
+const int character_count = 50;
+
+double min_time = 0.2;
+std::string filter;
+
+/// @brief Checks whether a benchmark was selected with --filter.
+inline bool is_selected(const std::string& name)
+{
+    return name.find(filter) != std::string::npos;
+}
+
+/// @brief Times a function, calibrating the batch size to the minimum time.
+/// @param name Name of the benchmark.
+/// @param operation Function performing one operation.
+/// @param results Vector to append the result to.
+void measure(const std::string& name, const std::function<void()>& operation,
+             std::vector<Result>& results)
+{
+    if (!is_selected(name))
+        return;
+
+    using Clock = std::chrono::steady_clock;
+    auto run = [&](long count)
+    {
+        auto start = Clock::now();
+        for (long i = 0; i < count; ++i)
+            operation();
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    };
+
+    // Doubles the batch until a sample takes long enough to time reliably.
+    long batch = 1;
+    double sample_time = min_time / samples;
+    while (run(batch) < sample_time / 4 && batch < (1L << 30))
+        batch *= 2;
+    batch = std::max(1L, static_cast<long>(batch * sample_time
+                                           / std::max(run(batch), 1e-9)));
+
+    std::vector<double> times;
+    times.reserve(samples);
+    long allocations = allocation_count();
+    for (int i = 0; i < samples; ++i)
+        times.push_back(run(batch) * 1e9 / batch);
+    allocations = allocation_count() - allocations;
+    std::sort(times.begin(), times.end());
+    results.push_back({name, batch * samples, times[samples / 2],
+                       static_cast<double>(allocations) / (batch * samples)});
+}
+
+/// @brief Builds a character with fields for every panel.
+Character make_character(int number)
+{
+    Character character;
+    character.set_detail("name", "Adventurer " + std::to_string(number));
+    character.set_detail("race", "Half-Elf");
+    character.set_detail("class", "Bard");
+    character.set_score("level", 1 + number % 20);
+    for (const char* ability : {"str", "dex", "con", "int", "wis", "cha"})
+    {
+        character.set_score(ability, 8 + number % 10);
+        character.set_score(std::string(ability) + "_mod", number % 5 - 1);
+    }
+    character.set_score("hp", 10 + number);
+    character.set_score("max_hp", 20 + number);
+    character.set_score("ac", 14);
+    character.set_score("initiative", number % 7);
+    character.set_score("effect_bless", 10);
+    for (int i = 0; i < 12; ++i)
+    {
+        std::string n = std::to_string(i);
+        character.set_detail("spell_" + n, "Spell " + n);
+        character.set_detail("attack_" + n, "Attack " + n + " +5 1d8+3");
+        character.set_score("skill_" + n, i % 6);
+        character.set_detail("item_" + n,
+                             "Item " + n + "; weight 2; value 5 gp"
+                             + (i > 0 ? "; in item_0" : ""));
+    }
+    return character;
+}
+
+/// @brief Adds characters to the roster, as if loaded from files.
+void load_characters(int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        Roster::add("bench/" + std::to_string(i) + Roster::file_suffix,
+                    make_character(i));
+    }
+}
+
+}; // namespace
+
+/// @brief Runs the benchmarks.
+/// Befriended by the TUI classes so that their internals can be timed
+/// without a terminal.
+class Benchmarks
+{
+public:
+    /// @brief Times the individual operations of the TUI and the program.
+    static void micro(std::vector<Result>& results);
+
+    /// @brief Times the main loop processing scripted input.
+    static void scenarios(std::vector<Result>& results);
+
+private:
+    /// @brief Creates an ncurses screen writing to /dev/null.
+    /// @param input Keys which the screen reads from standard input.
+    static void open_screen(const std::string& input);
+
+    /// @brief Destroys the screen created by open_screen().
+    static void close_screen();
+
+    /// @brief Runs the main loop until it has processed a script of keys.
+    /// @param keys Keys to type; a quit key is appended.
+    /// @param allocations Incremented by the number of heap allocations made
+    ///                    by the main loop.
+    /// @return Time taken in nanoseconds.
+    static double run_script(const std::string& keys, long& allocations);
+
+    static SCREEN* screen;
+    static FILE* output;
+};
+
+SCREEN* Benchmarks::screen = nullptr;
+FILE* Benchmarks::output = nullptr;
+
+void Benchmarks::open_screen(const std::string& input)
+{
+    // The main loop polls standard input, so scripted keys are read from a
+    // pipe in its place.
+    int fds[2];
+    if (pipe(fds) < 0)
+    {
+        std::perror("pipe");
+        std::exit(EXIT_FAILURE);
+    }
+    if (write(fds[1], input.data(), input.size())
+        != static_cast<ssize_t>(input.size()))
+    {
+        std::perror("write");
+        std::exit(EXIT_FAILURE);
+    }
+    close(fds[1]);
+    dup2(fds[0], STDIN_FILENO);
+    close(fds[0]);
+
+    output = std::fopen("/dev/null", "w");
+    screen = newterm("xterm-256color", output, stdin);
+    if (!screen)
+    {
+        std::fprintf(stderr, "cannot create terminal screen\n");
+        std::exit(EXIT_FAILURE);
+    }
+    resize_term(50, 160);
+    noecho();
+    cbreak();
+}
+
+void Benchmarks::close_screen()
+{
+    Tui::PanelManager::destroy();
+    endwin();
+    delscreen(screen);
+    std::fclose(output);
+    screen = nullptr;
+}
+
+double Benchmarks::run_script(const std::string& keys, long& allocations)
+{
+    // Restores expired effects so that every run does the same work.
+    load_characters(character_count);
+    open_screen(keys + static_cast<char>(key_bindings::quit));
+    Tui::PanelManager::create();
+
+    long start_count = allocation_count();
+    auto start = std::chrono::steady_clock::now();
+    Tui::MainLoop::done = false;
+    Tui::MainLoop::start();
+    std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+    allocations += allocation_count() - start_count;
+
+    if (Encounter::is_active())
+        Encounter::end();
+    close_screen();
+    return elapsed.count();
+}
+
+void Benchmarks::micro(std::vector<Result>& results)
+{
+    open_screen("");
+    Tui::PanelManager::create();
+    Tui::PanelManager::update();
+
+    measure("panel_manager_update", [] { Tui::PanelManager::update(); },
+            results);
+    WorkerPool::start();
+    measure("panel_manager_update_parallel",
+            [] { Tui::PanelManager::update(); }, results);
+    WorkerPool::stop();
+
+    Tui::Dimensions dimensions{40, 60, 0, 0};
+    Tui::Panel panel(&dimensions, Symbol("Bench"), 1, true);
+    panel.create_window();
+    std::vector<std::string> lines;
+    for (int i = 0; i < 38; ++i)
+        lines.push_back("content line " + std::to_string(i));
+    panel.set_content(lines);
+    measure("panel_draw", [&] { panel.draw(); }, results);
+    measure("panel_draw_refresh", [&]
+    {
+        panel.draw();
+        panel.refresh();
+    }, results);
+
+    // A 5,000-word description, shown from its start while the panel is
+    // resized to a different width each time, then wrapped completely.
+    std::string description;
+    for (int i = 0; i < 5000; ++i)
+        description += i % 3 == 0 ? "gelatinous " : "cube ";
+    std::vector<std::string> described{description};
+    int resizes = 0;
+    measure("panel_resize_reflow", [&]
+    {
+        dimensions.width = 40 + resizes++ % 40;
+        panel.create_window();
+        panel.set_content(described);
+        panel.draw();
+    }, results);
+    dimensions.width = 60;
+    panel.create_window();
+    panel.set_content(lines);
+    TextLayout layout(description);
+    measure("text_layout_wrap_all", [&]
+    {
+        layout.wrap(40 + resizes++ % 40);
+    }, results);
+
+    // Alternates entering panel selection mode and choosing a panel.
+    int key = 0;
+    measure("dispatch_select_panel", [&]
+    {
+        Tui::MainLoop::dispatch(key % 2 == 0 ? key_bindings::modifiers::go
+                                             : '1' + (key / 2) % 6);
+        ++key;
+    }, results);
+
+    // Alternates undoing and redoing a change to the open character.
+    const Roster::Entry& open = Roster::get_entries()[0];
+    Roster::erase(open.path, "hp");
+    measure("dispatch_undo_redo", [&]
+    {
+        Tui::MainLoop::dispatch(key % 2 == 0 ? key_bindings::undo
+                                             : key_bindings::redo);
+        ++key;
+    }, results);
+    Tui::PanelManager::redraw_dirty();
+
+    // A whole iteration of the main loop, selecting a panel with the latency
+    // overlay shown. Keys are pushed back in reverse, as ungetch() is LIFO.
+    Tui::MainLoop::show_latency = true;
+    measure("main_loop_frame", [&]
+    {
+        ungetch('1' + key % 6);
+        ungetch(key_bindings::modifiers::go);
+        Tui::MainLoop::run_frame();
+        ++key;
+    }, results);
+    Tui::MainLoop::show_latency = false;
+    Tui::MainLoop::hide_latency_overlay();
+    close_screen();
+
+    // Options which do not start the TUI; their output is discarded.
+    std::ofstream null_stream("/dev/null");
+    std::streambuf* cout_buffer = std::cout.rdbuf(null_stream.rdbuf());
+    for (const char* option : {"--version", "--help", "--show-keys"})
+    {
+        char program[] = "gelcube";
+        std::string argument = option;
+        char* argv[] = {program, &argument[0], nullptr};
+        measure(std::string("parse_options") + option,
+                [&] { parse_options(2, argv); }, results);
+    }
+    std::cout.rdbuf(cout_buffer);
+
+    // Effect names as they repeat across combatants.
+    std::vector<std::string> names;
+    for (int i = 0; i < 64; ++i)
+        names.push_back("effect_condition_" + std::to_string(i));
+    size_t next = 0;
+    measure("symbol_intern", [&]
+    {
+        Symbol symbol(names[next++ % names.size()]);
+        (void)symbol;
+    }, results);
+    std::vector<Symbol> symbols(names.begin(), names.end());
+    long equal = 0;
+    measure("symbol_compare", [&]
+    {
+        equal += symbols[next % symbols.size()]
+                 == symbols[(next + 1) % symbols.size()];
+        ++next;
+    }, results);
+    measure("string_compare", [&]
+    {
+        equal += names[next % names.size()]
+                 == names[(next + 1) % names.size()];
+        ++next;
+    }, results);
+
+    // A hit point change evaluating the formulas which read hit points, as
+    // every edit, reload and session change does.
+    Character derived = make_character(0);
+    derived.set_detail("bloodied_formula", "max_hp / 2 - hp");
+    derived.set_detail("spell_save_dc_formula", "8 + proficiency + int_mod");
+    DerivedStats::update_all(derived);
+    std::vector<std::string> changed{"hp"};
+    changed.reserve(8);
+    measure("derived_stats_update", [&]
+    {
+        changed.resize(1);
+        DerivedStats::update(derived, changed);
+    }, results);
+
+    // Alternates undoing and redoing a move of one item of a character
+    // carrying 10,000, which costs as much as the move, not the hoard.
+    if (is_selected("roster_undo_redo_hoard"))
+    {
+        Character hoard = make_character(0);
+        for (int i = 0; i < 10000; ++i)
+        {
+            std::string n = std::to_string(i);
+            hoard.set_detail("item_coin_" + n, "Coin " + n
+                             + "; value 1 gp; in item_0");
+        }
+        std::string path = "bench/hoard" + std::string(Roster::file_suffix);
+        Roster::add(path, hoard);
+        hoard.set_detail("item_coin_0", "Coin 0; value 1 gp; in item_1");
+        Roster::update(path, hoard, {"item_coin_0"});
+        Roster::open(path);
+        int step = 0;
+        measure("roster_undo_redo_hoard", [&]
+        {
+            if (step++ % 2 == 0)
+                Roster::undo();
+            else
+                Roster::redo();
+        }, results);
+        Roster::unload(path);
+        Roster::open(size_t{0});
+    }
+
+    // A million characters, filtered by a scan of every row, then by the
+    // level index, then by a scan split across the worker pool.
+    if (is_selected("query_"))
+    {
+        const char* classes[] = {"Bard", "Cleric", "Fighter", "Rogue",
+                                 "Wizard"};
+        CharacterTable table;
+        for (int i = 0; i < 1000000; ++i)
+        {
+            size_t row = table.add_row();
+            table.set_score(row, Symbol("level"), 1 + i % 20);
+            table.set_score(row, Symbol("hp"), i % 97);
+            table.set_detail(row, Symbol("class"), classes[i % 7 % 5]);
+        }
+        Query scan("level>=5 and class=wizard and hp<20");
+        Query rare("level=20 and class=wizard");
+        measure("query_1m_scan", [&] { scan.run(table); }, results);
+        table.build_index(Symbol("level"));
+        measure("query_1m_indexed", [&] { rare.run(table); }, results);
+        WorkerPool::start();
+        measure("query_1m_scan_parallel", [&] { scan.run(table); },
+                results);
+        WorkerPool::stop();
+    }
+
+    // Every event of a 1,000-record export, pretty-printed as most tools
+    // write them.
+    if (is_selected("json_reader_1k_records"))
+    {
+        std::string json = "{\"characters\": [\n";
+        for (int i = 0; i < 1000; ++i)
+        {
+            json += std::string(i > 0 ? ",\n" : "")
+                    + "  {\n    \"name\": \"Adventurer " + std::to_string(i)
+                    + "\",\n    \"level\": " + std::to_string(1 + i % 20)
+                    + ",\n    \"abilities\": {\"str\": 10, \"dex\": 14},"
+                      "\n    \"description\": \"";
+            for (int j = 0; j < 40; ++j)
+                json += "A gelatinous \\\"cube\\\". ";
+            json += "\"\n  }";
+        }
+        json += "\n]}\n";
+        measure("json_reader_1k_records", [&]
+        {
+            std::istringstream in(json);
+            JsonReader reader(in);
+            while (reader.next() != JsonReader::Event::end)
+            {
+            }
+        }, results);
+    }
+
+    // Spans are compiled into every frame, so they must cost next to
+    // nothing unless --trace is given. The trace is never written.
+    measure("trace_span_disabled", [&]
+    {
+        Trace::Span span("bench");
+    }, results);
+    if (is_selected("trace_span_enabled"))
+    {
+        Trace::start("/dev/null");
+        measure("trace_span_enabled", [&]
+        {
+            Trace::Span span("bench");
+        }, results);
+        Trace::stop();
+    }
+
+    Logger::Source log = Logger::source;
+    long count = 0;
+    measure("logger_info", [&]
+    {
+        BOOST_LOG_SEV(log, LogLevel::info) << "message " << ++count;
+    }, results);
+}
+
+void Benchmarks::scenarios(std::vector<Result>& results)
+{
+    // Timed as a whole, then reported per key.
+    auto scenario = [&](const std::string& name, const std::string& keys)
+    {
+        if (!is_selected(name))
+            return;
+        std::vector<double> times;
+        long allocations = 0;
+        for (int i = 0; i < samples; ++i)
+            times.push_back(run_script(keys, allocations) / (keys.size() + 1));
+        std::sort(times.begin(), times.end());
+        long iterations = samples * (keys.size() + 1);
+        results.push_back({name, iterations, times[samples / 2],
+                           static_cast<double>(allocations) / iterations});
+    };
+
+    std::string navigate;
+    for (int i = 0; i < 1000; ++i)
+    {
+        navigate += static_cast<char>(key_bindings::modifiers::go);
+        navigate += static_cast<char>('1' + i % 6);
+    }
+    scenario("scenario_navigate", navigate);
+
+    std::string turns(1, static_cast<char>(key_bindings::encounter));
+    turns.append(2000, static_cast<char>(key_bindings::next_turn));
+    scenario("scenario_encounter_turns", turns);
+
+    std::string edits;
+    for (int i = 0; i < 1000; ++i)
+    {
+        edits += static_cast<char>(key_bindings::undo);
+        edits += static_cast<char>(key_bindings::redo);
+    }
+    scenario("scenario_undo_redo", edits);
+}
+
+}; // namespace gelcube
+
+namespace
+{
+
+/// @brief Writes results as JSON, one benchmark per line.
+void write_json(std::ostream& out,
+                const std::vector<gelcube::Result>& results)
+{
+    out << "{\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        char line[256];
+        std::snprintf(line, sizeof(line),
+                      "    {\"name\": \"%s\", \"iterations\": %ld, "
+                      "\"ns_per_op\": %.2f, \"allocs_per_op\": %.2f}%s\n",
+                      results[i].name.c_str(), results[i].iterations,
+                      results[i].ns_per_op, results[i].allocs_per_op,
+                      i + 1 < results.size() ? "," : "");
+        out << line;
+    }
+    out << "  ]\n}\n";
+}
+
+/// @brief Reads the results written by write_json().
+std::map<std::string, double> read_json(std::istream& in)
+{
+    std::map<std::string, double> results;
+    std::regex entry("\"name\": \"([^\"]+)\".*\"ns_per_op\": ([0-9.eE+-]+)");
+    std::string line;
+    std::smatch match;
+    while (std::getline(in, line))
+    {
+        if (std::regex_search(line, match, entry))
+            results[match[1]] = std::stod(match[2]);
+    }
+    return results;
+}
+
+}; // namespace
+
+int main(int argc, char* argv[])
+{
+    po::options_description desc("Usage: gelcube_bench [OPTION]...");
+    desc.add_options()
+        ("json", po::value<std::string>()->value_name("FILE"),
+         "write results as JSON to FILE")
+        ("baseline", po::value<std::string>()->value_name("FILE"),
+         "compare with the JSON results in FILE")
+        ("threshold", po::value<double>()->default_value(10)
+                                         ->value_name("PERCENT"),
+         "slowdown reported as a regression")
+        ("filter", po::value<std::string>()->value_name("TEXT"),
+         "run only the benchmarks whose names contain TEXT")
+        ("min-time", po::value<double>()->default_value(0.2)
+                                        ->value_name("SECONDS"),
+         "time spent on each microbenchmark")
+        ("help", "display this help and exit");
+
+    po::variables_map vm;
+    try
+    {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+    }
+    catch (po::error& e)
+    {
+        std::cerr << argv[0] << ": " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (vm.count("help"))
+    {
+        std::cout << desc << std::endl;
+        return EXIT_SUCCESS;
+    }
+    if (vm.count("filter"))
+        gelcube::filter = vm["filter"].as<std::string>();
+    gelcube::min_time = vm["min-time"].as<double>();
+
+    // Log messages are formatted as usual but discarded.
+    gelcube::Logger::init();
+    std::ofstream null_stream("/dev/null");
+    std::streambuf* clog_buffer = std::clog.rdbuf(null_stream.rdbuf());
+
+    gelcube::load_characters(gelcube::character_count);
+    std::vector<gelcube::Result> results;
+    gelcube::Benchmarks::micro(results);
+    gelcube::Benchmarks::scenarios(results);
+    std::clog.rdbuf(clog_buffer);
+
+    std::map<std::string, double> baseline;
+    if (vm.count("baseline"))
+    {
+        std::ifstream in(vm["baseline"].as<std::string>());
+        if (!in)
+        {
+            std::cerr << argv[0] << ": cannot read "
+                      << vm["baseline"].as<std::string>() << std::endl;
+            return EXIT_FAILURE;
+        }
+        baseline = read_json(in);
+    }
+
+    double threshold = vm["threshold"].as<double>();
+    int regressions = 0;
+    std::printf("%-32s %14s %12s %10s", "benchmark", "ns/op", "iterations",
+                "allocs/op");
+    if (!baseline.empty())
+        std::printf(" %12s %9s", "baseline", "change");
+    std::printf("\n");
+    for (auto& result : results)
+    {
+        std::printf("%-32s %14.1f %12ld %10.2f", result.name.c_str(),
+                    result.ns_per_op, result.iterations, result.allocs_per_op);
+        auto previous = baseline.find(result.name);
+        if (previous != baseline.end())
+        {
+            double change = (result.ns_per_op / previous->second - 1) * 100;
+            bool is_regression = change > threshold;
+            regressions += is_regression;
+            std::printf(" %12.1f %+8.1f%%%s", previous->second, change,
+                        is_regression ? "  REGRESSION" : "");
+        }
+        for (const char* name : gelcube::allocation_free)
+        {
+            if (result.name == name && result.allocs_per_op > 0)
+            {
+                ++regressions;
+                std::printf("  ALLOCATES");
+            }
+        }
+        std::printf("\n");
+    }
+
+    if (vm.count("json"))
+    {
+        std::ofstream out(vm["json"].as<std::string>());
+        write_json(out, results);
+        if (!out)
+        {
+            std::cerr << argv[0] << ": cannot write "
+                      << vm["json"].as<std::string>() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Fails so that scripts can stop a release on regressions.
+    return regressions > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
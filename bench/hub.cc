@@ -0,0 +1,169 @@
+/// @file hub.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Benchmarks the latency of fanning a change out to every client of
+///        a session hub.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "../src/delta.hh"
+#include "../src/session_hub.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/log/core.hpp>
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+
+using gelcube::Delta;
+
+/// @brief Connects a blocking client socket to the hub.
+int connect_client(const std::string& path)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&address),
+                          sizeof(address)) < 0)
+    {
+        std::perror("connect");
+        std::exit(EXIT_FAILURE);
+    }
+    return fd;
+}
+
+/// @brief Reads from a receiver, counting the complete frames received.
+size_t read_frames(int fd, std::string& buffer)
+{
+    char data[65536];
+    ssize_t length = recv(fd, data, sizeof(data), MSG_DONTWAIT);
+    if (length > 0)
+        buffer.append(data, length);
+
+    size_t frames = 0;
+    size_t offset = 0;
+    size_t payload_size;
+    while (Delta::next_frame(buffer.data() + offset, buffer.size() - offset,
+                             payload_size))
+    {
+        offset += Delta::header_size + payload_size;
+        ++frames;
+    }
+    buffer.erase(0, offset);
+    return frames;
+}
+
+}; // namespace
+
+int main(int argc, char* argv[])
+{
+    size_t client_count = argc > 1 ? std::atoi(argv[1]) : 200;
+    size_t rounds = argc > 2 ? std::atoi(argv[2]) : 1000;
+    boost::log::core::get()->set_logging_enabled(false);
+    std::string path = "/tmp/gelcube-hub-bench-"
+                       + std::to_string(getpid()) + ".sock";
+
+    gelcube::SessionHub hub(path);
+    std::thread relay([&hub] { hub.run(); });
+
+    int sender = connect_client(path);
+    std::vector<int> receivers;
+    std::vector<std::string> buffers(client_count);
+    int epoll_fd = epoll_create1(0);
+    for (size_t i = 0; i < client_count; ++i)
+    {
+        receivers.push_back(connect_client(path));
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u32 = i;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, receivers.back(), &event);
+    }
+    // Lets the hub accept every client before measuring.
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    std::vector<double> latencies;
+    std::vector<epoll_event> events(client_count);
+    for (size_t round = 0; round < rounds; ++round)
+    {
+        Delta::Batch batch;
+        batch.add({Delta::Op::set_score, "fighter.character", "hp",
+                   static_cast<int>(round), {}});
+        batch.add({Delta::Op::set_detail, "fighter.character",
+                   "effect_poisoned", 0, "1"});
+        std::string frame;
+        batch.encode(0, frame);
+
+        std::vector<bool> done(client_count, false);
+        size_t remaining = client_count;
+        auto start = std::chrono::steady_clock::now();
+        if (send(sender, frame.data(), frame.size(), 0) < 0)
+        {
+            std::perror("send");
+            return EXIT_FAILURE;
+        }
+        while (remaining > 0)
+        {
+            int count = epoll_wait(epoll_fd, events.data(), events.size(), -1);
+            for (int i = 0; i < count; ++i)
+            {
+                uint32_t id = events[i].data.u32;
+                if (read_frames(receivers[id], buffers[id]) > 0 && !done[id])
+                {
+                    done[id] = true;
+                    --remaining;
+                }
+            }
+        }
+        std::chrono::duration<double, std::micro> elapsed =
+            std::chrono::steady_clock::now() - start;
+        latencies.push_back(elapsed.count());
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p)
+    {
+        return latencies[std::min(latencies.size() - 1,
+                                  static_cast<size_t>(p * latencies.size()))];
+    };
+    std::printf("%zu clients, %zu rounds\n", client_count, rounds);
+    std::printf("fan-out latency (us): p50 %.1f p99 %.1f max %.1f\n",
+                percentile(0.5), percentile(0.99), latencies.back());
+
+    // Wakes the hub so that it sees it has been stopped.
+    gelcube::SessionHub::stop();
+    close(connect_client(path));
+    relay.join();
+    close(sender);
+    for (int fd : receivers)
+        close(fd);
+    close(epoll_fd);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,201 @@
+/// @file soak.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Drives the TUI through resize and selection cycles without a
+///        terminal and checks that its memory stays bounded.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "../src/character.hh"
+#include "../src/frame_arena.hh"
+#include "../src/intl.hh"
+#include "../src/logger.hh"
+#include "../src/memory_accounting.hh"
+#include "../src/roster.hh"
+#include "../src/tui.hh"
+#include "../src/tui/key_bindings.hh"
+#include "../src/tui/main_loop.hh"
+#include "../src/tui/panel_manager.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <boost/log/core.hpp>
+
+#include <ncurses.h>
+#include <unistd.h>
+
+namespace gelcube
+{
+
+/// @brief Runs the soak test.
+/// Befriended by the TUI classes so that their internals can be driven
+/// without a terminal.
+class Soak
+{
+public:
+    /// @brief Runs the cycles.
+    /// @param cycles Number of cycles to run.
+    /// @param tolerance Growth in bytes of the resident set size, or of the
+    ///                  heap, allowed after warming up.
+    /// @return true if memory stayed within the tolerance.
+    static bool run(uint64_t cycles, int64_t tolerance);
+
+private:
+    /// @brief Resizes the terminal below the minimum size, restores it, and
+    ///        selects and deselects panels.
+    /// @param cycle Number of the cycle, varying the sizes and panels.
+    static void cycle(uint64_t cycle);
+};
+
+namespace
+{
+
+// Size of the headless terminal.
+const int lines = 50;
+const int columns = 160;
+
+// Size too small to fit the panels, so that they are recreated afterwards.
+const int small_lines = 4;
+const int small_columns = 20;
+
+/// @brief Memory in use at some point of the run.
+struct Sample
+{
+    int64_t resident_bytes;
+    int64_t heap_bytes;
+};
+
+Sample sample() noexcept
+{
+    return {MemoryAccounting::get_resident_bytes(),
+            MemoryAccounting::get_total().live_bytes};
+}
+
+}; // namespace
+
+void Soak::cycle(uint64_t cycle)
+{
+    resize_term(small_lines, small_columns);
+    Tui::MainLoop::dispatch(KEY_RESIZE);
+    resize_term(lines, columns + static_cast<int>(cycle % 2));
+    Tui::MainLoop::dispatch(KEY_RESIZE);
+
+    Tui::MainLoop::dispatch(key_bindings::modifiers::go);
+    Tui::MainLoop::dispatch('1' + cycle % Tui::PanelManager::panel_count);
+    Tui::MainLoop::dispatch(key_bindings::modifiers::go);
+    Tui::MainLoop::dispatch(key_bindings::modifiers::go);
+
+    // Creates and deletes the latency overlay's window.
+    Tui::MainLoop::dispatch(key_bindings::latency);
+    Tui::MainLoop::draw_latency_overlay();
+    Tui::MainLoop::dispatch(key_bindings::latency);
+
+    Tui::PanelManager::redraw_dirty();
+    FrameArena::reset();
+}
+
+bool Soak::run(uint64_t cycles, int64_t tolerance)
+{
+    FILE* output = std::fopen("/dev/null", "w");
+    SCREEN* screen = newterm("xterm-256color", output, stdin);
+    if (!screen)
+    {
+        std::fprintf(stderr, "cannot create terminal screen\n");
+        std::exit(EXIT_FAILURE);
+    }
+    resize_term(lines, columns);
+    noecho();
+    cbreak();
+    Tui::PanelManager::create();
+    Tui::PanelManager::update();
+
+    // Allocators and ncurses reach their working sizes while warming up.
+    uint64_t warmup = std::min<uint64_t>(cycles / 10, 10000);
+    for (uint64_t i = 0; i < warmup; ++i)
+        cycle(i);
+    Sample baseline = sample();
+    std::printf("%12s %14s %14s\n", "cycle", "resident KiB", "heap KiB");
+    std::printf("%12llu %14lld %14lld\n",
+                static_cast<unsigned long long>(warmup),
+                static_cast<long long>(baseline.resident_bytes >> 10),
+                static_cast<long long>(baseline.heap_bytes >> 10));
+
+    // Reports ten samples; the largest growth is checked.
+    Sample peak = baseline;
+    uint64_t step = std::max<uint64_t>((cycles - warmup) / 10, 1);
+    for (uint64_t i = warmup; i < cycles;)
+    {
+        uint64_t end = std::min(cycles, i + step);
+        for (; i < end; ++i)
+            cycle(i);
+
+        Sample current = sample();
+        peak.resident_bytes = std::max(peak.resident_bytes,
+                                       current.resident_bytes);
+        peak.heap_bytes = std::max(peak.heap_bytes, current.heap_bytes);
+        std::printf("%12llu %14lld %14lld\n",
+                    static_cast<unsigned long long>(i),
+                    static_cast<long long>(current.resident_bytes >> 10),
+                    static_cast<long long>(current.heap_bytes >> 10));
+        std::fflush(stdout);
+    }
+
+    Tui::PanelManager::destroy();
+    endwin();
+    delscreen(screen);
+    std::fclose(output);
+
+    int64_t resident_growth = peak.resident_bytes - baseline.resident_bytes;
+    int64_t heap_growth = peak.heap_bytes - baseline.heap_bytes;
+    std::printf("growth: resident %lld KiB, heap %lld KiB (tolerance %lld "
+                "KiB)\n", static_cast<long long>(resident_growth >> 10),
+                static_cast<long long>(heap_growth >> 10),
+                static_cast<long long>(tolerance >> 10));
+    return resident_growth <= tolerance && heap_growth <= tolerance;
+}
+
+}; // namespace gelcube
+
+int main(int argc, char* argv[])
+{
+    uint64_t cycles = argc > 1 ? std::strtoull(argv[1], nullptr, 10)
+                               : 1000000;
+    int64_t tolerance = (argc > 2 ? std::atoll(argv[2]) : 256) << 10;
+
+    gelcube::Logger::init();
+    boost::log::core::get()->set_logging_enabled(false);
+
+    // Panels show a character, as they would in a session.
+    gelcube::Character character;
+    character.set_detail("name", "Soak");
+    character.set_score("hp", 20);
+    character.set_score("max_hp", 20);
+    character.set_detail("spell_0", "Magic Missile");
+    character.set_detail("item_0", "Rope; weight 10");
+    gelcube::Roster::add("soak" + std::string(gelcube::Roster::file_suffix),
+                         character);
+
+    if (!gelcube::Soak::run(cycles, tolerance))
+    {
+        std::printf("memory grew beyond the tolerance\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
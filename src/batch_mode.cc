@@ -0,0 +1,589 @@
+/// @file batch_mode.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Validates and exports character files without the TUI.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "batch_mode.hh"
+#include "bounded_queue.hh"
+#include "character.hh"
+#include "character_file.hh"
+#include "derived_stats.hh"
+#include "encounter.hh"
+#include "formula.hh"
+#include "intl.hh"
+#include "inventory.hh"
+#include "roster.hh"
+#include "text_layout.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sys/stat.h>
+
+namespace gelcube
+{
+
+namespace
+{
+
+const char* const abilities[] = {"str", "dex", "con", "int", "wis", "cha"};
+const int max_level = 20;
+const int max_ability = 30;
+
+/// @brief Character file moving through the pipeline.
+struct Item
+{
+    size_t index;
+    std::string path;
+    std::string text;
+    std::vector<CharacterFile::Field> fields;
+    Character character;
+    // Rules broken, or the error which made the file unreadable.
+    std::vector<std::string> problems;
+    std::string sheet;
+    bool is_readable = true;
+};
+
+typedef BoundedQueue<std::unique_ptr<Item>> Queue;
+
+typedef std::vector<std::pair<std::string, int>> Scores;
+typedef std::vector<std::pair<std::string, std::string>> Details;
+
+/// @brief Starts a stage of the pipeline on several threads.
+/// Items which already have problems are passed on untouched. The output
+/// queue is closed once every thread of the stage has finished.
+/// @param running Number of threads of the stage still running; must outlive
+///                them.
+void start_stage(std::vector<std::thread>& threads, unsigned count,
+                 Queue& input, Queue& output, std::atomic<unsigned>& running,
+                 std::function<void(Item&)> process)
+{
+    running = count;
+    for (unsigned i = 0; i < count; ++i)
+    {
+        threads.emplace_back([&input, &output, &running, process]
+        {
+            std::unique_ptr<Item> item;
+            while (input.pop(item))
+            {
+                if (item->problems.empty())
+                {
+                    try
+                    {
+                        process(*item);
+                    }
+                    catch (CharacterFile::ReadException& e)
+                    {
+                        item->is_readable = false;
+                        item->problems.push_back(e.what());
+                    }
+                    catch (std::exception& e)
+                    {
+                        item->problems.push_back(e.what());
+                    }
+                }
+                if (!output.push(std::move(item)))
+                    break;
+            }
+            if (running.fetch_sub(1) == 1)
+                output.close();
+        });
+    }
+}
+
+/// @brief Gets the fields of a character in order of their keys.
+void sort_fields(const Character& character, Scores& scores,
+                 Details& details)
+{
+    character.get_scores().for_each([&](const std::string& key, int value)
+    {
+        scores.emplace_back(key, value);
+    });
+    character.get_details().for_each([&](const std::string& key,
+                                          const std::string& value)
+    {
+        details.emplace_back(key, value);
+    });
+    std::sort(scores.begin(), scores.end());
+    std::sort(details.begin(), details.end());
+}
+
+/// @brief Checks that a score, if set, is a number within a range.
+void check_range(const Character& character, const std::string& key,
+                 int min, int max, std::vector<std::string>& problems)
+{
+    if (character.get_detail(key))
+    {
+        problems.push_back(key + _(" must be a number"));
+        return;
+    }
+    const int* score = character.get_score(key);
+    if (score && (*score < min || *score > max))
+    {
+        problems.push_back(key + _(" must be from ") + std::to_string(min)
+                           + _(" to ") + std::to_string(max) + _(", not ")
+                           + std::to_string(*score));
+    }
+}
+
+inline bool ends_with(const std::string& s, const char* suffix) noexcept
+{
+    size_t length = std::char_traits<char>::length(suffix);
+    return s.size() >= length
+           && s.compare(s.size() - length, length, suffix) == 0;
+}
+
+inline bool is_effect(const std::string& key) noexcept
+{
+    return key.rfind(Encounter::effect_prefix, 0) == 0;
+}
+
+void append_json_string(std::string& out, const std::string& s)
+{
+    out += '"';
+    for (char c : s)
+    {
+        switch (c)
+        {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        case '\t':
+            out += "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                out += escaped;
+            }
+            else
+            {
+                out += c;
+            }
+        }
+    }
+    out += '"';
+}
+
+void append_csv_field(std::string& out, const std::string& s)
+{
+    if (s.find_first_of(",\"\r\n") == std::string::npos)
+    {
+        out += s;
+        return;
+    }
+    out += '"';
+    for (char c : s)
+    {
+        if (c == '"')
+            out += '"';
+        out += c;
+    }
+    out += '"';
+}
+
+void write_json(const Scores& scores, const Details& details,
+                const std::string& path, std::string& out)
+{
+    out += "{\n  \"file\": ";
+    append_json_string(out, path);
+    out += ",\n  \"scores\": {";
+    for (size_t i = 0; i < scores.size(); ++i)
+    {
+        out += i == 0 ? "\n    " : ",\n    ";
+        append_json_string(out, scores[i].first);
+        out += ": " + std::to_string(scores[i].second);
+    }
+    out += scores.empty() ? "},\n  \"details\": {" : "\n  },\n  \"details\": {";
+    for (size_t i = 0; i < details.size(); ++i)
+    {
+        out += i == 0 ? "\n    " : ",\n    ";
+        append_json_string(out, details[i].first);
+        out += ": ";
+        append_json_string(out, details[i].second);
+    }
+    out += details.empty() ? "}\n}\n" : "\n  }\n}\n";
+}
+
+void write_csv(const Scores& scores, const Details& details, std::string& out)
+{
+    out += "key,kind,value\n";
+    for (auto& score : scores)
+    {
+        append_csv_field(out, score.first);
+        out += ",score," + std::to_string(score.second) + "\n";
+    }
+    for (auto& detail : details)
+    {
+        append_csv_field(out, detail.first);
+        out += ",detail,";
+        append_csv_field(out, detail.second);
+        out += '\n';
+    }
+}
+
+void write_text(const Character& character, const Scores& scores,
+                const Details& details, const std::string& path,
+                std::string& out)
+{
+    const std::string* name = character.get_detail("name");
+    std::string title = name && !name->empty() ? *name : path;
+    out += title + '\n';
+    out.append(std::max(TextLayout::measure(title), 1), '=');
+    out += '\n';
+
+    size_t width = 0;
+    for (auto& score : scores)
+        width = std::max(width, score.first.size());
+    for (auto& detail : details)
+        width = std::max(width, detail.first.size());
+
+    auto field = [&](const std::string& key, const std::string& value)
+    {
+        out += "  " + key;
+        out.append(width - key.size() + 2, ' ');
+        out += value + '\n';
+    };
+    if (!scores.empty())
+    {
+        out += '\n';
+        out += _("Scores");
+        out += '\n';
+        for (auto& score : scores)
+            field(score.first, std::to_string(score.second));
+    }
+    if (!details.empty())
+    {
+        out += '\n';
+        out += _("Details");
+        out += '\n';
+        for (auto& detail : details)
+            field(detail.first, detail.second);
+    }
+}
+
+/// @brief Gets the path of the sheet exported for a character file.
+std::string sheet_path(const std::string& directory, const std::string& path,
+                       BatchMode::Format format)
+{
+    std::string stem = path.substr(path.rfind('/') + 1);
+    if (ends_with(stem, Roster::file_suffix))
+        stem.resize(stem.size()
+                    - std::char_traits<char>::length(Roster::file_suffix));
+    return directory + "/" + stem + BatchMode::get_extension(format);
+}
+
+}; // namespace
+
+bool BatchMode::parse_format(const std::string& name, Format& format) noexcept
+{
+    for (Format candidate : {Format::json, Format::csv, Format::text})
+    {
+        if (name == get_extension(candidate) + 1)
+        {
+            format = candidate;
+            return true;
+        }
+    }
+    if (name == "text")
+    {
+        format = Format::text;
+        return true;
+    }
+    return false;
+}
+
+const char* BatchMode::get_extension(Format format) noexcept
+{
+    switch (format)
+    {
+    case Format::json:
+        return ".json";
+    case Format::csv:
+        return ".csv";
+    case Format::text:
+        return ".txt";
+    default:
+        return "";
+    }
+}
+
+BatchMode::Stats BatchMode::run(const std::vector<std::string>& paths,
+                                const Settings& settings,
+                                std::ostream& problems)
+{
+    auto start = std::chrono::steady_clock::now();
+    const std::string& directory = settings.output_directory;
+    bool is_exporting = settings.format != Format::none;
+    if (is_exporting && mkdir(directory.c_str(), 0777) < 0 && errno != EEXIST)
+        throw std::system_error(errno, std::generic_category(), directory);
+
+    unsigned thread_count = settings.thread_count;
+    if (thread_count == 0)
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+
+    // read -> parse -> compute -> serialize -> write, skipping serialization
+    // when only validating.
+    Queue read_queue(settings.queue_capacity);
+    Queue parse_queue(settings.queue_capacity);
+    Queue compute_queue(settings.queue_capacity);
+    Queue serialize_queue(settings.queue_capacity);
+    Queue& done_queue = is_exporting ? serialize_queue : compute_queue;
+    std::atomic<unsigned> parsing{0};
+    std::atomic<unsigned> computing{0};
+    std::atomic<unsigned> serializing{0};
+    std::vector<std::thread> threads;
+    auto join = [&]
+    {
+        for (Queue* queue : {&read_queue, &parse_queue, &compute_queue,
+                             &serialize_queue})
+        {
+            queue->close();
+        }
+        for (auto& thread : threads)
+            thread.join();
+    };
+
+    Stats stats;
+    try
+    {
+        threads.emplace_back([&]
+        {
+            for (size_t i = 0; i < paths.size(); ++i)
+            {
+                std::unique_ptr<Item> item(new Item);
+                item->index = i;
+                item->path = paths[i];
+                try
+                {
+                    item->text = CharacterFile::read_text(paths[i]);
+                }
+                catch (CharacterFile::ReadException& e)
+                {
+                    item->is_readable = false;
+                    item->problems.push_back(e.what());
+                }
+                catch (std::exception& e)
+                {
+                    item->problems.push_back(e.what());
+                }
+                if (!read_queue.push(std::move(item)))
+                    break;
+            }
+            read_queue.close();
+        });
+
+        start_stage(threads, thread_count, read_queue, parse_queue, parsing,
+                    [](Item& item)
+        {
+            item.fields = CharacterFile::parse(item.text, item.path);
+            item.text = std::string();
+        });
+        start_stage(threads, thread_count, parse_queue, compute_queue,
+                    computing, [](Item& item)
+        {
+            CharacterFile::apply(item.fields, item.character);
+            item.fields = std::vector<CharacterFile::Field>();
+            DerivedStats::update_all(item.character);
+            item.problems = validate(item.character);
+        });
+        if (is_exporting)
+        {
+            start_stage(threads, thread_count, compute_queue, serialize_queue,
+                        serializing, [&settings](Item& item)
+            {
+                serialize(item.character, item.path, settings.format,
+                          item.sheet);
+                item.character = Character();
+            });
+        }
+
+        // Items finish out of order; they are held until their turn so that
+        // problems are reported in file order.
+        std::map<size_t, std::unique_ptr<Item>> finished;
+        std::unique_ptr<Item> item;
+        while (done_queue.pop(item))
+        {
+            size_t index = item->index;
+            finished.emplace(index, std::move(item));
+            for (auto next = finished.begin();
+                 next != finished.end() && next->first == stats.files;
+                 next = finished.erase(next))
+            {
+                Item& done = *next->second;
+                ++stats.files;
+                if (!done.is_readable)
+                {
+                    ++stats.unreadable;
+                    problems << done.problems.front() << '\n';
+                    continue;
+                }
+                if (!done.problems.empty())
+                {
+                    ++stats.invalid;
+                    for (auto& problem : done.problems)
+                        problems << done.path << _(": ") << problem << '\n';
+                    continue;
+                }
+                if (!is_exporting)
+                    continue;
+
+                std::string output = sheet_path(directory, done.path,
+                                                settings.format);
+                std::ofstream file(output, std::ios::binary);
+                file.write(done.sheet.data(), done.sheet.size());
+                file.close();
+                if (file)
+                    ++stats.exported;
+                else
+                    problems << output << _(": cannot write file") << '\n';
+            }
+        }
+    }
+    catch (...)
+    {
+        join();
+        throw;
+    }
+    join();
+    problems.flush();
+
+    stats.seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+std::vector<std::string> BatchMode::validate(const Character& character)
+{
+    std::vector<std::string> problems;
+    const std::string* name = character.get_detail("name");
+    if (!name || name->empty())
+        problems.push_back(_("missing name"));
+    check_range(character, "level", 1, max_level, problems);
+    for (const char* ability : abilities)
+        check_range(character, ability, 1, max_ability, problems);
+
+    const int* hp = character.get_score("hp");
+    const int* max_hp = character.get_score("max_hp");
+    if (hp && max_hp && *hp > *max_hp)
+    {
+        problems.push_back(_("hp ") + std::to_string(*hp)
+                           + _(" exceeds max_hp ") + std::to_string(*max_hp));
+    }
+
+    Scores scores;
+    Details details;
+    sort_fields(character, scores, details);
+    for (auto& score : scores)
+    {
+        if (is_effect(score.first) && score.second <= 0)
+            problems.push_back(score.first + _(": duration must be positive"));
+    }
+    for (auto& detail : details)
+    {
+        const std::string& key = detail.first;
+        const std::string& value = detail.second;
+        if (ends_with(key, DerivedStats::formula_suffix))
+        {
+            try
+            {
+                Formula::compile(value);
+            }
+            catch (const Formula::SyntaxException& e)
+            {
+                problems.push_back(key + _(": ") + e.what());
+            }
+        }
+        else if (is_effect(key) && Encounter::parse_duration(value) == 0)
+        {
+            problems.push_back(key + _(": malformed duration '") + value
+                               + _("'"));
+        }
+        else if (Inventory::is_item(key))
+        {
+            const std::string& container = Inventory::parse(value).container;
+            if (container == key)
+            {
+                problems.push_back(key + _(" is inside itself"));
+            }
+            else if (!container.empty() && !character.get_detail(container))
+            {
+                problems.push_back(key + _(": container '") + container
+                                   + _("' does not exist"));
+            }
+        }
+    }
+    return problems;
+}
+
+void BatchMode::serialize(const Character& character, const std::string& path,
+                          Format format, std::string& out)
+{
+    Scores scores;
+    Details details;
+    sort_fields(character, scores, details);
+    switch (format)
+    {
+    case Format::json:
+        write_json(scores, details, path, out);
+        break;
+    case Format::csv:
+        write_csv(scores, details, out);
+        break;
+    case Format::text:
+        write_text(character, scores, details, path, out);
+        break;
+    default:
+        break;
+    }
+}
+
+void BatchMode::report(const Stats& stats, std::ostream& out)
+{
+    char rate[64];
+    std::snprintf(rate, sizeof(rate), "%.2f s (%.0f", stats.seconds,
+                  stats.seconds > 0 ? stats.files / stats.seconds : 0.0);
+    out << _("Processed ") << stats.files << _(" files in ") << rate
+        << _(" files/s): ") << stats.invalid << _(" invalid, ")
+        << stats.unreadable << _(" unreadable, ") << stats.exported
+        << _(" exported") << std::endl;
+}
+
+}; // namespace gelcube
@@ -0,0 +1,128 @@
+/// @file batch_mode.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Validates and exports character files without the TUI.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_BATCH_MODE_HH_
+#define GELCUBE_SRC_BATCH_MODE_HH_
+
+#include "character.hh"
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace gelcube
+{
+
+/// @brief Validates and exports character files without the TUI.
+/// Files flow through a pipeline of stages (reading, parsing, computing
+/// derived stats and validating, then serializing), each running on its own
+/// threads and connected to the next by a gelcube::BoundedQueue, so the
+/// stages overlap and at most a few queues' worth of characters are held in
+/// memory however many files there are. The calling thread writes the sheets
+/// and reports problems in file order.
+typedef class BatchMode
+{
+public:
+    /// @brief Format of exported sheets.
+    enum class Format
+    {
+        none,
+        json,
+        csv,
+        text
+    };
+
+    /// @brief Settings of a batch run.
+    struct Settings
+    {
+        // Format of the sheets written, or none to only validate.
+        Format format = Format::none;
+        // Directory receiving one sheet per valid character, created if
+        // missing.
+        std::string output_directory = ".";
+        // Threads per parallel stage, or 0 for one per hardware thread.
+        unsigned thread_count = 0;
+        // Capacity of each queue between stages.
+        size_t queue_capacity = 64;
+    };
+
+    /// @brief Outcome of a batch run.
+    struct Stats
+    {
+        size_t files = 0;
+        // Files which could not be read or parsed.
+        size_t unreadable = 0;
+        // Characters breaking a rule (see validate()).
+        size_t invalid = 0;
+        size_t exported = 0;
+        double seconds = 0;
+    };
+
+    /// @brief Parses the name of a format.
+    /// @param name "json", "csv", or "text" or "txt".
+    /// @param format Receives the format.
+    /// @return false if the name is not recognized.
+    static bool parse_format(const std::string& name, Format& format) noexcept;
+
+    /// @brief Gets the file name extension of a format.
+    /// @param format Format of a sheet.
+    /// @return Extension, including the dot.
+    static const char* get_extension(Format format) noexcept;
+
+    /// @brief Processes character files.
+    /// Invalid characters are reported but not exported.
+    /// @param paths Paths of the character files.
+    /// @param settings Format, output directory and parallelism.
+    /// @param problems Stream receiving one line per problem, prefixed with
+    ///                 the path of the file.
+    /// @return Numbers of files processed, invalid and exported, and the
+    ///         time taken.
+    /// @throw std::system_error if the output directory cannot be created or
+    ///        a thread cannot be started.
+    static Stats run(const std::vector<std::string>& paths,
+                     const Settings& settings, std::ostream& problems);
+
+    /// @brief Checks a character against the rules.
+    /// Requires a name; a level from 1 to 20; ability scores from 1 to 30;
+    /// hit points no greater than the maximum; formulas which compile;
+    /// effect durations which parse; and items whose containers exist.
+    /// @param character Character with derived stats computed.
+    /// @return Description of each rule broken.
+    static std::vector<std::string> validate(const Character& character);
+
+    /// @brief Serializes a character as a sheet.
+    /// Fields are written in order of their keys.
+    /// @param character Character to serialize.
+    /// @param path Path of the character's file.
+    /// @param format Format of the sheet, other than none.
+    /// @param out String to append the sheet to.
+    static void serialize(const Character& character, const std::string& path,
+                          Format format, std::string& out);
+
+    /// @brief Prints the outcome and throughput of a batch run.
+    /// @param stats Outcome of the run.
+    /// @param out Stream to print to.
+    static void report(const Stats& stats, std::ostream& out);
+} BatchMode;
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_BATCH_MODE_HH_
@@ -0,0 +1,114 @@
+/// @file bounded_queue.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Blocking multiple-producer multiple-consumer queue of fixed capacity.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_BOUNDED_QUEUE_HH_
+#define GELCUBE_SRC_BOUNDED_QUEUE_HH_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+namespace gelcube
+{
+
+/// @brief Blocking multiple-producer multiple-consumer queue of fixed
+///        capacity.
+/// Connects the stages of a pipeline: producers wait while the queue is full,
+/// so a fast stage cannot run ahead of a slow one and memory stays
+/// proportional to the capacity. Closing the queue wakes every waiting
+/// thread; consumers then drain what is left.
+/// @tparam T Movable element type.
+template <typename T>
+class BoundedQueue
+{
+public:
+    /// @brief Constructs a new, empty BoundedQueue object.
+    /// @param capacity Maximum number of elements, at least 1.
+    explicit BoundedQueue(size_t capacity)
+        : capacity{capacity > 0 ? capacity : 1}
+    {
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    /// @brief Appends an element, waiting while the queue is full.
+    /// @param value Element to append.
+    /// @return false if the queue was closed, discarding the element.
+    bool push(T value)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [this]
+        {
+            return closed || elements.size() < capacity;
+        });
+        if (closed)
+            return false;
+        elements.push_back(std::move(value));
+        lock.unlock();
+        not_empty.notify_one();
+        return true;
+    }
+
+    /// @brief Removes the oldest element, waiting while the queue is empty.
+    /// @param value Receives the element.
+    /// @return false once the queue is closed and empty.
+    bool pop(T& value)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [this]
+        {
+            return closed || !elements.empty();
+        });
+        if (elements.empty())
+            return false;
+        value = std::move(elements.front());
+        elements.pop_front();
+        lock.unlock();
+        not_full.notify_one();
+        return true;
+    }
+
+    /// @brief Closes the queue.
+    /// Further pushes fail; pops succeed until the queue is empty.
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        not_full.notify_all();
+        not_empty.notify_all();
+    }
+
+private:
+    const size_t capacity;
+    std::deque<T> elements;
+    bool closed = false;
+    std::mutex mutex;
+    std::condition_variable not_full;
+    std::condition_variable not_empty;
+};
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_BOUNDED_QUEUE_HH_
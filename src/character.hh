@@ -0,0 +1,149 @@
+/// @file character.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Dungeons & Dragons character state.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_CHARACTER_HH_
+#define GELCUBE_SRC_CHARACTER_HH_
+
+#include "content.hh"
+#include "persistent_map.hh"
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace gelcube
+{
+
+struct CompiledFormulas;
+
+/// @brief Dungeons & Dragons character state.
+/// Stores numeric scores (level, hit points, ability scores, ...) and textual
+/// details (name, class, ...) in persistent maps. Copying a Character takes an
+/// O(1) snapshot which shares all of its memory with the original; modifying
+/// either copy afterwards only duplicates the path to the modified field.
+/// The names and values of details are gelcube::Content flyweights, so the
+/// items, spells and features which many characters have in common are
+/// stored once.
+typedef class Character
+{
+public:
+    typedef PersistentMap<std::string, int> Scores;
+    typedef PersistentMap<Content, Content, Content::Hash> Details;
+
+    /// @brief Gets a numeric score.
+    /// @param key Name of the score, e.g. "level".
+    /// @return Pointer to the score, or nullptr if it is not set.
+    inline const int* get_score(const std::string& key) const noexcept
+    {
+        return scores.find(key);
+    }
+
+    /// @brief Sets a numeric score.
+    /// Snapshots taken before the call are not affected.
+    /// @param key Name of the score.
+    /// @param value New value.
+    inline void set_score(const std::string& key, int value)
+    {
+        scores = scores.insert(key, value);
+    }
+
+    /// @brief Removes a numeric score.
+    /// @param key Name of the score.
+    inline void erase_score(const std::string& key)
+    {
+        scores = scores.erase(key);
+    }
+
+    /// @brief Gets a textual detail.
+    /// @param key Name of the detail, e.g. "name".
+    /// @return Pointer to the detail, or nullptr if it is not set.
+    inline const std::string* get_detail(const std::string& key) const noexcept
+    {
+        const Content* value = details.find(std::string_view(key));
+        return value ? &value->get_text() : nullptr;
+    }
+
+    /// @brief Sets a textual detail.
+    /// Snapshots taken before the call, and other characters sharing the
+    /// previous value, are not affected.
+    /// @param key Name of the detail.
+    /// @param value New value.
+    inline void set_detail(std::string_view key, std::string_view value)
+    {
+        details = details.insert(Content(key), Content(value));
+    }
+
+    /// @brief Sets a textual detail to shared content, without interning it
+    ///        again.
+    /// @param key Name of the detail.
+    /// @param value New value.
+    inline void set_detail(std::string_view key, Content value)
+    {
+        details = details.insert(Content(key), std::move(value));
+    }
+
+    /// @brief Removes a textual detail.
+    /// @param key Name of the detail.
+    inline void erase_detail(const std::string& key)
+    {
+        details = details.erase(std::string_view(key));
+    }
+
+    /// @brief Gets all numeric scores.
+    /// @return Persistent map of score names to values.
+    inline const Scores& get_scores() const noexcept
+    {
+        return scores;
+    }
+
+    /// @brief Gets all textual details.
+    /// @return Persistent map of shared detail names to shared values.
+    inline const Details& get_details() const noexcept
+    {
+        return details;
+    }
+
+    /// @brief Gets the formulas compiled for the character.
+    /// Maintained by gelcube::DerivedStats and shared between snapshots.
+    /// @return Compiled formulas, or nullptr if none have been compiled.
+    inline const std::shared_ptr<const CompiledFormulas>&
+    get_formulas() const noexcept
+    {
+        return formulas;
+    }
+
+    /// @brief Replaces the formulas compiled for the character.
+    /// @param formulas Compiled formulas.
+    inline void set_formulas(
+        std::shared_ptr<const CompiledFormulas> formulas) noexcept
+    {
+        this->formulas = std::move(formulas);
+    }
+
+private:
+    Scores scores;
+    Details details;
+    std::shared_ptr<const CompiledFormulas> formulas;
+} Character;
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_CHARACTER_HH_
@@ -0,0 +1,232 @@
+/// @file character_file.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Reads character files.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "character.hh"
+#include "character_file.hh"
+#include "derived_stats.hh"
+#include "intl.hh"
+#include "memory_accounting.hh"
+#include "trace.hh"
+
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <system_error>
+#include <unordered_set>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace gelcube
+{
+
+namespace
+{
+
+/// @brief Removes leading and trailing whitespace.
+std::string trim(const std::string& s, size_t begin, size_t end)
+{
+    while (begin < end && std::isspace(static_cast<unsigned char>(s[begin])))
+        ++begin;
+    while (end > begin && std::isspace(static_cast<unsigned char>(s[end - 1])))
+        --end;
+    return s.substr(begin, end - begin);
+}
+
+/// @brief Parses a whole string as a base 10 int.
+bool parse_int(const std::string& s, int& value)
+{
+    if (s.empty())
+        return false;
+
+    char* end;
+    errno = 0;
+    long parsed = std::strtol(s.c_str(), &end, 10);
+    if (*end != '\0' || errno == ERANGE || parsed < INT_MIN
+        || parsed > INT_MAX)
+    {
+        return false;
+    }
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+}; // namespace
+
+std::vector<CharacterFile::Field> CharacterFile::read(const std::string& path)
+{
+    return parse(read_text(path), path);
+}
+
+std::string CharacterFile::read_text(const std::string& path)
+{
+    Trace::Span span("CharacterFile::read_text");
+    MemoryAccounting::Scope scope(MemoryAccounting::Tag::content);
+    std::ifstream file(path);
+    if (!file)
+        throw ReadException(path + _(": cannot open file"));
+
+    std::string text{std::istreambuf_iterator<char>(file),
+                     std::istreambuf_iterator<char>()};
+    if (file.bad())
+        throw ReadException(path + _(": cannot read file"));
+    return text;
+}
+
+std::vector<CharacterFile::Field> CharacterFile::parse(const std::string& text,
+                                                       const std::string& path)
+{
+    MemoryAccounting::Scope scope(MemoryAccounting::Tag::content);
+    std::vector<Field> fields;
+    size_t number = 1;
+    for (size_t begin = 0; begin < text.size(); ++number)
+    {
+        size_t end = text.find('\n', begin);
+        if (end == std::string::npos)
+            end = text.size();
+        std::string content = trim(text, begin, end);
+        begin = end + 1;
+        if (content.empty() || content[0] == '#')
+            continue;
+
+        size_t separator = content.find('=');
+        std::string key = trim(content, 0,
+                               separator == std::string::npos ? 0 : separator);
+        if (key.empty())
+        {
+            throw ReadException(path + ":" + std::to_string(number)
+                                + _(": expected 'KEY = VALUE'"));
+        }
+
+        Field field{key, trim(content, separator + 1, content.size()), false,
+                    0};
+        field.is_score = parse_int(field.value, field.score);
+        fields.push_back(std::move(field));
+    }
+    return fields;
+}
+
+void CharacterFile::create(const std::string& path,
+                           const std::vector<Field>& fields,
+                           const std::string& comment)
+{
+    std::string text;
+    if (!comment.empty())
+        text += "# " + comment + "\n";
+    for (auto& field : fields)
+    {
+        text += field.key + " = "
+                + (field.is_score ? std::to_string(field.score) : field.value)
+                + "\n";
+    }
+
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC,
+                  0666);
+    if (fd < 0)
+        throw std::system_error(errno, std::generic_category(), path);
+    for (size_t offset = 0; offset < text.size();)
+    {
+        ssize_t written = write(fd, text.data() + offset,
+                                text.size() - offset);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written < 0)
+        {
+            int error = errno;
+            close(fd);
+            unlink(path.c_str());
+            throw std::system_error(error, std::generic_category(), path);
+        }
+        offset += written;
+    }
+    if (close(fd) < 0)
+    {
+        int error = errno;
+        unlink(path.c_str());
+        throw std::system_error(error, std::generic_category(), path);
+    }
+}
+
+std::vector<std::string> CharacterFile::apply(const std::vector<Field>& fields,
+                                              Character& character)
+{
+    MemoryAccounting::Scope scope(MemoryAccounting::Tag::content);
+    std::vector<std::string> changed;
+    std::unordered_set<std::string> present;
+
+    for (auto& field : fields)
+    {
+        present.insert(field.key);
+        if (DerivedStats::is_derived(field.key))
+            continue;
+
+        if (field.is_score)
+        {
+            const int* score = character.get_score(field.key);
+            if (!score || *score != field.score)
+            {
+                character.set_score(field.key, field.score);
+                character.erase_detail(field.key);
+                changed.push_back(field.key);
+            }
+        }
+        else
+        {
+            const std::string* detail = character.get_detail(field.key);
+            if (!detail || *detail != field.value)
+            {
+                character.set_detail(field.key, field.value);
+                character.erase_score(field.key);
+                changed.push_back(field.key);
+            }
+        }
+    }
+
+    // Removes fields deleted from the file.
+    std::vector<std::string> removed;
+    character.get_scores().for_each([&](const std::string& key, int)
+    {
+        if (!present.count(key) && !DerivedStats::is_derived(key, character))
+            removed.push_back(key);
+    });
+    for (auto& key : removed)
+        character.erase_score(key);
+    changed.insert(changed.end(), removed.begin(), removed.end());
+
+    removed.clear();
+    character.get_details().for_each([&](const std::string& key,
+                                          const std::string&)
+    {
+        if (!present.count(key))
+            removed.push_back(key);
+    });
+    for (auto& key : removed)
+        character.erase_detail(key);
+    changed.insert(changed.end(), removed.begin(), removed.end());
+
+    return changed;
+}
+
+}; // namespace gelcube
@@ -0,0 +1,114 @@
+/// @file character_file.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Reads character files.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_CHARACTER_FILE_HH_
+#define GELCUBE_SRC_CHARACTER_FILE_HH_
+
+#include "character.hh"
+
+#include <exception>
+#include <string>
+#include <vector>
+
+namespace gelcube
+{
+
+/// @brief Reads character files.
+/// A character file is a text file containing one 'KEY = VALUE' field per
+/// line. Blank lines and lines starting with '#' are ignored. Values which
+/// are integers are stored as scores, all other values as details.
+typedef class CharacterFile
+{
+public:
+    /// @brief Exception signifying an unreadable character file.
+    class ReadException : public std::exception
+    {
+    public:
+        /// @brief Constructs a new ReadException object.
+        /// @param message Description of the failure, including the path.
+        explicit ReadException(std::string message)
+            : message{std::move(message)}
+        {
+        }
+
+        const char* what() const noexcept override
+        {
+            return message.c_str();
+        }
+
+    private:
+        std::string message;
+    };
+
+    /// @brief Field read from a character file.
+    struct Field
+    {
+        std::string key;
+        std::string value;
+        bool is_score;
+        int score;
+    };
+
+    /// @brief Reads all fields from a character file.
+    /// @param path Path of the file.
+    /// @return Fields in file order. Later duplicates replace earlier ones
+    ///         when applied.
+    /// @throw gelcube::CharacterFile::ReadException if the file cannot be
+    ///        opened or a line is malformed.
+    static std::vector<Field> read(const std::string& path);
+
+    /// @brief Reads the contents of a character file without parsing them.
+    /// @param path Path of the file.
+    /// @return Contents of the file.
+    /// @throw gelcube::CharacterFile::ReadException if the file cannot be
+    ///        read.
+    static std::string read_text(const std::string& path);
+
+    /// @brief Parses the fields of a character file which was already read.
+    /// @param text Contents of the file.
+    /// @param path Path of the file, for error messages.
+    /// @return Fields in file order.
+    /// @throw gelcube::CharacterFile::ReadException if a line is malformed.
+    static std::vector<Field> parse(const std::string& text,
+                                    const std::string& path);
+
+    /// @brief Writes a new character file.
+    /// Values are written as they are, so they must not contain line breaks.
+    /// @param path Path of the file, which must not exist.
+    /// @param fields Fields to write, in order.
+    /// @param comment Line written first as a comment, or empty.
+    /// @throw std::system_error if the file exists or cannot be written.
+    static void create(const std::string& path,
+                       const std::vector<Field>& fields,
+                       const std::string& comment = "");
+
+    /// @brief Applies fields to a character, changing only what differs.
+    /// Fields missing from the file are removed from the character, except
+    /// for derived stats, which are maintained separately.
+    /// @param fields Fields read from a character file.
+    /// @param character Character to update in place.
+    /// @return Keys of the scores and details which changed.
+    static std::vector<std::string> apply(const std::vector<Field>& fields,
+                                          Character& character);
+} CharacterFile;
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_CHARACTER_FILE_HH_
@@ -0,0 +1,159 @@
+/// @file character_table.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Columns of character fields for filtering many characters.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "character.hh"
+#include "character_table.hh"
+#include "roster.hh"
+#include "symbol.hh"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace gelcube
+{
+
+const char* const CharacterTable::common_keys[] = {"level", "hp", "max_hp",
+                                                   "ac", nullptr};
+
+CharacterTable CharacterTable::from_roster()
+{
+    CharacterTable table;
+    for (auto& entry : Roster::get_entries())
+        table.add(entry.history.current());
+    if (table.size() >= index_threshold)
+    {
+        for (const char* const* key = common_keys; *key; ++key)
+            table.build_index(Symbol(*key));
+    }
+    return table;
+}
+
+size_t CharacterTable::add_row()
+{
+    indexes.clear();
+    if (rows == padded_rows)
+    {
+        padded_rows += block_rows;
+        for (auto& column : scores)
+            column.second.resize(padded_rows, missing_score);
+        for (auto& column : details)
+            column.second.resize(padded_rows, missing_detail);
+    }
+    return rows++;
+}
+
+size_t CharacterTable::add(const Character& character)
+{
+    size_t row = add_row();
+    character.get_scores().for_each([&](const std::string& key, int value)
+    {
+        set_score(row, Symbol(key), value);
+    });
+    character.get_details().for_each([&](const std::string& key,
+                                         const std::string& value)
+    {
+        set_detail(row, Symbol(key), value);
+    });
+    return row;
+}
+
+void CharacterTable::set_score(size_t row, Symbol key, int32_t value)
+{
+    std::vector<int32_t>& column = scores[key];
+    if (column.empty())
+        column.resize(padded_rows, missing_score);
+    column[row] = value;
+}
+
+void CharacterTable::set_detail(size_t row, Symbol key,
+                                std::string_view value)
+{
+    std::vector<uint32_t>& column = details[key];
+    if (column.empty())
+        column.resize(padded_rows, missing_detail);
+
+    // Dictionary numbers start after missing_detail.
+    auto id = values.emplace(fold(value), values.size() + 1).first;
+    column[row] = id->second;
+}
+
+void CharacterTable::build_index(Symbol key)
+{
+    auto column = scores.find(key);
+    if (column == scores.end())
+        return;
+
+    std::vector<IndexEntry>& index = indexes[key];
+    index.clear();
+    for (size_t row = 0; row < rows; ++row)
+    {
+        int32_t value = column->second[row];
+        if (value != missing_score)
+            index.push_back({value, static_cast<uint32_t>(row)});
+    }
+    std::sort(index.begin(), index.end(),
+              [](const IndexEntry& a, const IndexEntry& b)
+              {
+                  return a.value < b.value
+                         || (a.value == b.value && a.row < b.row);
+              });
+}
+
+const int32_t* CharacterTable::get_scores(Symbol key) const noexcept
+{
+    auto column = scores.find(key);
+    return column == scores.end() ? nullptr : column->second.data();
+}
+
+const uint32_t* CharacterTable::get_details(Symbol key) const noexcept
+{
+    auto column = details.find(key);
+    return column == details.end() ? nullptr : column->second.data();
+}
+
+uint32_t CharacterTable::find_value(std::string_view value) const
+{
+    auto id = values.find(std::string(value));
+    return id == values.end() ? missing_detail : id->second;
+}
+
+const std::vector<CharacterTable::IndexEntry>* CharacterTable::get_index(
+    Symbol key) const noexcept
+{
+    auto index = indexes.find(key);
+    return index == indexes.end() ? nullptr : &index->second;
+}
+
+std::string CharacterTable::fold(std::string_view text)
+{
+    std::string folded(text);
+    for (char& ch : folded)
+    {
+        if (ch >= 'A' && ch <= 'Z')
+            ch = static_cast<char>(ch - 'A' + 'a');
+    }
+    return folded;
+}
+
+}; // namespace gelcube
@@ -0,0 +1,151 @@
+/// @file character_table.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Columns of character fields for filtering many characters.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_CHARACTER_TABLE_HH_
+#define GELCUBE_SRC_CHARACTER_TABLE_HH_
+
+#include "character.hh"
+#include "symbol.hh"
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace gelcube
+{
+
+/// @brief Columns of character fields for filtering many characters.
+/// Each score or detail key is a column holding one value per character
+/// (row), so that a predicate reads one contiguous array instead of a map per
+/// character. Detail values are folded to lower case and stored as numbers
+/// from a dictionary shared by all columns. Columns are padded with missing
+/// values to a whole number of blocks, so that filters work on whole blocks.
+/// Score columns may also have a secondary index, sorted by value, for
+/// selective range queries.
+typedef class CharacterTable
+{
+public:
+    /// @brief Value of a score column where a character has no such score.
+    static constexpr int32_t missing_score = INT32_MIN;
+
+    /// @brief Value of a detail column where a character has no such detail.
+    static constexpr uint32_t missing_detail = 0;
+
+    /// @brief Number of rows in a block.
+    static constexpr size_t block_rows = 64;
+
+    /// @brief Keys given an index by from_roster() when the roster is large.
+    static const char* const common_keys[];
+
+    /// @brief Entry of a secondary index.
+    struct IndexEntry
+    {
+        int32_t value;
+        uint32_t row;
+    };
+
+    /// @brief Builds a table of the current version of every character in
+    ///        the roster.
+    /// Rows are in the order of gelcube::Roster::get_entries(). Indexes the
+    /// common keys if there are enough characters for them to pay off.
+    /// @return New table.
+    static CharacterTable from_roster();
+
+    /// @brief Adds a row with no fields.
+    /// Discards any indexes.
+    /// @return Number of the new row.
+    size_t add_row();
+
+    /// @brief Adds a row holding the scores and details of a character.
+    /// @param character Character to add.
+    /// @return Number of the new row.
+    size_t add(const Character& character);
+
+    /// @brief Sets a score in a row.
+    /// @param row Number of the row.
+    /// @param key Name of the score.
+    /// @param value New value, other than missing_score.
+    void set_score(size_t row, Symbol key, int32_t value);
+
+    /// @brief Sets a detail in a row.
+    /// @param row Number of the row.
+    /// @param key Name of the detail.
+    /// @param value New value, folded to lower case.
+    void set_detail(size_t row, Symbol key, std::string_view value);
+
+    /// @brief Builds a secondary index of a score column.
+    /// Rows with no such score are left out.
+    /// @param key Name of the score.
+    void build_index(Symbol key);
+
+    /// @brief Gets the number of rows.
+    /// @return Number of rows, without padding.
+    inline size_t size() const noexcept
+    {
+        return rows;
+    }
+
+    /// @brief Gets a score column.
+    /// @param key Name of the score.
+    /// @return Values of every row and the padding after them, or nullptr if
+    ///         no row has the score.
+    const int32_t* get_scores(Symbol key) const noexcept;
+
+    /// @brief Gets a detail column.
+    /// @param key Name of the detail.
+    /// @return Dictionary numbers of the values of every row and the padding
+    ///         after them, or nullptr if no row has the detail.
+    const uint32_t* get_details(Symbol key) const noexcept;
+
+    /// @brief Looks up a detail value in the dictionary.
+    /// @param value Value, folded to lower case.
+    /// @return Dictionary number, or missing_detail if no row has the value.
+    uint32_t find_value(std::string_view value) const;
+
+    /// @brief Gets the secondary index of a score column.
+    /// @param key Name of the score.
+    /// @return Entries sorted by value, or nullptr if the column is not
+    ///         indexed.
+    const std::vector<IndexEntry>* get_index(Symbol key) const noexcept;
+
+    /// @brief Folds text for comparison.
+    /// @param text UTF-8 text.
+    /// @return Text with ASCII letters in lower case.
+    static std::string fold(std::string_view text);
+
+private:
+    /// @brief Rows above which from_roster() indexes the common keys.
+    static constexpr size_t index_threshold = 4096;
+
+    size_t rows = 0;
+    size_t padded_rows = 0;
+    std::unordered_map<Symbol, std::vector<int32_t>> scores;
+    std::unordered_map<Symbol, std::vector<uint32_t>> details;
+    std::unordered_map<std::string, uint32_t> values;
+    std::unordered_map<Symbol, std::vector<IndexEntry>> indexes;
+} CharacterTable;
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_CHARACTER_TABLE_HH_
@@ -0,0 +1,163 @@
+/// @file content.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Flyweight text shared between characters.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "content.hh"
+#include "intern_table.hh"
+#include "memory_accounting.hh"
+
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace gelcube
+{
+
+namespace
+{
+
+/// @brief Shared text, its hash and the number of handles referring to it.
+struct Entry
+{
+    std::string text;
+    size_t hash = 0;
+    std::atomic<uint32_t> references{0};
+};
+
+typedef InternTable<Entry> Table;
+
+const std::string empty;
+const size_t empty_hash = Content::Hash{}(std::string_view());
+
+// Guarded by table_mutex.
+std::mutex table_mutex;
+uint32_t next_id = 1;
+std::vector<uint32_t> free_ids;
+std::atomic<size_t> entry_count{0};
+std::atomic<size_t> text_size{0};
+
+}; // namespace
+
+Content::Content(std::string_view text)
+{
+    if (text.empty())
+        return;
+
+    // The table is shared by every character, however it was loaded.
+    MemoryAccounting::Scope scope(MemoryAccounting::Tag::content);
+    std::lock_guard<std::mutex> lock(table_mutex);
+    auto& ids = Table::get_ids();
+    auto existing = ids.find(text);
+    if (existing != ids.end())
+    {
+        id = existing->second;
+        Table::get(id).references.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    uint32_t next;
+    if (!free_ids.empty())
+    {
+        next = free_ids.back();
+    }
+    else
+    {
+        if (next_id == UINT32_MAX)
+            throw std::length_error("too many content entries");
+        next = next_id;
+    }
+
+    Entry& entry = Table::add(next);
+    entry.text.assign(text);
+    entry.hash = Hash{}(text);
+    ids.emplace(entry.text, next);
+    entry.references.store(1, std::memory_order_relaxed);
+    if (!free_ids.empty())
+        free_ids.pop_back();
+    else
+        ++next_id;
+    entry_count.fetch_add(1, std::memory_order_relaxed);
+    text_size.fetch_add(text.size(), std::memory_order_relaxed);
+    id = next;
+}
+
+Content::Content(const Content& other) noexcept
+    : id{other.id}
+{
+    if (id != 0)
+        Table::get(id).references.fetch_add(1, std::memory_order_relaxed);
+}
+
+Content::~Content()
+{
+    if (id == 0)
+        return;
+    Entry& entry = Table::get(id);
+    if (entry.references.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        return;
+
+    // Another thread may have interned the text again, or removed the entry
+    // and reused it, before the lock was taken; only an entry which is still
+    // stored and has no handles is removed.
+    MemoryAccounting::Scope scope(MemoryAccounting::Tag::content);
+    std::lock_guard<std::mutex> lock(table_mutex);
+    if (entry.references.load(std::memory_order_relaxed) != 0
+        || entry.text.empty())
+    {
+        return;
+    }
+    Table::get_ids().erase(entry.text);
+    text_size.fetch_sub(entry.text.size(), std::memory_order_relaxed);
+    entry_count.fetch_sub(1, std::memory_order_relaxed);
+    std::string().swap(entry.text);
+    free_ids.push_back(id);
+}
+
+const std::string& Content::get_text() const noexcept
+{
+    if (id == 0)
+        return empty;
+    return Table::get(id).text;
+}
+
+size_t Content::get_hash() const noexcept
+{
+    if (id == 0)
+        return empty_hash;
+    return Table::get(id).hash;
+}
+
+size_t Content::get_count() noexcept
+{
+    return entry_count.load(std::memory_order_relaxed);
+}
+
+size_t Content::get_size() noexcept
+{
+    return text_size.load(std::memory_order_relaxed);
+}
+
+}; // namespace gelcube
@@ -0,0 +1,140 @@
+/// @file content.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Flyweight text shared between characters.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_CONTENT_HH_
+#define GELCUBE_SRC_CONTENT_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace gelcube
+{
+
+/// @brief Flyweight text shared between characters.
+/// Every distinct text is stored once in a global table of immutable entries,
+/// which handles refer to by a 32-bit identifier, so the items, spells and
+/// features repeated across thousands of characters cost four bytes each.
+/// Changing the text of one character's detail interns the new text and
+/// leaves every other handle untouched. Entries are counted by the handles
+/// referring to them and removed, for their identifiers to be reused, when
+/// the last handle is destroyed.
+/// Handles may be created, copied and read on any thread.
+typedef class Content
+{
+public:
+    /// @brief Constructs a handle to the empty text.
+    Content() noexcept = default;
+
+    /// @brief Constructs a handle to a text, interning it if necessary.
+    /// @param text Text to intern.
+    /// @throw std::length_error if the table is full.
+    explicit Content(std::string_view text);
+
+    Content(const Content& other) noexcept;
+
+    inline Content(Content&& other) noexcept
+        : id{other.id}
+    {
+        other.id = 0;
+    }
+
+    inline Content& operator=(Content other) noexcept
+    {
+        std::swap(id, other.id);
+        return *this;
+    }
+
+    ~Content();
+
+    /// @brief Gets the shared text.
+    /// @return Text, valid for as long as a handle to it exists.
+    const std::string& get_text() const noexcept;
+
+    /// @brief Gets the shared text, so that handles can be used wherever a
+    ///        string is read.
+    inline operator const std::string&() const noexcept
+    {
+        return get_text();
+    }
+
+    /// @brief Gets the hash of the text.
+    /// Computed when the text is interned; equal to Hash of the text itself.
+    /// @return Hash.
+    size_t get_hash() const noexcept;
+
+    /// @brief Gets the identifier of the entry.
+    /// Identifiers of removed entries are reused; the empty text is 0.
+    /// @return Identifier.
+    inline uint32_t get_id() const noexcept
+    {
+        return id;
+    }
+
+    /// @brief Gets the number of distinct texts stored.
+    /// @return Count, excluding the empty text.
+    static size_t get_count() noexcept;
+
+    /// @brief Gets the number of bytes of text stored.
+    /// @return Sum of the lengths of the distinct texts.
+    static size_t get_size() noexcept;
+
+    /// @brief Compares texts in O(1), since equal texts share an entry.
+    inline bool operator==(const Content& other) const noexcept
+    {
+        return id == other.id;
+    }
+
+    inline bool operator!=(const Content& other) const noexcept
+    {
+        return id != other.id;
+    }
+
+    /// @brief Compares with a text which need not be interned.
+    inline bool operator==(std::string_view text) const noexcept
+    {
+        return get_text() == text;
+    }
+
+    /// @brief Hashes handles and texts alike, so that maps keyed by content
+    ///        can be searched for a text without interning it.
+    struct Hash
+    {
+        inline size_t operator()(const Content& content) const noexcept
+        {
+            return content.get_hash();
+        }
+
+        inline size_t operator()(std::string_view text) const noexcept
+        {
+            return std::hash<std::string_view>{}(text);
+        }
+    };
+
+private:
+    uint32_t id = 0;
+} Content;
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_CONTENT_HH_
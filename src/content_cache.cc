@@ -0,0 +1,475 @@
+/// @file content_cache.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Parsed character files shared between processes.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "content_cache.hh"
+#include "character.hh"
+#include "intl.hh"
+#include "logger.hh"
+#include "memory_accounting.hh"
+#include "roster.hh"
+#include "trace.hh"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace gelcube
+{
+
+namespace
+{
+
+// Layout of a cache file:
+//   Header
+//   uint64_t offsets of the records, sorted by file name
+//   records: Record, then score_count and detail_count Fields
+//   texts: uint32_t length, then the bytes, each referred to by its offset
+// Integers are in the byte order of the host, which byte_order records.
+
+const char magic[8] = {'g', 'e', 'l', 'c', 'u', 'b', 'e', 'c'};
+const uint32_t byte_order = 0x01020304;
+
+struct Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t size;
+    uint64_t record_count;
+    uint64_t index_offset;
+    uint64_t text_offset;
+    uint64_t text_size;
+    // Of everything after the header.
+    uint64_t checksum;
+};
+
+struct Record
+{
+    // Name of the file within the roster directory.
+    uint32_t name;
+    uint32_t score_count;
+    uint32_t detail_count;
+    uint32_t reserved;
+    uint64_t size;
+    uint64_t inode;
+    int64_t modified;
+    int64_t changed;
+};
+
+// Score or detail; values of scores are stored as their bits.
+struct Field
+{
+    uint32_t key;
+    uint32_t value;
+};
+
+/// @brief Reads a structure from a possibly unaligned position.
+template <typename T>
+inline T load_at(const char* data, uint64_t offset) noexcept
+{
+    T value;
+    std::memcpy(&value, data + offset, sizeof(value));
+    return value;
+}
+
+/// @brief Hashes bytes eight at a time, to detect a damaged cache at a cost
+///        far below that of reading the character files.
+uint64_t get_checksum(const char* data, size_t size) noexcept
+{
+    uint64_t hash = 0xcbf29ce484222325;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+    {
+        hash = (hash ^ load_at<uint64_t>(data, i)) * 0x100000001b3;
+        hash ^= hash >> 29;
+    }
+    for (; i < size; ++i)
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * 0x100000001b3;
+    return hash;
+}
+
+/// @brief Appends a structure to a buffer.
+template <typename T>
+inline void append(std::string& buffer, const T& value)
+{
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+/// @brief Gets the name of a file within its directory.
+inline std::string_view get_name(const std::string& path) noexcept
+{
+    size_t slash = path.rfind('/');
+    return slash == std::string::npos
+               ? std::string_view(path)
+               : std::string_view(path).substr(slash + 1);
+}
+
+/// @brief Writes a whole buffer to a file.
+bool write_all(int fd, const std::string& buffer) noexcept
+{
+    size_t written = 0;
+    while (written < buffer.size())
+    {
+        ssize_t count = write(fd, buffer.data() + written,
+                              buffer.size() - written);
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count <= 0)
+            return false;
+        written += count;
+    }
+    return true;
+}
+
+}; // namespace
+
+std::string ContentCache::directory = ContentCache::default_directory;
+
+void ContentCache::set_directory(const std::string& directory)
+{
+    ContentCache::directory = directory;
+}
+
+ContentCache::ContentCache(const std::string& roster_directory)
+    : log{Logger::source}
+{
+    struct stat roster;
+    if (directory.empty() || stat(roster_directory.c_str(), &roster) != 0)
+        return;
+
+    // Named by the directory's identity rather than its path, so that every
+    // spelling of the path shares one cache.
+    char name[64];
+    std::snprintf(name, sizeof(name), "/gelcube-%llx-%llx.cache",
+                  static_cast<unsigned long long>(roster.st_dev),
+                  static_cast<unsigned long long>(roster.st_ino));
+    path = directory + name;
+
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+    if (fd < 0)
+        return;
+
+    // Only caches which could not have been written by someone able to
+    // forge characters are trusted.
+    struct stat cache;
+    if (fstat(fd, &cache) == 0 && S_ISREG(cache.st_mode)
+        && !(cache.st_mode & (S_IWGRP | S_IWOTH))
+        && (cache.st_uid == geteuid() || cache.st_uid == roster.st_uid
+            || cache.st_uid == 0)
+        && static_cast<uint64_t>(cache.st_size) >= sizeof(Header))
+    {
+        void* mapping = mmap(nullptr, cache.st_size, PROT_READ, MAP_SHARED,
+                             fd, 0);
+        if (mapping != MAP_FAILED)
+        {
+            data = static_cast<const char*>(mapping);
+            size = cache.st_size;
+        }
+    }
+    close(fd);
+    if (!data)
+        return;
+
+    Header header = load_at<Header>(data, 0);
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0
+        || header.version != format_version || header.byte_order != byte_order
+        || header.size != size || header.index_offset < sizeof(Header)
+        || header.index_offset > size
+        || header.record_count > (size - header.index_offset) / sizeof(uint64_t)
+        || header.text_offset > size
+        || header.text_size > size - header.text_offset
+        || header.checksum != get_checksum(data + sizeof(Header),
+                                           size - sizeof(Header)))
+    {
+        munmap(const_cast<char*>(data), size);
+        data = nullptr;
+        size = 0;
+        return;
+    }
+    record_count = header.record_count;
+    index_offset = header.index_offset;
+    text_offset = header.text_offset;
+    text_size = header.text_size;
+}
+
+ContentCache::~ContentCache()
+{
+    if (data)
+        munmap(const_cast<char*>(data), size);
+}
+
+Character ContentCache::read(const std::string& path)
+{
+    std::string_view name = get_name(path);
+    Cached cached;
+    uint64_t record = data ? find(name) : 0;
+    if (record != 0 && load(record, path, cached))
+    {
+        hits.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        // Stamped first, so that a file changing while it is read is read
+        // again next time rather than cached as it was.
+        bool is_stamped = get_stamp(path, cached.stamp);
+        cached.character = Roster::read(path);
+        misses.fetch_add(1, std::memory_order_relaxed);
+        if (!is_stamped)
+            return cached.character;
+    }
+
+    MemoryAccounting::Scope scope(MemoryAccounting::Tag::content);
+    std::lock_guard<std::mutex> lock(read_mutex);
+    auto& entry = characters[std::string(name)];
+    entry = cached;
+    return cached.character;
+}
+
+void ContentCache::publish()
+{
+    if (path.empty()
+        || (misses.load() == 0 && hits.load() == record_count))
+    {
+        return;
+    }
+
+    Trace::Span span("ContentCache::publish");
+    MemoryAccounting::Scope scope(MemoryAccounting::Tag::content);
+    std::lock_guard<std::mutex> lock(read_mutex);
+    std::string texts;
+    std::unordered_map<std::string_view, uint32_t> references;
+    auto add_text = [&](std::string_view text)
+    {
+        auto existing = references.find(text);
+        if (existing != references.end())
+            return existing->second;
+        if (texts.size() + sizeof(uint32_t) + text.size() > UINT32_MAX)
+            throw std::length_error("content cache too large");
+        uint32_t reference = texts.size();
+        append(texts, static_cast<uint32_t>(text.size()));
+        texts.append(text);
+        references.emplace(text, reference);
+        return reference;
+    };
+
+    std::string records;
+    std::vector<uint64_t> index;
+    try
+    {
+        for (auto& [name, cached] : characters)
+        {
+            const Character& character = cached.character;
+            index.push_back(records.size());
+            Record record{};
+            record.name = add_text(name);
+            record.score_count = character.get_scores().size();
+            record.detail_count = character.get_details().size();
+            record.size = cached.stamp.size;
+            record.inode = cached.stamp.inode;
+            record.modified = cached.stamp.modified;
+            record.changed = cached.stamp.changed;
+            append(records, record);
+            character.get_scores().for_each([&](const std::string& key,
+                                                int value)
+            {
+                append(records, Field{add_text(key),
+                                      static_cast<uint32_t>(value)});
+            });
+            character.get_details().for_each([&](const std::string& key,
+                                                 const std::string& value)
+            {
+                append(records, Field{add_text(key), add_text(value)});
+            });
+        }
+    }
+    catch (std::length_error& e)
+    {
+        BOOST_LOG_SEV(log, LogLevel::warning)
+            << path << _(": cannot publish: ") << e.what();
+        return;
+    }
+
+    Header header{};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = format_version;
+    header.byte_order = byte_order;
+    header.record_count = index.size();
+    header.index_offset = sizeof(Header);
+    uint64_t records_offset = header.index_offset
+                              + index.size() * sizeof(uint64_t);
+    header.text_offset = records_offset + records.size();
+    header.text_size = texts.size();
+    header.size = header.text_offset + texts.size();
+
+    std::string file;
+    file.reserve(header.size);
+    append(file, header);
+    for (uint64_t offset : index)
+        append(file, records_offset + offset);
+    file += records;
+    file += texts;
+    header.checksum = get_checksum(file.data() + sizeof(Header),
+                                   file.size() - sizeof(Header));
+    std::memcpy(&file[0], &header, sizeof(Header));
+
+    // Renamed into place once complete, so that readers see either version
+    // whole; those which mapped the old one keep it until they unmap it.
+    std::string temporary = path + "." + std::to_string(getpid()) + ".tmp";
+    int fd = open(temporary.c_str(),
+                  O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC | O_NOFOLLOW, 0644);
+    bool is_written = fd >= 0 && write_all(fd, file);
+    int error = errno;
+    if (fd >= 0 && close(fd) != 0 && is_written)
+    {
+        is_written = false;
+        error = errno;
+    }
+    if (is_written && rename(temporary.c_str(), path.c_str()) == 0)
+        return;
+    if (is_written)
+        error = errno;
+    if (fd >= 0)
+        unlink(temporary.c_str());
+
+    // Caches owned by other users, or a missing or read-only directory,
+    // only mean that this roster is not shared.
+    if (error != EACCES && error != EPERM && error != ENOENT
+        && error != EROFS)
+    {
+        BOOST_LOG_SEV(log, LogLevel::warning)
+            << path << _(": cannot publish: ")
+            << std::system_category().message(error);
+    }
+}
+
+bool ContentCache::get_stamp(const std::string& path, Stamp& stamp) noexcept
+{
+    struct stat file;
+    if (stat(path.c_str(), &file) != 0)
+        return false;
+    stamp.size = file.st_size;
+    stamp.inode = file.st_ino;
+    stamp.modified = file.st_mtim.tv_sec * INT64_C(1000000000)
+                     + file.st_mtim.tv_nsec;
+    stamp.changed = file.st_ctim.tv_sec * INT64_C(1000000000)
+                    + file.st_ctim.tv_nsec;
+    return true;
+}
+
+uint64_t ContentCache::find(std::string_view name) const noexcept
+{
+    uint64_t low = 0;
+    uint64_t high = record_count;
+    while (low < high)
+    {
+        uint64_t middle = low + (high - low) / 2;
+        uint64_t record = load_at<uint64_t>(
+            data, index_offset + middle * sizeof(uint64_t));
+        std::string_view other;
+        if (record == 0 || record > size - sizeof(Record)
+            || !get_text(load_at<Record>(data, record).name, other))
+        {
+            return 0;
+        }
+        int order = other.compare(name);
+        if (order == 0)
+            return record;
+        if (order < 0)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return 0;
+}
+
+bool ContentCache::load(uint64_t offset, const std::string& path,
+                        Cached& cached) const
+{
+    Record record = load_at<Record>(data, offset);
+    uint64_t fields = offset + sizeof(Record);
+    uint64_t field_count = uint64_t{record.score_count} + record.detail_count;
+    if (field_count > (size - fields) / sizeof(Field))
+        return false;
+
+    Stamp& stamp = cached.stamp;
+    if (!get_stamp(path, stamp) || stamp.size != record.size
+        || stamp.inode != record.inode || stamp.modified != record.modified
+        || stamp.changed != record.changed)
+    {
+        return false;
+    }
+
+    MemoryAccounting::Scope scope(MemoryAccounting::Tag::content);
+    Character character;
+    std::string key;
+    for (uint64_t i = 0; i < field_count; ++i)
+    {
+        Field field = load_at<Field>(data, fields + i * sizeof(Field));
+        std::string_view key_text;
+        std::string_view value_text;
+        if (!get_text(field.key, key_text))
+            return false;
+        if (i < record.score_count)
+        {
+            key.assign(key_text);
+            character.set_score(key, static_cast<int32_t>(field.value));
+        }
+        else if (get_text(field.value, value_text))
+        {
+            character.set_detail(key_text, value_text);
+        }
+        else
+        {
+            return false;
+        }
+    }
+    cached.character = std::move(character);
+    return true;
+}
+
+bool ContentCache::get_text(uint32_t reference,
+                            std::string_view& text) const noexcept
+{
+    if (text_size < sizeof(uint32_t)
+        || reference > text_size - sizeof(uint32_t))
+    {
+        return false;
+    }
+    uint32_t length = load_at<uint32_t>(data, text_offset + reference);
+    if (length > text_size - sizeof(uint32_t) - reference)
+        return false;
+    text = std::string_view(data + text_offset + reference + sizeof(uint32_t),
+                            length);
+    return true;
+}
+
+}; // namespace gelcube
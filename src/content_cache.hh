@@ -0,0 +1,151 @@
+/// @file content_cache.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Parsed character files shared between processes.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_CONTENT_CACHE_HH_
+#define GELCUBE_SRC_CONTENT_CACHE_HH_
+
+#include "character.hh"
+#include "logger.hh"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace gelcube
+{
+
+/// @brief Parsed character files shared between processes.
+/// The characters of a roster directory, with their derived stats, are
+/// published to a cache file, by default in /dev/shm, which later processes
+/// loading the same directory map read-only and share through the page
+/// cache, instead of reading and parsing every file. Each text is stored
+/// once. A character is taken from the cache only if its file has the same
+/// size, inode and modification and change times as when it was cached;
+/// other files are read as usual, and the cache is republished if any were.
+/// Publishing writes a new file and renames it over the old one, so
+/// processes which mapped the old version keep reading it safely. Caches
+/// written by another version of the format, or owned by anyone but the
+/// user, the owner of the roster directory or root, are ignored.
+typedef class ContentCache
+{
+public:
+    /// @brief Version of the file format, changed whenever it or the way
+    ///        derived stats are computed changes.
+    static constexpr uint32_t format_version = 1;
+
+    /// @brief Directory holding caches unless set_directory() is called.
+    static constexpr const char* default_directory = "/dev/shm";
+
+    /// @brief Sets the directory holding caches.
+    /// @param directory Path of the directory, or an empty string to disable
+    ///                  caching.
+    static void set_directory(const std::string& directory);
+
+    /// @brief Maps the cache of a roster directory, if there is a valid one.
+    /// @param roster_directory Path of the roster directory.
+    explicit ContentCache(const std::string& roster_directory);
+
+    ContentCache(const ContentCache&) = delete;
+    ContentCache& operator=(const ContentCache&) = delete;
+
+    ~ContentCache();
+
+    /// @brief Reads a character from the cache, or from its file if it
+    ///        changed since it was cached.
+    /// Safe to call from any thread.
+    /// @param path Path of a file in the roster directory.
+    /// @return Character described by the file, with derived stats.
+    /// @throw gelcube::CharacterFile::ReadException if the file cannot be
+    ///        read.
+    Character read(const std::string& path);
+
+    /// @brief Publishes the characters read, if any were not in the cache or
+    ///        any cached file was not read.
+    /// Failures are logged; the roster is still usable without a cache.
+    void publish();
+
+    /// @brief Gets the number of characters read from the cache.
+    /// @return Count.
+    inline size_t get_hits() const noexcept
+    {
+        return hits.load(std::memory_order_relaxed);
+    }
+
+private:
+    /// @brief Identity and version of a file, as given by stat().
+    struct Stamp
+    {
+        uint64_t size;
+        uint64_t inode;
+        // Modification and status change times in nanoseconds.
+        int64_t modified;
+        int64_t changed;
+    };
+
+    /// @brief Character read and the stamp of its file beforehand.
+    struct Cached
+    {
+        Character character;
+        Stamp stamp;
+    };
+
+    /// @brief Gets the stamp of a file.
+    /// @return false if the file cannot be examined.
+    static bool get_stamp(const std::string& path, Stamp& stamp) noexcept;
+
+    /// @brief Finds the record of a file.
+    /// @param name Name of the file within the roster directory.
+    /// @return Offset of the record, or 0 if there is none.
+    uint64_t find(std::string_view name) const noexcept;
+
+    /// @brief Builds the character of a record, if its file is unchanged.
+    /// @return false if the file changed or the record is malformed.
+    bool load(uint64_t record, const std::string& path,
+              Cached& cached) const;
+
+    /// @brief Gets a text of the mapped cache.
+    /// @return false if the reference is out of bounds.
+    bool get_text(uint32_t reference, std::string_view& text) const noexcept;
+
+    static std::string directory;
+
+    std::string path;
+    const char* data = nullptr;
+    size_t size = 0;
+    uint64_t record_count = 0;
+    uint64_t index_offset = 0;
+    uint64_t text_offset = 0;
+    uint64_t text_size = 0;
+
+    std::atomic<size_t> hits{0};
+    std::atomic<size_t> misses{0};
+    // Characters read, by file name, for publishing.
+    std::mutex read_mutex;
+    std::map<std::string, Cached> characters;
+    Logger::Source log;
+} ContentCache;
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_CONTENT_CACHE_HH_
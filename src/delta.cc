@@ -0,0 +1,260 @@
+/// @file delta.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Binary encoding of changes to character state.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "delta.hh"
+#include "intl.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gelcube
+{
+
+namespace
+{
+
+// Payload size after which encoding starts a new frame, so that peers can
+// process a large batch incrementally.
+const size_t frame_split_size = size_t{256} << 10;
+
+void put_varint(std::string& out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out += static_cast<char>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+void put_string(std::string& out, const std::string& s)
+{
+    put_varint(out, s.size());
+    out += s;
+}
+
+/// @brief Reads a payload, checking bounds.
+class Reader
+{
+public:
+    Reader(const char* data, size_t size)
+        : data{data}, end{data + size}
+    {
+    }
+
+    uint64_t varint()
+    {
+        uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7)
+        {
+            if (data == end)
+                fail();
+            uint8_t byte = *data++;
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                return value;
+        }
+        fail();
+    }
+
+    std::string string()
+    {
+        uint64_t size = varint();
+        if (size > static_cast<uint64_t>(end - data))
+            fail();
+        std::string s(data, size);
+        data += size;
+        return s;
+    }
+
+    uint8_t byte()
+    {
+        if (data == end)
+            fail();
+        return *data++;
+    }
+
+    bool at_end() const noexcept
+    {
+        return data == end;
+    }
+
+    [[noreturn]] void fail() const
+    {
+        throw Delta::DecodeException(_("malformed delta frame"));
+    }
+
+private:
+    const char* data;
+    const char* end;
+};
+
+/// @brief Writes the length prefix of a frame started at an offset.
+void finish_frame(std::string& out, size_t start)
+{
+    uint32_t size = out.size() - start - Delta::header_size;
+    for (size_t i = 0; i < Delta::header_size; ++i)
+        out[start + i] = static_cast<char>((size >> (8 * i)) & 0xff);
+}
+
+inline uint64_t zigzag(int value) noexcept
+{
+    return (static_cast<uint64_t>(static_cast<int64_t>(value)) << 1)
+           ^ static_cast<uint64_t>(static_cast<int64_t>(value) >> 63);
+}
+
+inline int unzigzag(uint64_t value) noexcept
+{
+    return static_cast<int>(static_cast<int64_t>(value >> 1)
+                            ^ -static_cast<int64_t>(value & 1));
+}
+
+}; // namespace
+
+void Delta::Batch::add(Op op)
+{
+    Changes& changes = characters[op.character];
+    if (op.kind == Op::remove)
+    {
+        changes.removed = true;
+        changes.ops.clear();
+        return;
+    }
+    std::string key = op.key;
+    changes.ops[std::move(key)] = std::move(op);
+}
+
+void Delta::Batch::merge(const Batch& other)
+{
+    other.for_each([this](const Op& op) { add(op); });
+}
+
+void Delta::Batch::encode(uint32_t origin, std::string& out) const
+{
+    // Payload layout: origin, then sections of (character, removed, count,
+    // ops). A character may span several sections.
+    auto begin_frame = [&]
+    {
+        size_t start = out.size();
+        out.append(header_size, '\0');
+        put_varint(out, origin);
+        return start;
+    };
+
+    size_t start = begin_frame();
+    for (auto& character : characters)
+    {
+        auto op = character.second.ops.begin();
+        bool removed = character.second.removed;
+        do
+        {
+            if (out.size() - start > frame_split_size)
+            {
+                finish_frame(out, start);
+                start = begin_frame();
+            }
+
+            // Bounds the size of a section by its number of ops.
+            size_t count = 0;
+            auto last = op;
+            while (last != character.second.ops.end() && count < 4096)
+            {
+                ++last;
+                ++count;
+            }
+
+            put_string(out, character.first);
+            out += static_cast<char>(removed);
+            put_varint(out, count);
+            for (; op != last; ++op)
+            {
+                const Op& change = op->second;
+                out += static_cast<char>(change.kind);
+                put_string(out, change.key);
+                if (change.kind == Op::set_score)
+                    put_varint(out, zigzag(change.score));
+                else if (change.kind == Op::set_detail)
+                    put_string(out, change.detail);
+            }
+            removed = false;
+        } while (op != character.second.ops.end());
+    }
+    finish_frame(out, start);
+}
+
+bool Delta::next_frame(const char* data, size_t size, size_t& payload_size)
+{
+    if (size < header_size)
+        return false;
+
+    uint32_t length = 0;
+    for (size_t i = 0; i < header_size; ++i)
+    {
+        length |= static_cast<uint32_t>(static_cast<uint8_t>(data[i]))
+                  << (8 * i);
+    }
+    if (length > max_payload_size)
+        throw DecodeException(_("delta frame is too large"));
+
+    payload_size = length;
+    return size - header_size >= length;
+}
+
+uint32_t Delta::decode(const char* payload, size_t size, std::vector<Op>& ops)
+{
+    Reader reader{payload, size};
+    uint64_t origin = reader.varint();
+    if (origin > UINT32_MAX)
+        reader.fail();
+
+    while (!reader.at_end())
+    {
+        std::string character = reader.string();
+        if (reader.byte())
+            ops.push_back({Op::remove, character, {}, 0, {}});
+
+        uint64_t count = reader.varint();
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            Op op{static_cast<Op::Kind>(reader.byte()), character, {}, 0, {}};
+            op.key = reader.string();
+            switch (op.kind)
+            {
+            case Op::set_score:
+                op.score = unzigzag(reader.varint());
+                break;
+            case Op::set_detail:
+                op.detail = reader.string();
+                break;
+            case Op::erase:
+                break;
+            default:
+                reader.fail();
+            }
+            ops.push_back(std::move(op));
+        }
+    }
+    return static_cast<uint32_t>(origin);
+}
+
+}; // namespace gelcube
@@ -0,0 +1,170 @@
+/// @file delta.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Binary encoding of changes to character state.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_DELTA_HH_
+#define GELCUBE_SRC_DELTA_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace gelcube
+{
+
+/// @brief Binary encoding of changes to character state.
+/// Changes are exchanged between session peers as frames: a 32-bit little
+/// endian payload length followed by the payload. A payload holds the
+/// identifier of the peer which made the changes, then one section per
+/// character listing the fields which changed. Integers are encoded as
+/// variable-length quantities, so a typical change to a score takes a few
+/// bytes plus its key.
+typedef class Delta
+{
+public:
+    /// @brief Exception signifying a malformed frame.
+    class DecodeException : public std::exception
+    {
+    public:
+        /// @brief Constructs a new DecodeException object.
+        /// @param message Description of the error.
+        explicit DecodeException(std::string message)
+            : message{std::move(message)}
+        {
+        }
+
+        const char* what() const noexcept override
+        {
+            return message.c_str();
+        }
+
+    private:
+        std::string message;
+    };
+
+    /// @brief Change to one field of a character, or removal of a character.
+    struct Op
+    {
+        enum Kind : uint8_t
+        {
+            set_score,
+            set_detail,
+            erase,
+            // Removes the whole character; key is unused.
+            remove
+        };
+
+        Kind kind;
+        std::string character;
+        std::string key;
+        int score;
+        std::string detail;
+    };
+
+    /// @brief Changes waiting to be sent.
+    /// Coalesces changes to the same field, so that only the latest value of
+    /// each field is sent however many times it changed.
+    class Batch
+    {
+    public:
+        /// @brief Adds a change, replacing any earlier change to the field.
+        /// Removing a character discards its earlier changes.
+        /// @param op Change to add.
+        void add(Op op);
+
+        /// @brief Adds every change of another batch.
+        /// @param other Batch to merge; later changes replace earlier ones.
+        void merge(const Batch& other);
+
+        /// @brief Encodes the changes as frames.
+        /// Large batches are split over several frames.
+        /// @param origin Identifier of the peer which made the changes.
+        /// @param out String to append the frames to.
+        void encode(uint32_t origin, std::string& out) const;
+
+        /// @brief Removes every change.
+        inline void clear() noexcept
+        {
+            characters.clear();
+        }
+
+        /// @brief Checks whether there are no changes.
+        /// @return true if empty.
+        inline bool empty() const noexcept
+        {
+            return characters.empty();
+        }
+
+        /// @brief Calls a function for every change.
+        /// Removals of a character precede its other changes.
+        /// @param function Callable taking (const Op&).
+        template <typename Function>
+        void for_each(Function&& function) const
+        {
+            for (auto& character : characters)
+            {
+                if (character.second.removed)
+                    function(Op{Op::remove, character.first, {}, 0, {}});
+                for (auto& op : character.second.ops)
+                    function(op.second);
+            }
+        }
+
+    private:
+        struct Changes
+        {
+            bool removed = false;
+            std::unordered_map<std::string, Op> ops;
+        };
+
+        std::unordered_map<std::string, Changes> characters;
+    };
+
+    /// @brief Size of the length prefix of a frame.
+    static constexpr size_t header_size = 4;
+
+    /// @brief Largest payload accepted from a peer.
+    static constexpr size_t max_payload_size = size_t{16} << 20;
+
+    /// @brief Finds the first complete frame in a buffer.
+    /// @param data Received bytes.
+    /// @param size Number of received bytes.
+    /// @param payload_size Set to the size of the frame's payload.
+    /// @return true if a whole frame has been received.
+    /// @throw gelcube::Delta::DecodeException if the frame is too large.
+    static bool next_frame(const char* data, size_t size,
+                           size_t& payload_size);
+
+    /// @brief Decodes the payload of a frame.
+    /// @param payload First byte after the length prefix.
+    /// @param size Size of the payload.
+    /// @param ops Vector to append the decoded changes to.
+    /// @return Identifier of the peer which made the changes.
+    /// @throw gelcube::Delta::DecodeException if the payload is malformed.
+    static uint32_t decode(const char* payload, size_t size,
+                           std::vector<Op>& ops);
+} Delta;
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_DELTA_HH_
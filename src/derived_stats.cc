@@ -0,0 +1,454 @@
+/// @file derived_stats.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Maintains scores computed from other scores.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "character.hh"
+#include "content.hh"
+#include "derived_stats.hh"
+#include "formula.hh"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace gelcube
+{
+
+namespace
+{
+
+/// @brief Computes one derived stat from a single input score.
+struct Rule
+{
+    const char* key;
+    const char* input;
+    int (*compute)(int input);
+};
+
+int ability_modifier(int score)
+{
+    // Rounds towards negative infinity.
+    return (score >= 10 ? score - 10 : score - 11) / 2;
+}
+
+int proficiency_bonus(int level)
+{
+    return level < 1 ? 2 : 2 + (level - 1) / 4;
+}
+
+int identity(int value)
+{
+    return value;
+}
+
+// Ordered so that every rule's input is computed before the rule itself.
+const Rule rules[] = {
+    {"str_mod", "str", ability_modifier},
+    {"dex_mod", "dex", ability_modifier},
+    {"con_mod", "con", ability_modifier},
+    {"int_mod", "int", ability_modifier},
+    {"wis_mod", "wis", ability_modifier},
+    {"cha_mod", "cha", ability_modifier},
+    {"proficiency", "level", proficiency_bonus},
+    {"initiative", "dex_mod", identity}
+};
+
+bool apply(const Rule& rule, Character& character)
+{
+    const int* input = character.get_score(rule.input);
+    const int* current = character.get_score(rule.key);
+    if (!input)
+    {
+        if (!current)
+            return false;
+        character.erase_score(rule.key);
+        return true;
+    }
+
+    int value = rule.compute(*input);
+    if (current && *current == value)
+        return false;
+    character.set_score(rule.key, value);
+    return true;
+}
+
+// Fields which rarely change, and so are folded into compiled formulas.
+const char* const static_fields[] = {
+    "level", "str", "dex", "con", "int", "wis", "cha"
+};
+
+const size_t suffix_length =
+    std::char_traits<char>::length(DerivedStats::formula_suffix);
+
+bool is_static(const std::string& field) noexcept
+{
+    return std::find_if(std::begin(static_fields), std::end(static_fields),
+                        [&](const char* s) { return field == s; })
+               != std::end(static_fields)
+           || DerivedStats::is_derived(field);
+}
+
+/// @brief Caches formulas compiled without constants, by source.
+/// Characters are loaded on worker threads, so access is serialized.
+class FormulaCache
+{
+public:
+    /// @brief Gets a formula compiled without constants.
+    /// @return Compiled formula, or nullptr if the source is malformed.
+    std::shared_ptr<const Formula> get(const std::string& source)
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        auto entry = entries.find(source);
+        if (entry != entries.end())
+            return entry->second;
+
+        if (entries.size() >= max_entries)
+            entries.clear();
+
+        std::shared_ptr<const Formula> formula;
+        try
+        {
+            formula = std::make_shared<const Formula>(Formula::compile(source));
+        }
+        catch (const Formula::SyntaxException&)
+        {
+        }
+        entries.emplace(source, formula);
+        return formula;
+    }
+
+private:
+    // Bounds memory when many distinct formulas are loaded.
+    static constexpr size_t max_entries = 4096;
+
+    std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<const Formula>> entries;
+};
+
+FormulaCache cache;
+
+inline bool is_formula(const std::string& key) noexcept
+{
+    return key.size() > suffix_length
+           && key.compare(key.size() - suffix_length, suffix_length,
+                          DerivedStats::formula_suffix) == 0;
+}
+
+}; // namespace
+
+/// @brief Formulas compiled for a character.
+/// Shared by the character's snapshots and replaced, never modified, when a
+/// formula must be compiled again.
+struct CompiledFormulas
+{
+    /// @brief Formula specialized for the character.
+    struct Entry
+    {
+        /// @brief Value of a static field when the formula was compiled.
+        struct Static
+        {
+            std::string name;
+            bool is_set;
+            int value;
+        };
+
+        // Detail holding the formula, and its text when compiled.
+        Content key;
+        Content source;
+        // Score derived by the formula.
+        std::string target;
+        // Formula without constants, whose inputs include the static fields.
+        std::shared_ptr<const Formula> generic;
+        // Formula with the static fields folded in, or nullptr if the source
+        // is malformed.
+        std::shared_ptr<const Formula> formula;
+        std::vector<Static> statics;
+
+        /// @brief Checks whether the folded fields still have their values.
+        bool is_current(const Character& character) const noexcept
+        {
+            for (auto& field : statics)
+            {
+                const int* value = character.get_score(field.name);
+                if (value ? !field.is_set || field.value != *value
+                          : field.is_set)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    const Entry* find(const Content& key) const noexcept
+    {
+        for (auto& entry : entries)
+        {
+            if (entry.key == key)
+                return &entry;
+        }
+        return nullptr;
+    }
+
+    std::vector<Entry> entries;
+};
+
+namespace
+{
+
+/// @brief Compiles a formula for a character.
+CompiledFormulas::Entry compile(const Content& key, const Content& source,
+                                const Character& character)
+{
+    const std::string& text = key.get_text();
+    CompiledFormulas::Entry entry{key, source,
+                                  text.substr(0, text.size() - suffix_length),
+                                  cache.get(source.get_text()), nullptr, {}};
+    if (!entry.generic)
+        return entry;
+
+    for (auto& input : entry.generic->get_inputs())
+    {
+        if (!is_static(input))
+            continue;
+        const int* value = character.get_score(input);
+        entry.statics.push_back({input, value != nullptr,
+                                 value ? *value : 0});
+    }
+    if (entry.statics.empty())
+    {
+        entry.formula = entry.generic;
+        return entry;
+    }
+
+    try
+    {
+        entry.formula = std::make_shared<const Formula>(Formula::compile(
+            source.get_text(), [&](const std::string& field) -> const int*
+            {
+                return is_static(field) ? character.get_score(field) : nullptr;
+            }));
+    }
+    catch (const Formula::SyntaxException&)
+    {
+    }
+    return entry;
+}
+
+/// @brief Brings the compiled formulas of a character up to date.
+/// A formula is compiled again only if its source or one of the static
+/// fields folded into it changed; the table is copied first, so snapshots
+/// keep theirs. If nothing changed, nothing is allocated or locked.
+/// @param changed Keys which changed; the scores of removed formulas are
+///                erased and appended.
+/// @return Formulas of the character.
+const CompiledFormulas& sync_formulas(Character& character,
+                                      std::vector<std::string>& changed)
+{
+    static const CompiledFormulas none;
+    std::shared_ptr<const CompiledFormulas> table = character.get_formulas();
+    std::shared_ptr<CompiledFormulas> copy;
+    auto make_copy = [&]
+    {
+        if (!copy)
+        {
+            copy = table ? std::make_shared<CompiledFormulas>(*table)
+                         : std::make_shared<CompiledFormulas>();
+        }
+    };
+
+    size_t count = 0;
+    character.get_details().for_each([&](const Content& key,
+                                          const Content& source)
+    {
+        if (!is_formula(key.get_text()))
+            return;
+        ++count;
+        const CompiledFormulas::Entry* entry = table ? table->find(key)
+                                                     : nullptr;
+        if (entry && entry->source == source && entry->is_current(character))
+            return;
+
+        make_copy();
+        CompiledFormulas::Entry compiled = compile(key, source, character);
+        auto existing = std::find_if(copy->entries.begin(),
+                                     copy->entries.end(),
+                                     [&](const CompiledFormulas::Entry& e)
+                                     { return e.key == key; });
+        if (existing != copy->entries.end())
+            *existing = std::move(compiled);
+        else
+            copy->entries.push_back(std::move(compiled));
+    });
+
+    // Drops the formulas whose details were removed, with their scores.
+    const CompiledFormulas* current = copy ? copy.get() : table.get();
+    if (current && current->entries.size() != count)
+    {
+        make_copy();
+        auto removed = std::remove_if(
+            copy->entries.begin(), copy->entries.end(),
+            [&](const CompiledFormulas::Entry& entry)
+            {
+                return !character.get_details().find(
+                    std::string_view(entry.key.get_text()));
+            });
+        for (auto entry = removed; entry != copy->entries.end(); ++entry)
+        {
+            if (character.get_score(entry->target))
+            {
+                character.erase_score(entry->target);
+                changed.push_back(entry->target);
+            }
+        }
+        copy->entries.erase(removed, copy->entries.end());
+    }
+
+    if (copy)
+        character.set_formulas(std::move(copy));
+    return character.get_formulas() ? *character.get_formulas() : none;
+}
+
+/// @brief Evaluates a formula into its score.
+/// @return true if the score changed.
+bool apply_formula(const CompiledFormulas::Entry& entry,
+                   Character& character)
+{
+    const int* current = character.get_score(entry.target);
+    if (!entry.formula)
+    {
+        if (!current)
+            return false;
+        character.erase_score(entry.target);
+        return true;
+    }
+
+    int value = entry.formula->evaluate(character);
+    if (current && *current == value)
+        return false;
+    character.set_score(entry.target, value);
+    return true;
+}
+
+/// @brief Recomputes the formulas which read changed keys.
+/// Repeats until no formula result changes, so that formulas may read the
+/// results of other formulas; cycles stop after one pass per formula.
+void update_formulas(Character& character, std::vector<std::string>& changed)
+{
+    // Without compiled formulas, removed ones are known only by their keys.
+    if (!character.get_formulas())
+    {
+        for (size_t i = 0; i < changed.size(); ++i)
+        {
+            const std::string& key = changed[i];
+            if (!is_formula(key) || character.get_detail(key))
+                continue;
+            std::string target = key.substr(0, key.size() - suffix_length);
+            if (character.get_score(target))
+            {
+                character.erase_score(target);
+                changed.push_back(target);
+            }
+        }
+    }
+    const CompiledFormulas& formulas = sync_formulas(character, changed);
+
+    size_t checked = 0;
+    for (size_t pass = 0; pass <= formulas.entries.size(); ++pass)
+    {
+        size_t end = changed.size();
+        auto is_changed = [&](const std::string& key)
+        {
+            return std::find(changed.begin() + checked, changed.begin() + end,
+                             key)
+                   != changed.begin() + end;
+        };
+        for (auto& entry : formulas.entries)
+        {
+            bool affected = is_changed(entry.key.get_text())
+                            || (entry.generic
+                                && std::any_of(
+                                       entry.generic->get_inputs().begin(),
+                                       entry.generic->get_inputs().end(),
+                                       is_changed));
+            if (affected && apply_formula(entry, character))
+                changed.push_back(entry.target);
+        }
+        if (changed.size() == end)
+            break;
+        checked = end;
+    }
+}
+
+}; // namespace
+
+bool DerivedStats::is_derived(const std::string& key) noexcept
+{
+    for (auto& rule : rules)
+    {
+        if (key == rule.key)
+            return true;
+    }
+    return false;
+}
+
+bool DerivedStats::is_derived(const std::string& key,
+                              const Character& character) noexcept
+{
+    return is_derived(key) || character.get_detail(key + formula_suffix);
+}
+
+void DerivedStats::update(Character& character,
+                          std::vector<std::string>& changed)
+{
+    for (auto& rule : rules)
+    {
+        if (std::find(changed.begin(), changed.end(), rule.input)
+                != changed.end()
+            && apply(rule, character))
+        {
+            changed.push_back(rule.key);
+        }
+    }
+    update_formulas(character, changed);
+}
+
+void DerivedStats::update_all(Character& character)
+{
+    for (auto& rule : rules)
+        apply(rule, character);
+
+    // Evaluates every formula, then settles formulas reading other formulas.
+    std::vector<std::string> changed;
+    for (auto& entry : sync_formulas(character, changed).entries)
+    {
+        if (apply_formula(entry, character))
+            changed.push_back(entry.target);
+    }
+    update_formulas(character, changed);
+}
+
+}; // namespace gelcube
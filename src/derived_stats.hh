@@ -0,0 +1,79 @@
+/// @file derived_stats.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Maintains scores computed from other scores.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_DERIVED_STATS_HH_
+#define GELCUBE_SRC_DERIVED_STATS_HH_
+
+#include "character.hh"
+
+#include <string>
+#include <vector>
+
+namespace gelcube
+{
+
+/// @brief Maintains scores computed from other scores.
+/// Derived stats (ability modifiers, proficiency bonus, ...) are stored as
+/// ordinary scores and recomputed only when one of their inputs changes.
+/// Characters may define their own derived stats with formula details, e.g.
+/// 'spell_save_dc_formula = 8 + proficiency + int_mod' derives the score
+/// 'spell_save_dc' (see gelcube::Formula). Each character keeps its formulas
+/// compiled, with its static fields (level and ability scores) folded into
+/// the bytecode as constants; a formula is compiled again only when its
+/// source or one of those fields changes, so evaluating it builds no strings
+/// and takes no locks.
+typedef class DerivedStats
+{
+public:
+    /// @brief Suffix of the details holding formulas.
+    static constexpr const char* formula_suffix = "_formula";
+
+    /// @brief Checks whether a score is derived by a built-in rule.
+    /// @param key Name of the score.
+    /// @return true if the score is computed by DerivedStats.
+    static bool is_derived(const std::string& key) noexcept;
+
+    /// @brief Checks whether a score is derived for a character.
+    /// @param key Name of the score.
+    /// @param character Character whose formulas are considered.
+    /// @return true if the score is computed by a built-in rule or by one of
+    ///         the character's formulas.
+    static bool is_derived(const std::string& key,
+                           const Character& character) noexcept;
+
+    /// @brief Recomputes the derived stats which depend on changed keys.
+    /// Derived stats depending on other derived stats are updated in the same
+    /// pass.
+    /// @param character Character to update in place.
+    /// @param changed Keys which changed since the last update; derived keys
+    ///                which change are appended.
+    static void update(Character& character,
+                       std::vector<std::string>& changed);
+
+    /// @brief Recomputes every derived stat.
+    /// Used when a character is first loaded. Formulas which fail to compile
+    /// remove their score.
+    /// @param character Character to update in place.
+    static void update_all(Character& character);
+} DerivedStats;
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_DERIVED_STATS_HH_
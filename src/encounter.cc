@@ -0,0 +1,238 @@
+/// @file encounter.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Manages the running combat encounter.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "encounter.hh"
+#include "initiative_tracker.hh"
+#include "roster.hh"
+#include "symbol.hh"
+#include "timing_wheel.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace gelcube
+{
+
+InitiativeTracker Encounter::tracker;
+std::vector<std::string> Encounter::paths;
+std::unordered_map<std::string, InitiativeTracker::Id> Encounter::combatants;
+TimingWheel<Encounter::Expiry> Encounter::expiries;
+std::unordered_map<uint64_t, std::vector<Encounter::Expiry>>
+    Encounter::pending;
+std::unordered_map<uint64_t, uint32_t> Encounter::generations;
+bool Encounter::active = false;
+std::mt19937 Encounter::generator{std::random_device{}()};
+
+namespace
+{
+
+// Rounds of six seconds in each unit of game time.
+const uint64_t rounds_per_minute = 10;
+const uint64_t rounds_per_hour = 600;
+
+/// @brief Checks whether a character field describes a timed effect.
+inline bool is_effect(const std::string& key) noexcept
+{
+    return key.rfind(Encounter::effect_prefix, 0) == 0;
+}
+
+}; // namespace
+
+uint64_t Encounter::parse_duration(const std::string& value)
+{
+    char* end;
+    unsigned long long amount = std::strtoull(value.c_str(), &end, 10);
+    if (end == value.c_str())
+        return 0;
+
+    std::string unit = end;
+    if (unit == "m")
+        return amount * rounds_per_minute;
+    if (unit == "h")
+        return amount * rounds_per_hour;
+    if (unit == "" || unit == "r")
+        return amount;
+    return 0;
+}
+
+void Encounter::start()
+{
+    end();
+    for (auto& entry : Roster::get_entries())
+        join(entry.path, entry.history.current());
+
+    tracker.restart();
+    active = true;
+    begin_round();
+}
+
+void Encounter::update(const Roster::Change& change)
+{
+    if (!active || change.path.empty())
+        return;
+    const Character* character = Roster::get(change.path);
+    if (!character)
+        return;
+    auto combatant = combatants.find(change.path);
+    if (combatant == combatants.end())
+    {
+        join(change.path, *character);
+        return;
+    }
+
+    for (auto& key : change.keys)
+    {
+        if (!is_effect(key))
+            continue;
+
+        // Forgets the old duration, also when the effect was removed.
+        ++generations[effect_key(combatant->second, Symbol(key))];
+        const int* value = character->get_score(key);
+        const std::string* text = character->get_detail(key);
+        uint64_t rounds = value ? (*value > 0 ? *value : 0)
+                                : text ? parse_duration(*text) : 0;
+        if (rounds > 0)
+            add_effect(combatant->second, key, rounds);
+    }
+}
+
+void Encounter::end() noexcept
+{
+    tracker = InitiativeTracker{};
+    paths.clear();
+    combatants.clear();
+    expiries = TimingWheel<Expiry>{};
+    pending.clear();
+    generations.clear();
+    active = false;
+}
+
+std::vector<Roster::Change> Encounter::next_turn()
+{
+    std::vector<Roster::Change> changes;
+    if (tracker.size() == 0)
+        return changes;
+
+    expire(tracker.current(), Phase::turn_end, changes);
+    int round = tracker.get_round();
+    tracker.next();
+    if (tracker.get_round() != round)
+        begin_round();
+    expire(tracker.current(), Phase::turn_start, changes);
+    return changes;
+}
+
+void Encounter::delay()
+{
+    if (tracker.size() < 2)
+        return;
+
+    InitiativeTracker::Id current = tracker.current();
+    size_t position = tracker.rank(current) + 1;
+    InitiativeTracker::Id following = tracker.at(position % tracker.size());
+    int round = tracker.get_round();
+    tracker.set_initiative(current, tracker.get(following).initiative - 1);
+    if (tracker.get_round() != round)
+        begin_round();
+}
+
+void Encounter::add_effect(InitiativeTracker::Id combatant,
+                           const std::string& key, uint64_t rounds,
+                           Phase phase)
+{
+    // Round r is wheel time r; an effect lasting one round expires in the
+    // current round.
+    uint64_t round = active ? tracker.get_round() : 1;
+    Symbol symbol(key);
+    Expiry expiry{combatant, phase, symbol,
+                  generations[effect_key(combatant, symbol)]};
+    if (active && rounds <= 1)
+        pending[turn_key(combatant, phase)].push_back(std::move(expiry));
+    else
+        expiries.schedule(round + rounds - 1, std::move(expiry));
+}
+
+void Encounter::join(const std::string& path, const Character& character)
+{
+    std::uniform_int_distribution<int> d20(1, 20);
+    const std::string* name = character.get_detail("name");
+    const int* modifier = character.get_score("initiative");
+    const int* dex = character.get_score("dex");
+    InitiativeTracker::Id id = tracker.add(
+        {name ? *name : path, d20(generator) + (modifier ? *modifier : 0),
+         dex ? *dex : 10});
+
+    if (paths.size() <= id)
+        paths.resize(id + 1);
+    paths[id] = path;
+    combatants[path] = id;
+
+    character.get_scores().for_each([&](const std::string& key, int value)
+    {
+        if (is_effect(key) && value > 0)
+            add_effect(id, key, value);
+    });
+    character.get_details().for_each([&](const std::string& key,
+                                          const std::string& value)
+    {
+        uint64_t rounds = parse_duration(value);
+        if (is_effect(key) && rounds > 0)
+            add_effect(id, key, rounds);
+    });
+}
+
+void Encounter::begin_round()
+{
+    expiries.advance(tracker.get_round(), [](uint64_t, Expiry&& expiry)
+    {
+        pending[turn_key(expiry.combatant, expiry.phase)]
+            .push_back(std::move(expiry));
+    });
+}
+
+void Encounter::expire(InitiativeTracker::Id combatant, Phase phase,
+                       std::vector<Roster::Change>& changes)
+{
+    auto due = pending.find(turn_key(combatant, phase));
+    if (due == pending.end())
+        return;
+
+    for (auto& expiry : due->second)
+    {
+        if (expiry.generation
+            != generations[effect_key(expiry.combatant, expiry.key)])
+        {
+            continue;
+        }
+        Roster::Change change = Roster::erase(paths[expiry.combatant],
+                                              expiry.key.get_text());
+        if (!change.keys.empty())
+            changes.push_back(std::move(change));
+    }
+    pending.erase(due);
+}
+
+}; // namespace gelcube
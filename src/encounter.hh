@@ -0,0 +1,185 @@
+/// @file encounter.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Manages the running combat encounter.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_ENCOUNTER_HH_
+#define GELCUBE_SRC_ENCOUNTER_HH_
+
+#include "initiative_tracker.hh"
+#include "roster.hh"
+#include "symbol.hh"
+#include "timing_wheel.hh"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gelcube
+{
+
+/// @brief Manages the running combat encounter.
+/// Holds the turn order of every character in the roster while an encounter
+/// is active, and expires their timed effects as turns pass. Effects are
+/// scheduled on a timing wheel keyed on the round number; when a round
+/// begins, its due effects wait for the start or end of their combatant's
+/// turn, so no turn ever scans the effects of other combatants.
+typedef class Encounter
+{
+public:
+    /// @brief Point in a combatant's turn at which an effect expires.
+    enum class Phase
+    {
+        turn_start,
+        turn_end
+    };
+
+    /// @brief Prefix of the character fields describing timed effects.
+    /// The value of an effect field is its duration: an integer number of
+    /// rounds, or a number followed by 'm' for minutes or 'h' for hours of
+    /// game time. Effects expire at the end of the character's turn.
+    static constexpr const char* effect_prefix = "effect_";
+
+    /// @brief Starts an encounter with every character in the roster.
+    /// Rolls initiative (d20 + the character's 'initiative' score) for each
+    /// character, using the 'dex' score to break ties, and schedules the
+    /// expiry of each character's effects.
+    static void start();
+
+    /// @brief Brings the encounter up to date with a change to the roster.
+    /// Characters loaded while the encounter is running join the turn order,
+    /// rolling initiative as at the start. Effects which were added or whose
+    /// durations changed are scheduled again, from the current round.
+    /// @param change Change returned by the roster.
+    static void update(const Roster::Change& change);
+
+    /// @brief Ends the encounter.
+    /// Effects which have not expired are kept.
+    static void end() noexcept;
+
+    /// @brief Seeds the initiative rolls.
+    /// Used to make encounters reproducible, e.g. when replaying input.
+    /// @param value Seed for the random number generator.
+    static inline void seed(uint32_t value)
+    {
+        generator.seed(value);
+    }
+
+    /// @brief Checks whether an encounter is running.
+    /// @return true if active.
+    static inline bool is_active() noexcept
+    {
+        return active;
+    }
+
+    /// @brief Passes the turn to the next combatant.
+    /// Expires the effects ending with the current combatant's turn, starts a
+    /// new round if required, and expires the effects starting with the next
+    /// combatant's turn. Expired effects are removed from the characters.
+    /// @return Changes to the characters whose effects expired.
+    static std::vector<Roster::Change> next_turn();
+
+    /// @brief Delays the current combatant's turn.
+    /// Moves the combatant to act after the combatant which follows it, which
+    /// then takes the turn.
+    static void delay();
+
+    /// @brief Parses the duration of an effect detail, e.g. "10m" or "8h".
+    /// @param value Value of the effect field.
+    /// @return Number of rounds, or 0 if the duration is malformed.
+    static uint64_t parse_duration(const std::string& value);
+
+    /// @brief Schedules the expiry of an effect.
+    /// @param combatant Combatant affected by the effect.
+    /// @param key Character field removed when the effect expires.
+    /// @param rounds Number of rounds, counting the current one, after which
+    ///               the effect expires.
+    /// @param phase Point in the combatant's turn at which it expires.
+    static void add_effect(InitiativeTracker::Id combatant,
+                           const std::string& key, uint64_t rounds,
+                           Phase phase = Phase::turn_end);
+
+    /// @brief Gets the turn order.
+    /// @return Initiative tracker of the encounter.
+    static inline const InitiativeTracker& get_tracker() noexcept
+    {
+        return tracker;
+    }
+
+    /// @brief Gets the character file of a combatant.
+    /// @param combatant Identifier of the combatant.
+    /// @return Path in the roster.
+    static inline const std::string& get_path(InitiativeTracker::Id combatant)
+    {
+        return paths.at(combatant);
+    }
+
+private:
+    /// @brief Effect waiting to expire.
+    struct Expiry
+    {
+        InitiativeTracker::Id combatant;
+        Phase phase;
+        // Effects repeat across combatants, so their keys are interned.
+        Symbol key;
+        // Scheduling of the effect this expiry belongs to; expiries of
+        // earlier schedulings are ignored.
+        uint32_t generation;
+    };
+
+    /// @brief Adds a character to the turn order.
+    /// Rolls its initiative and schedules the expiry of its effects.
+    static void join(const std::string& path, const Character& character);
+
+    /// @brief Moves the effects due in a new round to their turns.
+    static void begin_round();
+
+    /// @brief Expires the effects waiting for a point in a turn.
+    static void expire(InitiativeTracker::Id combatant, Phase phase,
+                       std::vector<Roster::Change>& changes);
+
+    /// @brief Gets the key of a combatant's effect in the generations map.
+    static inline uint64_t effect_key(InitiativeTracker::Id combatant,
+                                      Symbol key) noexcept
+    {
+        return static_cast<uint64_t>(combatant) << 32 | key.get_id();
+    }
+
+    /// @brief Gets the key of a turn in the pending map.
+    static inline uint64_t turn_key(InitiativeTracker::Id combatant,
+                                    Phase phase) noexcept
+    {
+        return static_cast<uint64_t>(combatant) << 1
+               | (phase == Phase::turn_end ? 1 : 0);
+    }
+
+    static InitiativeTracker tracker;
+    static std::vector<std::string> paths;
+    static std::unordered_map<std::string, InitiativeTracker::Id> combatants;
+    static TimingWheel<Expiry> expiries;
+    static std::unordered_map<uint64_t, std::vector<Expiry>> pending;
+    static std::unordered_map<uint64_t, uint32_t> generations;
+    static bool active;
+    static std::mt19937 generator;
+} Encounter;
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_ENCOUNTER_HH_
@@ -0,0 +1,94 @@
+/// @file file_watcher.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Wrapper for inotify directory watches.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "file_watcher.hh"
+#include "trace.hh"
+
+#include <algorithm>
+#include <cerrno>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace gelcube
+{
+
+FileWatcher::FileWatcher()
+    : fd{inotify_init1(IN_NONBLOCK | IN_CLOEXEC)}
+{
+    if (fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(),
+                                "inotify_init1");
+    }
+}
+
+FileWatcher::~FileWatcher()
+{
+    close(fd);
+}
+
+void FileWatcher::watch(const std::string& directory)
+{
+    // IN_CLOSE_WRITE rather than IN_MODIFY so that partially written files
+    // are not reported; editors which save by renaming generate IN_MOVED_TO.
+    int wd = inotify_add_watch(fd, directory.c_str(),
+                               IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM
+                               | IN_DELETE);
+    if (wd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(),
+                                "inotify_add_watch");
+    }
+    directories[wd] = directory;
+}
+
+std::vector<std::string> FileWatcher::read_changes()
+{
+    Trace::Span span("FileWatcher::read_changes");
+    std::vector<std::string> paths;
+    overflowed = false;
+    alignas(inotify_event) char buffer[4096];
+    ssize_t length;
+    while ((length = read(fd, buffer, sizeof(buffer))) > 0)
+    {
+        for (char* p = buffer; p < buffer + length;)
+        {
+            auto event = reinterpret_cast<inotify_event*>(p);
+            p += sizeof(inotify_event) + event->len;
+            if (event->mask & IN_Q_OVERFLOW)
+                overflowed = true;
+
+            auto directory = directories.find(event->wd);
+            if (event->len == 0 || directory == directories.end())
+                continue;
+
+            std::string path = directory->second + "/" + event->name;
+            if (std::find(paths.begin(), paths.end(), path) == paths.end())
+                paths.push_back(std::move(path));
+        }
+    }
+    return paths;
+}
+
+}; // namespace gelcube
@@ -0,0 +1,86 @@
+/// @file file_watcher.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Wrapper for inotify directory watches.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_FILE_WATCHER_HH_
+#define GELCUBE_SRC_FILE_WATCHER_HH_
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gelcube
+{
+
+/// @brief Wrapper for inotify directory watches.
+/// Reports files which have been written, created, moved, or deleted in the
+/// watched directories. The inotify file descriptor is non-blocking and can
+/// be polled alongside other event sources.
+typedef class FileWatcher
+{
+public:
+    /// @brief Constructs a new FileWatcher object.
+    /// Initializes an inotify instance.
+    /// @throw std::system_error if inotify cannot be initialized.
+    FileWatcher();
+
+    /// @brief Destroys the FileWatcher object.
+    /// Closes the inotify instance and removes all of its watches.
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    /// @brief Watches a directory for changes to the files it contains.
+    /// @param directory Path of the directory.
+    /// @throw std::system_error if the watch cannot be added.
+    void watch(const std::string& directory);
+
+    /// @brief Reads all pending events.
+    /// Does not block. Paths are reported once per call however many events
+    /// were generated for them, in the order they were first seen.
+    /// @return Paths of the changed files.
+    std::vector<std::string> read_changes();
+
+    /// @brief Checks whether events were lost before the last read_changes().
+    /// The kernel drops events once its queue is full, e.g. during a burst of
+    /// syncs; every file in the watched directories must then be rescanned.
+    /// @return true if the event queue overflowed.
+    inline bool has_overflowed() const noexcept
+    {
+        return overflowed;
+    }
+
+    /// @brief Gets the inotify file descriptor.
+    /// @return File descriptor which becomes readable when changes are
+    ///         pending.
+    inline int get_fd() const noexcept
+    {
+        return fd;
+    }
+
+private:
+    int fd;
+    std::unordered_map<int, std::string> directories;
+    bool overflowed = false;
+} FileWatcher;
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_FILE_WATCHER_HH_
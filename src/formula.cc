@@ -0,0 +1,704 @@
+/// @file formula.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Compiled rules formulas.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "character.hh"
+#include "formula.hh"
+#include "intl.hh"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gelcube
+{
+
+namespace
+{
+
+// Limits the dice rolled by a single term, so that a typo cannot stall a
+// refresh.
+const int max_dice = 1000;
+
+// Arithmetic shared by the tree walker, the constant folder, and the
+// interpreter, so that all three agree exactly. Overflow wraps.
+
+inline int wrap_add(int a, int b) noexcept
+{
+    return static_cast<int>(static_cast<unsigned>(a)
+                            + static_cast<unsigned>(b));
+}
+
+inline int wrap_subtract(int a, int b) noexcept
+{
+    return static_cast<int>(static_cast<unsigned>(a)
+                            - static_cast<unsigned>(b));
+}
+
+inline int wrap_multiply(int a, int b) noexcept
+{
+    return static_cast<int>(static_cast<unsigned>(a)
+                            * static_cast<unsigned>(b));
+}
+
+inline int wrap_negate(int a) noexcept
+{
+    return static_cast<int>(0u - static_cast<unsigned>(a));
+}
+
+/// @brief Divides, rounding down as the rules do; division by zero gives 0.
+inline int floor_divide(int a, int b) noexcept
+{
+    if (b == 0)
+        return 0;
+    if (b == -1)
+        return wrap_negate(a);
+
+    int quotient = a / b;
+    if (a % b != 0 && (a < 0) != (b < 0))
+        --quotient;
+    return quotient;
+}
+
+/// @brief Rolls dice, or takes their average (rounded down) without an rng.
+inline int roll_dice(int count, int sides, std::mt19937* rng) noexcept
+{
+    if (count <= 0 || sides <= 0)
+        return 0;
+    count = std::min(count, max_dice);
+    if (!rng)
+    {
+        return static_cast<int>(static_cast<long long>(count) * (sides + 1)
+                                / 2);
+    }
+
+    std::uniform_int_distribution<int> die(1, sides);
+    int total = 0;
+    for (int i = 0; i < count; ++i)
+        total = wrap_add(total, die(*rng));
+    return total;
+}
+
+/// @brief Applies a binary operator to two values.
+int apply(Formula::Node::Kind kind, int a, int b, std::mt19937* rng) noexcept
+{
+    switch (kind)
+    {
+    case Formula::Node::add:
+        return wrap_add(a, b);
+    case Formula::Node::subtract:
+        return wrap_subtract(a, b);
+    case Formula::Node::multiply:
+        return wrap_multiply(a, b);
+    case Formula::Node::divide:
+        return floor_divide(a, b);
+    case Formula::Node::minimum:
+        return std::min(a, b);
+    case Formula::Node::maximum:
+        return std::max(a, b);
+    case Formula::Node::roll:
+        return roll_dice(a, b, rng);
+    default:
+        return 0;
+    }
+}
+
+typedef std::unique_ptr<Formula::Node> NodePtr;
+
+NodePtr make_node(Formula::Node::Kind kind, int value = 0,
+                  std::string name = "", NodePtr left = nullptr,
+                  NodePtr right = nullptr)
+{
+    size_t depth = 1 + std::max(left ? left->depth : 0,
+                                right ? right->depth : 0);
+    return NodePtr{new Formula::Node{kind, value, std::move(name),
+                                     std::move(left), std::move(right),
+                                     depth}};
+}
+
+/// @brief Token of a formula.
+struct Token
+{
+    enum Kind
+    {
+        end,
+        number,
+        identifier,
+        dice,
+        plus,
+        minus,
+        star,
+        slash,
+        open,
+        close,
+        comma
+    };
+
+    Kind kind;
+    int value;
+    std::string text;
+    size_t position;
+};
+
+/// @brief Splits a formula into tokens.
+/// Dice are written as 'd' directly followed by the number of sides, or a
+/// lone 'd' before a parenthesis, and lex as a dice operator.
+std::vector<Token> tokenize(const std::string& source)
+{
+    std::vector<Token> tokens;
+    size_t i = 0;
+    while (i < source.size())
+    {
+        unsigned char c = source[i];
+        size_t start = i;
+        if (std::isspace(c))
+        {
+            ++i;
+        }
+        else if (std::isdigit(c))
+        {
+            while (i < source.size()
+                   && std::isdigit(static_cast<unsigned char>(source[i])))
+            {
+                ++i;
+            }
+            errno = 0;
+            long value = std::strtol(source.c_str() + start, nullptr, 10);
+            if (errno == ERANGE || value > INT_MAX)
+            {
+                throw Formula::SyntaxException(
+                    std::to_string(start + 1) + _(": number is too large"));
+            }
+            tokens.push_back({Token::number, static_cast<int>(value), "",
+                              start});
+        }
+        else if (std::isalpha(c) || c == '_')
+        {
+            while (i < source.size()
+                   && (std::isalnum(static_cast<unsigned char>(source[i]))
+                       || source[i] == '_'))
+            {
+                ++i;
+            }
+            std::string text = source.substr(start, i - start);
+            bool is_dice = text[0] == 'd'
+                && std::all_of(text.begin() + 1, text.end(),
+                               [](unsigned char d) { return std::isdigit(d); });
+            if (is_dice)
+            {
+                tokens.push_back({Token::dice, 0, "", start});
+                // Lexes the sides that follow, e.g. the "8" of "d8".
+                i = start + 1;
+            }
+            else
+            {
+                tokens.push_back({Token::identifier, 0, std::move(text),
+                                  start});
+            }
+        }
+        else
+        {
+            Token::Kind kind;
+            switch (c)
+            {
+            case '+': kind = Token::plus; break;
+            case '-': kind = Token::minus; break;
+            case '*': kind = Token::star; break;
+            case '/': kind = Token::slash; break;
+            case '(': kind = Token::open; break;
+            case ')': kind = Token::close; break;
+            case ',': kind = Token::comma; break;
+            default:
+                throw Formula::SyntaxException(
+                    std::to_string(start + 1) + _(": unexpected character '")
+                    + source[start] + "'");
+            }
+            tokens.push_back({kind, 0, "", start});
+            ++i;
+        }
+    }
+    tokens.push_back({Token::end, 0, "", source.size()});
+    return tokens;
+}
+
+/// @brief Recursive descent parser.
+///
+/// formula := expr { ',' ('minimum' | 'maximum') expr }
+/// expr    := term { ('+' | '-') term }
+/// term    := unary { ('*' | '/') unary }
+/// unary   := '-' unary | roll
+/// roll    := 'd' primary | primary [ 'd' primary ]
+/// primary := number | field | ('min' | 'max') '(' expr { ',' expr } ')'
+///          | '(' expr ')'
+class Parser
+{
+public:
+    explicit Parser(const std::string& source)
+        : tokens{tokenize(source)}
+    {
+    }
+
+    NodePtr parse_formula()
+    {
+        NodePtr node = parse_expr();
+        while (accept(Token::comma))
+        {
+            const Token& clause = expect(Token::identifier);
+            Formula::Node::Kind kind;
+            // "minimum 1" bounds the value from below.
+            if (clause.text == "minimum")
+                kind = Formula::Node::maximum;
+            else if (clause.text == "maximum")
+                kind = Formula::Node::minimum;
+            else
+                fail(clause, _("expected 'minimum' or 'maximum'"));
+            node = make(kind, 0, "", std::move(node), parse_expr());
+        }
+        expect(Token::end);
+        return node;
+    }
+
+private:
+    NodePtr parse_expr()
+    {
+        NodePtr node = parse_term();
+        for (;;)
+        {
+            if (accept(Token::plus))
+            {
+                node = make(Formula::Node::add, 0, "", std::move(node),
+                            parse_term());
+            }
+            else if (accept(Token::minus))
+            {
+                node = make(Formula::Node::subtract, 0, "",
+                            std::move(node), parse_term());
+            }
+            else
+            {
+                return node;
+            }
+        }
+    }
+
+    NodePtr parse_term()
+    {
+        NodePtr node = parse_unary();
+        for (;;)
+        {
+            if (accept(Token::star))
+            {
+                node = make(Formula::Node::multiply, 0, "",
+                            std::move(node), parse_unary());
+            }
+            else if (accept(Token::slash))
+            {
+                node = make(Formula::Node::divide, 0, "",
+                            std::move(node), parse_unary());
+            }
+            else
+            {
+                return node;
+            }
+        }
+    }
+
+    NodePtr parse_unary()
+    {
+        if (accept(Token::minus))
+            return make(Formula::Node::negate, 0, "",
+                        parse_nested(&Parser::parse_unary));
+        return parse_roll();
+    }
+
+    NodePtr parse_roll()
+    {
+        NodePtr count = accept(Token::dice)
+            ? make(Formula::Node::number, 1) : nullptr;
+        if (count)
+        {
+            return make(Formula::Node::roll, 0, "", std::move(count),
+                        parse_primary());
+        }
+
+        NodePtr node = parse_primary();
+        if (accept(Token::dice))
+        {
+            node = make(Formula::Node::roll, 0, "", std::move(node),
+                        parse_primary());
+        }
+        return node;
+    }
+
+    NodePtr parse_primary()
+    {
+        const Token& token = tokens[next];
+        switch (token.kind)
+        {
+        case Token::number:
+            ++next;
+            return make(Formula::Node::number, token.value);
+
+        case Token::identifier:
+            ++next;
+            if ((token.text == "min" || token.text == "max")
+                && accept(Token::open))
+            {
+                Formula::Node::Kind kind = token.text == "min"
+                    ? Formula::Node::minimum : Formula::Node::maximum;
+                NodePtr node = parse_nested(&Parser::parse_expr);
+                while (accept(Token::comma))
+                {
+                    node = make(kind, 0, "", std::move(node),
+                                parse_nested(&Parser::parse_expr));
+                }
+                expect(Token::close);
+                return node;
+            }
+            return make(Formula::Node::field, 0, token.text);
+
+        case Token::open:
+        {
+            ++next;
+            NodePtr node = parse_nested(&Parser::parse_expr);
+            expect(Token::close);
+            return node;
+        }
+
+        default:
+            fail(token, _("expected a number, field, or '('"));
+        }
+    }
+
+    /// @brief Builds a node, failing if the tree becomes too deep.
+    NodePtr make(Formula::Node::Kind kind, int value = 0,
+                 std::string name = "", NodePtr left = nullptr,
+                 NodePtr right = nullptr)
+    {
+        NodePtr node = make_node(kind, value, std::move(name),
+                                 std::move(left), std::move(right));
+        if (node->depth > Formula::max_depth)
+            fail(tokens[next], _("formula is too deeply nested"));
+        return node;
+    }
+
+    /// @brief Parses a nested expression, failing if nesting is too deep.
+    NodePtr parse_nested(NodePtr (Parser::*parse)())
+    {
+        if (++nesting > Formula::max_depth)
+            fail(tokens[next], _("formula is too deeply nested"));
+        NodePtr node = (this->*parse)();
+        --nesting;
+        return node;
+    }
+
+    bool accept(Token::Kind kind) noexcept
+    {
+        if (tokens[next].kind != kind)
+            return false;
+        ++next;
+        return true;
+    }
+
+    const Token& expect(Token::Kind kind)
+    {
+        const Token& token = tokens[next];
+        if (token.kind != kind)
+        {
+            fail(token, kind == Token::end ? _("unexpected input")
+                      : kind == Token::close ? _("expected ')'")
+                      : _("unexpected token"));
+        }
+        ++next;
+        return token;
+    }
+
+    [[noreturn]] void fail(const Token& token, const char* message) const
+    {
+        throw Formula::SyntaxException(std::to_string(token.position + 1)
+                                       + ": " + message);
+    }
+
+    std::vector<Token> tokens;
+    size_t next = 0;
+    size_t nesting = 0;
+};
+
+/// @brief Folds constant subtrees in place.
+/// Fields found in the constants are substituted first. Dice are never
+/// folded, since rolls differ between evaluations.
+void fold(NodePtr& node, const Formula::Constants& constants)
+{
+    switch (node->kind)
+    {
+    case Formula::Node::number:
+        return;
+
+    case Formula::Node::field:
+        if (constants)
+        {
+            if (const int* value = constants(node->name))
+                node = make_node(Formula::Node::number, *value);
+        }
+        return;
+
+    case Formula::Node::negate:
+        fold(node->left, constants);
+        if (node->left->kind == Formula::Node::number)
+            node = make_node(Formula::Node::number,
+                             wrap_negate(node->left->value));
+        return;
+
+    default:
+        break;
+    }
+
+    fold(node->left, constants);
+    fold(node->right, constants);
+    bool left_constant = node->left->kind == Formula::Node::number;
+    bool right_constant = node->right->kind == Formula::Node::number;
+    if (left_constant && right_constant && node->kind != Formula::Node::roll)
+    {
+        node = make_node(Formula::Node::number,
+                         apply(node->kind, node->left->value,
+                               node->right->value, nullptr));
+        return;
+    }
+
+    // Drops identities, e.g. "x + 0" and "x * 1".
+    if (right_constant)
+    {
+        int value = node->right->value;
+        if ((value == 0 && (node->kind == Formula::Node::add
+                            || node->kind == Formula::Node::subtract))
+            || (value == 1 && (node->kind == Formula::Node::multiply
+                               || node->kind == Formula::Node::divide)))
+        {
+            node = std::move(node->left);
+            return;
+        }
+    }
+    if (left_constant)
+    {
+        int value = node->left->value;
+        if ((value == 0 && node->kind == Formula::Node::add)
+            || (value == 1 && node->kind == Formula::Node::multiply))
+        {
+            node = std::move(node->right);
+            return;
+        }
+    }
+}
+
+}; // namespace
+
+std::unique_ptr<Formula::Node> Formula::parse(const std::string& source)
+{
+    return Parser{source}.parse_formula();
+}
+
+int Formula::walk(const Node& node, const Character& character,
+                  std::mt19937* rng)
+{
+    switch (node.kind)
+    {
+    case Node::number:
+        return node.value;
+    case Node::field:
+    {
+        const int* score = character.get_score(node.name);
+        return score ? *score : 0;
+    }
+    case Node::negate:
+        return wrap_negate(walk(*node.left, character, rng));
+    default:
+    {
+        int a = walk(*node.left, character, rng);
+        int b = walk(*node.right, character, rng);
+        return apply(node.kind, a, b, rng);
+    }
+    }
+}
+
+Formula Formula::compile(const std::string& source,
+                         const Constants& constants)
+{
+    NodePtr root = parse(source);
+    fold(root, constants);
+
+    Formula formula;
+    formula.emit(*root, 0);
+    formula.code.push_back({Opcode::ret, 0, 0, 0, 0});
+    formula.code.shrink_to_fit();
+    return formula;
+}
+
+int Formula::evaluate(const Character& character,
+                      std::mt19937* rng) const noexcept
+{
+    int values[max_inputs];
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        const int* score = character.get_score(inputs[i]);
+        values[i] = score ? *score : 0;
+    }
+    return evaluate(values, rng);
+}
+
+int Formula::evaluate(const int* values, std::mt19937* rng) const noexcept
+{
+    int r[max_registers];
+    for (const Instruction* i = code.data();; ++i)
+    {
+        switch (i->op)
+        {
+        case Opcode::load:
+            r[i->dst] = i->immediate;
+            break;
+        case Opcode::input:
+            r[i->dst] = values[i->immediate];
+            break;
+        case Opcode::negate:
+            r[i->dst] = wrap_negate(r[i->a]);
+            break;
+        case Opcode::add:
+            r[i->dst] = wrap_add(r[i->a], r[i->b]);
+            break;
+        case Opcode::add_immediate:
+            r[i->dst] = wrap_add(r[i->a], i->immediate);
+            break;
+        case Opcode::subtract:
+            r[i->dst] = wrap_subtract(r[i->a], r[i->b]);
+            break;
+        case Opcode::multiply:
+            r[i->dst] = wrap_multiply(r[i->a], r[i->b]);
+            break;
+        case Opcode::multiply_immediate:
+            r[i->dst] = wrap_multiply(r[i->a], i->immediate);
+            break;
+        case Opcode::divide:
+            r[i->dst] = floor_divide(r[i->a], r[i->b]);
+            break;
+        case Opcode::divide_immediate:
+            r[i->dst] = floor_divide(r[i->a], i->immediate);
+            break;
+        case Opcode::minimum:
+            r[i->dst] = std::min(r[i->a], r[i->b]);
+            break;
+        case Opcode::maximum:
+            r[i->dst] = std::max(r[i->a], r[i->b]);
+            break;
+        case Opcode::roll:
+            r[i->dst] = roll_dice(r[i->a], r[i->b], rng);
+            break;
+        case Opcode::ret:
+            return r[i->a];
+        }
+    }
+}
+
+void Formula::emit(const Node& node, uint8_t target)
+{
+    if (target >= max_registers)
+        throw SyntaxException(_("formula is too deeply nested"));
+
+    switch (node.kind)
+    {
+    case Node::number:
+        code.push_back({Opcode::load, target, 0, 0, node.value});
+        return;
+
+    case Node::field:
+    {
+        auto slot = std::find(inputs.begin(), inputs.end(), node.name);
+        if (slot == inputs.end())
+        {
+            if (inputs.size() == max_inputs)
+                throw SyntaxException(_("formula reads too many fields"));
+            slot = inputs.insert(inputs.end(), node.name);
+        }
+        code.push_back({Opcode::input, target, 0, 0,
+                        static_cast<int32_t>(slot - inputs.begin())});
+        return;
+    }
+
+    case Node::negate:
+        emit(*node.left, target);
+        code.push_back({Opcode::negate, target, target, 0, 0});
+        return;
+
+    default:
+        break;
+    }
+
+    emit(*node.left, target);
+
+    // Uses an immediate operand for a constant on the right, e.g. "level / 2".
+    if (node.right->kind == Node::number)
+    {
+        int value = node.right->value;
+        switch (node.kind)
+        {
+        case Node::add:
+            code.push_back({Opcode::add_immediate, target, target, 0, value});
+            return;
+        case Node::subtract:
+            code.push_back({Opcode::add_immediate, target, target, 0,
+                            wrap_negate(value)});
+            return;
+        case Node::multiply:
+            code.push_back({Opcode::multiply_immediate, target, target, 0,
+                            value});
+            return;
+        case Node::divide:
+            code.push_back({Opcode::divide_immediate, target, target, 0,
+                            value});
+            return;
+        default:
+            break;
+        }
+    }
+
+    uint8_t temporary = target + 1;
+    emit(*node.right, temporary);
+
+    Opcode op;
+    switch (node.kind)
+    {
+    case Node::add: op = Opcode::add; break;
+    case Node::subtract: op = Opcode::subtract; break;
+    case Node::multiply: op = Opcode::multiply; break;
+    case Node::divide: op = Opcode::divide; break;
+    case Node::minimum: op = Opcode::minimum; break;
+    case Node::maximum: op = Opcode::maximum; break;
+    default: op = Opcode::roll; break;
+    }
+    code.push_back({op, target, target, temporary, 0});
+}
+
+}; // namespace gelcube
@@ -0,0 +1,210 @@
+/// @file formula.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Compiled rules formulas.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_FORMULA_HH_
+#define GELCUBE_SRC_FORMULA_HH_
+
+#include "character.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gelcube
+{
+
+/// @brief Rules formula compiled to register bytecode.
+/// Formulas are integer expressions over character scores, e.g.
+/// "proficiency + wis_mod, minimum 1" or "max(0, (level - 5) / 2)d8". They
+/// support + - * / (rounding down), unary minus, parentheses, min() and max(),
+/// dice (NdM, dM, or (expr)d(expr)), and trailing ", minimum EXPR" and
+/// ", maximum EXPR" clauses.
+///
+/// A formula is parsed once, constant folded (optionally substituting fields
+/// known not to change), and compiled to a flat sequence of register
+/// instructions. Evaluation runs a single loop over the instructions with the
+/// registers on the stack, and never allocates.
+typedef class Formula
+{
+public:
+    /// @brief Exception signifying a malformed formula.
+    class SyntaxException : public std::exception
+    {
+    public:
+        /// @brief Constructs a new SyntaxException object.
+        /// @param message Description of the error, including its position.
+        explicit SyntaxException(std::string message)
+            : message{std::move(message)}
+        {
+        }
+
+        const char* what() const noexcept override
+        {
+            return message.c_str();
+        }
+
+    private:
+        std::string message;
+    };
+
+    /// @brief Node of a parsed formula.
+    struct Node
+    {
+        enum Kind
+        {
+            number,
+            field,
+            negate,
+            add,
+            subtract,
+            multiply,
+            divide,
+            minimum,
+            maximum,
+            roll
+        };
+
+        Kind kind;
+        int value;
+        std::string name;
+        std::unique_ptr<Node> left;
+        std::unique_ptr<Node> right;
+        // Length of the longest path to a leaf, counting this node.
+        size_t depth;
+    };
+
+    /// @brief Looks up the value of a field which does not change.
+    /// Returns nullptr if the field must be read at evaluation time.
+    typedef std::function<const int*(const std::string&)> Constants;
+
+    /// @brief Maximum number of fields read by a formula at evaluation time.
+    static constexpr size_t max_inputs = 32;
+
+    /// @brief Maximum depth of a formula's syntax tree, and of the nesting of
+    ///        its parentheses, unary minuses and function arguments.
+    /// Bounds the recursion of parsing, folding and compiling.
+    static constexpr size_t max_depth = 256;
+
+    /// @brief Parses a formula without compiling it.
+    /// @param source Text of the formula.
+    /// @return Root of the syntax tree.
+    /// @throw gelcube::Formula::SyntaxException if the formula is malformed or
+    ///        nested deeper than max_depth.
+    static std::unique_ptr<Node> parse(const std::string& source);
+
+    /// @brief Evaluates a syntax tree by walking it.
+    /// Reference implementation of the formula semantics, used to check and
+    /// benchmark compiled formulas.
+    /// @param node Root of the syntax tree.
+    /// @param character Character whose scores are read; missing scores are
+    ///                  0.
+    /// @param rng Source of dice rolls, or nullptr to use average rolls.
+    /// @return Value of the formula.
+    static int walk(const Node& node, const Character& character,
+                    std::mt19937* rng = nullptr);
+
+    /// @brief Compiles a formula.
+    /// @param source Text of the formula.
+    /// @param constants Fields to substitute at compile time.
+    /// @return Compiled formula.
+    /// @throw gelcube::Formula::SyntaxException if the formula is malformed,
+    ///        reads more than max_inputs fields, or is too deeply nested.
+    static Formula compile(const std::string& source,
+                           const Constants& constants = nullptr);
+
+    /// @brief Evaluates the formula against a character.
+    /// @param character Character whose scores are read; missing scores are
+    ///                  0.
+    /// @param rng Source of dice rolls, or nullptr to use average rolls.
+    /// @return Value of the formula.
+    int evaluate(const Character& character,
+                 std::mt19937* rng = nullptr) const noexcept;
+
+    /// @brief Evaluates the formula against resolved inputs.
+    /// @param inputs Values of the fields returned by get_inputs(), in order.
+    /// @param rng Source of dice rolls, or nullptr to use average rolls.
+    /// @return Value of the formula.
+    int evaluate(const int* inputs,
+                 std::mt19937* rng = nullptr) const noexcept;
+
+    /// @brief Gets the fields read at evaluation time.
+    /// Fields substituted at compile time are not included.
+    /// @return Names of the fields, in input order.
+    inline const std::vector<std::string>& get_inputs() const noexcept
+    {
+        return inputs;
+    }
+
+    /// @brief Gets the number of compiled instructions.
+    /// @return Length of the bytecode.
+    inline size_t size() const noexcept
+    {
+        return code.size();
+    }
+
+private:
+    enum class Opcode : uint8_t
+    {
+        load,
+        input,
+        negate,
+        add,
+        add_immediate,
+        subtract,
+        multiply,
+        multiply_immediate,
+        divide,
+        divide_immediate,
+        minimum,
+        maximum,
+        roll,
+        ret
+    };
+
+    /// @brief Register instruction.
+    /// Computes dst from registers a and b, or from a and the immediate.
+    struct Instruction
+    {
+        Opcode op;
+        uint8_t dst;
+        uint8_t a;
+        uint8_t b;
+        int32_t immediate;
+    };
+
+    static constexpr size_t max_registers = 32;
+
+    /// @brief Emits the instructions computing a node into a register.
+    /// Registers above the target are used for temporaries.
+    void emit(const Node& node, uint8_t target);
+
+    std::vector<Instruction> code;
+    std::vector<std::string> inputs;
+} Formula;
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_FORMULA_HH_
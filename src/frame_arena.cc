@@ -0,0 +1,34 @@
+/// @file frame_arena.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Scratch memory released at the end of every frame.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "frame_arena.hh"
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace gelcube
+{
+
+alignas(std::max_align_t) std::byte FrameArena::buffer[FrameArena::capacity];
+std::pmr::monotonic_buffer_resource FrameArena::resource{
+    FrameArena::buffer, FrameArena::capacity,
+    std::pmr::new_delete_resource()};
+
+}; // namespace gelcube
@@ -0,0 +1,65 @@
+/// @file frame_arena.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Scratch memory released at the end of every frame.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_FRAME_ARENA_HH_
+#define GELCUBE_SRC_FRAME_ARENA_HH_
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace gelcube
+{
+
+/// @brief Scratch memory released at the end of every frame.
+/// Temporary strings and containers used while handling events and drawing
+/// (see gelcube::Tui::MainLoop) are allocated from a fixed buffer by bumping
+/// a pointer, and are all freed at once when the frame ends, so a frame in
+/// the steady state makes no heap allocations. Frames which outgrow the
+/// buffer take further memory from the heap until they end.
+/// Only the UI thread may use the arena.
+typedef class FrameArena
+{
+public:
+    /// @brief Size of the buffer reused by every frame.
+    static const size_t capacity = size_t{64} << 10;
+
+    /// @brief Gets the memory resource for allocations in this frame.
+    /// Memory obtained from it is valid until reset() is called.
+    /// @return Memory resource for std::pmr containers.
+    static inline std::pmr::memory_resource* get() noexcept
+    {
+        return &resource;
+    }
+
+    /// @brief Frees everything allocated in this frame.
+    /// Called by the main loop at the end of each frame.
+    static inline void reset() noexcept
+    {
+        resource.release();
+    }
+
+private:
+    alignas(std::max_align_t) static std::byte buffer[capacity];
+    static std::pmr::monotonic_buffer_resource resource;
+} FrameArena;
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_FRAME_ARENA_HH_
@@ -0,0 +1,112 @@
+/// @file history.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Unlimited undo and redo of snapshots.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_HISTORY_HH_
+#define GELCUBE_SRC_HISTORY_HH_
+
+#include <utility>
+#include <vector>
+
+namespace gelcube
+{
+
+/// @brief Unlimited undo and redo of snapshots.
+/// Keeps every committed version of a value. Intended for types backed by
+/// persistent data structures (e.g. gelcube::Character), for which storing a
+/// version is an O(1) copy sharing memory with its neighbours.
+/// @tparam T Copyable snapshot type.
+template <typename T>
+class History
+{
+public:
+    /// @brief Constructs a new History object.
+    /// @param initial Initial version, which cannot be undone.
+    explicit History(T initial = T{})
+        : present{std::move(initial)}
+    {
+    }
+
+    /// @brief Gets the current version.
+    /// @return Current version.
+    inline const T& current() const noexcept
+    {
+        return present;
+    }
+
+    /// @brief Makes a new version current.
+    /// The previous version becomes undoable and all redoable versions are
+    /// discarded.
+    /// @param version New version.
+    inline void commit(T version)
+    {
+        past.push_back(std::move(present));
+        present = std::move(version);
+        future.clear();
+    }
+
+    /// @brief Restores the previous version.
+    /// @return false if there is nothing to undo.
+    inline bool undo()
+    {
+        if (past.empty())
+            return false;
+
+        future.push_back(std::move(present));
+        present = std::move(past.back());
+        past.pop_back();
+        return true;
+    }
+
+    /// @brief Restores the most recently undone version.
+    /// @return false if there is nothing to redo.
+    inline bool redo()
+    {
+        if (future.empty())
+            return false;
+
+        past.push_back(std::move(present));
+        present = std::move(future.back());
+        future.pop_back();
+        return true;
+    }
+
+    /// @brief Checks whether a version can be undone.
+    /// @return true if undo() would succeed.
+    inline bool can_undo() const noexcept
+    {
+        return !past.empty();
+    }
+
+    /// @brief Checks whether a version can be redone.
+    /// @return true if redo() would succeed.
+    inline bool can_redo() const noexcept
+    {
+        return !future.empty();
+    }
+
+private:
+    std::vector<T> past;
+    T present;
+    std::vector<T> future;
+};
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_HISTORY_HH_
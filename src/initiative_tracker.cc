@@ -0,0 +1,217 @@
+/// @file initiative_tracker.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Turn order of the combatants in an encounter.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "initiative_tracker.hh"
+
+#include <cstddef>
+#include <utility>
+
+namespace gelcube
+{
+
+InitiativeTracker::Id InitiativeTracker::add(Combatant combatant)
+{
+    // xorshift32 heap priorities keep the treap balanced in expectation.
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+
+    Id id;
+    if (!free_ids.empty())
+    {
+        id = free_ids.back();
+        free_ids.pop_back();
+        nodes[id] = {std::move(combatant), none, none, seed, 1, arrivals++};
+    }
+    else
+    {
+        id = static_cast<Id>(nodes.size());
+        nodes.push_back({std::move(combatant), none, none, seed, 1,
+                         arrivals++});
+    }
+
+    link(id);
+    if (turn == none)
+        turn = id;
+    return id;
+}
+
+void InitiativeTracker::remove(Id id)
+{
+    if (id == turn)
+    {
+        size_t position = rank(id);
+        unlink(id);
+        if (position == size() && position != 0)
+        {
+            position = 0;
+            ++round;
+        }
+        turn = size() == 0 ? none : at(position);
+    }
+    else
+    {
+        unlink(id);
+    }
+    free_ids.push_back(id);
+}
+
+void InitiativeTracker::set_initiative(Id id, int initiative)
+{
+    if (id == turn && size() > 1)
+    {
+        // The turn passes to whoever followed the combatant before it moved.
+        next();
+    }
+    unlink(id);
+    nodes[id].combatant.initiative = initiative;
+    link(id);
+}
+
+InitiativeTracker::Id InitiativeTracker::next()
+{
+    if (turn == none)
+        return none;
+
+    size_t position = rank(turn) + 1;
+    if (position == size())
+    {
+        position = 0;
+        ++round;
+    }
+    turn = at(position);
+    return turn;
+}
+
+size_t InitiativeTracker::rank(Id id) const noexcept
+{
+    size_t position = 0;
+    Id node = root;
+    while (node != id)
+    {
+        if (precedes(id, node))
+        {
+            node = nodes[node].left;
+        }
+        else
+        {
+            position += size_of(nodes[node].left) + 1;
+            node = nodes[node].right;
+        }
+    }
+    return position + size_of(nodes[id].left);
+}
+
+InitiativeTracker::Id InitiativeTracker::at(size_t rank) const noexcept
+{
+    Id node = root;
+    for (;;)
+    {
+        size_t left = size_of(nodes[node].left);
+        if (rank < left)
+        {
+            node = nodes[node].left;
+        }
+        else if (rank == left)
+        {
+            return node;
+        }
+        else
+        {
+            rank -= left + 1;
+            node = nodes[node].right;
+        }
+    }
+}
+
+bool InitiativeTracker::precedes(Id a, Id b) const noexcept
+{
+    const Combatant& x = nodes[a].combatant;
+    const Combatant& y = nodes[b].combatant;
+    if (x.initiative != y.initiative)
+        return x.initiative > y.initiative;
+    if (x.tiebreak != y.tiebreak)
+        return x.tiebreak > y.tiebreak;
+    return nodes[a].arrival < nodes[b].arrival;
+}
+
+void InitiativeTracker::split(Id tree, Id key, Id& before,
+                              Id& after) noexcept
+{
+    if (tree == none)
+    {
+        before = none;
+        after = none;
+    }
+    else if (precedes(tree, key))
+    {
+        split(nodes[tree].right, key, nodes[tree].right, after);
+        before = tree;
+        update_size(tree);
+    }
+    else
+    {
+        split(nodes[tree].left, key, before, nodes[tree].left);
+        after = tree;
+        update_size(tree);
+    }
+}
+
+InitiativeTracker::Id InitiativeTracker::merge(Id before, Id after) noexcept
+{
+    if (before == none)
+        return after;
+    if (after == none)
+        return before;
+
+    if (nodes[before].priority > nodes[after].priority)
+    {
+        nodes[before].right = merge(nodes[before].right, after);
+        update_size(before);
+        return before;
+    }
+    nodes[after].left = merge(before, nodes[after].left);
+    update_size(after);
+    return after;
+}
+
+void InitiativeTracker::link(Id id) noexcept
+{
+    Id before, after;
+    split(root, id, before, after);
+    nodes[id].left = none;
+    nodes[id].right = none;
+    nodes[id].size = 1;
+    root = merge(merge(before, id), after);
+}
+
+void InitiativeTracker::unlink(Id id) noexcept
+{
+    // Descends by key, so no parent links are needed.
+    Id* link = &root;
+    while (*link != id)
+    {
+        nodes[*link].size -= 1;
+        link = precedes(id, *link) ? &nodes[*link].left : &nodes[*link].right;
+    }
+    *link = merge(nodes[id].left, nodes[id].right);
+}
+
+}; // namespace gelcube
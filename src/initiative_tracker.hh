@@ -0,0 +1,181 @@
+/// @file initiative_tracker.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Turn order of the combatants in an encounter.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_INITIATIVE_TRACKER_HH_
+#define GELCUBE_SRC_INITIATIVE_TRACKER_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gelcube
+{
+
+/// @brief Turn order of the combatants in an encounter.
+/// Combatants are kept in an order-statistic treap sorted by initiative, so
+/// adding, removing, and reordering a combatant, finding whose turn is next,
+/// and finding a combatant's position in the turn order all take O(log n)
+/// expected time. A window of the turn order can be read without visiting
+/// the rest of it.
+typedef class InitiativeTracker
+{
+public:
+    /// @brief Stable identifier of a combatant.
+    typedef uint32_t Id;
+
+    /// @brief Identifier which refers to no combatant.
+    static constexpr Id none = UINT32_MAX;
+
+    /// @brief Combatant in the turn order.
+    struct Combatant
+    {
+        std::string name;
+        int initiative;
+        // Breaks ties between equal initiatives, e.g. the Dexterity score.
+        int tiebreak;
+    };
+
+    /// @brief Adds a combatant.
+    /// The first combatant added takes the current turn. Combatants tied on
+    /// initiative and tiebreak act in the order they were added.
+    /// @param combatant Combatant to add.
+    /// @return Identifier of the combatant.
+    Id add(Combatant combatant);
+
+    /// @brief Removes a combatant.
+    /// If it is the combatant's turn, the turn passes to the next combatant,
+    /// starting a new round if it was the last.
+    /// @param id Identifier of the combatant.
+    void remove(Id id);
+
+    /// @brief Changes a combatant's initiative.
+    /// If it is the combatant's turn (e.g. when delaying), the turn passes to
+    /// the combatant which followed it.
+    /// @param id Identifier of the combatant.
+    /// @param initiative New initiative.
+    void set_initiative(Id id, int initiative);
+
+    /// @brief Passes the turn to the next combatant.
+    /// Starts a new round after the last combatant's turn.
+    /// @return Identifier of the combatant whose turn it is, or none if there
+    ///         are no combatants.
+    Id next();
+
+    /// @brief Starts the first round.
+    /// Gives the turn to the first combatant in the turn order, e.g. after
+    /// adding every combatant when an encounter begins.
+    inline void restart() noexcept
+    {
+        turn = root == none ? none : at(0);
+        round = 1;
+    }
+
+    /// @brief Gets the combatant whose turn it is.
+    /// @return Identifier, or none if there are no combatants.
+    inline Id current() const noexcept
+    {
+        return turn;
+    }
+
+    /// @brief Gets the position of a combatant in the turn order.
+    /// @param id Identifier of the combatant.
+    /// @return Zero-based position, where 0 acts first.
+    size_t rank(Id id) const noexcept;
+
+    /// @brief Gets the combatant at a position in the turn order.
+    /// @param rank Zero-based position, less than size().
+    /// @return Identifier of the combatant.
+    Id at(size_t rank) const noexcept;
+
+    /// @brief Gets a combatant.
+    /// @param id Identifier of the combatant.
+    /// @return Combatant data.
+    inline const Combatant& get(Id id) const noexcept
+    {
+        return nodes[id].combatant;
+    }
+
+    /// @brief Gets the number of combatants.
+    /// @return Number of combatants.
+    inline size_t size() const noexcept
+    {
+        return size_of(root);
+    }
+
+    /// @brief Gets the current round.
+    /// @return Round number, starting at 1.
+    inline int get_round() const noexcept
+    {
+        return round;
+    }
+
+private:
+    struct Node
+    {
+        Combatant combatant;
+        Id left;
+        Id right;
+        uint32_t priority;
+        uint32_t size;
+        // Order in which combatants were added, breaking the last ties;
+        // identifiers are reused, so they cannot.
+        uint64_t arrival;
+    };
+
+    inline size_t size_of(Id id) const noexcept
+    {
+        return id == none ? 0 : nodes[id].size;
+    }
+
+    inline void update_size(Id id) noexcept
+    {
+        nodes[id].size = 1 + size_of(nodes[id].left) + size_of(nodes[id].right);
+    }
+
+    /// @brief Checks whether a combatant acts before another.
+    bool precedes(Id a, Id b) const noexcept;
+
+    /// @brief Splits a subtree into combatants acting before and not before
+    ///        a combatant.
+    void split(Id tree, Id key, Id& before, Id& after) noexcept;
+
+    /// @brief Joins two subtrees where every combatant of the first acts
+    ///        before every combatant of the second.
+    Id merge(Id before, Id after) noexcept;
+
+    /// @brief Links a node into the tree.
+    void link(Id id) noexcept;
+
+    /// @brief Unlinks a node from the tree without freeing it.
+    void unlink(Id id) noexcept;
+
+    std::vector<Node> nodes;
+    std::vector<Id> free_ids;
+    Id root = none;
+    Id turn = none;
+    int round = 1;
+    uint32_t seed = 0x9e3779b9;
+    uint64_t arrivals = 0;
+} InitiativeTracker;
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_INITIATIVE_TRACKER_HH_
@@ -0,0 +1,203 @@
+/// @file input_recording.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Records user input and replays it.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "input_recording.hh"
+#include "intl.hh"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <ios>
+#include <ostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <ncurses.h>
+
+namespace gelcube
+{
+
+InputRecording::Mode InputRecording::mode = InputRecording::Mode::off;
+bool InputRecording::realtime = false;
+uint32_t InputRecording::seed = 0;
+int InputRecording::lines = 0;
+int InputRecording::columns = 0;
+uint64_t InputRecording::start_time = 0;
+std::ofstream InputRecording::file;
+std::vector<InputRecording::Event> InputRecording::events;
+size_t InputRecording::next_event = 0;
+std::vector<uint64_t> InputRecording::latencies;
+
+namespace
+{
+
+const char* const format_name = "gelcube-input";
+const int format_version = 1;
+
+/// @brief Gets the time of a monotonic clock.
+/// @return Microseconds since an unspecified point.
+inline uint64_t now() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// @brief Formats a duration for reports.
+std::string format_microseconds(uint64_t nanoseconds)
+{
+    std::ostringstream ss;
+    ss.setf(std::ios::fixed);
+    ss.precision(1);
+    ss << nanoseconds / 1000.0 << _(" us");
+    return ss.str();
+}
+
+}; // namespace
+
+void InputRecording::record(const std::string& path)
+{
+    file.open(path, std::ios::out | std::ios::trunc);
+    if (!file)
+        throw std::system_error(errno, std::generic_category(), path);
+    seed = std::random_device{}();
+    mode = Mode::record;
+}
+
+void InputRecording::replay(const std::string& path, bool realtime)
+{
+    std::ifstream in(path);
+    if (!in)
+        throw std::system_error(errno, std::generic_category(), path);
+
+    std::string line;
+    std::string name;
+    int version = 0;
+    std::getline(in, line);
+    std::istringstream header(line);
+    if (!(header >> name >> version >> seed >> lines >> columns)
+        || name != format_name || version != format_version)
+    {
+        throw FormatException(path + _(": not an input recording"));
+    }
+
+    events.clear();
+    for (size_t number = 2; std::getline(in, line); ++number)
+    {
+        if (line.empty())
+            continue;
+        std::istringstream fields(line);
+        Event event{0, 0, 0, 0};
+        if (!(fields >> event.time >> event.key))
+        {
+            throw FormatException(path + _(":") + std::to_string(number)
+                                  + _(": malformed event"));
+        }
+        if (event.key == KEY_RESIZE
+            && !(fields >> event.lines >> event.columns))
+        {
+            throw FormatException(path + _(":") + std::to_string(number)
+                                  + _(": resize without a size"));
+        }
+        events.push_back(event);
+    }
+
+    next_event = 0;
+    latencies.clear();
+    latencies.reserve(events.size());
+    InputRecording::realtime = realtime;
+    mode = Mode::replay;
+}
+
+void InputRecording::begin(int lines, int columns)
+{
+    start_time = now();
+    if (mode != Mode::record)
+        return;
+    file << format_name << ' ' << format_version << ' ' << seed << ' '
+         << lines << ' ' << columns << '\n';
+    file.flush();
+}
+
+void InputRecording::capture(int key, int lines, int columns)
+{
+    if (mode != Mode::record)
+        return;
+    file << now() - start_time << ' ' << key;
+    if (key == KEY_RESIZE)
+        file << ' ' << lines << ' ' << columns;
+    // Flushes each key so that the recording survives a crash.
+    file << std::endl;
+}
+
+void InputRecording::report(std::ostream& out)
+{
+    if (latencies.empty())
+    {
+        out << _("No events replayed.") << std::endl;
+        return;
+    }
+
+    std::vector<uint64_t> sorted = latencies;
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&](double p)
+    {
+        return sorted[std::min(sorted.size() - 1,
+                               static_cast<size_t>(p * sorted.size()))];
+    };
+    out << _("Replayed ") << latencies.size()
+        << _(" events; event-to-frame latency: p50 ")
+        << format_microseconds(percentile(0.5)) << _(", p99 ")
+        << format_microseconds(percentile(0.99)) << _(", max ")
+        << format_microseconds(sorted.back()) << std::endl;
+
+    // Lists the slowest events so that they can be found in the recording.
+    std::vector<size_t> slowest(latencies.size());
+    for (size_t i = 0; i < slowest.size(); ++i)
+        slowest[i] = i;
+    size_t count = std::min<size_t>(5, slowest.size());
+    std::partial_sort(slowest.begin(), slowest.begin() + count, slowest.end(),
+                      [](size_t a, size_t b)
+                      { return latencies[a] > latencies[b]; });
+    out << _("Slowest events:") << std::endl;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Event& event = events[slowest[i]];
+        const char* name = keyname(event.key);
+        out << "  #" << slowest[i] + 1 << _(" at ")
+            << format_microseconds(event.time * 1000) << _(": ")
+            << (name ? name : std::to_string(event.key).c_str()) << _(", ")
+            << format_microseconds(latencies[slowest[i]]) << std::endl;
+    }
+}
+
+void InputRecording::finish()
+{
+    if (file.is_open())
+        file.close();
+    mode = Mode::off;
+}
+
+}; // namespace gelcube
@@ -0,0 +1,182 @@
+/// @file input_recording.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Records user input and replays it.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_INPUT_RECORDING_HH_
+#define GELCUBE_SRC_INPUT_RECORDING_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gelcube
+{
+
+/// @brief Records user input and replays it.
+/// A recording holds every key read by the TUI, including resizes, with the
+/// time it was read and the terminal size after each resize, plus the seed of
+/// the initiative rolls. Replaying a recording against a headless screen
+/// reproduces the session and times how long each event takes to reach the
+/// screen.
+///
+/// Recordings are text files. The first line is
+/// 'gelcube-input 1 SEED LINES COLUMNS', giving the initial terminal size, and
+/// each further line is 'MICROSECONDS KEY' or, for resizes,
+/// 'MICROSECONDS KEY LINES COLUMNS'.
+typedef class InputRecording
+{
+public:
+    /// @brief Exception signifying a malformed recording.
+    class FormatException : public std::exception
+    {
+    public:
+        /// @brief Constructs a new FormatException object.
+        /// @param message Description of the error.
+        explicit FormatException(std::string message)
+            : message{std::move(message)}
+        {
+        }
+
+        const char* what() const noexcept override
+        {
+            return message.c_str();
+        }
+
+    private:
+        std::string message;
+    };
+
+    /// @brief Key read by the TUI.
+    struct Event
+    {
+        // Microseconds since input started being read.
+        uint64_t time;
+        int key;
+        // Terminal size after a resize.
+        int lines;
+        int columns;
+    };
+
+    enum class Mode
+    {
+        off,
+        record,
+        replay
+    };
+
+    /// @brief Records the input of the next TUI session.
+    /// @param path Path of the recording, which is overwritten.
+    /// @throw std::system_error if the file cannot be opened.
+    static void record(const std::string& path);
+
+    /// @brief Replays a recording instead of reading input.
+    /// @param path Path of the recording.
+    /// @param realtime true to keep the recorded time between events, false
+    ///                 to replay as fast as possible.
+    /// @throw std::system_error if the file cannot be opened.
+    /// @throw gelcube::InputRecording::FormatException if the file is not a
+    ///        recording.
+    static void replay(const std::string& path, bool realtime);
+
+    /// @brief Gets whether input is being recorded or replayed.
+    /// @return Mode.
+    static inline Mode get_mode() noexcept
+    {
+        return mode;
+    }
+
+    /// @brief Checks whether a replay keeps the recorded timing.
+    /// @return true if events are replayed at their original times.
+    static inline bool is_realtime() noexcept
+    {
+        return realtime;
+    }
+
+    /// @brief Gets the seed of the initiative rolls.
+    /// @return Seed, generated when recording and read when replaying.
+    static inline uint32_t get_seed() noexcept
+    {
+        return seed;
+    }
+
+    /// @brief Gets the terminal size when the recording started.
+    /// @return Lines and columns.
+    static inline std::pair<int, int> get_size() noexcept
+    {
+        return {lines, columns};
+    }
+
+    /// @brief Starts the clock and writes the header of a recording.
+    /// Does nothing unless recording.
+    /// @param lines Number of lines of the terminal.
+    /// @param columns Number of columns of the terminal.
+    static void begin(int lines, int columns);
+
+    /// @brief Records a key.
+    /// Does nothing unless recording.
+    /// @param key Character returned by getch().
+    /// @param lines Number of lines of the terminal after the key was read.
+    /// @param columns Number of columns of the terminal after the key was
+    ///                read.
+    static void capture(int key, int lines, int columns);
+
+    /// @brief Gets the next event of a replay.
+    /// @return Event, or nullptr once every event has been replayed.
+    static inline const Event* next() noexcept
+    {
+        return next_event < events.size() ? &events[next_event++] : nullptr;
+    }
+
+    /// @brief Adds the time a replayed event took to reach the screen.
+    /// @param nanoseconds Time from reading the event to the frame being
+    ///                    sent to the terminal.
+    static inline void add_latency(uint64_t nanoseconds)
+    {
+        latencies.push_back(nanoseconds);
+    }
+
+    /// @brief Prints the latencies of a replay.
+    /// Gives percentiles over every event and lists the slowest events.
+    /// @param out Stream to print to.
+    static void report(std::ostream& out);
+
+    /// @brief Stops recording or replaying.
+    static void finish();
+
+private:
+    static Mode mode;
+    static bool realtime;
+    static uint32_t seed;
+    static int lines;
+    static int columns;
+    static uint64_t start_time;
+    static std::ofstream file;
+    static std::vector<Event> events;
+    static size_t next_event;
+    static std::vector<uint64_t> latencies;
+} InputRecording;
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_INPUT_RECORDING_HH_
@@ -0,0 +1,102 @@
+/// @file intern_table.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Table of interned strings.
+/// @version 0.1
+/// @date 2026-10-19
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_INTERN_TABLE_HH_
+#define GELCUBE_SRC_INTERN_TABLE_HH_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+
+namespace gelcube
+{
+
+/// @brief Table of interned strings, addressed by 32-bit identifiers.
+/// Entries are stored in chunks which double in size and never move, so that
+/// they can be read without locking while others are added. Chunk k holds
+/// identifiers
+/// [first_chunk_size * (2^k - 1), first_chunk_size * (2^(k+1) - 1)).
+/// Adding entries and using the index must be guarded by the caller's lock.
+/// Every Entry type has its own table.
+/// @tparam Entry Type of the entries, holding at least the interned string.
+template <typename Entry>
+class InternTable
+{
+public:
+    /// @brief Gets an entry which has been added.
+    /// @param id Identifier of the entry.
+    /// @return Entry, which never moves.
+    static inline Entry& get(uint32_t id) noexcept
+    {
+        size_t chunk, offset;
+        locate(id, chunk, offset);
+        return chunks[chunk].load(std::memory_order_acquire)[offset];
+    }
+
+    /// @brief Gets an entry, allocating the chunk which holds it if needed.
+    /// @param id Identifier of the entry.
+    /// @return Entry, which never moves.
+    static Entry& add(uint32_t id)
+    {
+        size_t chunk, offset;
+        locate(id, chunk, offset);
+        Entry* entries = chunks[chunk].load(std::memory_order_relaxed);
+        if (!entries)
+        {
+            entries = new Entry[size_t{1} << (chunk + first_chunk_bits)];
+            chunks[chunk].store(entries, std::memory_order_release);
+        }
+        return entries[offset];
+    }
+
+    /// @brief Gets the index of the strings which have been interned.
+    /// Constructed on first use, so that strings can be interned during
+    /// static initialization.
+    /// @return Map of each string, which must be stored in its entry, to the
+    ///         identifier of the entry.
+    static std::unordered_map<std::string_view, uint32_t>& get_ids()
+    {
+        static std::unordered_map<std::string_view, uint32_t> ids;
+        return ids;
+    }
+
+private:
+    /// @brief Finds the chunk and offset of an identifier.
+    static inline void locate(uint32_t id, size_t& chunk,
+                              size_t& offset) noexcept
+    {
+        uint64_t position = static_cast<uint64_t>(id)
+            + (1u << first_chunk_bits);
+        unsigned bits = 63 - __builtin_clzll(position);
+        chunk = bits - first_chunk_bits;
+        offset = position - (uint64_t{1} << bits);
+    }
+
+    static constexpr unsigned first_chunk_bits = 6;
+    static constexpr size_t chunk_count = 32 - first_chunk_bits + 1;
+
+    static inline std::atomic<Entry*> chunks[chunk_count];
+};
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_INTERN_TABLE_HH_
@@ -0,0 +1,388 @@
+/// @file inventory.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Nested containers of items with aggregate weight and value.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "character.hh"
+#include "inventory.hh"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gelcube
+{
+
+namespace
+{
+
+/// @brief Removes leading and trailing whitespace.
+std::string trim(const std::string& s)
+{
+    size_t begin = 0;
+    size_t end = s.size();
+    while (begin < end && std::isspace(static_cast<unsigned char>(s[begin])))
+        ++begin;
+    while (end > begin && std::isspace(static_cast<unsigned char>(s[end - 1])))
+        --end;
+    return s.substr(begin, end - begin);
+}
+
+/// @brief Gets the copper pieces in one coin of a denomination.
+/// @return Multiplier, or 0 if the denomination is unknown.
+int64_t copper_per(const std::string& denomination)
+{
+    if (denomination.empty() || denomination == "gp")
+        return 100;
+    if (denomination == "cp")
+        return 1;
+    if (denomination == "sp")
+        return 10;
+    if (denomination == "ep")
+        return 50;
+    if (denomination == "pp")
+        return 1000;
+    return 0;
+}
+
+}; // namespace
+
+Inventory::Inventory()
+    : nodes(1)
+{
+}
+
+Inventory::Item Inventory::parse(const std::string& value)
+{
+    Item item;
+    size_t start = 0;
+    bool is_name = true;
+    while (start <= value.size())
+    {
+        size_t end = value.find(';', start);
+        if (end == std::string::npos)
+            end = value.size();
+        std::string attribute = trim(value.substr(start, end - start));
+        start = end + 1;
+
+        if (is_name)
+        {
+            item.name = std::move(attribute);
+            is_name = false;
+            continue;
+        }
+
+        size_t space = attribute.find(' ');
+        std::string name = attribute.substr(0, space);
+        std::string argument = space == std::string::npos
+            ? std::string{} : trim(attribute.substr(space + 1));
+        char* rest;
+        if (name == "weight")
+        {
+            double pounds = std::strtod(argument.c_str(), &rest);
+            item.weight = std::llround(pounds * 100);
+        }
+        else if (name == "value")
+        {
+            double amount = std::strtod(argument.c_str(), &rest);
+            item.value = std::llround(amount * copper_per(trim(rest)));
+        }
+        else if (name == "count")
+        {
+            item.quantity = std::max(0, std::atoi(argument.c_str()));
+        }
+        else if (name == "in" && !argument.empty())
+        {
+            item.container = is_item(argument) ? argument
+                                               : item_prefix + argument;
+        }
+        else if (name == "extradimensional")
+        {
+            item.extradimensional = true;
+        }
+    }
+    return item;
+}
+
+void Inventory::set(const std::string& key, Item item)
+{
+    auto existing = keys.find(key);
+    Id id;
+    if (existing == keys.end())
+    {
+        if (free_ids.empty())
+        {
+            id = nodes.size();
+            nodes.emplace_back();
+        }
+        else
+        {
+            id = free_ids.back();
+            free_ids.pop_back();
+        }
+        keys.emplace(key, id);
+        nodes[id].key = key;
+        nodes[id].item = std::move(item);
+        place(id);
+    }
+    else
+    {
+        // Moving is removing from one container and adding to another, each
+        // O(depth).
+        id = existing->second;
+        stop_waiting(id);
+        detach(id);
+        nodes[id].item = std::move(item);
+        place(id);
+    }
+
+    // Adopts items which were waiting for this container.
+    auto adopted = waiting.find(key);
+    if (adopted != waiting.end())
+    {
+        std::vector<Id> contents = std::move(adopted->second);
+        waiting.erase(adopted);
+        for (Id content : contents)
+        {
+            nodes[content].is_waiting = false;
+            blocked.erase(std::remove(blocked.begin(), blocked.end(), content),
+                          blocked.end());
+            detach(content);
+            place(content);
+        }
+    }
+    retry_blocked();
+}
+
+void Inventory::erase(const std::string& key)
+{
+    auto existing = keys.find(key);
+    if (existing == keys.end())
+        return;
+
+    Id id = existing->second;
+    stop_waiting(id);
+    detach(id);
+    while (nodes[id].first_child != none)
+    {
+        Id content = nodes[id].first_child;
+        detach(content);
+        attach(content, root);
+        nodes[content].is_waiting = true;
+        waiting[key].push_back(content);
+    }
+
+    keys.erase(existing);
+    nodes[id] = Node{};
+    free_ids.push_back(id);
+    retry_blocked();
+}
+
+void Inventory::sync(const Character& character,
+                     const std::vector<std::string>& keys)
+{
+    for (auto& key : keys)
+    {
+        if (!is_item(key))
+            continue;
+        if (const std::string* value = character.get_detail(key))
+            set(key, parse(*value));
+        else
+            erase(key);
+    }
+}
+
+void Inventory::rebuild(const Character& character)
+{
+    nodes.assign(1, Node{});
+    free_ids.clear();
+    keys.clear();
+    waiting.clear();
+    blocked.clear();
+    character.get_details().for_each([&](const std::string& key,
+                                          const std::string& value)
+    {
+        if (is_item(key))
+            set(key, parse(value));
+    });
+}
+
+Inventory::Id Inventory::find(const std::string& key) const noexcept
+{
+    auto existing = keys.find(key);
+    return existing == keys.end() ? none : existing->second;
+}
+
+Inventory::Totals Inventory::get_totals(Id id) const noexcept
+{
+    const Node& node = nodes[id];
+    Totals totals;
+    totals.weight = node.item.weight * node.item.quantity
+                    + (node.item.extradimensional ? 0 : node.contents.weight);
+    totals.value = node.item.value * node.item.quantity + node.contents.value;
+    totals.count = 1 + node.contents.count;
+    return totals;
+}
+
+void Inventory::propagate(Id container, Totals delta, bool subtract) noexcept
+{
+    for (Id id = container; id != none; id = nodes[id].parent)
+    {
+        Totals& contents = nodes[id].contents;
+        if (subtract)
+        {
+            contents.weight -= delta.weight;
+            contents.value -= delta.value;
+            contents.count -= delta.count;
+        }
+        else
+        {
+            contents.weight += delta.weight;
+            contents.value += delta.value;
+            contents.count += delta.count;
+        }
+
+        // Nothing inside an extradimensional container weighs anything
+        // outside of it.
+        if (nodes[id].item.extradimensional)
+            delta.weight = 0;
+    }
+}
+
+void Inventory::detach(Id id) noexcept
+{
+    Node& node = nodes[id];
+    if (node.parent == none)
+        return;
+
+    Node& parent = nodes[node.parent];
+    if (node.previous == none)
+        parent.first_child = node.next;
+    else
+        nodes[node.previous].next = node.next;
+    if (node.next == none)
+        parent.last_child = node.previous;
+    else
+        nodes[node.next].previous = node.previous;
+
+    Id container = node.parent;
+    node.parent = none;
+    node.previous = none;
+    node.next = none;
+    propagate(container, get_totals(id), true);
+}
+
+void Inventory::attach(Id id, Id container) noexcept
+{
+    Node& node = nodes[id];
+    Node& parent = nodes[container];
+    node.parent = container;
+    node.previous = parent.last_child;
+    node.next = none;
+    if (parent.last_child == none)
+        parent.first_child = id;
+    else
+        nodes[parent.last_child].next = id;
+    parent.last_child = id;
+    propagate(container, get_totals(id), false);
+}
+
+void Inventory::place(Id id)
+{
+    const std::string& container_key = nodes[id].item.container;
+    if (container_key.empty())
+    {
+        attach(id, root);
+        return;
+    }
+
+    Id container = find(container_key);
+    if (container == none || is_inside(container, id))
+    {
+        attach(id, root);
+        nodes[id].is_waiting = true;
+        waiting[container_key].push_back(id);
+        if (container != none)
+            blocked.push_back(id);
+        return;
+    }
+    attach(id, container);
+}
+
+void Inventory::stop_waiting(Id id)
+{
+    Node& node = nodes[id];
+    if (!node.is_waiting)
+        return;
+
+    auto list = waiting.find(node.item.container);
+    list->second.erase(std::find(list->second.begin(), list->second.end(),
+                                 id));
+    if (list->second.empty())
+        waiting.erase(list);
+    node.is_waiting = false;
+
+    auto block = std::find(blocked.begin(), blocked.end(), id);
+    if (block != blocked.end())
+        blocked.erase(block);
+}
+
+void Inventory::retry_blocked()
+{
+    // Iterates over a copy, since placing may block items again.
+    std::vector<Id> items;
+    items.swap(blocked);
+    for (Id id : items)
+    {
+        Id container = find(nodes[id].item.container);
+        if (container != none && !is_inside(container, id))
+        {
+            // Bypasses stop_waiting(), which would search blocked.
+            auto list = waiting.find(nodes[id].item.container);
+            list->second.erase(std::find(list->second.begin(),
+                                         list->second.end(), id));
+            if (list->second.empty())
+                waiting.erase(list);
+            nodes[id].is_waiting = false;
+            detach(id);
+            attach(id, container);
+        }
+        else
+        {
+            blocked.push_back(id);
+        }
+    }
+}
+
+bool Inventory::is_inside(Id id, Id container) const noexcept
+{
+    for (; id != none; id = nodes[id].parent)
+    {
+        if (id == container)
+            return true;
+    }
+    return false;
+}
+
+}; // namespace gelcube
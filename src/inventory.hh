@@ -0,0 +1,245 @@
+/// @file inventory.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Nested containers of items with aggregate weight and value.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_INVENTORY_HH_
+#define GELCUBE_SRC_INVENTORY_HH_
+
+#include "character.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gelcube
+{
+
+/// @brief Nested containers of items with aggregate weight and value.
+/// Items are read from character details such as
+/// 'item_rope = Rope; weight 10; value 1 gp; in backpack'. Every container
+/// keeps the totals of its contents, so adding, editing, moving or removing
+/// an item only updates the containers above it, in O(depth), and the totals
+/// of any container are read in O(1).
+typedef class Inventory
+{
+public:
+    /// @brief Identifier of an item.
+    typedef uint32_t Id;
+
+    /// @brief Identifier of the outermost container, holding every item which
+    ///        is not inside another one.
+    static constexpr Id root = 0;
+
+    /// @brief Identifier which refers to no item.
+    static constexpr Id none = UINT32_MAX;
+
+    /// @brief Prefix of the details describing items.
+    static constexpr const char* item_prefix = "item_";
+
+    /// @brief Item described by a detail.
+    struct Item
+    {
+        std::string name;
+        // Weight of one item in hundredths of a pound.
+        int64_t weight = 0;
+        // Value of one item in copper pieces.
+        int64_t value = 0;
+        int quantity = 1;
+        // Key of the containing item's detail, empty if carried directly.
+        std::string container;
+        // true if contents do not add to the carried weight, e.g. a bag of
+        // holding.
+        bool extradimensional = false;
+    };
+
+    /// @brief Aggregate of the items in a container.
+    struct Totals
+    {
+        // Carried weight in hundredths of a pound.
+        int64_t weight = 0;
+        // Value in copper pieces.
+        int64_t value = 0;
+        // Number of distinct items.
+        size_t count = 0;
+    };
+
+    /// @brief Constructs an empty inventory.
+    Inventory();
+
+    /// @brief Parses the value of an item detail.
+    /// The value is the item's name followed by any of the attributes
+    /// 'weight N[.N] [lb]', 'value N [cp|sp|ep|gp|pp]', 'count N',
+    /// 'in CONTAINER' and 'extradimensional', separated by semicolons.
+    /// Unrecognized attributes are ignored.
+    /// @param value Value of the detail.
+    /// @return Parsed item.
+    static Item parse(const std::string& value);
+
+    /// @brief Checks whether a detail describes an item.
+    /// @param key Name of the detail.
+    /// @return true if the key starts with item_prefix.
+    static inline bool is_item(const std::string& key) noexcept
+    {
+        return key.compare(0, std::char_traits<char>::length(item_prefix),
+                           item_prefix) == 0;
+    }
+
+    /// @brief Adds or replaces an item.
+    /// Items naming a container which does not exist, or which is inside the
+    /// item itself, are carried directly until the container is added or
+    /// moved out.
+    /// @param key Name of the item's detail.
+    /// @param item Item to store.
+    void set(const std::string& key, Item item);
+
+    /// @brief Removes an item.
+    /// Its contents are carried directly until the container is added again.
+    /// @param key Name of the item's detail.
+    void erase(const std::string& key);
+
+    /// @brief Applies changes to a character's item details.
+    /// @param character Current version of the character.
+    /// @param keys Keys which changed; keys which are not items are ignored.
+    void sync(const Character& character,
+              const std::vector<std::string>& keys);
+
+    /// @brief Replaces every item with those of a character.
+    /// @param character Character to read.
+    void rebuild(const Character& character);
+
+    /// @brief Finds an item.
+    /// @param key Name of the item's detail.
+    /// @return Identifier, or none if the item does not exist.
+    Id find(const std::string& key) const noexcept;
+
+    /// @brief Gets an item.
+    /// @param id Identifier of an item other than root.
+    /// @return Item data.
+    inline const Item& get(Id id) const noexcept
+    {
+        return nodes[id].item;
+    }
+
+    /// @brief Gets the totals of a container's contents.
+    /// @param id Identifier of the container, root for everything carried.
+    /// @return Totals, excluding the container itself.
+    inline const Totals& get_contents(Id id = root) const noexcept
+    {
+        return nodes[id].contents;
+    }
+
+    /// @brief Gets what an item adds to its container.
+    /// @param id Identifier of an item other than root.
+    /// @return The item's own weight and value including its contents;
+    ///         contents of extradimensional items add no weight.
+    Totals get_totals(Id id) const noexcept;
+
+    /// @brief Visits items in display order.
+    /// Containers precede their contents. Only the visited part of the tree
+    /// is traversed, so the cost does not depend on the total number of
+    /// items.
+    /// @param count Maximum number of items to visit.
+    /// @param visit Callable taking (Id id, size_t depth), where items
+    ///              carried directly have depth 0.
+    template <typename Function>
+    void visit(size_t count, Function&& visit) const
+    {
+        Id id = nodes[root].first_child;
+        size_t depth = 0;
+        while (id != none && count-- > 0)
+        {
+            visit(id, depth);
+            if (nodes[id].first_child != none)
+            {
+                id = nodes[id].first_child;
+                ++depth;
+                continue;
+            }
+            while (id != none && nodes[id].next == none)
+            {
+                id = nodes[id].parent;
+                if (id == root)
+                    return;
+                --depth;
+            }
+            if (id != none)
+                id = nodes[id].next;
+        }
+    }
+
+    /// @brief Gets the number of items.
+    /// @return Number of distinct items.
+    inline size_t size() const noexcept
+    {
+        return keys.size();
+    }
+
+private:
+    struct Node
+    {
+        std::string key;
+        Item item;
+        Totals contents;
+        Id parent = none;
+        Id first_child = none;
+        Id last_child = none;
+        Id previous = none;
+        Id next = none;
+        // true if listed in waiting under the container's key.
+        bool is_waiting = false;
+    };
+
+    /// @brief Adds or subtracts totals from the contents of a container and
+    ///        those above it.
+    void propagate(Id container, Totals delta, bool subtract) noexcept;
+
+    /// @brief Unlinks an item and its contents from its container.
+    void detach(Id id) noexcept;
+
+    /// @brief Links an item and its contents into a container.
+    void attach(Id id, Id container) noexcept;
+
+    /// @brief Places an item in the container it names, if possible.
+    void place(Id id);
+
+    /// @brief Stops an item waiting for its container.
+    void stop_waiting(Id id);
+
+    /// @brief Places the items whose container was inside them, if their
+    ///        containers have since moved.
+    void retry_blocked();
+
+    /// @brief Checks whether an item is inside another or is the same item.
+    bool is_inside(Id id, Id container) const noexcept;
+
+    std::vector<Node> nodes;
+    std::vector<Id> free_ids;
+    std::unordered_map<std::string, Id> keys;
+    // Items carried directly because their container does not exist yet.
+    std::unordered_map<std::string, std::vector<Id>> waiting;
+    // Waiting items whose container exists but is inside them; rare, so
+    // retried after every change.
+    std::vector<Id> blocked;
+} Inventory;
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_INVENTORY_HH_
@@ -0,0 +1,294 @@
+/// @file json_import.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Imports characters from the JSON exports of other tools.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "character_file.hh"
+#include "intl.hh"
+#include "json_import.hh"
+#include "json_reader.hh"
+#include "memory_accounting.hh"
+#include "roster.hh"
+
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace gelcube
+{
+
+namespace
+{
+
+/// @brief Object or array within a record.
+struct Frame
+{
+    // Key of the container, prefixed to the keys inside it.
+    std::string prefix;
+    bool is_array;
+    // Number of elements read, if an array.
+    size_t count;
+};
+
+inline std::string join(const std::string& prefix, const std::string& key)
+{
+    if (prefix.empty() || key.empty())
+        return prefix.empty() ? key : prefix;
+    return prefix + "_" + key;
+}
+
+/// @brief Converts a JSON number to a score if it is an integer.
+bool parse_score(const std::string& text, int& score)
+{
+    if (text.find_first_of(".eE") != std::string::npos)
+        return false;
+    char* end;
+    errno = 0;
+    long value = std::strtol(text.c_str(), &end, 10);
+    if (*end != '\0' || errno == ERANGE || value < INT_MIN || value > INT_MAX)
+        return false;
+    score = static_cast<int>(value);
+    return true;
+}
+
+/// @brief Keeps a value on one line of a character file.
+std::string flatten(const std::string& value)
+{
+    std::string line = value;
+    for (char& c : line)
+    {
+        if (static_cast<unsigned char>(c) < 0x20 || c == 0x7f)
+            c = ' ';
+    }
+    return line;
+}
+
+/// @brief Reads the rest of a record whose opening brace has been read.
+/// @param reader Reader positioned after the brace.
+/// @param fields Receives the fields of the record.
+/// @return Description of the error, or empty if the record is well formed.
+/// @throw gelcube::JsonReader::SyntaxException if the record is malformed.
+std::string read_record(JsonReader& reader,
+                        std::vector<CharacterFile::Field>& fields)
+{
+    std::string error;
+    std::vector<Frame> frames{{"", false, 0}};
+    std::string key;
+    auto add = [&](const std::string& value, bool is_score, int score)
+    {
+        Frame& frame = frames.back();
+        std::string name = join(frame.prefix,
+                                frame.is_array ? std::to_string(++frame.count)
+                                               : key);
+        if (name.empty())
+            return;
+        if (fields.size() == JsonImport::max_fields)
+        {
+            error = _("more than ") + std::to_string(JsonImport::max_fields)
+                    + _(" fields");
+            return;
+        }
+        fields.push_back({name, is_score ? std::string() : flatten(value),
+                          is_score, score});
+    };
+
+    for (;;)
+    {
+        switch (reader.next())
+        {
+        case JsonReader::Event::key:
+            key = JsonImport::make_key(reader.get_text());
+            break;
+        case JsonReader::Event::begin_object:
+        case JsonReader::Event::begin_array:
+        {
+            Frame& frame = frames.back();
+            std::string prefix = join(frame.prefix,
+                                      frame.is_array
+                                          ? std::to_string(++frame.count)
+                                          : key);
+            bool is_array = reader.get_containers().back() == '[';
+            frames.push_back({std::move(prefix), is_array, 0});
+            break;
+        }
+        case JsonReader::Event::end_object:
+        case JsonReader::Event::end_array:
+            frames.pop_back();
+            if (frames.empty())
+                return error;
+            break;
+        case JsonReader::Event::string:
+            add(reader.get_text(), false, 0);
+            break;
+        case JsonReader::Event::number:
+        {
+            int score;
+            bool is_score = parse_score(reader.get_text(), score);
+            add(reader.get_text(), is_score, is_score ? score : 0);
+            break;
+        }
+        case JsonReader::Event::boolean:
+            add({}, true, reader.get_text() == "true");
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+/// @brief Checks whether an object just opened is a record.
+inline bool is_record(const std::string& containers) noexcept
+{
+    return containers == "[{" || containers == "{[{";
+}
+
+}; // namespace
+
+JsonImport::Stats JsonImport::run(std::istream& in, const std::string& source,
+                                  const std::string& directory,
+                                  std::ostream& errors)
+{
+    MemoryAccounting::Scope scope(MemoryAccounting::Tag::content);
+    auto start = std::chrono::steady_clock::now();
+    Stats stats;
+    JsonReader reader(in);
+    std::vector<CharacterFile::Field> fields;
+    std::string comment = _("Imported from ") + source;
+
+    for (;;)
+    {
+        JsonReader::Event event;
+        try
+        {
+            event = reader.next();
+        }
+        catch (JsonReader::SyntaxException& e)
+        {
+            errors << source << _(": ") << e.what() << '\n';
+            reader.recover(reader.get_containers().size());
+            continue;
+        }
+        if (event == JsonReader::Event::end)
+            break;
+        if (event != JsonReader::Event::begin_object
+            || !is_record(reader.get_containers()))
+        {
+            continue;
+        }
+
+        ++stats.records;
+        size_t depth = reader.get_containers().size() - 1;
+        fields.clear();
+        std::string error;
+        try
+        {
+            error = read_record(reader, fields);
+        }
+        catch (JsonReader::SyntaxException& e)
+        {
+            error = e.what();
+            reader.recover(depth);
+        }
+
+        std::string name;
+        for (auto& field : fields)
+        {
+            if (field.key == "name")
+                name = field.is_score ? std::to_string(field.score)
+                                      : field.value;
+        }
+        if (error.empty() && name.empty())
+            error = _("record has no name");
+
+        if (error.empty())
+        {
+            std::string file = make_key(name);
+            if (file.empty())
+                file = "character_" + std::to_string(stats.records);
+            std::string path = directory + "/" + file + Roster::file_suffix;
+            try
+            {
+                CharacterFile::create(path, fields, comment);
+                ++stats.imported;
+                continue;
+            }
+            catch (std::system_error& e)
+            {
+                error = e.code().value() == EEXIST
+                            ? path + _(" already exists")
+                            : e.what();
+            }
+        }
+        ++stats.failed;
+        errors << source << _(": record ") << stats.records << _(": ")
+               << error << '\n';
+    }
+    errors.flush();
+
+    stats.bytes = reader.get_offset();
+    stats.seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+std::string JsonImport::make_key(const std::string& name)
+{
+    std::string key;
+    for (char c : name)
+    {
+        if (c >= 'A' && c <= 'Z')
+        {
+            key += static_cast<char>(c - 'A' + 'a');
+        }
+        else if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')
+                 || static_cast<unsigned char>(c) >= 0x80)
+        {
+            key += c;
+        }
+        else if (!key.empty() && key.back() != '_')
+        {
+            key += '_';
+        }
+    }
+    while (!key.empty() && key.back() == '_')
+        key.pop_back();
+    return key;
+}
+
+void JsonImport::report(const Stats& stats, std::ostream& out)
+{
+    char rate[96];
+    double seconds = stats.seconds > 0 ? stats.seconds : 1e-9;
+    std::snprintf(rate, sizeof(rate), "%.2f s: %.0f", stats.seconds,
+                  stats.records / seconds);
+    out << _("Imported ") << stats.imported << _(" of ") << stats.records
+        << _(" records (") << stats.failed << _(" failed) in ") << rate
+        << _(" records/s, ");
+    std::snprintf(rate, sizeof(rate), "%.1f",
+                  stats.bytes / seconds / (1 << 20));
+    out << rate << _(" MiB/s") << std::endl;
+}
+
+}; // namespace gelcube
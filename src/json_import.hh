@@ -0,0 +1,89 @@
+/// @file json_import.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Imports characters from the JSON exports of other tools.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_JSON_IMPORT_HH_
+#define GELCUBE_SRC_JSON_IMPORT_HH_
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+
+namespace gelcube
+{
+
+/// @brief Imports characters from the JSON exports of other tools.
+/// A record is an object in a top-level array, e.g. '[{...}, {...}]', or in
+/// an array which is a member of a top-level object, e.g.
+/// '{"characters": [{...}]}'. Each record with a "name" becomes a character
+/// file named after it. Keys are lowercased, with characters other than
+/// letters and digits replaced by '_', and keys in nested objects and arrays
+/// are joined to their parent's with '_', so '"abilities": {"str": 15}'
+/// gives 'abilities_str = 15' and '"spells": ["Shield"]' gives
+/// 'spells_1 = Shield'. Integers become scores, booleans 1 or 0, and other
+/// values details; nulls are skipped.
+///
+/// The input is streamed through a gelcube::JsonReader, one record at a
+/// time, so an import of any size runs in the memory of its largest record.
+/// Malformed or unnamed records are reported and skipped.
+typedef class JsonImport
+{
+public:
+    /// @brief Outcome of an import.
+    struct Stats
+    {
+        uint64_t records = 0;
+        uint64_t imported = 0;
+        uint64_t failed = 0;
+        uint64_t bytes = 0;
+        double seconds = 0;
+    };
+
+    /// @brief Maximum number of fields in a record.
+    static constexpr size_t max_fields = 4096;
+
+    /// @brief Imports every record of a JSON export.
+    /// @param in Stream to read the export from.
+    /// @param source Name of the export, for messages and the comment at the
+    ///               top of each character file.
+    /// @param directory Directory receiving the character files; existing
+    ///                  files are never replaced.
+    /// @param errors Stream receiving one line per record which failed, and
+    ///               per syntax error between records.
+    /// @return Numbers of records read, imported and failed, and the bytes
+    ///         and time taken.
+    static Stats run(std::istream& in, const std::string& source,
+                     const std::string& directory, std::ostream& errors);
+
+    /// @brief Converts a JSON key to a character field key.
+    /// @param name Key in the export.
+    /// @return Key with ASCII letters lowercased and runs of other ASCII
+    ///         characters replaced by '_'; empty if nothing is left.
+    static std::string make_key(const std::string& name);
+
+    /// @brief Prints the outcome and throughput of an import.
+    /// @param stats Outcome of the import.
+    /// @param out Stream to print to.
+    static void report(const Stats& stats, std::ostream& out);
+} JsonImport;
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_JSON_IMPORT_HH_
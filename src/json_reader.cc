@@ -0,0 +1,551 @@
+/// @file json_reader.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Streaming JSON reader producing one event at a time.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "intl.hh"
+#include "json_reader.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace gelcube
+{
+
+namespace
+{
+
+// Longest number or literal accepted.
+const size_t max_word_size = 64;
+
+inline bool is_whitespace(char c) noexcept
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+inline bool is_word(char c) noexcept
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || c == '-'
+           || c == '+' || c == '.' || c == 'E';
+}
+
+inline bool is_digit(char c) noexcept
+{
+    return c >= '0' && c <= '9';
+}
+
+/// @brief Finds the first byte which is not whitespace.
+inline const char* find_non_whitespace(const char* p, const char* end) noexcept
+{
+    // Compact JSON has no whitespace between tokens.
+    if (p < end && !is_whitespace(*p))
+        return p;
+#ifdef __SSE2__
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i carriage_return = _mm_set1_epi8('\r');
+    const __m128i tab = _mm_set1_epi8('\t');
+    while (end - p >= 16)
+    {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i whitespace = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(bytes, space),
+                         _mm_cmpeq_epi8(bytes, newline)),
+            _mm_or_si128(_mm_cmpeq_epi8(bytes, carriage_return),
+                         _mm_cmpeq_epi8(bytes, tab)));
+        unsigned mask = ~_mm_movemask_epi8(whitespace) & 0xffff;
+        if (mask)
+            return p + __builtin_ctz(mask);
+        p += 16;
+    }
+#endif
+    while (p < end && is_whitespace(*p))
+        ++p;
+    return p;
+}
+
+/// @brief Finds the first quote, backslash or control character.
+inline const char* find_string_special(const char* p,
+                                       const char* end) noexcept
+{
+#ifdef __SSE2__
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1f);
+    while (end - p >= 16)
+    {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        // Unsigned bytes up to 0x1f are those whose maximum with it is 0x1f.
+        __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(bytes, quote),
+                         _mm_cmpeq_epi8(bytes, backslash)),
+            _mm_cmpeq_epi8(_mm_max_epu8(bytes, control), control));
+        unsigned mask = _mm_movemask_epi8(special);
+        if (mask)
+            return p + __builtin_ctz(mask);
+        p += 16;
+    }
+#endif
+    while (p < end && *p != '"' && *p != '\\'
+           && static_cast<unsigned char>(*p) >= 0x20)
+    {
+        ++p;
+    }
+    return p;
+}
+
+/// @brief Finds the first quote, bracket or comma.
+inline const char* find_structural(const char* p, const char* end) noexcept
+{
+#ifdef __SSE2__
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i comma = _mm_set1_epi8(',');
+    // Setting bit 5 maps '[' to '{' and ']' to '}', and nothing else to
+    // either.
+    const __m128i case_bit = _mm_set1_epi8(0x20);
+    const __m128i open = _mm_set1_epi8('{');
+    const __m128i close = _mm_set1_epi8('}');
+    while (end - p >= 16)
+    {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i folded = _mm_or_si128(bytes, case_bit);
+        __m128i structural = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(bytes, quote),
+                         _mm_cmpeq_epi8(bytes, comma)),
+            _mm_or_si128(_mm_cmpeq_epi8(folded, open),
+                         _mm_cmpeq_epi8(folded, close)));
+        unsigned mask = _mm_movemask_epi8(structural);
+        if (mask)
+            return p + __builtin_ctz(mask);
+        p += 16;
+    }
+#endif
+    while (p < end && *p != '"' && *p != ',' && *p != '{' && *p != '}'
+           && *p != '[' && *p != ']')
+    {
+        ++p;
+    }
+    return p;
+}
+
+/// @brief Checks a number against the JSON grammar.
+bool is_number(const std::string& s) noexcept
+{
+    size_t i = 0;
+    if (i < s.size() && s[i] == '-')
+        ++i;
+    if (i == s.size())
+        return false;
+    if (s[i] == '0')
+    {
+        ++i;
+    }
+    else if (is_digit(s[i]))
+    {
+        while (i < s.size() && is_digit(s[i]))
+            ++i;
+    }
+    else
+    {
+        return false;
+    }
+
+    if (i < s.size() && s[i] == '.')
+    {
+        if (++i == s.size() || !is_digit(s[i]))
+            return false;
+        while (i < s.size() && is_digit(s[i]))
+            ++i;
+    }
+    if (i < s.size() && (s[i] == 'e' || s[i] == 'E'))
+    {
+        ++i;
+        if (i < s.size() && (s[i] == '+' || s[i] == '-'))
+            ++i;
+        if (i == s.size() || !is_digit(s[i]))
+            return false;
+        while (i < s.size() && is_digit(s[i]))
+            ++i;
+    }
+    return i == s.size();
+}
+
+void append_utf8(std::string& out, uint32_t code)
+{
+    if (code < 0x80)
+    {
+        out += static_cast<char>(code);
+    }
+    else if (code < 0x800)
+    {
+        out += static_cast<char>(0xc0 | (code >> 6));
+        out += static_cast<char>(0x80 | (code & 0x3f));
+    }
+    else if (code < 0x10000)
+    {
+        out += static_cast<char>(0xe0 | (code >> 12));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (code & 0x3f));
+    }
+    else
+    {
+        out += static_cast<char>(0xf0 | (code >> 18));
+        out += static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (code & 0x3f));
+    }
+}
+
+}; // namespace
+
+JsonReader::JsonReader(std::istream& in, size_t buffer_size)
+    : in{in}, buffer(buffer_size > 0 ? buffer_size : 1),
+      position{buffer.data()}, end{buffer.data()}
+{
+}
+
+JsonReader::Event JsonReader::next()
+{
+    for (;;)
+    {
+        if (!skip_whitespace())
+        {
+            if (containers.empty())
+                return Event::end;
+            // Reports the truncation once, then ends.
+            containers.clear();
+            expect = Expect::value;
+            fail(_("unexpected end of input"));
+        }
+
+        char c = *position;
+        if ((c == '}' || c == ']')
+            && (expect == Expect::value_or_end || expect == Expect::key_or_end
+                || expect == Expect::comma_or_end))
+        {
+            char open = c == '}' ? '{' : '[';
+            if (containers.back() != open)
+                fail(open == '{' ? _("expected ']'") : _("expected '}'"));
+            ++position;
+            containers.pop_back();
+            end_value();
+            return open == '{' ? Event::end_object : Event::end_array;
+        }
+
+        switch (expect)
+        {
+        case Expect::colon:
+            if (c != ':')
+                fail(_("expected ':'"));
+            ++position;
+            expect = Expect::value;
+            continue;
+        case Expect::comma_or_end:
+            if (c != ',')
+            {
+                fail(containers.back() == '{' ? _("expected ',' or '}'")
+                                              : _("expected ',' or ']'"));
+            }
+            ++position;
+            expect = containers.back() == '{' ? Expect::key : Expect::value;
+            continue;
+        case Expect::key:
+        case Expect::key_or_end:
+            if (c != '"')
+                fail(_("expected a key"));
+            ++position;
+            read_string();
+            expect = Expect::colon;
+            return Event::key;
+        default:
+            break;
+        }
+
+        switch (c)
+        {
+        case '{':
+        case '[':
+            if (containers.size() >= max_depth)
+                fail(_("too deeply nested"));
+            ++position;
+            containers += c;
+            if (c == '{')
+            {
+                expect = Expect::key_or_end;
+                return Event::begin_object;
+            }
+            expect = Expect::value_or_end;
+            return Event::begin_array;
+        case '"':
+            ++position;
+            read_string();
+            end_value();
+            return Event::string;
+        default:
+            break;
+        }
+
+        read_word();
+        end_value();
+        if (text == "true" || text == "false")
+            return Event::boolean;
+        if (text == "null")
+            return Event::null;
+        if (!is_number(text))
+            fail(_("expected a value"));
+        return Event::number;
+    }
+}
+
+void JsonReader::recover(size_t depth)
+{
+    if (in_string)
+    {
+        in_string = false;
+        skip_string();
+    }
+    if (depth > containers.size())
+        depth = containers.size();
+
+    // Containers opened since the error, or left open by it.
+    size_t nesting = containers.size() - depth;
+    containers.resize(depth);
+    for (;;)
+    {
+        position = find_structural(position, end);
+        if (position == end)
+        {
+            if (fill())
+                continue;
+            break;
+        }
+
+        char c = *position;
+        if (c == '"')
+        {
+            ++position;
+            skip_string();
+            continue;
+        }
+        if (c == '{' || c == '[')
+        {
+            ++position;
+            ++nesting;
+            continue;
+        }
+        if (nesting > 0)
+        {
+            ++position;
+            if (c != ',' && --nesting == 0 && depth == 0)
+                break;
+            continue;
+        }
+
+        // Stops before a comma or closing bracket of the container, which
+        // next() then reads; any other closing bracket is stray.
+        if (depth > 0
+            && (c == ','
+                || (c == '}' && containers.back() == '{')
+                || (c == ']' && containers.back() == '[')))
+        {
+            break;
+        }
+        ++position;
+    }
+    expect = depth > 0 ? Expect::comma_or_end : Expect::value;
+}
+
+bool JsonReader::fill()
+{
+    consumed += end - buffer.data();
+    in.read(buffer.data(), buffer.size());
+    position = buffer.data();
+    end = position + in.gcount();
+    return position < end;
+}
+
+bool JsonReader::skip_whitespace()
+{
+    for (;;)
+    {
+        position = find_non_whitespace(position, end);
+        if (position < end)
+            return true;
+        if (!fill())
+            return false;
+    }
+}
+
+char JsonReader::take()
+{
+    if (position == end && !fill())
+    {
+        in_string = false;
+        fail(_("unterminated string"));
+    }
+    return *position++;
+}
+
+void JsonReader::read_string()
+{
+    text.clear();
+    in_string = true;
+    for (;;)
+    {
+        const char* special = find_string_special(position, end);
+        text.append(position, special);
+        position = special;
+        if (text.size() > max_string_size)
+            fail(_("string is too long"));
+
+        char c = take();
+        if (c == '"')
+        {
+            in_string = false;
+            return;
+        }
+        if (c != '\\')
+        {
+            // Only possible after take() read more of the stream.
+            if (static_cast<unsigned char>(c) >= 0x20)
+            {
+                text += c;
+                continue;
+            }
+            fail(_("control character in string"));
+        }
+
+        switch (char escape = take())
+        {
+        case '"':
+        case '\\':
+        case '/':
+            text += escape;
+            break;
+        case 'b':
+            text += '\b';
+            break;
+        case 'f':
+            text += '\f';
+            break;
+        case 'n':
+            text += '\n';
+            break;
+        case 'r':
+            text += '\r';
+            break;
+        case 't':
+            text += '\t';
+            break;
+        case 'u':
+        {
+            uint32_t code = read_hex();
+            if (code >= 0xdc00 && code < 0xe000)
+                fail(_("invalid surrogate pair"));
+            if (code >= 0xd800 && code < 0xdc00)
+            {
+                if (take() != '\\' || take() != 'u')
+                    fail(_("invalid surrogate pair"));
+                uint32_t low = read_hex();
+                if (low < 0xdc00 || low >= 0xe000)
+                    fail(_("invalid surrogate pair"));
+                code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+            }
+            append_utf8(text, code);
+            break;
+        }
+        default:
+            fail(_("invalid escape in string"));
+        }
+    }
+}
+
+void JsonReader::skip_string()
+{
+    for (;;)
+    {
+        position = find_string_special(position, end);
+        if (position == end)
+        {
+            if (!fill())
+                return;
+            continue;
+        }
+        char c = *position++;
+        if (c == '"')
+            return;
+        if (c == '\\' && (position < end || fill()))
+            ++position;
+    }
+}
+
+unsigned JsonReader::read_hex()
+{
+    unsigned code = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        char c = take();
+        code <<= 4;
+        if (is_digit(c))
+            code |= c - '0';
+        else if (c >= 'a' && c <= 'f')
+            code |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F')
+            code |= c - 'A' + 10;
+        else
+            fail(_("invalid escape in string"));
+    }
+    return code;
+}
+
+void JsonReader::read_word()
+{
+    text.clear();
+    for (;;)
+    {
+        while (position < end && is_word(*position))
+        {
+            if (text.size() == max_word_size)
+                fail(_("expected a value"));
+            text += *position++;
+        }
+        if (position < end || !fill())
+            break;
+    }
+    if (text.empty())
+        fail(_("expected a value"));
+}
+
+void JsonReader::end_value() noexcept
+{
+    expect = containers.empty() ? Expect::value : Expect::comma_or_end;
+}
+
+void JsonReader::fail(const char* message) const
+{
+    throw SyntaxException(message + std::string(_(" at byte "))
+                          + std::to_string(get_offset()));
+}
+
+}; // namespace gelcube
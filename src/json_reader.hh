@@ -0,0 +1,185 @@
+/// @file json_reader.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Streaming JSON reader producing one event at a time.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_JSON_READER_HH_
+#define GELCUBE_SRC_JSON_READER_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <istream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gelcube
+{
+
+/// @brief Streaming JSON reader producing one event at a time.
+/// Reads a stream of JSON values through a fixed-size buffer and reports the
+/// start and end of each container and each key and scalar as an event,
+/// without building a tree, so memory is bounded by the buffer, the nesting
+/// depth and the longest string, whatever the size of the input. Whitespace
+/// and the contents of strings are scanned 16 bytes at a time where SSE2 is
+/// available. After a syntax error, recover() skips to the next value of an
+/// enclosing container, so that one malformed record need not end a long
+/// import.
+typedef class JsonReader
+{
+public:
+    /// @brief Exception signifying malformed JSON.
+    class SyntaxException : public std::exception
+    {
+    public:
+        /// @brief Constructs a new SyntaxException object.
+        /// @param message Description of the error, including its offset.
+        explicit SyntaxException(std::string message)
+            : message{std::move(message)}
+        {
+        }
+
+        const char* what() const noexcept override
+        {
+            return message.c_str();
+        }
+
+    private:
+        std::string message;
+    };
+
+    /// @brief Part of the input read by next().
+    enum class Event
+    {
+        begin_object,
+        end_object,
+        begin_array,
+        end_array,
+        key,
+        string,
+        number,
+        boolean,
+        null,
+        end
+    };
+
+    /// @brief Maximum number of nested containers.
+    static constexpr size_t max_depth = 256;
+
+    /// @brief Maximum length of a key or string in bytes.
+    static constexpr size_t max_string_size = size_t{1} << 20;
+
+    /// @brief Constructs a new JsonReader object.
+    /// @param in Stream to read from; any number of values may follow each
+    ///           other, e.g. one per line.
+    /// @param buffer_size Number of bytes read from the stream at a time.
+    explicit JsonReader(std::istream& in, size_t buffer_size = 64 << 10);
+
+    /// @brief Reads the next event.
+    /// @return Event read, or Event::end once the input is exhausted.
+    /// @throw gelcube::JsonReader::SyntaxException if the input is malformed.
+    Event next();
+
+    /// @brief Gets the text of the last key, string, number or boolean.
+    /// Strings are unescaped into UTF-8; numbers and booleans are as
+    /// written.
+    /// @return Text of the event.
+    inline const std::string& get_text() const noexcept
+    {
+        return text;
+    }
+
+    /// @brief Gets the containers enclosing the next event.
+    /// @return One '{' or '[' per open container, outermost first.
+    inline const std::string& get_containers() const noexcept
+    {
+        return containers;
+    }
+
+    /// @brief Gets the number of bytes consumed.
+    /// @return Offset in the stream of the next byte to read.
+    inline uint64_t get_offset() const noexcept
+    {
+        return consumed + (position - buffer.data());
+    }
+
+    /// @brief Skips input after a syntax error.
+    /// Resumes at the next ',' or closing bracket of the container at a
+    /// depth, so that next() continues with the value after the one which
+    /// was malformed. Brackets inside strings are ignored.
+    /// @param depth Number of containers enclosing the value to skip; the
+    ///              outer containers must be unaffected by the error.
+    void recover(size_t depth);
+
+private:
+    /// @brief What the reader expects after whitespace.
+    enum class Expect
+    {
+        value,
+        value_or_end,
+        key,
+        key_or_end,
+        colon,
+        comma_or_end
+    };
+
+    /// @brief Reads more of the stream into the buffer.
+    /// @return false at the end of the stream.
+    bool fill();
+
+    /// @brief Skips whitespace, reading more of the stream as required.
+    /// @return false at the end of the stream.
+    bool skip_whitespace();
+
+    /// @brief Consumes one byte of a string.
+    /// @throw gelcube::JsonReader::SyntaxException at the end of the stream.
+    char take();
+
+    /// @brief Reads a string whose opening quote has been consumed.
+    void read_string();
+
+    /// @brief Skips a string whose opening quote has been consumed.
+    void skip_string();
+
+    /// @brief Reads the four hexadecimal digits of a \u escape.
+    unsigned read_hex();
+
+    /// @brief Reads a number or literal into the text.
+    void read_word();
+
+    /// @brief Updates the expectation after a complete value.
+    void end_value() noexcept;
+
+    [[noreturn]] void fail(const char* message) const;
+
+    std::istream& in;
+    std::vector<char> buffer;
+    const char* position;
+    const char* end;
+    // Bytes of the stream before the start of the buffer.
+    uint64_t consumed = 0;
+    std::string text;
+    std::string containers;
+    Expect expect = Expect::value;
+    bool in_string = false;
+} JsonReader;
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_JSON_READER_HH_
@@ -0,0 +1,88 @@
+/// @file latency_histogram.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Histogram of latencies with bounded relative error.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "latency_histogram.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace gelcube
+{
+
+void LatencyHistogram::record(uint64_t value, uint64_t count) noexcept
+{
+    counts[index_of(value)] += count;
+    total += count;
+    max = std::max(max, value);
+}
+
+uint64_t LatencyHistogram::percentile(double percent) const noexcept
+{
+    if (total == 0)
+        return 0;
+
+    // Rank of the value, counting from 1.
+    uint64_t rank = static_cast<uint64_t>(
+        std::ceil(std::clamp(percent, 0.0, 100.0) / 100 * total));
+    rank = std::max<uint64_t>(rank, 1);
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < bucket_count; ++i)
+    {
+        seen += counts[i];
+        if (seen >= rank)
+            return std::min(highest_in(i), max);
+    }
+    return max;
+}
+
+void LatencyHistogram::reset() noexcept
+{
+    counts.fill(0);
+    total = 0;
+    max = 0;
+}
+
+size_t LatencyHistogram::index_of(uint64_t value) noexcept
+{
+    // Values below twice the sub-bucket count are their own index.
+    if (value < 2 * sub_bucket_count)
+        return value;
+
+    // Keeps the leading bit and the sub-bucket bits below it.
+    unsigned leading = 63 - __builtin_clzll(value);
+    unsigned shift = leading - sub_bucket_bits;
+    return (shift + 1) * sub_bucket_count + (value >> shift)
+           - sub_bucket_count;
+}
+
+uint64_t LatencyHistogram::highest_in(size_t index) noexcept
+{
+    if (index < 2 * sub_bucket_count)
+        return index;
+
+    unsigned shift = index / sub_bucket_count - 1;
+    uint64_t mantissa = index % sub_bucket_count + sub_bucket_count;
+    return ((mantissa + 1) << shift) - 1;
+}
+
+}; // namespace gelcube
@@ -0,0 +1,88 @@
+/// @file latency_histogram.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Histogram of latencies with bounded relative error.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_LATENCY_HISTOGRAM_HH_
+#define GELCUBE_SRC_LATENCY_HISTOGRAM_HH_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace gelcube
+{
+
+/// @brief Histogram of latencies with bounded relative error.
+/// Buckets values the way HDR histograms do: values below 128 have a bucket
+/// each, and every power of two above is split into 64 buckets, so any
+/// recorded value is reported within 1.6% whether it is a microsecond or an
+/// hour. Recording is O(1) and the histogram has a fixed size, so it can run
+/// for a whole session.
+typedef class LatencyHistogram
+{
+public:
+    /// @brief Records a value.
+    /// @param value Latency, e.g. in nanoseconds.
+    /// @param count Number of occurrences.
+    void record(uint64_t value, uint64_t count = 1) noexcept;
+
+    /// @brief Gets a percentile of the recorded values.
+    /// @param percent Percentile from 0 to 100.
+    /// @return Highest value in the bucket containing the percentile, or 0
+    ///         if nothing has been recorded.
+    uint64_t percentile(double percent) const noexcept;
+
+    /// @brief Gets the largest recorded value.
+    /// @return Exact maximum, or 0 if nothing has been recorded.
+    inline uint64_t get_max() const noexcept
+    {
+        return max;
+    }
+
+    /// @brief Gets the number of recorded values.
+    /// @return Total count.
+    inline uint64_t get_count() const noexcept
+    {
+        return total;
+    }
+
+    /// @brief Removes every recorded value.
+    void reset() noexcept;
+
+private:
+    // Bits of each value kept below its leading bit.
+    static constexpr unsigned sub_bucket_bits = 6;
+    static constexpr size_t sub_bucket_count = size_t{1} << sub_bucket_bits;
+    static constexpr size_t bucket_count
+        = (65 - sub_bucket_bits) * sub_bucket_count;
+
+    /// @brief Gets the bucket of a value.
+    static size_t index_of(uint64_t value) noexcept;
+
+    /// @brief Gets the highest value of a bucket.
+    static uint64_t highest_in(size_t index) noexcept;
+
+    std::array<uint64_t, bucket_count> counts{};
+    uint64_t total = 0;
+    uint64_t max = 0;
+} LatencyHistogram;
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_LATENCY_HISTOGRAM_HH_
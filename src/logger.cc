@@ -19,11 +19,15 @@
 /// along with this program. If not, see <https://www.gnu.org/licenses/>.
 
 #include "logger.hh"
+#include "memory_accounting.hh"
 
 #include <iostream>
 
 #include <boost/core/null_deleter.hpp>
 #include <boost/log/core.hpp>
+#include <boost/log/core/record_view.hpp>
+#include <boost/log/expressions/message.hpp>
+#include <boost/log/utility/formatting_ostream.hpp>
 #include <boost/smart_ptr/make_shared_object.hpp>
 #include <boost/smart_ptr/shared_ptr.hpp>
 
@@ -37,9 +41,19 @@ Logger::Source Logger::source;
 
 void Logger::init()
 {
+    MemoryAccounting::Scope scope(MemoryAccounting::Tag::logging);
     sink = boost::make_shared<Sink>();
     boost::shared_ptr<std::ostream> stream{&std::clog, boost::null_deleter{}};
     sink->locked_backend()->add_stream(stream);
+
+    // Writes the message alone, as the default formatter does, counting the
+    // memory used to format it against logging.
+    sink->set_formatter([](const logging::record_view& record,
+                           logging::formatting_ostream& stream)
+    {
+        MemoryAccounting::Scope scope(MemoryAccounting::Tag::logging);
+        stream << record[logging::expressions::smessage];
+    });
     logging::core::get()->add_sink(sink);
 }
 
@@ -20,6 +20,7 @@
 /// along with this program. If not, see <https://www.gnu.org/licenses/>.
 
 #include "logger.hh"
+#include "memory_accounting.hh"
 #include "options.hh"
 
 #include <clocale>
@@ -27,12 +28,16 @@
 #include <libintl.h>
 
 typedef gelcube::Logger Logger;
+typedef gelcube::MemoryAccounting MemoryAccounting;
 
 int main(int argc, char* argv[])
 {
     // Initializes internationalization.
-    std::setlocale(LC_ALL, "");
-    textdomain("gelcube");
+    {
+        MemoryAccounting::Scope scope(MemoryAccounting::Tag::i18n);
+        std::setlocale(LC_ALL, "");
+        textdomain("gelcube");
+    }
 
     // Initializes the log interface.
     Logger::init();
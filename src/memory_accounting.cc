@@ -0,0 +1,359 @@
+/// @file memory_accounting.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Accounts for heap memory by subsystem.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "intl.hh"
+#include "logger.hh"
+#include "memory_accounting.hh"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+namespace gelcube
+{
+
+thread_local MemoryAccounting::Tag MemoryAccounting::current
+    = MemoryAccounting::Tag::other;
+std::thread MemoryAccounting::logging_thread;
+std::mutex MemoryAccounting::logging_mutex;
+std::condition_variable MemoryAccounting::logging_stopped;
+bool MemoryAccounting::is_logging = false;
+
+namespace
+{
+
+/// @brief Precedes every block, keeping the alignment of the block itself.
+struct alignas(std::max_align_t) Header
+{
+    size_t size;
+    MemoryAccounting::Tag tag;
+};
+
+/// @brief Usage counted against a subsystem.
+/// Constant-initialized, so that allocations made before main() are counted.
+struct Counters
+{
+    std::atomic<int64_t> live_bytes{0};
+    std::atomic<int64_t> peak_bytes{0};
+    std::atomic<uint64_t> allocations{0};
+
+    void add(int64_t size) noexcept
+    {
+        int64_t live = live_bytes.fetch_add(size, std::memory_order_relaxed)
+                       + size;
+        int64_t peak = peak_bytes.load(std::memory_order_relaxed);
+        while (live > peak
+               && !peak_bytes.compare_exchange_weak(
+                   peak, live, std::memory_order_relaxed))
+        {
+        }
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void remove(int64_t size) noexcept
+    {
+        live_bytes.fetch_sub(size, std::memory_order_relaxed);
+    }
+
+    MemoryAccounting::Usage get() const noexcept
+    {
+        return {live_bytes.load(std::memory_order_relaxed),
+                peak_bytes.load(std::memory_order_relaxed),
+                allocations.load(std::memory_order_relaxed)};
+    }
+};
+
+// One for each tag, then one for the whole program.
+Counters counters[MemoryAccounting::tag_count + 1];
+Counters& total = counters[MemoryAccounting::tag_count];
+
+const char* const tag_names[MemoryAccounting::tag_count] = {
+    "other", "tui", "content", "roster", "logging", "i18n"
+};
+
+const std::chrono::steady_clock::time_point start_time
+    = std::chrono::steady_clock::now();
+
+/// @brief Formats a size, e.g. "512 B" or "3.4 MiB".
+std::string format_bytes(int64_t bytes)
+{
+    const char* units[] = {"B", "KiB", "MiB", "GiB"};
+    double size = static_cast<double>(bytes);
+    size_t unit = 0;
+    while ((size >= 1024 || size <= -1024) && unit + 1 < 4)
+    {
+        size /= 1024;
+        ++unit;
+    }
+
+    char text[32];
+    if (unit == 0)
+        std::snprintf(text, sizeof(text), "%lld B",
+                      static_cast<long long>(bytes));
+    else
+        std::snprintf(text, sizeof(text), "%.1f %s", size, units[unit]);
+    return text;
+}
+
+/// @brief Allocates a block with a header, as operator new must.
+/// @throw std::bad_alloc if no memory is available or the size with the
+///        header does not fit in size_t.
+void* allocate(size_t size)
+{
+    if (size > SIZE_MAX - sizeof(Header))
+        throw std::bad_alloc();
+    void* block;
+    while (!(block = std::malloc(sizeof(Header) + size)))
+    {
+        std::new_handler handler = std::get_new_handler();
+        if (!handler)
+            throw std::bad_alloc();
+        handler();
+    }
+
+    Header* header = static_cast<Header*>(block);
+    header->size = size;
+    header->tag = MemoryAccounting::get_current();
+    counters[static_cast<size_t>(header->tag)].add(size);
+    total.add(size);
+    return header + 1;
+}
+
+/// @brief Offset of an over-aligned block from the start of its allocation,
+/// leaving room for the header immediately before the block.
+size_t get_offset(std::align_val_t alignment) noexcept
+{
+    size_t align = static_cast<size_t>(alignment);
+    return (sizeof(Header) + align - 1) / align * align;
+}
+
+/// @brief Allocates an over-aligned block with a header, as operator new
+/// must.
+/// @throw std::bad_alloc if no memory is available or the size with the
+///        header and padding does not fit in size_t.
+void* allocate(size_t size, std::align_val_t alignment)
+{
+    size_t align = static_cast<size_t>(alignment);
+    size_t offset = get_offset(alignment);
+    if (size > SIZE_MAX - offset - (align - 1))
+        throw std::bad_alloc();
+    // aligned_alloc() requires the size to be a multiple of the alignment.
+    size_t length = (offset + size + align - 1) / align * align;
+    void* block;
+    while (!(block = std::aligned_alloc(align, length)))
+    {
+        std::new_handler handler = std::get_new_handler();
+        if (!handler)
+            throw std::bad_alloc();
+        handler();
+    }
+
+    Header* header = reinterpret_cast<Header*>(
+        static_cast<char*>(block) + offset) - 1;
+    header->size = size;
+    header->tag = MemoryAccounting::get_current();
+    counters[static_cast<size_t>(header->tag)].add(size);
+    total.add(size);
+    return header + 1;
+}
+
+/// @brief Removes the header of a block from the accounting.
+/// @return The header.
+Header* release(void* pointer) noexcept
+{
+    Header* header = static_cast<Header*>(pointer) - 1;
+    counters[static_cast<size_t>(header->tag)].remove(header->size);
+    total.remove(header->size);
+    return header;
+}
+
+void deallocate(void* pointer) noexcept
+{
+    if (!pointer)
+        return;
+
+    std::free(release(pointer));
+}
+
+void deallocate(void* pointer, std::align_val_t alignment) noexcept
+{
+    if (!pointer)
+        return;
+
+    release(pointer);
+    std::free(static_cast<char*>(pointer) - get_offset(alignment));
+}
+
+}; // namespace
+
+MemoryAccounting::Usage MemoryAccounting::get_usage(Tag tag) noexcept
+{
+    return counters[static_cast<size_t>(tag)].get();
+}
+
+MemoryAccounting::Usage MemoryAccounting::get_total() noexcept
+{
+    return total.get();
+}
+
+const char* MemoryAccounting::get_name(Tag tag) noexcept
+{
+    return tag_names[static_cast<size_t>(tag)];
+}
+
+int64_t MemoryAccounting::get_resident_bytes() noexcept
+{
+    FILE* statm = std::fopen("/proc/self/statm", "r");
+    if (!statm)
+        return 0;
+
+    long long pages = 0;
+    long long resident = 0;
+    if (std::fscanf(statm, "%lld %lld", &pages, &resident) != 2)
+        resident = 0;
+    std::fclose(statm);
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+void MemoryAccounting::report(std::ostream& out)
+{
+    double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start_time).count();
+
+    auto row = [&](const char* name, const Usage& usage)
+    {
+        char line[128];
+        std::snprintf(line, sizeof(line), "%-10s %12s %12s %12llu %10.1f\n",
+                      name, format_bytes(usage.live_bytes).c_str(),
+                      format_bytes(usage.peak_bytes).c_str(),
+                      static_cast<unsigned long long>(usage.allocations),
+                      seconds > 0 ? usage.allocations / seconds : 0.0);
+        out << line;
+    };
+
+    char header[128];
+    std::snprintf(header, sizeof(header), "%-10s %12s %12s %12s %10s\n",
+                  _("subsystem"), _("live"), _("peak"), _("allocations"),
+                  _("allocs/s"));
+    out << header;
+    for (size_t i = 0; i < tag_count; ++i)
+        row(tag_names[i], counters[i].get());
+    row(_("total"), total.get());
+    out << _("Resident set size: ") << format_bytes(get_resident_bytes())
+        << std::endl;
+}
+
+void MemoryAccounting::start_logging(std::chrono::seconds interval)
+{
+    stop_logging();
+    is_logging = true;
+    logging_thread = std::thread(run_logging, interval);
+}
+
+void MemoryAccounting::stop_logging()
+{
+    if (!logging_thread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(logging_mutex);
+        is_logging = false;
+    }
+    logging_stopped.notify_all();
+    logging_thread.join();
+}
+
+void MemoryAccounting::run_logging(std::chrono::seconds interval)
+{
+    Scope scope(Tag::logging);
+    Logger::Source log = Logger::source;
+
+    uint64_t previous[tag_count];
+    for (size_t i = 0; i < tag_count; ++i)
+        previous[i] = counters[i].get().allocations;
+
+    std::unique_lock<std::mutex> lock(logging_mutex);
+    while (!logging_stopped.wait_for(lock, interval,
+                                     [] { return !is_logging; }))
+    {
+        std::ostringstream message;
+        message << _("Memory usage:");
+        for (size_t i = 0; i < tag_count; ++i)
+        {
+            Usage usage = counters[i].get();
+            message << ' ' << tag_names[i] << ' '
+                    << format_bytes(usage.live_bytes) << _(" (peak ")
+                    << format_bytes(usage.peak_bytes) << ", "
+                    << (usage.allocations - previous[i]) / interval.count()
+                    << _(" allocs/s);");
+            previous[i] = usage.allocations;
+        }
+        Usage usage = total.get();
+        message << _(" total ") << format_bytes(usage.live_bytes)
+                << _(" (peak ") << format_bytes(usage.peak_bytes)
+                << _("); resident ") << format_bytes(get_resident_bytes());
+        BOOST_LOG_SEV(log, LogLevel::info) << message.str();
+    }
+}
+
+}; // namespace gelcube
+
+void* operator new(std::size_t size)
+{
+    return gelcube::allocate(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    gelcube::deallocate(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    gelcube::deallocate(pointer);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return gelcube::allocate(size, alignment);
+}
+
+void operator delete(void* pointer, std::align_val_t alignment) noexcept
+{
+    gelcube::deallocate(pointer, alignment);
+}
+
+void operator delete(void* pointer, std::size_t,
+                     std::align_val_t alignment) noexcept
+{
+    gelcube::deallocate(pointer, alignment);
+}
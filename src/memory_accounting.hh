@@ -0,0 +1,148 @@
+/// @file memory_accounting.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Accounts for heap memory by subsystem.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_MEMORY_ACCOUNTING_HH_
+#define GELCUBE_SRC_MEMORY_ACCOUNTING_HH_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <thread>
+
+namespace gelcube
+{
+
+/// @brief Accounts for heap memory by subsystem.
+/// Replaces the global operator new and operator delete, including their
+/// over-aligned forms, so that every allocation made through them is
+/// counted against the subsystem which made it, as marked by the innermost
+/// Scope on the allocating thread. Each block carries a small header
+/// recording its size and subsystem, so memory freed elsewhere is still
+/// returned to the right subsystem. Memory which C libraries such as ncurses
+/// and gettext obtain from malloc() directly is not counted, but is part of
+/// the resident set size in reports.
+typedef class MemoryAccounting
+{
+public:
+    /// @brief Subsystem which memory is counted against.
+    enum class Tag
+    {
+        other,
+        tui,
+        content,
+        roster,
+        logging,
+        i18n
+    };
+
+    /// @brief Number of tags.
+    static const size_t tag_count = static_cast<size_t>(Tag::i18n) + 1;
+
+    /// @brief Memory usage of a subsystem, or of the whole program.
+    struct Usage
+    {
+        int64_t live_bytes;
+        int64_t peak_bytes;
+        uint64_t allocations;
+    };
+
+    /// @brief Counts allocations on the calling thread against a subsystem
+    ///        until destroyed.
+    /// Scopes nest; the innermost one applies.
+    typedef class Scope
+    {
+    public:
+        explicit Scope(Tag tag) noexcept
+            : previous{current}
+        {
+            current = tag;
+        }
+
+        ~Scope()
+        {
+            current = previous;
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Tag previous;
+    } Scope;
+
+    /// @brief Gets the memory usage of a subsystem.
+    /// @param tag Subsystem.
+    /// @return Usage counted since the program started.
+    static Usage get_usage(Tag tag) noexcept;
+
+    /// @brief Gets the memory usage of the whole program.
+    /// The peak is that of the total, not the sum of the subsystems' peaks.
+    /// @return Usage counted since the program started.
+    static Usage get_total() noexcept;
+
+    /// @brief Gets the name of a subsystem, as used in reports.
+    /// @param tag Subsystem.
+    /// @return Name, e.g. "tui".
+    static const char* get_name(Tag tag) noexcept;
+
+    /// @brief Gets the resident set size of the process.
+    /// @return Size in bytes, or 0 if it cannot be read.
+    static int64_t get_resident_bytes() noexcept;
+
+    /// @brief Writes a table of memory usage by subsystem.
+    /// Allocation rates are averaged over the life of the program.
+    /// @param out Stream to write to.
+    static void report(std::ostream& out);
+
+    /// @brief Logs memory usage by subsystem at an interval.
+    /// Logs from a background thread, so that usage is reported even while
+    /// the program is idle. Allocation rates are averaged over the interval.
+    /// @param interval Time between reports.
+    /// @throw std::system_error if the thread cannot be started.
+    static void start_logging(std::chrono::seconds interval);
+
+    /// @brief Stops logging started by start_logging(), if any.
+    static void stop_logging();
+
+    /// @brief Gets the subsystem which allocations on the calling thread
+    ///        are counted against.
+    /// @return Tag of the innermost Scope, or Tag::other outside of any.
+    static inline Tag get_current() noexcept
+    {
+        return current;
+    }
+
+private:
+    /// @brief Logs usage until stop_logging() is called.
+    static void run_logging(std::chrono::seconds interval);
+
+    static thread_local Tag current;
+    static std::thread logging_thread;
+    static std::mutex logging_mutex;
+    static std::condition_variable logging_stopped;
+    static bool is_logging;
+} MemoryAccounting;
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_MEMORY_ACCOUNTING_HH_
@@ -0,0 +1,102 @@
+/// @file mpsc_queue.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Lock-free multiple-producer single-consumer queue.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_MPSC_QUEUE_HH_
+#define GELCUBE_SRC_MPSC_QUEUE_HH_
+
+#include <atomic>
+#include <utility>
+
+namespace gelcube
+{
+
+/// @brief Lock-free multiple-producer single-consumer queue.
+/// Unbounded linked queue after Dmitry Vyukov's design: producers swap
+/// themselves onto the head with a single atomic exchange and never wait for
+/// each other or for the consumer. Only one thread may pop.
+/// @tparam T Default-constructible, movable element type.
+template <typename T>
+class MpscQueue
+{
+public:
+    /// @brief Constructs a new, empty MpscQueue object.
+    MpscQueue()
+        : head{new Node}, tail{head.load(std::memory_order_relaxed)}
+    {
+    }
+
+    /// @brief Destroys the MpscQueue object.
+    /// Destroys all elements still queued. No producer may be pushing.
+    ~MpscQueue()
+    {
+        T discarded;
+        while (pop(discarded))
+        {
+        }
+        delete tail;
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    /// @brief Appends an element.
+    /// Safe to call from any number of threads concurrently.
+    /// @param value Element to append.
+    void push(T value)
+    {
+        Node* node = new Node;
+        node->value = std::move(value);
+        Node* previous = head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    /// @brief Removes the oldest element.
+    /// Must only be called from the consumer thread. An element whose push()
+    /// has not yet linked it into the queue is not visible until it has.
+    /// @param value Receives the element.
+    /// @return false if the queue is empty.
+    bool pop(T& value)
+    {
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (!next)
+            return false;
+
+        value = std::move(next->value);
+        delete tail;
+        tail = next;
+        return true;
+    }
+
+private:
+    struct Node
+    {
+        std::atomic<Node*> next{nullptr};
+        T value;
+    };
+
+    // Most recently pushed node; producers contend on it.
+    std::atomic<Node*> head;
+    // Consumed stub node preceding the oldest element.
+    Node* tail;
+};
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_MPSC_QUEUE_HH_
@@ -18,22 +18,45 @@
 /// You should have received a copy of the GNU General Public License
 /// along with this program. If not, see <https://www.gnu.org/licenses/>.
 
+#include "batch_mode.hh"
+#include "character_file.hh"
+#include "character_table.hh"
 #include "config.hh"
+#include "content_cache.hh"
+#include "input_recording.hh"
 #include "intl.hh"
+#include "json_import.hh"
 #include "logger.hh"
+#include "memory_accounting.hh"
 #include "options.hh"
+#include "query.hh"
+#include "roster.hh"
+#include "session_client.hh"
+#include "session_hub.hh"
+#include "session_state.hh"
+#include "signal.hh"
+#include "terminal_writer.hh"
+#include "trace.hh"
 #include "tui.hh"
+#include "worker_pool.hh"
 
+#include <chrono>
+#include <csignal>
 #include <cstdlib>
 #include <cstring>
+#include <exception>
+#include <fstream>
+#include <functional>
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <system_error>
 #include <vector>
 
 #include <boost/program_options/errors.hpp>
 #include <boost/program_options/options_description.hpp>
 #include <boost/program_options/parsers.hpp>
+#include <boost/program_options/value_semantic.hpp>
 #include <boost/program_options/variables_map.hpp>
 
 namespace po = boost::program_options;
@@ -53,34 +76,28 @@ public:
     /// @param short_name Short-format option name.
     Option(const char* long_name, const char* description,
            const char* short_name = "")
-        : long_name{long_name}, description{description}, short_name{short_name}
+        : long_name{long_name}, description{description},
+          short_name{short_name}, full_name{long_name}
     {
+        // Joined once, so that getting the name never allocates.
+        if (std::strlen(short_name) > 0)
+            full_name.append(",").append(short_name);
     }
 
     /// @brief Gets the full name of the option to add to a description.
     /// Uses the format 'LONG' or 'LONG,SHORT' for use with
     /// po::options_description::add_options.
     /// @return Full name (internal data).
-    const char* name() noexcept
+    inline const char* name() const noexcept
     {
-        if (std::strlen(short_name) > 0)
-        {
-            std::stringstream ss_name;
-            ss_name << long_name << "," << short_name;
-            s_name = ss_name.str();
-            return s_name.c_str();
-        }
-        else
-        {
-            return long_name;
-        }
+        return full_name.c_str();
     }
 
     /// @brief Gets the number of occurrences of the option in a variables map.
     /// Used with a notified variables map containing parsed option data.
     /// @param vm Variables map of long-format option names to values.
     /// @return Number of occurrences.
-    inline size_t count(po::variables_map vm) const noexcept
+    inline size_t count(const po::variables_map& vm) const noexcept
     {
         return vm.count(long_name);
     }
@@ -90,7 +107,7 @@ public:
     const char* short_name;
 
 private:
-    std::string s_name;
+    std::string full_name;
 } Option;
 
 namespace options
@@ -101,6 +118,94 @@ Option show_keys(
     _("display keybindings for the TUI"),
     _("k"));
 
+Option roster(
+    _("roster"),
+    _("load and watch the character files in directory DIR"),
+    _("r"));
+
+Option cache_dir(
+    _("cache-dir"),
+    _("share the parsed roster with other instances through a cache in "
+      "directory DIR (default: /dev/shm)"));
+
+Option no_cache(
+    _("no-cache"),
+    _("read every character file instead of a shared cache"));
+
+Option state(
+    _("state"),
+    _("keep the state of the TUI in FILE and resume from it on the next run "
+      "(default: $XDG_STATE_HOME/gelcube/session)"));
+
+Option no_resume(
+    _("no-resume"),
+    _("start the TUI from its default state and do not keep it"));
+
+Option query(
+    _("query"),
+    _("print the name and path of each character in the roster matching "
+      "QUERY, e.g. 'level>=5 and class=wizard and hp<20', and exit"));
+
+Option validate(
+    _("validate"),
+    _("check every character in the roster against the rules, report "
+      "problems and throughput, and exit"));
+
+Option export_sheets(
+    _("export"),
+    _("validate the roster and write a sheet for each valid character in "
+      "FORMAT (json, csv or text), and exit"));
+
+Option output(
+    _("output"),
+    _("write exported sheets to directory DIR (default: current directory)"),
+    _("o"));
+
+Option import_json(
+    _("import"),
+    _("import the characters in the JSON export FILE ('-' for standard input) "
+      "into the roster, and exit"));
+
+Option hub(
+    _("hub"),
+    _("relay character changes between programs connecting to SOCKET"));
+
+Option connect(
+    _("connect"),
+    _("share character changes with the session hub at SOCKET"));
+
+Option record(
+    _("record"),
+    _("record the keys typed in the TUI to FILE"));
+
+Option replay(
+    _("replay"),
+    _("replay the keys recorded in FILE without a terminal and report how "
+      "long each took to display"));
+
+Option realtime(
+    _("realtime"),
+    _("replay keys at their recorded times instead of as fast as possible"));
+
+Option frame_output(
+    _("frame-output"),
+    _("write each frame of the TUI at once, synchronized if the terminal "
+      "supports it, and print the bytes and syscalls per frame on exit"));
+
+Option trace(
+    _("trace"),
+    _("record timed spans of the main loop, drawing and background work, and "
+      "write them to FILE in Chrome trace event format on exit and on "
+      "SIGUSR1"));
+
+Option memory_stats(
+    _("memory-stats"),
+    _("print memory usage by subsystem on exit"));
+
+Option memory_log(
+    _("memory-log"),
+    _("log memory usage by subsystem every SECONDS"));
+
 Option help(
     _("help"),
     _("display this help and exit"),
@@ -120,6 +225,13 @@ void show_keys() noexcept
     std::cout << _("Keybindings for the TUI:") << std::endl
               << _(" g                  enter panel selection mode") << std::endl
               << _(" q                  quit the program") << std::endl
+              << _(" u                  undo the last change to the character") << std::endl
+              << _(" ^R                 redo the last undone change") << std::endl
+              << _(" i                  start or end an encounter with the roster") << std::endl
+              << _(" n                  pass the turn to the next combatant") << std::endl
+              << _(" d                  delay the current combatant's turn") << std::endl
+              << _(" l                  show or hide input latency") << std::endl
+              << _(" /                  open the next character matching a query") << std::endl
               << std::endl
               << _("Keybindings in panel selection mode:") << std::endl
               << _(" 1-9                focus the panel with the specified index") << std::endl;
@@ -138,24 +250,342 @@ void show_version() noexcept
               << _("Written by Ryan Pullinger and Natalie Wiggins.") << std::endl;
 }
 
-int parse_options(int argc, char* argv[]) noexcept
+/// @brief Relays character changes until interrupted.
+/// @param program Name the program was invoked with.
+/// @param socket Path of the socket to listen on.
+/// @return Exit status.
+int run_hub(const char* program, const std::string& socket) noexcept
 {
-    if (argc < 1)
+    Logger::Source log = Logger::source;
+    try
+    {
+        SessionHub hub(socket);
+        Signal signal(SessionHub::stop, {SIGINT, SIGTERM});
+        hub.run();
+        return EXIT_SUCCESS;
+    }
+    catch (std::system_error& e)
+    {
+        BOOST_LOG_SEV(log, LogLevel::fatal)
+            << program << _(": session hub: ") << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    catch (std::exception& e)
+    {
+        BOOST_LOG_SEV(log, LogLevel::fatal)
+            << program << _(": session hub: ") << e.what() << std::endl;
         return EXIT_FAILURE;
+    }
+}
 
+/// @brief Prints the characters in the roster matching a query.
+/// Reads the character files, or their shared cache, and filters them on the
+/// worker threads.
+/// @param program Name the program was invoked with.
+/// @param text Query (see gelcube::Query).
+/// @return Exit status.
+int run_query(const char* program, const std::string& text) noexcept
+{
     Logger::Source log = Logger::source;
+    int status = EXIT_SUCCESS;
+    try
+    {
+        Query query(text);
+        WorkerPool::start();
 
-    // Declares supported options.
+        for (auto& directory : Roster::get_directories())
+        {
+            std::vector<std::string> paths = Roster::list_files(directory);
+            std::vector<Character> characters(paths.size());
+            std::vector<std::string> errors(paths.size());
+            ContentCache cache(directory);
+            WorkerPool::run_parallel(paths.size(), [&](size_t i)
+            {
+                try
+                {
+                    characters[i] = cache.read(paths[i]);
+                }
+                catch (CharacterFile::ReadException& e)
+                {
+                    errors[i] = e.what();
+                }
+            });
+            cache.publish();
+            for (size_t i = 0; i < paths.size(); ++i)
+            {
+                if (errors[i].empty())
+                {
+                    Roster::add(paths[i], std::move(characters[i]));
+                }
+                else
+                {
+                    BOOST_LOG_SEV(log, LogLevel::warning)
+                        << program << _(": ") << errors[i];
+                }
+            }
+        }
+
+        const auto& entries = Roster::get_entries();
+        for (uint32_t row : query.run(CharacterTable::from_roster()))
+        {
+            const Character& character = entries[row].history.current();
+            const std::string* name = character.get_detail("name");
+            std::cout << (name ? *name : "") << '\t' << entries[row].path
+                      << '\n';
+        }
+        std::cout.flush();
+    }
+    catch (Query::ParseException& e)
+    {
+        BOOST_LOG_SEV(log, LogLevel::fatal)
+            << program << _(": invalid query: ") << e.what() << std::endl;
+        status = EXIT_FAILURE;
+    }
+    catch (std::system_error& e)
+    {
+        BOOST_LOG_SEV(log, LogLevel::fatal)
+            << program << _(": cannot load roster: ") << e.what()
+            << std::endl;
+        status = EXIT_FAILURE;
+    }
+    catch (std::exception& e)
+    {
+        BOOST_LOG_SEV(log, LogLevel::fatal)
+            << program << _(": cannot run query: ") << e.what() << std::endl;
+        status = EXIT_FAILURE;
+    }
+    WorkerPool::stop();
+    return status;
+}
+
+/// @brief Validates the roster and exports sheets without the TUI.
+/// @param program Name the program was invoked with.
+/// @param settings Format and output directory of the sheets.
+/// @return Exit status; failure if any file is unreadable or invalid.
+int run_batch(const char* program, const BatchMode::Settings& settings) noexcept
+{
+    Logger::Source log = Logger::source;
+    try
+    {
+        std::vector<std::string> paths;
+        for (auto& directory : Roster::get_directories())
+        {
+            std::vector<std::string> files = Roster::list_files(directory);
+            paths.insert(paths.end(), files.begin(), files.end());
+        }
+
+        BatchMode::Stats stats = BatchMode::run(paths, settings, std::cerr);
+        BatchMode::report(stats, std::cout);
+        return stats.invalid + stats.unreadable == 0 ? EXIT_SUCCESS
+                                                      : EXIT_FAILURE;
+    }
+    catch (std::system_error& e)
+    {
+        BOOST_LOG_SEV(log, LogLevel::fatal)
+            << program << _(": batch: ") << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    catch (std::exception& e)
+    {
+        BOOST_LOG_SEV(log, LogLevel::fatal)
+            << program << _(": batch: ") << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
+
+/// @brief Imports a JSON export into the roster.
+/// @param program Name the program was invoked with.
+/// @param file Path of the export, or "-" for standard input.
+/// @return Exit status; failure if any record was not imported.
+int run_import(const char* program, const std::string& file) noexcept
+{
+    Logger::Source log = Logger::source;
+    try
+    {
+        std::ifstream stream;
+        if (file != "-")
+        {
+            stream.open(file, std::ios::binary);
+            if (!stream)
+            {
+                BOOST_LOG_SEV(log, LogLevel::fatal)
+                    << program << _(": cannot open ") << file << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        std::istream& in = file == "-" ? std::cin : stream;
+
+        JsonImport::Stats stats = JsonImport::run(
+            in, file, Roster::get_directories().front(), std::cerr);
+        JsonImport::report(stats, std::cout);
+        if (in.bad())
+        {
+            BOOST_LOG_SEV(log, LogLevel::fatal)
+                << program << _(": cannot read ") << file << std::endl;
+            return EXIT_FAILURE;
+        }
+        return stats.failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    catch (std::system_error& e)
+    {
+        BOOST_LOG_SEV(log, LogLevel::fatal)
+            << program << _(": import: ") << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    catch (std::exception& e)
+    {
+        BOOST_LOG_SEV(log, LogLevel::fatal)
+            << program << _(": import: ") << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
+
+/// @brief Runs the program, accounting for memory as requested.
+/// @param program Name the program was invoked with.
+/// @param vm Variables map of parsed options.
+/// @param run Function running the program and returning its exit status.
+/// @return Exit status.
+int account_memory(const char* program, const po::variables_map& vm,
+                   const std::function<int()>& run) noexcept
+{
+    Logger::Source log = Logger::source;
+    if (options::memory_log.count(vm))
+    {
+        unsigned seconds = vm[options::memory_log.long_name].as<unsigned>();
+        if (seconds == 0)
+        {
+            BOOST_LOG_SEV(log, LogLevel::fatal)
+                << program << _(": memory log interval must be positive")
+                << std::endl;
+            return EXIT_FAILURE;
+        }
+        try
+        {
+            MemoryAccounting::start_logging(std::chrono::seconds(seconds));
+        }
+        catch (std::system_error& e)
+        {
+            BOOST_LOG_SEV(log, LogLevel::warning)
+                << program << _(": cannot log memory usage: ") << e.what();
+        }
+    }
+
+    int status = run();
+
+    MemoryAccounting::stop_logging();
+    if (options::memory_stats.count(vm))
+        MemoryAccounting::report(std::cout);
+    return status;
+}
+
+/// @brief Runs the program, tracing spans as requested.
+/// @param program Name the program was invoked with.
+/// @param vm Variables map of parsed options.
+/// @param run Function running the program and returning its exit status.
+/// @return Exit status.
+int trace_spans(const char* program, const po::variables_map& vm,
+                const std::function<int()>& run) noexcept
+{
+    if (!options::trace.count(vm))
+        return run();
+
+    Logger::Source log = Logger::source;
+    Trace::start(vm[options::trace.long_name].as<std::string>());
+    int status = run();
+    Trace::stop();
+    try
+    {
+        Trace::write();
+    }
+    catch (std::system_error& e)
+    {
+        BOOST_LOG_SEV(log, LogLevel::error)
+            << program << _(": cannot write trace: ") << e.what();
+    }
+    return status;
+}
+
+/// @brief Runs the TUI, the session hub or a batch command, accounting for
+///        memory and tracing spans as requested.
+/// @param program Name the program was invoked with.
+/// @param vm Variables map of parsed options.
+/// @param run Function running the program and returning its exit status.
+/// @return Exit status.
+int instrument(const char* program, const po::variables_map& vm,
+               const std::function<int()>& run) noexcept
+{
+    return account_memory(program, vm, [&]
+    {
+        return trace_spans(program, vm, run);
+    });
+}
+
+/// @brief Declares supported options.
+/// Their translated text is counted as i18n memory.
+/// @param program Name the program was invoked with.
+/// @return Description of the options for parsing and help.
+po::options_description describe_options(const char* program)
+{
+    MemoryAccounting::Scope scope(MemoryAccounting::Tag::i18n);
     std::stringstream caption;
-    caption << _("Usage: ") << argv[0] << _(" [OPTION]...") << std::endl
+    caption << _("Usage: ") << program << _(" [OPTION]...") << std::endl
             << _("Manage Dungeons & Dragons characters.") << std::endl
             << std::endl
             << _("Mandatory arguments to long options are mandatory for short options too");
     po::options_description desc(caption.str());
     desc.add_options()
         (options::show_keys.name(), options::show_keys.description)
+        (options::roster.name(), po::value<std::string>()->value_name("DIR"),
+         options::roster.description)
+        (options::cache_dir.name(),
+         po::value<std::string>()->value_name("DIR"),
+         options::cache_dir.description)
+        (options::no_cache.name(), options::no_cache.description)
+        (options::state.name(), po::value<std::string>()->value_name("FILE"),
+         options::state.description)
+        (options::no_resume.name(), options::no_resume.description)
+        (options::query.name(), po::value<std::string>()->value_name("QUERY"),
+         options::query.description)
+        (options::validate.name(), options::validate.description)
+        (options::export_sheets.name(),
+         po::value<std::string>()->value_name("FORMAT"),
+         options::export_sheets.description)
+        (options::output.name(), po::value<std::string>()->value_name("DIR"),
+         options::output.description)
+        (options::import_json.name(),
+         po::value<std::string>()->value_name("FILE"),
+         options::import_json.description)
+        (options::hub.name(), po::value<std::string>()->value_name("SOCKET"),
+         options::hub.description)
+        (options::connect.name(),
+         po::value<std::string>()->value_name("SOCKET"),
+         options::connect.description)
+        (options::record.name(),
+         po::value<std::string>()->value_name("FILE"),
+         options::record.description)
+        (options::replay.name(),
+         po::value<std::string>()->value_name("FILE"),
+         options::replay.description)
+        (options::realtime.name(), options::realtime.description)
+        (options::frame_output.name(), options::frame_output.description)
+        (options::trace.name(), po::value<std::string>()->value_name("FILE"),
+         options::trace.description)
+        (options::memory_stats.name(), options::memory_stats.description)
+        (options::memory_log.name(),
+         po::value<unsigned>()->value_name("SECONDS"),
+         options::memory_log.description)
         (options::help.name(), options::help.description)
         (options::version.name(), options::version.description);
+    return desc;
+}
+
+int parse_options(int argc, char* argv[]) noexcept
+{
+    if (argc < 1)
+        return EXIT_FAILURE;
+
+    Logger::Source log = Logger::source;
+    po::options_description desc = describe_options(argv[0]);
 
     // Processes options.
     try
@@ -178,9 +608,166 @@ int parse_options(int argc, char* argv[]) noexcept
             show_version();
             return EXIT_SUCCESS;
         }
+        else if (options::hub.count(vm))
+        {
+            const std::string& socket
+                = vm[options::hub.long_name].as<std::string>();
+            return instrument(argv[0], vm, [&]
+            {
+                return run_hub(argv[0], socket);
+            });
+        }
         else
         {
-            return Tui::start();
+            if (options::roster.count(vm))
+            {
+                Roster::add_directory(
+                    vm[options::roster.long_name].as<std::string>());
+            }
+            if (options::no_cache.count(vm))
+            {
+                ContentCache::set_directory("");
+            }
+            else if (options::cache_dir.count(vm))
+            {
+                ContentCache::set_directory(
+                    vm[options::cache_dir.long_name].as<std::string>());
+            }
+            if (options::import_json.count(vm))
+            {
+                if (Roster::get_directories().empty())
+                {
+                    BOOST_LOG_SEV(log, LogLevel::fatal)
+                        << argv[0] << _(": importing needs a roster")
+                        << std::endl;
+                    return EXIT_FAILURE;
+                }
+                const std::string& file
+                    = vm[options::import_json.long_name].as<std::string>();
+                return instrument(argv[0], vm, [&]
+                {
+                    return run_import(argv[0], file);
+                });
+            }
+            if (options::validate.count(vm)
+                || options::export_sheets.count(vm))
+            {
+                if (Roster::get_directories().empty())
+                {
+                    BOOST_LOG_SEV(log, LogLevel::fatal)
+                        << argv[0] << _(": batch mode needs a roster")
+                        << std::endl;
+                    return EXIT_FAILURE;
+                }
+                BatchMode::Settings settings;
+                if (options::export_sheets.count(vm)
+                    && !BatchMode::parse_format(
+                           vm[options::export_sheets.long_name]
+                               .as<std::string>(),
+                           settings.format))
+                {
+                    BOOST_LOG_SEV(log, LogLevel::fatal)
+                        << argv[0] << _(": unknown export format '")
+                        << vm[options::export_sheets.long_name]
+                               .as<std::string>()
+                        << _("'") << std::endl;
+                    return EXIT_FAILURE;
+                }
+                if (options::output.count(vm))
+                {
+                    settings.output_directory
+                        = vm[options::output.long_name].as<std::string>();
+                }
+                return instrument(argv[0], vm, [&]
+                {
+                    return run_batch(argv[0], settings);
+                });
+            }
+            if (options::query.count(vm))
+            {
+                if (Roster::get_directories().empty())
+                {
+                    BOOST_LOG_SEV(log, LogLevel::fatal)
+                        << argv[0] << _(": a query needs a roster")
+                        << std::endl;
+                    return EXIT_FAILURE;
+                }
+                const std::string& text
+                    = vm[options::query.long_name].as<std::string>();
+                return instrument(argv[0], vm, [&]
+                {
+                    return run_query(argv[0], text);
+                });
+            }
+            if (options::connect.count(vm))
+            {
+                const std::string& socket
+                    = vm[options::connect.long_name].as<std::string>();
+                try
+                {
+                    SessionClient::connect(socket);
+                }
+                catch (std::system_error& e)
+                {
+                    BOOST_LOG_SEV(log, LogLevel::fatal)
+                        << argv[0] << _(": cannot connect to session hub: ")
+                        << e.what() << std::endl;
+                    return EXIT_FAILURE;
+                }
+            }
+            if (options::frame_output.count(vm))
+                TerminalWriter::enable();
+            if (options::record.count(vm) && options::replay.count(vm))
+            {
+                BOOST_LOG_SEV(log, LogLevel::fatal)
+                    << argv[0] << _(": cannot record while replaying")
+                    << std::endl;
+                return EXIT_FAILURE;
+            }
+            try
+            {
+                if (options::record.count(vm))
+                {
+                    InputRecording::record(
+                        vm[options::record.long_name].as<std::string>());
+                }
+                else if (options::replay.count(vm))
+                {
+                    InputRecording::replay(
+                        vm[options::replay.long_name].as<std::string>(),
+                        options::realtime.count(vm));
+                }
+            }
+            catch (std::exception& e)
+            {
+                BOOST_LOG_SEV(log, LogLevel::fatal)
+                    << argv[0] << _(": ") << e.what() << std::endl;
+                return EXIT_FAILURE;
+            }
+
+            // Recordings start from the default state, so that they replay
+            // the same way.
+            if (!options::no_resume.count(vm)
+                && !options::record.count(vm) && !options::replay.count(vm))
+            {
+                std::string path = options::state.count(vm)
+                    ? vm[options::state.long_name].as<std::string>()
+                    : SessionState::get_default_path();
+                try
+                {
+                    if (!path.empty())
+                        SessionState::open(path);
+                }
+                catch (std::system_error& e)
+                {
+                    BOOST_LOG_SEV(log, LogLevel::warning)
+                        << argv[0] << _(": cannot keep the TUI state: ")
+                        << e.what();
+                }
+            }
+            int status = instrument(argv[0], vm, Tui::start);
+            SessionState::close();
+            return status;
         }
     }
     catch (po::unknown_option& e)
@@ -190,6 +777,19 @@ int parse_options(int argc, char* argv[]) noexcept
             << _("Try '") << argv[0] << _(" --help' for more information.") << std::endl;
         return EXIT_FAILURE;
     }
+    catch (po::error& e)
+    {
+        BOOST_LOG_SEV(log, LogLevel::fatal)
+            << argv[0] << _(": ") << e.what() << std::endl
+            << _("Try '") << argv[0] << _(" --help' for more information.") << std::endl;
+        return EXIT_FAILURE;
+    }
+    catch (std::system_error& e)
+    {
+        BOOST_LOG_SEV(log, LogLevel::fatal)
+            << argv[0] << _(": cannot load roster: ") << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
 }
 
 }; // namespace gelcube
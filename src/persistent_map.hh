@@ -0,0 +1,443 @@
+/// @file persistent_map.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Persistent hash array mapped trie.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_PERSISTENT_MAP_HH_
+#define GELCUBE_SRC_PERSISTENT_MAP_HH_
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace gelcube
+{
+
+/// @brief Persistent hash array mapped trie.
+/// Immutable map whose copies share structure. Copying is O(1); insertion and
+/// erasure copy only the path from the root to the modified entry, so every
+/// previous version remains valid and shares all untouched nodes with the
+/// new one. Nodes are never modified after construction, so a version may be
+/// read from any thread without locking while another thread derives new
+/// versions from it.
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class PersistentMap
+{
+public:
+    /// @brief Looks up the value associated with a key.
+    /// @tparam Lookup Type of the key searched for: Key, or any type which
+    ///                Hash accepts and Key compares equal to, so that keys
+    ///                need not be constructed to be found.
+    /// @param key Key to search for.
+    /// @return Pointer to the value, or nullptr if the key is not present. The
+    ///         pointer remains valid for as long as any version containing the
+    ///         entry exists.
+    template <typename Lookup = Key>
+    const Value* find(const Lookup& key) const noexcept
+    {
+        size_t hash = Hash{}(key);
+        const Node* node = root.get();
+        for (size_t shift = 0; node != nullptr; shift += bits_per_level)
+        {
+            if (shift >= hash_bits)
+            {
+                // Collision node: leaves are stored linearly.
+                for (auto& slot : node->slots)
+                {
+                    if (slot.leaf->key == key)
+                        return &slot.leaf->value;
+                }
+                return nullptr;
+            }
+
+            uint32_t bit = bit_for(hash, shift);
+            if (!(node->bitmap & bit))
+                return nullptr;
+
+            const Slot& slot = node->slots[index_for(node->bitmap, bit)];
+            if (slot.leaf)
+            {
+                if (slot.leaf->hash == hash && slot.leaf->key == key)
+                    return &slot.leaf->value;
+                return nullptr;
+            }
+            node = slot.node.get();
+        }
+        return nullptr;
+    }
+
+    /// @brief Creates a new version with a key set to a value.
+    /// Replaces the value if the key is already present.
+    /// @param key Key to insert.
+    /// @param value Value to associate with the key.
+    /// @return New version of the map.
+    PersistentMap insert(const Key& key, Value value) const
+    {
+        auto leaf = std::make_shared<const Leaf>(
+            Leaf{Hash{}(key), key, std::move(value)});
+        bool added = false;
+        PersistentMap result;
+        result.root = insert(root, 0, std::move(leaf), added);
+        result.count = count + (added ? 1 : 0);
+        return result;
+    }
+
+    /// @brief Creates a new version without a key.
+    /// @tparam Lookup Type of the key, as for find().
+    /// @param key Key to remove.
+    /// @return New version of the map, sharing all nodes with this one if the
+    ///         key is not present.
+    template <typename Lookup = Key>
+    PersistentMap erase(const Lookup& key) const
+    {
+        bool removed = false;
+        PersistentMap result;
+        result.root = erase(root, 0, Hash{}(key), key, removed);
+        result.count = count - (removed ? 1 : 0);
+        if (!removed)
+            result.root = root;
+        return result;
+    }
+
+    /// @brief Calls a function for every entry.
+    /// Iteration order is unspecified but stable for a given version.
+    /// @param function Callable taking (const Key&, const Value&).
+    template <typename Function>
+    void for_each(Function&& function) const
+    {
+        if (root)
+            for_each(*root, function);
+    }
+
+    /// @brief Calls a function for every key whose value differs between this
+    ///        version and another.
+    /// Subtrees which both versions share are skipped without being visited,
+    /// so comparing versions derived from each other costs O(d log n) for d
+    /// differences rather than O(n).
+    /// @param other Version to compare with.
+    /// @param function Callable taking (const Key&, const Value* value,
+    ///                 const Value* other_value), where a value is nullptr if
+    ///                 the key is not present in that version.
+    template <typename Function>
+    void diff(const PersistentMap& other, Function&& function) const
+    {
+        diff(root.get(), other.root.get(), 0, function);
+    }
+
+    /// @brief Gets the number of entries.
+    /// @return Number of entries.
+    inline size_t size() const noexcept
+    {
+        return count;
+    }
+
+    /// @brief Checks whether the map has no entries.
+    /// @return true if empty.
+    inline bool empty() const noexcept
+    {
+        return count == 0;
+    }
+
+    /// @brief Checks whether two versions share the same root.
+    /// Identical versions are always equal; this is an O(1) test used to skip
+    /// work when nothing changed between two snapshots.
+    /// @param other Version to compare with.
+    /// @return true if both versions share their root node.
+    inline bool is_identical(const PersistentMap& other) const noexcept
+    {
+        return root == other.root;
+    }
+
+private:
+    struct Leaf
+    {
+        size_t hash;
+        Key key;
+        Value value;
+    };
+
+    struct Node;
+
+    // Either a leaf or a child node, never both.
+    struct Slot
+    {
+        std::shared_ptr<const Leaf> leaf;
+        std::shared_ptr<const Node> node;
+    };
+
+    struct Node
+    {
+        uint32_t bitmap = 0;
+        // One slot per bit set in bitmap, ordered by bit position. Collision
+        // nodes ignore bitmap and store only leaves.
+        std::vector<Slot> slots;
+    };
+
+    typedef std::shared_ptr<const Node> NodePtr;
+    typedef std::shared_ptr<const Leaf> LeafPtr;
+
+    static constexpr size_t bits_per_level = 5;
+    static constexpr size_t hash_bits = sizeof(size_t) * CHAR_BIT;
+
+    static inline uint32_t bit_for(size_t hash, size_t shift) noexcept
+    {
+        return uint32_t{1} << ((hash >> shift) & 0x1f);
+    }
+
+    static inline size_t index_for(uint32_t bitmap, uint32_t bit) noexcept
+    {
+        return __builtin_popcount(bitmap & (bit - 1));
+    }
+
+    static NodePtr insert(const NodePtr& node, size_t shift, LeafPtr leaf,
+                          bool& added)
+    {
+        if (shift >= hash_bits)
+        {
+            auto copy = node ? std::make_shared<Node>(*node)
+                             : std::make_shared<Node>();
+            for (auto& slot : copy->slots)
+            {
+                if (slot.leaf->key == leaf->key)
+                {
+                    slot.leaf = std::move(leaf);
+                    return copy;
+                }
+            }
+            copy->slots.push_back({std::move(leaf), nullptr});
+            added = true;
+            return copy;
+        }
+
+        uint32_t bit = bit_for(leaf->hash, shift);
+        auto copy = node ? std::make_shared<Node>(*node)
+                         : std::make_shared<Node>();
+        size_t index = index_for(copy->bitmap, bit);
+
+        if (!(copy->bitmap & bit))
+        {
+            copy->bitmap |= bit;
+            copy->slots.insert(copy->slots.begin() + index,
+                               {std::move(leaf), nullptr});
+            added = true;
+            return copy;
+        }
+
+        Slot& slot = copy->slots[index];
+        if (slot.node)
+        {
+            slot.node = insert(slot.node, shift + bits_per_level,
+                               std::move(leaf), added);
+        }
+        else if (slot.leaf->hash == leaf->hash && slot.leaf->key == leaf->key)
+        {
+            slot.leaf = std::move(leaf);
+        }
+        else
+        {
+            // Pushes both leaves down into a new subtree.
+            bool unused = false;
+            NodePtr child = insert(nullptr, shift + bits_per_level,
+                                   std::move(slot.leaf), unused);
+            slot.node = insert(child, shift + bits_per_level,
+                               std::move(leaf), added);
+            slot.leaf = nullptr;
+        }
+        return copy;
+    }
+
+    template <typename Lookup>
+    static NodePtr erase(const NodePtr& node, size_t shift, size_t hash,
+                         const Lookup& key, bool& removed)
+    {
+        if (!node)
+            return nullptr;
+
+        if (shift >= hash_bits)
+        {
+            for (size_t i = 0; i < node->slots.size(); ++i)
+            {
+                if (node->slots[i].leaf->key == key)
+                {
+                    removed = true;
+                    if (node->slots.size() == 1)
+                        return nullptr;
+                    auto copy = std::make_shared<Node>(*node);
+                    copy->slots.erase(copy->slots.begin() + i);
+                    return copy;
+                }
+            }
+            return node;
+        }
+
+        uint32_t bit = bit_for(hash, shift);
+        if (!(node->bitmap & bit))
+            return node;
+
+        size_t index = index_for(node->bitmap, bit);
+        const Slot& slot = node->slots[index];
+        Slot replacement;
+        if (slot.leaf)
+        {
+            if (slot.leaf->hash != hash || !(slot.leaf->key == key))
+                return node;
+            removed = true;
+        }
+        else
+        {
+            NodePtr child = erase(slot.node, shift + bits_per_level, hash, key,
+                                  removed);
+            if (!removed)
+                return node;
+            if (child && child->slots.size() == 1 && child->slots[0].leaf)
+            {
+                // Collapses a child holding a single leaf into this level.
+                replacement.leaf = child->slots[0].leaf;
+            }
+            else
+            {
+                replacement.node = std::move(child);
+            }
+        }
+
+        auto copy = std::make_shared<Node>(*node);
+        if (replacement.leaf || replacement.node)
+        {
+            copy->slots[index] = std::move(replacement);
+        }
+        else
+        {
+            copy->bitmap &= ~bit;
+            copy->slots.erase(copy->slots.begin() + index);
+            if (copy->slots.empty())
+                return nullptr;
+        }
+        return copy;
+    }
+
+    template <typename Function>
+    static void for_each(const Node& node, Function& function)
+    {
+        for (auto& slot : node.slots)
+        {
+            if (slot.leaf)
+                function(slot.leaf->key, slot.leaf->value);
+            else
+                for_each(*slot.node, function);
+        }
+    }
+
+    template <typename Function>
+    static void diff(const Node* node, const Node* other, size_t shift,
+                     Function& function)
+    {
+        if (node == other)
+            return;
+        if (!node || !other || shift >= hash_bits)
+        {
+            diff_leaves(node, nullptr, other, nullptr, function);
+            return;
+        }
+
+        for (uint32_t bits = node->bitmap | other->bitmap; bits != 0;
+             bits &= bits - 1)
+        {
+            uint32_t bit = bits & (~bits + 1);
+            const Slot* slot = node->bitmap & bit
+                ? &node->slots[index_for(node->bitmap, bit)] : nullptr;
+            const Slot* other_slot = other->bitmap & bit
+                ? &other->slots[index_for(other->bitmap, bit)] : nullptr;
+            if (slot && other_slot && slot->node && other_slot->node)
+            {
+                diff(slot->node.get(), other_slot->node.get(),
+                     shift + bits_per_level, function);
+            }
+            else
+            {
+                diff_leaves(slot && slot->node ? slot->node.get() : nullptr,
+                            slot ? slot->leaf.get() : nullptr,
+                            other_slot && other_slot->node
+                                ? other_slot->node.get() : nullptr,
+                            other_slot ? other_slot->leaf.get() : nullptr,
+                            function);
+            }
+        }
+    }
+
+    /// @brief Compares the entries of two parts of the trie at the same hash
+    ///        prefix one by one.
+    /// Used where the structure of the versions differs, i.e. for collision
+    /// nodes and where a leaf meets a node, which hold few entries, or where
+    /// one version has nothing, whose entries all differ.
+    template <typename Function>
+    static void diff_leaves(const Node* node, const Leaf* leaf,
+                            const Node* other, const Leaf* other_leaf,
+                            Function& function)
+    {
+        std::vector<const Leaf*> leaves;
+        std::vector<const Leaf*> other_leaves;
+        collect(node, leaf, leaves);
+        collect(other, other_leaf, other_leaves);
+        for (const Leaf* entry : leaves)
+        {
+            auto match = std::find_if(other_leaves.begin(),
+                                      other_leaves.end(),
+                                      [&](const Leaf* other_entry)
+            {
+                return other_entry->key == entry->key;
+            });
+            if (match == other_leaves.end())
+                function(entry->key, &entry->value, nullptr);
+            else if (*match != entry && !((*match)->value == entry->value))
+                function(entry->key, &entry->value, &(*match)->value);
+        }
+        for (const Leaf* other_entry : other_leaves)
+        {
+            auto match = std::find_if(leaves.begin(), leaves.end(),
+                                      [&](const Leaf* entry)
+            {
+                return entry->key == other_entry->key;
+            });
+            if (match == leaves.end())
+                function(other_entry->key, nullptr, &other_entry->value);
+        }
+    }
+
+    static void collect(const Node* node, const Leaf* leaf,
+                        std::vector<const Leaf*>& leaves)
+    {
+        if (leaf)
+            leaves.push_back(leaf);
+        if (!node)
+            return;
+        for (auto& slot : node->slots)
+            collect(slot.node.get(), slot.leaf.get(), leaves);
+    }
+
+    NodePtr root;
+    size_t count = 0;
+};
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_PERSISTENT_MAP_HH_
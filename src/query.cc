@@ -0,0 +1,469 @@
+/// @file query.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Filters characters by their scores and details.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "character_table.hh"
+#include "intl.hh"
+#include "query.hh"
+#include "symbol.hh"
+#include "worker_pool.hh"
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace gelcube
+{
+
+namespace
+{
+
+// Blocks filtered by each task when a query is split across threads.
+const size_t chunk_blocks = 1024;
+
+// An index is used if it leaves fewer than one row in this many to test.
+const size_t selectivity = 16;
+
+static_assert(CharacterTable::block_rows == 64,
+              "a block of rows must fit a 64-bit mask");
+
+struct Comparison
+{
+    std::string_view text;
+    Query::Op op;
+};
+
+// Operators which are prefixes of others come last.
+const Comparison comparisons[] = {
+    {"==", Query::Op::equal},
+    {"!=", Query::Op::not_equal},
+    {"<=", Query::Op::less_equal},
+    {">=", Query::Op::greater_equal},
+    {"=", Query::Op::equal},
+    {"<", Query::Op::less},
+    {">", Query::Op::greater}};
+
+inline bool is_key_char(char ch) noexcept
+{
+    return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z')
+           || (ch >= '0' && ch <= '9') || ch == '_';
+}
+
+inline bool is_space(char ch) noexcept
+{
+    return ch == ' ' || ch == '\t';
+}
+
+/// @brief Compares two values.
+template <Query::Op op>
+inline bool test(int32_t a, int32_t b) noexcept
+{
+    switch (op)
+    {
+    case Query::Op::equal:
+        return a == b;
+    case Query::Op::not_equal:
+        return a != b;
+    case Query::Op::less:
+        return a < b;
+    case Query::Op::less_equal:
+        return a <= b;
+    case Query::Op::greater:
+        return a > b;
+    case Query::Op::greater_equal:
+        return a >= b;
+    }
+    return false;
+}
+
+inline bool test(Query::Op op, int32_t a, int32_t b) noexcept
+{
+    switch (op)
+    {
+    case Query::Op::equal:
+        return test<Query::Op::equal>(a, b);
+    case Query::Op::not_equal:
+        return test<Query::Op::not_equal>(a, b);
+    case Query::Op::less:
+        return test<Query::Op::less>(a, b);
+    case Query::Op::less_equal:
+        return test<Query::Op::less_equal>(a, b);
+    case Query::Op::greater:
+        return test<Query::Op::greater>(a, b);
+    case Query::Op::greater_equal:
+        return test<Query::Op::greater_equal>(a, b);
+    }
+    return false;
+}
+
+#ifdef __SSE2__
+/// @brief Compares four values, setting every bit of the matching lanes.
+template <Query::Op op>
+inline __m128i test(__m128i a, __m128i b) noexcept
+{
+    const __m128i ones = _mm_cmpeq_epi32(a, a);
+    switch (op)
+    {
+    case Query::Op::equal:
+        return _mm_cmpeq_epi32(a, b);
+    case Query::Op::not_equal:
+        return _mm_xor_si128(_mm_cmpeq_epi32(a, b), ones);
+    case Query::Op::less:
+        return _mm_cmplt_epi32(a, b);
+    case Query::Op::less_equal:
+        return _mm_xor_si128(_mm_cmpgt_epi32(a, b), ones);
+    case Query::Op::greater:
+        return _mm_cmpgt_epi32(a, b);
+    case Query::Op::greater_equal:
+        return _mm_xor_si128(_mm_cmplt_epi32(a, b), ones);
+    }
+    return _mm_setzero_si128();
+}
+#endif
+
+/// @brief Clears the bits of the rows of each block which do not match.
+/// Blocks with no matching rows left are skipped.
+template <Query::Op op>
+void compare(const int32_t* column, size_t blocks, int32_t value,
+             int32_t missing, uint64_t* mask) noexcept
+{
+#ifdef __SSE2__
+    const __m128i values = _mm_set1_epi32(value);
+    const __m128i missings = _mm_set1_epi32(missing);
+#endif
+    for (size_t block = 0; block < blocks; ++block, column += 64)
+    {
+        if (!mask[block])
+            continue;
+
+        uint64_t bits = 0;
+#ifdef __SSE2__
+        for (unsigned i = 0; i < 64; i += 4)
+        {
+            __m128i lanes = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(column + i));
+            __m128i result = _mm_andnot_si128(
+                _mm_cmpeq_epi32(lanes, missings), test<op>(lanes, values));
+            bits |= static_cast<uint64_t>(
+                        _mm_movemask_ps(_mm_castsi128_ps(result)))
+                    << i;
+        }
+#else
+        for (unsigned i = 0; i < 64; ++i)
+        {
+            bits |= static_cast<uint64_t>(column[i] != missing
+                                          && test<op>(column[i], value))
+                    << i;
+        }
+#endif
+        mask[block] &= bits;
+    }
+}
+
+void compare(Query::Op op, const int32_t* column, size_t blocks,
+             int32_t value, int32_t missing, uint64_t* mask) noexcept
+{
+    switch (op)
+    {
+    case Query::Op::equal:
+        compare<Query::Op::equal>(column, blocks, value, missing, mask);
+        break;
+    case Query::Op::not_equal:
+        compare<Query::Op::not_equal>(column, blocks, value, missing, mask);
+        break;
+    case Query::Op::less:
+        compare<Query::Op::less>(column, blocks, value, missing, mask);
+        break;
+    case Query::Op::less_equal:
+        compare<Query::Op::less_equal>(column, blocks, value, missing, mask);
+        break;
+    case Query::Op::greater:
+        compare<Query::Op::greater>(column, blocks, value, missing, mask);
+        break;
+    case Query::Op::greater_equal:
+        compare<Query::Op::greater_equal>(column, blocks, value, missing,
+                                          mask);
+        break;
+    }
+}
+
+}; // namespace
+
+Query::Query(std::string_view text)
+{
+    size_t i = 0;
+    auto skip_spaces = [&]
+    {
+        while (i < text.size() && is_space(text[i]))
+            ++i;
+    };
+    auto position = [&] { return std::to_string(i + 1); };
+
+    skip_spaces();
+    while (i < text.size())
+    {
+        // Field name.
+        size_t start = i;
+        while (i < text.size() && is_key_char(text[i]))
+            ++i;
+        if (i == start)
+            throw ParseException(_("expected a field name at position ")
+                                 + position());
+        Predicate predicate{Symbol(text.substr(start, i - start)), Op::equal,
+                            false, 0, {}};
+        skip_spaces();
+
+        // Comparison.
+        std::string_view rest = text.substr(i);
+        auto comparison = std::find_if(
+            std::begin(comparisons), std::end(comparisons),
+            [rest](const Comparison& comparison)
+            {
+                return rest.substr(0, comparison.text.size())
+                       == comparison.text;
+            });
+        if (comparison == std::end(comparisons))
+            throw ParseException(_("expected a comparison at position ")
+                                 + position());
+        predicate.op = comparison->op;
+        i += comparison->text.size();
+        skip_spaces();
+
+        // Value, quoted to include spaces.
+        std::string_view value;
+        bool is_quoted = i < text.size() && text[i] == '"';
+        if (is_quoted)
+        {
+            size_t end = text.find('"', i + 1);
+            if (end == text.npos)
+                throw ParseException(_("unterminated quote at position ")
+                                     + position());
+            value = text.substr(i + 1, end - i - 1);
+            i = end + 1;
+        }
+        else
+        {
+            start = i;
+            while (i < text.size() && !is_space(text[i]))
+                ++i;
+            value = text.substr(start, i - start);
+            if (value.empty())
+                throw ParseException(_("expected a value at position ")
+                                     + position());
+        }
+
+        auto result = std::from_chars(value.data(),
+                                      value.data() + value.size(),
+                                      predicate.score);
+        predicate.is_score = !is_quoted && result.ec == std::errc()
+                             && result.ptr == value.data() + value.size()
+                             && predicate.score
+                                != CharacterTable::missing_score;
+        if (!predicate.is_score)
+        {
+            if (predicate.op != Op::equal && predicate.op != Op::not_equal)
+            {
+                throw ParseException(_("only = and != compare text: ")
+                                     + std::string(value));
+            }
+            predicate.detail = CharacterTable::fold(value);
+        }
+        predicates.push_back(std::move(predicate));
+
+        // Conjunction.
+        skip_spaces();
+        if (i == text.size())
+            break;
+        start = i;
+        while (i < text.size() && !is_space(text[i]))
+            ++i;
+        if (CharacterTable::fold(text.substr(start, i - start)) != "and")
+        {
+            i = start;
+            throw ParseException(_("expected 'and' at position ")
+                                 + position());
+        }
+        skip_spaces();
+        if (i == text.size())
+            throw ParseException(_("expected a field name at position ")
+                                 + position());
+    }
+}
+
+std::vector<uint32_t> Query::run(const CharacterTable& table) const
+{
+    Plan plan = this->plan(table);
+    std::vector<uint32_t> rows;
+    if (run_indexed(table, plan, rows))
+        return rows;
+
+    const size_t block_rows = CharacterTable::block_rows;
+    size_t blocks = (table.size() + block_rows - 1) / block_rows;
+    std::vector<uint64_t> mask(blocks);
+    size_t chunks = (blocks + chunk_blocks - 1) / chunk_blocks;
+    WorkerPool::run_parallel(chunks, [&](size_t chunk)
+    {
+        size_t begin = chunk * chunk_blocks;
+        filter(plan, begin, std::min(begin + chunk_blocks, blocks),
+               mask.data());
+    });
+
+    // Padding never matches a comparison, but matches an empty query.
+    if (table.size() % block_rows != 0)
+        mask.back() &= (uint64_t{1} << (table.size() % block_rows)) - 1;
+
+    size_t count = 0;
+    for (uint64_t bits : mask)
+        count += __builtin_popcountll(bits);
+    rows.reserve(count);
+    for (size_t block = 0; block < blocks; ++block)
+    {
+        for (uint64_t bits = mask[block]; bits; bits &= bits - 1)
+        {
+            rows.push_back(static_cast<uint32_t>(
+                block * block_rows + __builtin_ctzll(bits)));
+        }
+    }
+    return rows;
+}
+
+Query::Plan Query::plan(const CharacterTable& table) const
+{
+    Plan plan;
+    for (auto& predicate : predicates)
+    {
+        if (predicate.is_score)
+        {
+            plan.columns.push_back(table.get_scores(predicate.key));
+            plan.values.push_back(predicate.score);
+            plan.missing.push_back(CharacterTable::missing_score);
+        }
+        else
+        {
+            // Dictionary numbers are compared as signed values of the same
+            // width; only equality is tested.
+            plan.columns.push_back(reinterpret_cast<const int32_t*>(
+                table.get_details(predicate.key)));
+            plan.values.push_back(static_cast<int32_t>(
+                table.find_value(predicate.detail)));
+            plan.missing.push_back(
+                static_cast<int32_t>(CharacterTable::missing_detail));
+        }
+    }
+    return plan;
+}
+
+void Query::filter(const Plan& plan, size_t begin, size_t end,
+                   uint64_t* mask) const noexcept
+{
+    std::fill(mask + begin, mask + end, ~uint64_t{0});
+    for (size_t i = 0; i < predicates.size(); ++i)
+    {
+        if (!plan.columns[i])
+        {
+            std::fill(mask + begin, mask + end, 0);
+            return;
+        }
+        compare(predicates[i].op,
+                plan.columns[i] + begin * CharacterTable::block_rows,
+                end - begin, plan.values[i], plan.missing[i], mask + begin);
+    }
+}
+
+bool Query::matches(const Plan& plan, size_t row) const noexcept
+{
+    for (size_t i = 0; i < predicates.size(); ++i)
+    {
+        if (!plan.columns[i])
+            return false;
+        int32_t value = plan.columns[i][row];
+        if (value == plan.missing[i]
+            || !test(predicates[i].op, value, plan.values[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Query::run_indexed(const CharacterTable& table, const Plan& plan,
+                        std::vector<uint32_t>& rows) const
+{
+    typedef CharacterTable::IndexEntry Entry;
+    for (auto& predicate : predicates)
+    {
+        const std::vector<Entry>* index = table.get_index(predicate.key);
+        if (!predicate.is_score || predicate.op == Op::not_equal || !index)
+            continue;
+
+        auto lower = std::lower_bound(
+            index->begin(), index->end(), predicate.score,
+            [](const Entry& entry, int32_t value)
+            { return entry.value < value; });
+        auto upper = std::upper_bound(
+            index->begin(), index->end(), predicate.score,
+            [](int32_t value, const Entry& entry)
+            { return value < entry.value; });
+        auto first = index->begin();
+        auto last = index->end();
+        switch (predicate.op)
+        {
+        case Op::equal:
+            first = lower;
+            last = upper;
+            break;
+        case Op::less:
+            last = lower;
+            break;
+        case Op::less_equal:
+            last = upper;
+            break;
+        case Op::greater:
+            first = upper;
+            break;
+        case Op::greater_equal:
+            first = lower;
+            break;
+        case Op::not_equal:
+            break;
+        }
+        if (static_cast<size_t>(last - first) * selectivity >= table.size())
+            continue;
+
+        for (auto entry = first; entry != last; ++entry)
+        {
+            if (matches(plan, entry->row))
+                rows.push_back(entry->row);
+        }
+        std::sort(rows.begin(), rows.end());
+        return true;
+    }
+    return false;
+}
+
+}; // namespace gelcube
@@ -0,0 +1,139 @@
+/// @file query.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Filters characters by their scores and details.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_QUERY_HH_
+#define GELCUBE_SRC_QUERY_HH_
+
+#include "character_table.hh"
+#include "symbol.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace gelcube
+{
+
+/// @brief Filters characters by their scores and details.
+/// A query is a list of comparisons joined by 'and', e.g.
+/// 'level>=5 and class=wizard and hp<20'. A comparison with an integer tests
+/// a score with any of =, !=, <, <=, > and >=; any other value tests a detail
+/// with = or !=, ignoring the case of ASCII letters, and may be quoted to
+/// include spaces. Characters without the field never match.
+///
+/// Queries run over a gelcube::CharacterTable a block of rows at a time,
+/// comparing four values per instruction where SSE2 is available, and split
+/// large tables across the worker threads. A comparison on an indexed score
+/// which few rows satisfy is answered from the index instead.
+typedef class Query
+{
+public:
+    /// @brief Exception signifying a malformed query.
+    class ParseException : public std::exception
+    {
+    public:
+        /// @brief Constructs a new ParseException object.
+        /// @param message Description of the error.
+        explicit ParseException(std::string message)
+            : message{std::move(message)}
+        {
+        }
+
+        const char* what() const noexcept override
+        {
+            return message.c_str();
+        }
+
+    private:
+        std::string message;
+    };
+
+    /// @brief Comparison operator.
+    enum class Op
+    {
+        equal,
+        not_equal,
+        less,
+        less_equal,
+        greater,
+        greater_equal
+    };
+
+    /// @brief Parses a query.
+    /// @param text Query; an empty query matches every character.
+    /// @throw gelcube::Query::ParseException if the query is malformed.
+    explicit Query(std::string_view text);
+
+    /// @brief Finds the rows of a table which match.
+    /// Splits large tables across the worker threads, if started (see
+    /// gelcube::WorkerPool::run_parallel()).
+    /// @param table Table to search.
+    /// @return Numbers of the matching rows, in ascending order.
+    std::vector<uint32_t> run(const CharacterTable& table) const;
+
+private:
+    /// @brief Comparison of a field with a value.
+    struct Predicate
+    {
+        Symbol key;
+        Op op;
+        bool is_score;
+        int32_t score;
+        // Detail value, folded to lower case.
+        std::string detail;
+    };
+
+    /// @brief Rows of a table matching each predicate.
+    /// Columns are looked up once per run.
+    struct Plan
+    {
+        // Column of each predicate, or nullptr if no row has the field.
+        std::vector<const int32_t*> columns;
+        // Value each column is compared with.
+        std::vector<int32_t> values;
+        std::vector<int32_t> missing;
+    };
+
+    /// @brief Looks up the columns and values of the predicates in a table.
+    Plan plan(const CharacterTable& table) const;
+
+    /// @brief Filters blocks of rows.
+    /// @param mask Bits of the rows of each block, set for matching rows.
+    void filter(const Plan& plan, size_t begin, size_t end,
+                uint64_t* mask) const noexcept;
+
+    /// @brief Tests a single row.
+    bool matches(const Plan& plan, size_t row) const noexcept;
+
+    /// @brief Answers the query from an index if few rows can match.
+    /// @return true if the index was used.
+    bool run_indexed(const CharacterTable& table, const Plan& plan,
+                     std::vector<uint32_t>& rows) const;
+
+    std::vector<Predicate> predicates;
+} Query;
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_QUERY_HH_
@@ -0,0 +1,423 @@
+/// @file roster.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Manages all loaded characters.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "character.hh"
+#include "character_file.hh"
+#include "content.hh"
+#include "derived_stats.hh"
+#include "intl.hh"
+#include "logger.hh"
+#include "memory_accounting.hh"
+#include "roster.hh"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace gelcube
+{
+
+std::vector<Roster::Entry> Roster::entries;
+std::unordered_map<std::string, size_t> Roster::paths;
+std::unordered_map<std::string, size_t> Roster::names;
+std::vector<std::string> Roster::directories;
+size_t Roster::open_index = 0;
+Logger::Source Roster::log;
+
+namespace
+{
+
+/// @brief Checks whether a file name ends with the character file suffix.
+bool is_character_file(const char* name)
+{
+    size_t length = std::strlen(name);
+    size_t suffix_length = std::strlen(Roster::file_suffix);
+    return length > suffix_length
+           && std::strcmp(name + length - suffix_length,
+                          Roster::file_suffix) == 0;
+}
+
+/// @brief Collects the keys of every score and detail.
+void append_keys(const Character& character, std::vector<std::string>& keys)
+{
+    character.get_scores().for_each([&](const std::string& key, int)
+    {
+        keys.push_back(key);
+    });
+    character.get_details().for_each([&](const std::string& key,
+                                         const std::string&)
+    {
+        keys.push_back(key);
+    });
+}
+
+/// @brief Collects the keys of the scores and details which differ between two
+///        versions of a character.
+void diff_keys(const Character& before, const Character& after,
+               std::vector<std::string>& keys)
+{
+    // Only the parts of the maps which differ are visited, so stepping
+    // through the history costs as much as the change, not the character.
+    before.get_scores().diff(after.get_scores(),
+                             [&](const std::string& key, const int*,
+                                 const int*)
+    {
+        keys.push_back(key);
+    });
+    // Equal details share content, so they compare by identifier.
+    before.get_details().diff(after.get_details(),
+                              [&](const Content& key, const Content*,
+                                  const Content*)
+    {
+        keys.push_back(key);
+    });
+}
+
+}; // namespace
+
+void Roster::add_directory(const std::string& directory)
+{
+    log = Logger::source;
+
+    DIR* dir = opendir(directory.c_str());
+    if (!dir)
+    {
+        throw std::system_error(errno, std::generic_category(),
+                                directory);
+    }
+    closedir(dir);
+
+    directories.push_back(directory);
+}
+
+std::vector<std::string> Roster::list_files(const std::string& directory)
+{
+    DIR* dir = opendir(directory.c_str());
+    if (!dir)
+    {
+        throw std::system_error(errno, std::generic_category(),
+                                directory);
+    }
+
+    std::vector<std::string> files;
+    while (dirent* entry = readdir(dir))
+    {
+        if (is_character_file(entry->d_name))
+            files.push_back(directory + "/" + entry->d_name);
+    }
+    closedir(dir);
+
+    // Loads in a stable order regardless of directory layout.
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+Character Roster::read(const std::string& path)
+{
+    MemoryAccounting::Scope scope(MemoryAccounting::Tag::content);
+    Character character;
+    CharacterFile::apply(CharacterFile::read(path), character);
+    DerivedStats::update_all(character);
+    return character;
+}
+
+Roster::Change Roster::add(const std::string& path, Character character)
+{
+    MemoryAccounting::Scope scope(MemoryAccounting::Tag::roster);
+    Change change;
+    change.path = path;
+    auto existing = paths.find(path);
+    if (existing == paths.end())
+    {
+        append_keys(character, change.keys);
+        change.is_open = insert(path, std::move(character)) == open_index;
+        return change;
+    }
+
+    size_t index = existing->second;
+    change.is_open = index == open_index;
+
+    // Every field of both versions may have changed.
+    const Character& current = entries[index].history.current();
+    if (current.get_scores().is_identical(character.get_scores())
+        && current.get_details().is_identical(character.get_details()))
+    {
+        return change;
+    }
+    append_keys(current, change.keys);
+    append_keys(character, change.keys);
+
+    commit(index, std::move(character), change.keys);
+    return change;
+}
+
+Roster::Change Roster::erase(const std::string& path, const std::string& key)
+{
+    MemoryAccounting::Scope scope(MemoryAccounting::Tag::roster);
+    Change change;
+    auto existing = paths.find(path);
+    if (existing == paths.end())
+        return change;
+
+    change.path = path;
+    Character character = entries[existing->second].history.current();
+    if (character.get_score(key))
+        character.erase_score(key);
+    else if (character.get_detail(key))
+        character.erase_detail(key);
+    else
+        return change;
+
+    change.is_open = existing->second == open_index;
+    change.keys.push_back(key);
+    DerivedStats::update(character, change.keys);
+    commit(existing->second, std::move(character), change.keys);
+    return change;
+}
+
+Roster::Change Roster::reload(const std::string& path)
+{
+    MemoryAccounting::Scope scope(MemoryAccounting::Tag::roster);
+    size_t slash = path.rfind('/');
+    if (!is_character_file(path.c_str() + (slash == std::string::npos
+                                               ? 0 : slash + 1)))
+    {
+        return {};
+    }
+
+    struct stat status;
+    if (stat(path.c_str(), &status) != 0)
+    {
+        auto existing = paths.find(path);
+        if (existing == paths.end())
+            return {};
+        return remove(existing->second);
+    }
+
+    return load(path);
+}
+
+Roster::Change Roster::undo()
+{
+    return step(&History<Character>::undo);
+}
+
+Roster::Change Roster::redo()
+{
+    return step(&History<Character>::redo);
+}
+
+Roster::Change Roster::update(const std::string& path, Character character,
+                              std::vector<std::string> keys)
+{
+    MemoryAccounting::Scope scope(MemoryAccounting::Tag::roster);
+    Change change;
+    change.path = path;
+    change.keys = std::move(keys);
+    auto existing = paths.find(path);
+    if (existing == paths.end())
+    {
+        change.is_open = insert(path, std::move(character)) == open_index;
+    }
+    else
+    {
+        change.is_open = existing->second == open_index;
+        commit(existing->second, std::move(character), change.keys);
+    }
+    return change;
+}
+
+Roster::Change Roster::unload(const std::string& path)
+{
+    MemoryAccounting::Scope scope(MemoryAccounting::Tag::roster);
+    auto existing = paths.find(path);
+    if (existing == paths.end())
+        return {};
+    return remove(existing->second);
+}
+
+bool Roster::open(const std::string& path) noexcept
+{
+    auto index = paths.find(path);
+    if (index == paths.end())
+        return false;
+    open_index = index->second;
+    return true;
+}
+
+const Character* Roster::get(const std::string& path) noexcept
+{
+    auto index = paths.find(path);
+    return index == paths.end() ? nullptr
+                                : &entries[index->second].history.current();
+}
+
+const Roster::Entry* Roster::find(const std::string& name) noexcept
+{
+    auto index = names.find(name);
+    return index == names.end() ? nullptr : &entries[index->second];
+}
+
+Roster::Change Roster::load(const std::string& path)
+{
+    std::vector<CharacterFile::Field> fields;
+    try
+    {
+        fields = CharacterFile::read(path);
+    }
+    catch (CharacterFile::ReadException& e)
+    {
+        // Keeps the previous version, e.g. while an editor is mid-save.
+        BOOST_LOG_SEV(log, LogLevel::error) << e.what();
+        return {};
+    }
+
+    auto existing = paths.find(path);
+    Character character = existing == paths.end()
+        ? Character{}
+        : entries[existing->second].history.current();
+    Change change;
+    change.path = path;
+    change.keys = CharacterFile::apply(fields, character);
+    if (change.keys.empty())
+        return change;
+
+    DerivedStats::update(character, change.keys);
+    if (existing == paths.end())
+    {
+        change.is_open = insert(path, std::move(character)) == open_index;
+    }
+    else
+    {
+        change.is_open = existing->second == open_index;
+        commit(existing->second, std::move(character), change.keys);
+    }
+    return change;
+}
+
+Roster::Change Roster::step(bool (History<Character>::*move)())
+{
+    MemoryAccounting::Scope scope(MemoryAccounting::Tag::roster);
+    if (entries.empty())
+        return {};
+
+    Entry& entry = entries[open_index];
+    Character before = entry.history.current();
+    if (!(entry.history.*move)())
+        return {};
+
+    const Character& after = entry.history.current();
+    index_name(before.get_detail("name"), after.get_detail("name"),
+               open_index);
+
+    Change change;
+    change.is_open = true;
+    change.path = entry.path;
+    diff_keys(before, after, change.keys);
+    entry.inventory.sync(after, change.keys);
+    return change;
+}
+
+size_t Roster::insert(const std::string& path, Character character)
+{
+    size_t index = entries.size();
+    entries.push_back({path, History<Character>{std::move(character)},
+                       Inventory{}});
+    entries[index].inventory.rebuild(entries[index].history.current());
+    paths[path] = index;
+    index_name(nullptr, entries[index].history.current().get_detail("name"),
+               index);
+    return index;
+}
+
+void Roster::commit(size_t index, Character character,
+                    const std::vector<std::string>& keys)
+{
+    Entry& entry = entries[index];
+    const std::string* old_name = entry.history.current().get_detail("name");
+    std::string name = old_name ? *old_name : std::string{};
+    entry.history.commit(std::move(character));
+    index_name(old_name ? &name : nullptr,
+               entry.history.current().get_detail("name"), index);
+    entry.inventory.sync(entry.history.current(), keys);
+}
+
+Roster::Change Roster::remove(size_t index)
+{
+    Change change;
+    change.is_open = index == open_index;
+    change.path = entries[index].path;
+    append_keys(entries[index].history.current(), change.keys);
+
+    index_name(entries[index].history.current().get_detail("name"), nullptr,
+               index);
+    paths.erase(entries[index].path);
+
+    // Moves the last entry into the removed entry's place.
+    size_t last = entries.size() - 1;
+    if (index != last)
+    {
+        entries[index] = std::move(entries[last]);
+        paths[entries[index].path] = index;
+        const std::string* name = entries[index].history.current()
+                                      .get_detail("name");
+        if (name)
+            names[*name] = index;
+        if (open_index == last)
+            open_index = index;
+    }
+    entries.pop_back();
+
+    if (change.is_open)
+    {
+        // The next open character replaces every field of the removed one.
+        open_index = 0;
+        if (!entries.empty())
+            append_keys(entries[open_index].history.current(), change.keys);
+    }
+    return change;
+}
+
+void Roster::index_name(const std::string* old_name,
+                        const std::string* new_name, size_t index)
+{
+    if (old_name && new_name && *old_name == *new_name)
+        return;
+
+    if (old_name)
+    {
+        auto existing = names.find(*old_name);
+        if (existing != names.end() && existing->second == index)
+            names.erase(existing);
+    }
+    if (new_name)
+        names[*new_name] = index;
+}
+
+}; // namespace gelcube
@@ -0,0 +1,235 @@
+/// @file roster.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Manages all loaded characters.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_ROSTER_HH_
+#define GELCUBE_SRC_ROSTER_HH_
+
+#include "character.hh"
+#include "history.hh"
+#include "inventory.hh"
+#include "logger.hh"
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gelcube
+{
+
+/// @brief Manages all loaded characters.
+/// Loads character files from directories and keeps an undo history and a
+/// name index for each of them. One character is open for display in the
+/// TUI.
+typedef class Roster
+{
+public:
+    /// @brief Loaded character file.
+    struct Entry
+    {
+        std::string path;
+        History<Character> history;
+        // Items of the current version, kept in step with each commit.
+        Inventory inventory;
+    };
+
+    /// @brief Result of reloading a character file.
+    struct Change
+    {
+        // true if the reloaded file belongs to the open character.
+        bool is_open = false;
+        // Path of the changed character, empty if nothing changed.
+        std::string path;
+        // Keys of the scores and details which changed.
+        std::vector<std::string> keys;
+    };
+
+    /// @brief Suffix of the files loaded as characters.
+    static constexpr const char* file_suffix = ".character";
+
+    /// @brief Adds a directory of character files to the roster.
+    /// The directory is remembered so that it can be loaded and watched for
+    /// changes; its files are not read.
+    /// @param directory Path of the directory.
+    /// @throw std::system_error if the directory cannot be opened.
+    static void add_directory(const std::string& directory);
+
+    /// @brief Lists the character files in a directory.
+    /// Safe to call from any thread.
+    /// @param directory Path of the directory.
+    /// @return Paths of the character files, sorted.
+    /// @throw std::system_error if the directory cannot be opened.
+    static std::vector<std::string> list_files(const std::string& directory);
+
+    /// @brief Reads a character file without adding it to the roster.
+    /// Computes all derived stats. Safe to call from any thread, e.g. to load
+    /// characters in the background.
+    /// @param path Path of the file.
+    /// @return Character described by the file.
+    /// @throw gelcube::CharacterFile::ReadException if the file cannot be
+    ///        read.
+    static Character read(const std::string& path);
+
+    /// @brief Adds a character which was read in the background.
+    /// Commits a new version if a character was already loaded from the same
+    /// path.
+    /// @param path Path of the file the character was read from.
+    /// @param character Character to add.
+    /// @return Description of what changed.
+    static Change add(const std::string& path, Character character);
+
+    /// @brief Removes a score or detail from a character.
+    /// Commits a new version to the character's history.
+    /// @param path Path of the character's file.
+    /// @param key Name of the score or detail.
+    /// @return Description of what changed.
+    static Change erase(const std::string& path, const std::string& key);
+
+    /// @brief Reloads a changed character file.
+    /// Re-parses only the given file, applies the fields which differ from
+    /// the loaded character, and recomputes only the derived stats depending
+    /// on them. The file is added to the roster if it is new, and removed if it
+    /// no longer exists. The new version is committed to the character's
+    /// history so that external edits can be undone.
+    /// @param path Path of the file.
+    /// @return Description of what changed.
+    static Change reload(const std::string& path);
+
+    /// @brief Undoes the last change to the open character.
+    /// @return Description of what changed, with no keys if there is nothing
+    ///         to undo.
+    static Change undo();
+
+    /// @brief Redoes the last undone change to the open character.
+    /// @return Description of what changed, with no keys if there is nothing
+    ///         to redo.
+    static Change redo();
+
+    /// @brief Adds or replaces a character whose changed fields are known.
+    /// Used for characters received from other programs, whose derived stats
+    /// are already computed.
+    /// @param path Path identifying the character.
+    /// @param character New version of the character.
+    /// @param keys Keys of the scores and details which changed.
+    /// @return Description of what changed.
+    static Change update(const std::string& path, Character character,
+                         std::vector<std::string> keys);
+
+    /// @brief Removes a character from the roster.
+    /// @param path Path identifying the character.
+    /// @return Description of what changed.
+    static Change unload(const std::string& path);
+
+    /// @brief Opens a character for display in the TUI.
+    /// @param index Index of the character in get_entries(); ignored if out of
+    ///              range.
+    static inline void open(size_t index) noexcept
+    {
+        if (index < entries.size())
+            open_index = index;
+    }
+
+    /// @brief Opens a character by the path it was loaded from.
+    /// @param path Path of the character's file.
+    /// @return false if no character was loaded from the path.
+    static bool open(const std::string& path) noexcept;
+
+    /// @brief Gets the index of the open character.
+    /// @return Index in get_entries(), or 0 if the roster is empty.
+    static inline size_t get_open_index() noexcept
+    {
+        return open_index;
+    }
+
+    /// @brief Gets the open character.
+    /// @return Current version of the open character, or nullptr if the roster
+    ///         is empty.
+    static inline const Character* get_open() noexcept
+    {
+        return entries.empty() ? nullptr
+                               : &entries[open_index].history.current();
+    }
+
+    /// @brief Gets the inventory of the open character.
+    /// @return Inventory, or nullptr if the roster is empty.
+    static inline const Inventory* get_open_inventory() noexcept
+    {
+        return entries.empty() ? nullptr : &entries[open_index].inventory;
+    }
+
+    /// @brief Gets a character by the path it was loaded from.
+    /// @param path Path of the character's file.
+    /// @return Current version of the character, or nullptr if no character
+    ///         was loaded from the path.
+    static const Character* get(const std::string& path) noexcept;
+
+    /// @brief Finds a character by name.
+    /// @param name Value of the character's 'name' detail.
+    /// @return Entry, or nullptr if no character has the name.
+    static const Entry* find(const std::string& name) noexcept;
+
+    /// @brief Gets all loaded characters.
+    /// @return Entries in load order, except that removal moves the last
+    ///         entry into the removed entry's place.
+    static inline const std::vector<Entry>& get_entries() noexcept
+    {
+        return entries;
+    }
+
+    /// @brief Gets the directories which characters were loaded from.
+    /// @return Paths of the directories.
+    static inline const std::vector<std::string>& get_directories() noexcept
+    {
+        return directories;
+    }
+
+private:
+    /// @brief Adds a character to the roster or replaces it.
+    static Change load(const std::string& path);
+
+    /// @brief Moves the open character through its history.
+    static Change step(bool (History<Character>::*move)());
+
+    /// @brief Adds a new entry whose history starts at a character.
+    static size_t insert(const std::string& path, Character character);
+
+    /// @brief Commits a new version of a character.
+    /// Updates only the items whose keys changed.
+    static void commit(size_t index, Character character,
+                       const std::vector<std::string>& keys);
+
+    /// @brief Removes a character from the roster.
+    static Change remove(size_t index);
+
+    /// @brief Updates the name index after a character's name changed.
+    static void index_name(const std::string* old_name,
+                           const std::string* new_name, size_t index);
+
+    static std::vector<Entry> entries;
+    static std::unordered_map<std::string, size_t> paths;
+    static std::unordered_map<std::string, size_t> names;
+    static std::vector<std::string> directories;
+    static size_t open_index;
+    static Logger::Source log;
+} Roster;
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_ROSTER_HH_
@@ -0,0 +1,287 @@
+/// @file session_client.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Shares character changes with the other programs in a session.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "character.hh"
+#include "delta.hh"
+#include "intl.hh"
+#include "logger.hh"
+#include "roster.hh"
+#include "session_client.hh"
+#include "trace.hh"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace gelcube
+{
+
+int SessionClient::fd = -1;
+Delta::Batch SessionClient::batch;
+std::string SessionClient::input;
+std::string SessionClient::output;
+size_t SessionClient::output_offset = 0;
+Logger::Source SessionClient::log;
+
+void SessionClient::connect(const std::string& socket_path)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path))
+    {
+        throw std::system_error(ENAMETOOLONG, std::generic_category(),
+                                socket_path);
+    }
+    std::memcpy(address.sun_path, socket_path.c_str(),
+                socket_path.size() + 1);
+
+    int socket_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (socket_fd < 0)
+        throw std::system_error(errno, std::generic_category(), "socket");
+
+    // Connects while blocking so that a missing hub is reported at once.
+    if (::connect(socket_fd, reinterpret_cast<sockaddr*>(&address),
+                  sizeof(address)) < 0)
+    {
+        int error = errno;
+        close(socket_fd);
+        throw std::system_error(error, std::generic_category(), socket_path);
+    }
+    fd = socket_fd;
+}
+
+std::vector<Roster::Change> SessionClient::disconnect()
+{
+    std::vector<Roster::Change> changes;
+    if (fd < 0)
+        return changes;
+
+    close(fd);
+    fd = -1;
+    batch.clear();
+    input.clear();
+    output.clear();
+    output_offset = 0;
+
+    std::vector<std::string> paths;
+    for (auto& entry : Roster::get_entries())
+    {
+        if (is_remote(entry.path))
+            paths.push_back(entry.path);
+    }
+    for (auto& path : paths)
+        changes.push_back(Roster::unload(path));
+    return changes;
+}
+
+bool SessionClient::is_remote(const std::string& path) noexcept
+{
+    return path.compare(0, std::char_traits<char>::length(path_prefix),
+                        path_prefix) == 0;
+}
+
+void SessionClient::publish(const Roster::Change& change)
+{
+    if (fd < 0 || change.path.empty() || is_remote(change.path))
+        return;
+
+    const Character* character = Roster::get(change.path);
+    if (!character)
+    {
+        batch.add({Delta::Op::remove, change.path, {}, 0, {}});
+        return;
+    }
+
+    for (auto& key : change.keys)
+    {
+        Delta::Op op{Delta::Op::erase, change.path, key, 0, {}};
+        if (const int* score = character->get_score(key))
+        {
+            op.kind = Delta::Op::set_score;
+            op.score = *score;
+        }
+        else if (const std::string* detail = character->get_detail(key))
+        {
+            op.kind = Delta::Op::set_detail;
+            op.detail = *detail;
+        }
+        batch.add(std::move(op));
+    }
+}
+
+void SessionClient::flush()
+{
+    if (fd < 0)
+        return;
+    Trace::Span span("SessionClient::flush");
+
+    // Encodes only once earlier output has been sent, so that changes made in
+    // the meantime are coalesced.
+    if (output_offset == output.size() && !batch.empty())
+    {
+        output.clear();
+        output_offset = 0;
+        batch.encode(0, output);
+        batch.clear();
+    }
+
+    while (output_offset < output.size())
+    {
+        ssize_t written = send(fd, output.data() + output_offset,
+                               output.size() - output_offset,
+                               MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                BOOST_LOG_SEV(log, LogLevel::error)
+                    << _("Cannot send changes to the session hub: ")
+                    << std::strerror(errno);
+                output.clear();
+                output_offset = 0;
+            }
+            return;
+        }
+        output_offset += written;
+    }
+}
+
+std::vector<Roster::Change> SessionClient::receive()
+{
+    std::vector<Roster::Change> changes;
+    if (fd < 0)
+        return changes;
+
+    bool is_open = true;
+    char buffer[65536];
+    for (;;)
+    {
+        ssize_t length = recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (length > 0)
+        {
+            input.append(buffer, length);
+            continue;
+        }
+        if (length < 0 && errno == EINTR)
+            continue;
+        if (length == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+            is_open = false;
+        break;
+    }
+
+    // Applies consecutive changes to the same character as one version.
+    std::string path;
+    Character character;
+    std::vector<std::string> keys;
+    auto commit = [&]
+    {
+        if (!keys.empty())
+        {
+            changes.push_back(Roster::update(path, std::move(character),
+                                             std::move(keys)));
+        }
+        keys.clear();
+    };
+
+    size_t offset = 0;
+    try
+    {
+        size_t payload_size;
+        std::vector<Delta::Op> ops;
+        while (Delta::next_frame(input.data() + offset, input.size() - offset,
+                                 payload_size))
+        {
+            ops.clear();
+            uint32_t origin = Delta::decode(
+                input.data() + offset + Delta::header_size, payload_size,
+                ops);
+            offset += Delta::header_size + payload_size;
+
+            std::string prefix = path_prefix + std::to_string(origin) + ':';
+            for (auto& op : ops)
+            {
+                std::string op_path = prefix + op.character;
+                if (op_path != path)
+                {
+                    commit();
+                    path = std::move(op_path);
+                    const Character* existing = Roster::get(path);
+                    character = existing ? *existing : Character{};
+                }
+
+                switch (op.kind)
+                {
+                case Delta::Op::remove:
+                    keys.clear();
+                    character = Character{};
+                    if (Roster::get(path))
+                        changes.push_back(Roster::unload(path));
+                    break;
+                case Delta::Op::set_score:
+                    character.erase_detail(op.key);
+                    character.set_score(op.key, op.score);
+                    keys.push_back(std::move(op.key));
+                    break;
+                case Delta::Op::set_detail:
+                    character.erase_score(op.key);
+                    character.set_detail(op.key, std::move(op.detail));
+                    keys.push_back(std::move(op.key));
+                    break;
+                case Delta::Op::erase:
+                    character.erase_score(op.key);
+                    character.erase_detail(op.key);
+                    keys.push_back(std::move(op.key));
+                    break;
+                }
+            }
+        }
+        commit();
+    }
+    catch (Delta::DecodeException& e)
+    {
+        BOOST_LOG_SEV(log, LogLevel::error)
+            << _("Cannot read changes from the session hub: ") << e.what();
+        commit();
+        is_open = false;
+    }
+    input.erase(0, offset);
+
+    if (!is_open)
+    {
+        BOOST_LOG_SEV(log, LogLevel::warning)
+            << _("Disconnected from the session hub");
+        for (auto& change : disconnect())
+            changes.push_back(std::move(change));
+    }
+    return changes;
+}
+
+}; // namespace gelcube
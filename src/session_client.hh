@@ -0,0 +1,100 @@
+/// @file session_client.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Shares character changes with the other programs in a session.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_SESSION_CLIENT_HH_
+#define GELCUBE_SRC_SESSION_CLIENT_HH_
+
+#include "delta.hh"
+#include "logger.hh"
+#include "roster.hh"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace gelcube
+{
+
+/// @brief Shares character changes with the other programs in a session.
+/// Connects to a gelcube::SessionHub, sends the changed fields of local
+/// characters and adds the characters of other programs to the roster.
+/// Changes made while earlier ones are still being sent are coalesced, so a
+/// burst of edits to one field sends only its latest value.
+typedef class SessionClient
+{
+public:
+    /// @brief Prefix of the roster paths of characters from other programs.
+    /// Remote characters are loaded as 'hub:ORIGIN:PATH'.
+    static constexpr const char* path_prefix = "hub:";
+
+    /// @brief Connects to a session hub.
+    /// @param socket Path of the hub's socket.
+    /// @throw std::system_error if the connection fails.
+    static void connect(const std::string& socket);
+
+    /// @brief Disconnects from the session hub.
+    /// @return Changes from unloading the characters of other programs.
+    static std::vector<Roster::Change> disconnect();
+
+    /// @brief Gets the file descriptor to poll for received changes.
+    /// @return File descriptor, or -1 if not connected.
+    static inline int get_fd() noexcept
+    {
+        return fd;
+    }
+
+    /// @brief Checks whether changes are still waiting to be sent.
+    /// @return true if flush() must be called again later.
+    static inline bool has_pending() noexcept
+    {
+        return output_offset < output.size() || !batch.empty();
+    }
+
+    /// @brief Checks whether a character was received from another program.
+    /// @param path Roster path of the character.
+    /// @return true if the character is remote.
+    static bool is_remote(const std::string& path) noexcept;
+
+    /// @brief Queues a change to a local character to be sent.
+    /// Does nothing if not connected or if the character is remote.
+    /// @param change Change returned by the roster.
+    static void publish(const Roster::Change& change);
+
+    /// @brief Sends as many queued changes as possible without blocking.
+    /// Disconnects if the hub has gone away.
+    static void flush();
+
+    /// @brief Applies the changes received from the hub to the roster.
+    /// Disconnects if the hub has gone away.
+    /// @return Description of what changed.
+    static std::vector<Roster::Change> receive();
+
+private:
+    static int fd;
+    static Delta::Batch batch;
+    static std::string input;
+    static std::string output;
+    static size_t output_offset;
+    static Logger::Source log;
+} SessionClient;
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_SESSION_CLIENT_HH_
@@ -0,0 +1,434 @@
+/// @file session_hub.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Relays character changes between the programs in a session.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "delta.hh"
+#include "intl.hh"
+#include "logger.hh"
+#include "session_hub.hh"
+
+#include <cerrno>
+#include <climits>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace gelcube
+{
+
+volatile sig_atomic_t SessionHub::done = false;
+
+namespace
+{
+
+// Identifier of the listening socket in epoll events; clients start at 1.
+const uint32_t listener_id = 0;
+
+const int max_events = 256;
+
+/// @brief Fills in the address of a Unix domain socket.
+/// @throw std::system_error if the path is too long.
+sockaddr_un socket_address(const std::string& path)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path))
+    {
+        throw std::system_error(ENAMETOOLONG, std::generic_category(),
+                                path);
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return address;
+}
+
+inline bool would_block(int error) noexcept
+{
+    return error == EAGAIN || error == EWOULDBLOCK;
+}
+
+}; // namespace
+
+SessionHub::SessionHub(std::string path)
+    : path{std::move(path)}, listen_fd{-1}, epoll_fd{-1},
+      log{Logger::source}
+{
+    sockaddr_un address = socket_address(this->path);
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                       0);
+    if (listen_fd < 0)
+        throw std::system_error(errno, std::generic_category(), "socket");
+
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&address),
+             sizeof(address)) < 0
+        || listen(listen_fd, SOMAXCONN) < 0)
+    {
+        int error = errno;
+        close(listen_fd);
+        throw std::system_error(error, std::generic_category(), this->path);
+    }
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u32 = listener_id;
+    if (epoll_fd < 0
+        || epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &event) < 0)
+    {
+        int error = errno;
+        if (epoll_fd >= 0)
+            close(epoll_fd);
+        close(listen_fd);
+        unlink(this->path.c_str());
+        throw std::system_error(error, std::generic_category(), "epoll");
+    }
+}
+
+SessionHub::~SessionHub()
+{
+    for (auto& client : clients)
+        close(client.second.fd);
+    close(epoll_fd);
+    close(listen_fd);
+    unlink(path.c_str());
+}
+
+void SessionHub::run()
+{
+    BOOST_LOG_SEV(log, LogLevel::info)
+        << _("Session hub listening on ") << path;
+
+    epoll_event events[max_events];
+    while (!done)
+    {
+        int count = epoll_wait(epoll_fd, events, max_events, -1);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            throw std::system_error(errno, std::generic_category(),
+                                    "epoll_wait");
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+            uint32_t id = events[i].data.u32;
+            if (id == listener_id)
+            {
+                accept_clients();
+                continue;
+            }
+
+            // The client may have been disconnected earlier in this batch.
+            auto client = clients.find(id);
+            if (client == clients.end())
+                continue;
+
+            bool is_open = true;
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+                is_open = read_client(id, client->second);
+            if (is_open && (events[i].events & EPOLLOUT))
+            {
+                is_open = flush(client->second);
+                watch_output(id, client->second);
+            }
+            if (!is_open)
+                disconnect(id);
+        }
+
+        // Disconnections found while broadcasting queue further changes.
+        while (!received.empty())
+            broadcast();
+    }
+}
+
+void SessionHub::accept_clients()
+{
+    for (;;)
+    {
+        int fd = accept4(listen_fd, nullptr, nullptr,
+                         SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            if (!would_block(errno) && errno != EINTR)
+            {
+                BOOST_LOG_SEV(log, LogLevel::warning)
+                    << _("Cannot accept client: ") << std::strerror(errno);
+            }
+            return;
+        }
+
+        uint32_t id = next_id++;
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u32 = id;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0)
+        {
+            close(fd);
+            continue;
+        }
+
+        Client& client = clients[id];
+        client.fd = fd;
+        BOOST_LOG_SEV(log, LogLevel::debug) << _("Client ") << id
+                                           << _(" joined the session");
+
+        // Brings the new client up to date with everyone else.
+        for (auto& changes : state)
+            changes.second.encode(changes.first, client.output);
+        if (!flush(client))
+            disconnect(id);
+        else
+            watch_output(id, client);
+    }
+}
+
+bool SessionHub::read_client(uint32_t id, Client& client)
+{
+    char buffer[65536];
+    for (;;)
+    {
+        ssize_t length = recv(client.fd, buffer, sizeof(buffer), 0);
+        if (length > 0)
+        {
+            client.input.append(buffer, length);
+            if (!decode_frames(id, client))
+                return false;
+
+            // Only a partial frame is left, which next_frame() bounds.
+            if (client.input.size()
+                > Delta::header_size + Delta::max_payload_size)
+            {
+                BOOST_LOG_SEV(log, LogLevel::warning)
+                    << _("Client ") << id << _(": ")
+                    << _("delta frame is too large");
+                return false;
+            }
+            continue;
+        }
+        if (length < 0 && errno == EINTR)
+            continue;
+        return length < 0 && would_block(errno);
+    }
+}
+
+bool SessionHub::decode_frames(uint32_t id, Client& client)
+{
+    // Decodes every complete frame, keeping any partial frame for later.
+    size_t offset = 0;
+    try
+    {
+        size_t payload_size;
+        std::vector<Delta::Op> ops;
+        while (Delta::next_frame(client.input.data() + offset,
+                                 client.input.size() - offset, payload_size))
+        {
+            ops.clear();
+            Delta::decode(client.input.data() + offset + Delta::header_size,
+                          payload_size, ops);
+            offset += Delta::header_size + payload_size;
+
+            Delta::Batch& batch = received[id];
+            for (auto& op : ops)
+                batch.add(std::move(op));
+        }
+    }
+    catch (Delta::DecodeException& e)
+    {
+        BOOST_LOG_SEV(log, LogLevel::warning)
+            << _("Client ") << id << _(": ") << e.what();
+        return false;
+    }
+    client.input.erase(0, offset);
+    return true;
+}
+
+void SessionHub::broadcast()
+{
+    std::unordered_map<uint32_t, Delta::Batch> batches;
+    batches.swap(received);
+
+    // Encodes each sender's changes once for every recipient.
+    std::vector<std::pair<uint32_t, std::string>> frames;
+    for (auto& batch : batches)
+    {
+        frames.emplace_back(batch.first, std::string{});
+        batch.second.encode(batch.first, frames.back().second);
+        if (clients.count(batch.first))
+            state[batch.first].merge(batch.second);
+    }
+
+    std::vector<uint32_t> failed;
+    std::vector<iovec> iov;
+    for (auto& entry : clients)
+    {
+        uint32_t id = entry.first;
+        Client& client = entry.second;
+        if (client.output_offset < client.output.size())
+        {
+            // Coalesces changes until the client catches up.
+            for (auto& batch : batches)
+            {
+                if (batch.first != id)
+                    client.backlog[batch.first].merge(batch.second);
+            }
+            continue;
+        }
+
+        iov.clear();
+        size_t total = 0;
+        for (auto& frame : frames)
+        {
+            if (frame.first == id)
+                continue;
+            iov.push_back({const_cast<char*>(frame.second.data()),
+                           frame.second.size()});
+            total += frame.second.size();
+        }
+        if (iov.empty())
+            continue;
+
+        ssize_t written = 0;
+        if (iov.size() <= IOV_MAX)
+        {
+            msghdr message{};
+            message.msg_iov = iov.data();
+            message.msg_iovlen = iov.size();
+            written = sendmsg(client.fd, &message,
+                              MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (written < 0)
+            {
+                if (!would_block(errno) && errno != EINTR)
+                {
+                    failed.push_back(id);
+                    continue;
+                }
+                written = 0;
+            }
+        }
+        if (static_cast<size_t>(written) == total)
+            continue;
+
+        // Keeps whatever could not be written.
+        size_t skip = written;
+        for (auto& buffer : iov)
+        {
+            if (skip >= buffer.iov_len)
+            {
+                skip -= buffer.iov_len;
+                continue;
+            }
+            client.output.append(static_cast<char*>(buffer.iov_base) + skip,
+                                 buffer.iov_len - skip);
+            skip = 0;
+        }
+        if (!flush(client))
+            failed.push_back(id);
+        else
+            watch_output(id, client);
+    }
+
+    for (uint32_t id : failed)
+        disconnect(id);
+}
+
+bool SessionHub::flush(Client& client)
+{
+    for (;;)
+    {
+        while (client.output_offset < client.output.size())
+        {
+            ssize_t written = send(client.fd,
+                                   client.output.data() + client.output_offset,
+                                   client.output.size() - client.output_offset,
+                                   MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return would_block(errno);
+            }
+            client.output_offset += written;
+        }
+        client.output.clear();
+        client.output_offset = 0;
+
+        if (client.backlog.empty())
+            return true;
+        for (auto& batch : client.backlog)
+            batch.second.encode(batch.first, client.output);
+        client.backlog.clear();
+    }
+}
+
+void SessionHub::watch_output(uint32_t id, Client& client)
+{
+    bool is_pending = client.output_offset < client.output.size();
+    if (is_pending == client.is_watching_output)
+        return;
+
+    epoll_event event{};
+    event.events = is_pending ? EPOLLIN | EPOLLOUT : EPOLLIN;
+    event.data.u32 = id;
+    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, client.fd, &event);
+    client.is_watching_output = is_pending;
+}
+
+void SessionHub::disconnect(uint32_t id)
+{
+    auto client = clients.find(id);
+    if (client == clients.end())
+        return;
+
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, client->second.fd, nullptr);
+    close(client->second.fd);
+    clients.erase(client);
+    BOOST_LOG_SEV(log, LogLevel::debug) << _("Client ") << id
+                                       << _(" left the session");
+
+    // Removes the client's characters from everyone else.
+    auto changes = state.find(id);
+    Delta::Batch removal;
+    if (changes != state.end())
+    {
+        changes->second.for_each([&](const Delta::Op& op)
+        {
+            removal.add({Delta::Op::remove, op.character, {}, 0, {}});
+        });
+        state.erase(changes);
+    }
+    if (removal.empty())
+        received.erase(id);
+    else
+        received[id] = std::move(removal);
+}
+
+}; // namespace gelcube
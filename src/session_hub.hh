@@ -0,0 +1,129 @@
+/// @file session_hub.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Relays character changes between the programs in a session.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_SESSION_HUB_HH_
+#define GELCUBE_SRC_SESSION_HUB_HH_
+
+#include "delta.hh"
+#include "logger.hh"
+
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gelcube
+{
+
+/// @brief Relays character changes between the programs in a session.
+/// Listens on a Unix domain socket for clients (see gelcube::SessionClient)
+/// and forwards the delta frames each client sends to every other client.
+/// Changes received in one iteration of the event loop are coalesced and
+/// encoded once per sender, then written to each client with a single
+/// gathering sendmsg(). Clients which cannot keep up accumulate coalesced
+/// changes instead of queued frames, so a slow client costs memory
+/// proportional to the number of fields changed, not the number of changes.
+/// Clients joining the session are sent the latest value of every field.
+typedef class SessionHub
+{
+public:
+    /// @brief Constructs a new SessionHub object.
+    /// Creates the socket and starts listening.
+    /// @param path Path of the socket, which must not exist.
+    /// @throw std::system_error if the socket cannot be created.
+    explicit SessionHub(std::string path);
+
+    /// @brief Destroys the SessionHub object.
+    /// Disconnects every client and removes the socket.
+    ~SessionHub();
+
+    SessionHub(const SessionHub&) = delete;
+    SessionHub& operator=(const SessionHub&) = delete;
+
+    /// @brief Relays changes until stopped.
+    /// @throw std::system_error if waiting for events fails.
+    void run();
+
+    /// @brief Stops relaying changes.
+    /// Used as a signal handler.
+    /// @param sig_num Signal number for sighandler_t.
+    static inline void stop(int sig_num = 0) noexcept
+    {
+        done = true;
+    }
+
+private:
+    struct Client
+    {
+        int fd = -1;
+        std::string input;
+        std::string output;
+        size_t output_offset = 0;
+        // Changes coalesced while output could not be written, by sender.
+        std::unordered_map<uint32_t, Delta::Batch> backlog;
+        bool is_watching_output = false;
+    };
+
+    /// @brief Accepts every pending connection.
+    void accept_clients();
+
+    /// @brief Reads and decodes everything a client has sent.
+    /// Frames are decoded as they arrive, so that a client's input never
+    /// holds more than one partial frame.
+    /// @return false if the client must be disconnected, including when a
+    ///        frame is larger than Delta::max_payload_size.
+    bool read_client(uint32_t id, Client& client);
+
+    /// @brief Decodes the complete frames in a client's input.
+    /// @return false if a frame is malformed or too large.
+    bool decode_frames(uint32_t id, Client& client);
+
+    /// @brief Sends the changes received in this iteration to every client.
+    void broadcast();
+
+    /// @brief Writes as much pending output to a client as possible.
+    /// @return false if the client must be disconnected.
+    bool flush(Client& client);
+
+    /// @brief Updates whether the event loop waits for a client to become
+    ///        writable.
+    void watch_output(uint32_t id, Client& client);
+
+    /// @brief Disconnects a client, removing its characters from the others.
+    void disconnect(uint32_t id);
+
+    std::string path;
+    int listen_fd;
+    int epoll_fd;
+    uint32_t next_id = 1;
+    std::unordered_map<uint32_t, Client> clients;
+    // Latest value of every field, by sender, for clients which join later.
+    std::unordered_map<uint32_t, Delta::Batch> state;
+    // Changes received in the current iteration, by sender.
+    std::unordered_map<uint32_t, Delta::Batch> received;
+    Logger::Source log;
+    static volatile sig_atomic_t done;
+} SessionHub;
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_SESSION_HUB_HH_
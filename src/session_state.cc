@@ -0,0 +1,248 @@
+/// @file session_state.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief State of the TUI kept in a mapped file, to resume from after a
+///        restart.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "session_state.hh"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace gelcube
+{
+
+namespace
+{
+
+const char magic[8] = {'g', 'e', 'l', 'c', 'u', 'b', 'e', 's'};
+const uint32_t byte_order = 0x01020304;
+
+/// @brief Creates the directories leading to a file, as mkdir -p would.
+/// @param path Path of the file.
+/// @throw std::system_error if a directory cannot be created.
+void make_parent_directories(const std::string& path)
+{
+    for (size_t end = path.find('/', 1); end != std::string::npos;
+         end = path.find('/', end + 1))
+    {
+        std::string directory = path.substr(0, end);
+        if (mkdir(directory.c_str(), 0700) != 0 && errno != EEXIST)
+            throw std::system_error(errno, std::generic_category(), directory);
+    }
+}
+
+}; // namespace
+
+SessionState::File* SessionState::file = nullptr;
+int SessionState::fd = -1;
+
+std::string SessionState::get_default_path()
+{
+    // Relative paths are invalid in XDG variables and are ignored.
+    const char* state_home = std::getenv("XDG_STATE_HOME");
+    if (state_home && *state_home == '/')
+        return std::string(state_home) + "/gelcube/session";
+    const char* home = std::getenv("HOME");
+    if (home && *home)
+        return std::string(home) + "/.local/state/gelcube/session";
+    return {};
+}
+
+bool SessionState::open(const std::string& path)
+{
+    close();
+    make_parent_directories(path);
+    int descriptor = ::open(path.c_str(),
+                            O_RDWR | O_CREAT | O_CLOEXEC | O_NOFOLLOW, 0600);
+    if (descriptor < 0)
+        throw std::system_error(errno, std::generic_category(), path);
+    auto fail = [&](int error)
+    {
+        ::close(descriptor);
+        return std::system_error(error, std::generic_category(), path);
+    };
+
+    // Held until the file is closed, by this program or its exit.
+    if (flock(descriptor, LOCK_EX | LOCK_NB) != 0)
+    {
+        if (errno == EWOULDBLOCK)
+        {
+            ::close(descriptor);
+            return false;
+        }
+        throw fail(errno);
+    }
+
+    struct stat status;
+    if (fstat(descriptor, &status) != 0)
+        throw fail(errno);
+    if (!S_ISREG(status.st_mode))
+        throw fail(EINVAL);
+
+    // Blocks are allocated up front, as running out of space while storing
+    // to the mapping would raise SIGBUS.
+    bool is_sized = static_cast<uint64_t>(status.st_size) == sizeof(File);
+    if (!is_sized && ftruncate(descriptor, 0) != 0)
+        throw fail(errno);
+    int error = posix_fallocate(descriptor, 0, sizeof(File));
+    if (error != 0)
+        throw fail(error);
+
+    void* mapping = mmap(nullptr, sizeof(File), PROT_READ | PROT_WRITE,
+                         MAP_SHARED, descriptor, 0);
+    if (mapping == MAP_FAILED)
+        throw fail(errno);
+    File* mapped = static_cast<File*>(mapping);
+
+    uint32_t current = mapped->current.load(std::memory_order_relaxed);
+    if (!is_sized || std::memcmp(mapped->magic, magic, sizeof(magic)) != 0
+        || mapped->version != format_version
+        || mapped->byte_order != byte_order || mapped->size != sizeof(File)
+        || current > 1
+        || mapped->slots[current].open_path_size > max_path_size
+        || mapped->slots[current].query_size > max_query_size)
+    {
+        std::memset(static_cast<void*>(mapped), 0, sizeof(File));
+        std::memcpy(mapped->magic, magic, sizeof(magic));
+        mapped->version = format_version;
+        mapped->byte_order = byte_order;
+        mapped->size = sizeof(File);
+        mapped->current.store(0, std::memory_order_relaxed);
+    }
+
+    file = mapped;
+    fd = descriptor;
+    return true;
+}
+
+void SessionState::close() noexcept
+{
+    if (!file)
+        return;
+    munmap(file, sizeof(File));
+    ::close(fd);
+    file = nullptr;
+    fd = -1;
+}
+
+size_t SessionState::get_selected_index() noexcept
+{
+    return file ? get_current().selected_index : 0;
+}
+
+size_t SessionState::get_last_selected_index() noexcept
+{
+    return file ? get_current().last_selected_index : 0;
+}
+
+bool SessionState::get_show_latency() noexcept
+{
+    return file && get_current().show_latency;
+}
+
+std::string_view SessionState::get_open_path() noexcept
+{
+    if (!file)
+        return {};
+    const Slot& slot = get_current();
+    return {slot.open_path, slot.open_path_size};
+}
+
+std::string_view SessionState::get_query() noexcept
+{
+    if (!file)
+        return {};
+    const Slot& slot = get_current();
+    return {slot.query, slot.query_size};
+}
+
+void SessionState::set_selection(size_t selected,
+                                 size_t last_selected) noexcept
+{
+    if (!file || (get_current().selected_index == selected
+                  && get_current().last_selected_index == last_selected))
+    {
+        return;
+    }
+    Slot& slot = begin();
+    slot.selected_index = static_cast<uint32_t>(selected);
+    slot.last_selected_index = static_cast<uint32_t>(last_selected);
+    commit(slot);
+}
+
+void SessionState::set_show_latency(bool show) noexcept
+{
+    if (!file || static_cast<bool>(get_current().show_latency) == show)
+        return;
+    Slot& slot = begin();
+    slot.show_latency = show;
+    commit(slot);
+}
+
+void SessionState::set_open_path(std::string_view path) noexcept
+{
+    if (path.size() > max_path_size)
+        path = {};
+    if (!file || get_open_path() == path)
+        return;
+    Slot& slot = begin();
+    path.copy(slot.open_path, path.size());
+    slot.open_path_size = static_cast<uint32_t>(path.size());
+    commit(slot);
+}
+
+void SessionState::set_query(std::string_view query) noexcept
+{
+    if (query.size() > max_query_size)
+        query = {};
+    if (!file || get_query() == query)
+        return;
+    Slot& slot = begin();
+    query.copy(slot.query, query.size());
+    slot.query_size = static_cast<uint32_t>(query.size());
+    commit(slot);
+}
+
+SessionState::Slot& SessionState::begin() noexcept
+{
+    uint32_t current = file->current.load(std::memory_order_relaxed);
+    Slot& slot = file->slots[1 - current];
+    std::memcpy(&slot, &file->slots[current], sizeof(Slot));
+    return slot;
+}
+
+void SessionState::commit(const Slot& slot) noexcept
+{
+    // Everything written to the slot is stored before it becomes current.
+    file->current.store(&slot == &file->slots[1] ? 1 : 0,
+                        std::memory_order_release);
+}
+
+}; // namespace gelcube
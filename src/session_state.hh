@@ -0,0 +1,167 @@
+/// @file session_state.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief State of the TUI kept in a mapped file, to resume from after a
+///        restart.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_SESSION_STATE_HH_
+#define GELCUBE_SRC_SESSION_STATE_HH_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace gelcube
+{
+
+/// @brief State of the TUI kept in a mapped file, to resume from after a
+///        restart.
+/// The selected panels, the open character, the last query and whether
+/// input latency is shown are written straight into a small file mapped
+/// shared, so saving a change is a few stores and survives the program being
+/// killed, e.g. when an SSH session drops; the kernel writes the pages back.
+/// The file holds two copies of the state: a change is written to the copy
+/// which is not current, which is then made current by a single store, so
+/// the state read back is always one which was saved whole. Only one program
+/// keeps a file at a time; the others run without it.
+typedef class SessionState
+{
+public:
+    /// @brief Version of the file format, changed whenever it changes.
+    static constexpr uint32_t format_version = 1;
+
+    /// @brief Longest path of an open character which is kept.
+    static constexpr size_t max_path_size = 4096;
+
+    /// @brief Longest query which is kept.
+    static constexpr size_t max_query_size = 1024;
+
+    /// @brief Gets the path of the state file unless another is given.
+    /// @return $XDG_STATE_HOME/gelcube/session, or
+    ///         ~/.local/state/gelcube/session, or an empty string if neither
+    ///         variable is set.
+    static std::string get_default_path();
+
+    /// @brief Maps a state file, creating it and its directory if needed.
+    /// A file of another format version is reset to the default state.
+    /// @param path Path of the file.
+    /// @return false if another program keeps the file.
+    /// @throw std::system_error if the file cannot be created or mapped.
+    static bool open(const std::string& path);
+
+    /// @brief Unmaps the state file.
+    /// The state is saved as it stands.
+    static void close() noexcept;
+
+    /// @brief Checks whether a state file is mapped.
+    /// @return true if the state is kept.
+    static inline bool is_open() noexcept
+    {
+        return file != nullptr;
+    }
+
+    /// @brief Gets the index of the selected panel.
+    /// @return Index, or 0 if no state file is mapped.
+    static size_t get_selected_index() noexcept;
+
+    /// @brief Gets the index of the previously selected panel.
+    /// @return Index, or 0 if no state file is mapped.
+    static size_t get_last_selected_index() noexcept;
+
+    /// @brief Checks whether input latency is shown.
+    /// @return false if no state file is mapped.
+    static bool get_show_latency() noexcept;
+
+    /// @brief Gets the path of the open character.
+    /// @return Path, or an empty string if none is kept.
+    static std::string_view get_open_path() noexcept;
+
+    /// @brief Gets the text of the last query.
+    /// @return Text, or an empty string if none is kept.
+    static std::string_view get_query() noexcept;
+
+    /// @brief Saves the indices of the selected panels.
+    /// Does nothing if they are unchanged or no state file is mapped.
+    /// @param selected Index of the selected panel.
+    /// @param last_selected Index of the previously selected panel.
+    static void set_selection(size_t selected, size_t last_selected) noexcept;
+
+    /// @brief Saves whether input latency is shown.
+    /// Does nothing if it is unchanged or no state file is mapped.
+    /// @param show true if the latency overlay is shown.
+    static void set_show_latency(bool show) noexcept;
+
+    /// @brief Saves the path of the open character.
+    /// Does nothing if it is unchanged or no state file is mapped. A path
+    /// longer than max_path_size is saved as an empty string.
+    /// @param path Path the character was loaded from.
+    static void set_open_path(std::string_view path) noexcept;
+
+    /// @brief Saves the text of the last query.
+    /// Does nothing if it is unchanged or no state file is mapped. A query
+    /// longer than max_query_size is saved as an empty string.
+    /// @param query Text of the query.
+    static void set_query(std::string_view query) noexcept;
+
+private:
+    /// @brief Copy of the state.
+    struct Slot
+    {
+        uint32_t selected_index;
+        uint32_t last_selected_index;
+        uint32_t show_latency;
+        uint32_t open_path_size;
+        uint32_t query_size;
+        char open_path[max_path_size];
+        char query[max_query_size];
+    };
+
+    /// @brief Layout of the mapped file.
+    struct File
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t byte_order;
+        uint64_t size;
+        // Index of the current slot.
+        std::atomic<uint32_t> current;
+        Slot slots[2];
+    };
+
+    /// @brief Gets the current copy of the state.
+    static inline const Slot& get_current() noexcept
+    {
+        return file->slots[file->current.load(std::memory_order_acquire)];
+    }
+
+    /// @brief Copies the current state into the other slot, to be changed.
+    /// @return Slot to change and then pass to commit().
+    static Slot& begin() noexcept;
+
+    /// @brief Makes a changed slot current.
+    static void commit(const Slot& slot) noexcept;
+
+    static File* file;
+    static int fd;
+} SessionState;
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_SESSION_STATE_HH_
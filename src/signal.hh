@@ -47,6 +47,9 @@ public:
     /// the constructor with the default handler.
     ~Signal();
 
+    Signal(const Signal&) = delete;
+    Signal& operator=(const Signal&) = delete;
+
 private:
     std::vector<int> sig_nums;
 } Signal;
@@ -0,0 +1,105 @@
+/// @file symbol.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Interned strings.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "intern_table.hh"
+#include "symbol.hh"
+#include "text_layout.hh"
+
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace gelcube
+{
+
+namespace
+{
+
+/// @brief Interned string and its display width.
+struct Entry
+{
+    std::string text;
+    int width = 0;
+};
+
+typedef InternTable<Entry> Table;
+
+std::atomic<uint32_t> count{1};
+const Entry empty;
+
+// Guards interning.
+std::mutex table_mutex;
+
+inline const Entry& get_entry(uint32_t id) noexcept
+{
+    if (id == 0)
+        return empty;
+    return Table::get(id);
+}
+
+}; // namespace
+
+Symbol::Symbol(std::string_view text)
+{
+    if (text.empty())
+        return;
+
+    std::lock_guard<std::mutex> lock(table_mutex);
+    auto& ids = Table::get_ids();
+    auto existing = ids.find(text);
+    if (existing != ids.end())
+    {
+        id = existing->second;
+        return;
+    }
+
+    uint32_t next = count.load(std::memory_order_relaxed);
+    if (next == UINT32_MAX)
+        throw std::length_error("too many symbols");
+    Entry& entry = Table::add(next);
+    entry.text.assign(text);
+    entry.width = TextLayout::measure(text);
+    ids.emplace(entry.text, next);
+    count.store(next + 1, std::memory_order_release);
+    id = next;
+}
+
+const std::string& Symbol::get_text() const noexcept
+{
+    return get_entry(id).text;
+}
+
+int Symbol::get_width() const noexcept
+{
+    return get_entry(id).width;
+}
+
+size_t Symbol::get_count() noexcept
+{
+    return count.load(std::memory_order_relaxed);
+}
+
+}; // namespace gelcube
@@ -0,0 +1,117 @@
+/// @file symbol.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Interned strings.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_SYMBOL_HH_
+#define GELCUBE_SRC_SYMBOL_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace gelcube
+{
+
+/// @brief Interned string.
+/// Every distinct string is stored once in a global table, and symbols refer
+/// to it by a 32-bit identifier, so symbols are compared and hashed in O(1)
+/// and strings which repeat across characters, panels and encounters cost
+/// four bytes each. The display width of each string is computed when it is
+/// interned. Strings are never removed from the table.
+/// Symbols may be created and read on any thread.
+typedef class Symbol
+{
+public:
+    /// @brief Constructs the symbol of the empty string.
+    Symbol() noexcept = default;
+
+    /// @brief Constructs the symbol of a string, interning it if necessary.
+    /// @param text String to intern.
+    explicit Symbol(std::string_view text);
+
+    /// @brief Gets the interned string.
+    /// @return String, valid for the life of the program.
+    const std::string& get_text() const noexcept;
+
+    /// @brief Gets the interned string as a C string.
+    /// @return Null-terminated string, valid for the life of the program.
+    inline const char* c_str() const noexcept
+    {
+        return get_text().c_str();
+    }
+
+    /// @brief Gets the number of terminal columns the string occupies.
+    /// Computed for the locale set when the string was interned.
+    /// @return Width in columns.
+    int get_width() const noexcept;
+
+    /// @brief Gets the identifier of the symbol.
+    /// Identifiers are assigned in the order strings are interned; the empty
+    /// string is 0.
+    /// @return Identifier.
+    inline uint32_t get_id() const noexcept
+    {
+        return id;
+    }
+
+    /// @brief Gets the number of distinct strings interned.
+    /// @return Count, including the empty string.
+    static size_t get_count() noexcept;
+
+    inline bool operator==(Symbol other) const noexcept
+    {
+        return id == other.id;
+    }
+
+    inline bool operator!=(Symbol other) const noexcept
+    {
+        return id != other.id;
+    }
+
+    /// @brief Orders symbols by identifier, not alphabetically.
+    /// Suits sorting for lookup; compare get_text() to sort for display.
+    inline bool operator<(Symbol other) const noexcept
+    {
+        return id < other.id;
+    }
+
+private:
+    uint32_t id = 0;
+} Symbol;
+
+}; // namespace gelcube
+
+namespace std
+{
+
+/// @brief Hashes symbols by identifier.
+template <>
+struct hash<gelcube::Symbol>
+{
+    inline size_t operator()(gelcube::Symbol symbol) const noexcept
+    {
+        return symbol.get_id();
+    }
+};
+
+}; // namespace std
+
+#endif // GELCUBE_SRC_SYMBOL_HH_
@@ -0,0 +1,241 @@
+/// @file terminal_writer.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Writes each frame of the TUI to the terminal at once.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "intl.hh"
+#include "terminal_writer.hh"
+#include "trace.hh"
+
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include <fcntl.h>
+#include <ncurses.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace gelcube
+{
+
+bool TerminalWriter::enabled = false;
+bool TerminalWriter::synchronized = false;
+int TerminalWriter::capture_fd = -1;
+int TerminalWriter::terminal_fd = -1;
+std::string TerminalWriter::frame;
+TerminalWriter::Stats TerminalWriter::stats = {};
+
+namespace
+{
+
+// Synchronized update sequences (DEC private mode 2026).
+const std::string_view begin_update = "\x1b[?2026h";
+const std::string_view end_update = "\x1b[?2026l";
+
+// DECRQM for mode 2026, then primary device attributes, which every terminal
+// answers: a reply to the latter alone means the mode is not supported.
+const std::string_view synchronized_query = "\x1b[?2026$p\x1b[c";
+
+// Time the terminal has to answer the query.
+const std::chrono::milliseconds query_timeout(200);
+
+}; // namespace
+
+void TerminalWriter::start() noexcept
+{
+    if (!enabled || capture_fd >= 0)
+        return;
+    if (!isatty(STDIN_FILENO) || !isatty(STDOUT_FILENO))
+        return;
+
+    terminal_fd = fcntl(STDOUT_FILENO, F_DUPFD_CLOEXEC, 0);
+    capture_fd = memfd_create("gelcube-frame", MFD_CLOEXEC);
+    if (terminal_fd < 0 || capture_fd < 0)
+    {
+        stop();
+        return;
+    }
+    synchronized = query_synchronized();
+}
+
+void TerminalWriter::stop() noexcept
+{
+    if (capture_fd >= 0)
+        close(capture_fd);
+    if (terminal_fd >= 0)
+        close(terminal_fd);
+    capture_fd = -1;
+    terminal_fd = -1;
+}
+
+void TerminalWriter::update()
+{
+    Trace::Span span("TerminalWriter::update");
+    if (capture_fd < 0)
+    {
+        doupdate();
+        return;
+    }
+
+    // ncurses writes to the standard output, which points at the capture
+    // file while the frame is drawn.
+    if (dup2(capture_fd, STDOUT_FILENO) < 0)
+    {
+        doupdate();
+        return;
+    }
+    doupdate();
+    dup2(terminal_fd, STDOUT_FILENO);
+    off_t size = lseek(capture_fd, 0, SEEK_CUR);
+    stats.syscalls += 3;
+    ++stats.frames;
+    if (size <= 0)
+        return;
+    lseek(capture_fd, 0, SEEK_SET);
+
+    // The buffer keeps its capacity, so frames no larger than the largest so
+    // far are not allocated.
+    size_t prefix = synchronized ? begin_update.size() : 0;
+    frame.resize(prefix + size);
+    ssize_t length = pread(capture_fd, &frame[prefix], size, 0);
+    stats.syscalls += 2;
+    if (length < 0)
+        length = 0;
+    frame.resize(prefix + length);
+    if (synchronized)
+    {
+        frame.replace(0, prefix, begin_update);
+        frame += end_update;
+    }
+
+    size_t written = 0;
+    while (written < frame.size())
+    {
+        ssize_t result = write(terminal_fd, frame.data() + written,
+                               frame.size() - written);
+        ++stats.syscalls;
+        if (result < 0)
+        {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+            break;
+        }
+        written += result;
+    }
+    stats.bytes += written;
+}
+
+void TerminalWriter::report(std::ostream& out)
+{
+    if (stats.frames == 0)
+    {
+        out << _("No frames were written at once.") << std::endl;
+        return;
+    }
+
+    char line[128];
+    std::snprintf(line, sizeof(line), "%.1f", static_cast<double>(stats.bytes)
+                                              / stats.frames);
+    out << _("Wrote ") << stats.frames
+        << (synchronized ? _(" synchronized frames: ") : _(" frames: "))
+        << line << _(" bytes and ");
+    std::snprintf(line, sizeof(line), "%.2f", static_cast<double>(stats.syscalls)
+                                              / stats.frames);
+    out << line << _(" syscalls per frame") << std::endl;
+}
+
+bool TerminalWriter::query_synchronized() noexcept
+{
+    termios original;
+    if (tcgetattr(STDIN_FILENO, &original) < 0)
+        return false;
+    termios raw = original;
+    raw.c_lflag &= ~(ICANON | ECHO);
+    raw.c_cc[VMIN] = 0;
+    raw.c_cc[VTIME] = 0;
+    if (tcsetattr(STDIN_FILENO, TCSANOW, &raw) < 0)
+        return false;
+
+    int status = 0;
+    bool answered = false;
+    if (write(terminal_fd, synchronized_query.data(),
+              synchronized_query.size())
+        == static_cast<ssize_t>(synchronized_query.size()))
+    {
+        using Clock = std::chrono::steady_clock;
+        Clock::time_point deadline = Clock::now() + query_timeout;
+        char reply[256];
+        size_t size = 0;
+        while (!answered && size < sizeof(reply))
+        {
+            auto remaining = std::chrono::duration_cast<
+                std::chrono::milliseconds>(deadline - Clock::now()).count();
+            pollfd input = {STDIN_FILENO, POLLIN, 0};
+            if (remaining <= 0
+                || poll(&input, 1, static_cast<int>(remaining)) <= 0)
+            {
+                if (remaining > 0 && errno == EINTR)
+                    continue;
+                break;
+            }
+            ssize_t length = read(STDIN_FILENO, reply + size,
+                                  sizeof(reply) - size);
+            if (length <= 0)
+                break;
+            size += length;
+
+            // Replies are CSI ? 2026 ; STATUS $ y and CSI ? ... c.
+            std::string_view replies(reply, size);
+            for (size_t i = replies.find("\x1b[?"); i != replies.npos;
+                 i = replies.find("\x1b[?", i))
+            {
+                size_t end = replies.find_first_not_of("0123456789;$", i + 3);
+                if (end == replies.npos)
+                    break;
+                std::string_view parameters = replies.substr(i + 3,
+                                                             end - i - 3);
+                if (replies[end] == 'y'
+                    && parameters.substr(0, 5) == "2026;")
+                {
+                    status = std::atoi(parameters.data() + 5);
+                }
+                else if (replies[end] == 'c')
+                {
+                    answered = true;
+                }
+                i = end;
+            }
+        }
+    }
+    tcsetattr(STDIN_FILENO, TCSANOW, &original);
+
+    // The mode is set or reset, possibly permanently set, but known.
+    return status == 1 || status == 2 || status == 3;
+}
+
+}; // namespace gelcube
@@ -0,0 +1,121 @@
+/// @file terminal_writer.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Writes each frame of the TUI to the terminal at once.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_TERMINAL_WRITER_HH_
+#define GELCUBE_SRC_TERMINAL_WRITER_HH_
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace gelcube
+{
+
+/// @brief Writes each frame of the TUI to the terminal at once.
+/// Windows are staged with wnoutrefresh() while a frame is drawn and sent by
+/// update() at its end. By default ncurses writes the frame itself. When
+/// enabled, ncurses' output for the frame is captured in memory instead and
+/// sent with a single write(), wrapped in the synchronized update sequences
+/// of DEC private mode 2026 if the terminal reports supporting them, so that
+/// it never shows a partly drawn frame. Support is detected with a DECRQM
+/// query when the writer starts. If the terminal does not answer, or the
+/// output cannot be captured, frames are written by ncurses as usual.
+typedef class TerminalWriter
+{
+public:
+    /// @brief Totals of the frames written at once.
+    struct Stats
+    {
+        uint64_t frames;
+        uint64_t bytes;
+        // System calls made to capture and send the frames: dup2(), lseek(),
+        // pread() and write().
+        uint64_t syscalls;
+    };
+
+    /// @brief Writes frames at once in the next TUI session.
+    static inline void enable() noexcept
+    {
+        enabled = true;
+    }
+
+    /// @brief Checks whether frames are to be written at once.
+    /// @return true if enabled, whether or not the terminal allowed it.
+    static inline bool is_enabled() noexcept
+    {
+        return enabled;
+    }
+
+    /// @brief Prepares to write frames at once, if enabled.
+    /// Must be called before ncurses is initialized, as it queries the
+    /// terminal on the standard input and output.
+    static void start() noexcept;
+
+    /// @brief Stops writing frames at once.
+    /// Must be called after ncurses has ended.
+    static void stop() noexcept;
+
+    /// @brief Sends the staged windows to the terminal.
+    /// Used instead of doupdate() at the end of each frame.
+    static void update();
+
+    /// @brief Checks whether frames are written at once.
+    /// @return true if started and the output can be captured.
+    static inline bool is_active() noexcept
+    {
+        return capture_fd >= 0;
+    }
+
+    /// @brief Checks whether frames are wrapped in synchronized updates.
+    /// @return true if the terminal reported supporting mode 2026.
+    static inline bool is_synchronized() noexcept
+    {
+        return synchronized;
+    }
+
+    /// @brief Gets the totals of the frames written at once.
+    /// @return Totals since the writer started.
+    static inline const Stats& get_stats() noexcept
+    {
+        return stats;
+    }
+
+    /// @brief Writes the bytes and system calls per frame to a stream.
+    /// @param out Output stream.
+    static void report(std::ostream& out);
+
+private:
+    /// @brief Asks the terminal whether it supports synchronized updates.
+    /// @return true if the terminal reported supporting mode 2026.
+    static bool query_synchronized() noexcept;
+
+    static bool enabled;
+    static bool synchronized;
+    // Memory file receiving ncurses' output during update().
+    static int capture_fd;
+    // Duplicate of the standard output, which is the terminal.
+    static int terminal_fd;
+    static std::string frame;
+    static Stats stats;
+} TerminalWriter;
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_TERMINAL_WRITER_HH_
@@ -0,0 +1,236 @@
+/// @file text_layout.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Wraps text to a width in terminal columns.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "text_layout.hh"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cwchar>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <wchar.h>
+
+namespace gelcube
+{
+
+namespace
+{
+
+/// @brief Decodes the character at the start of a UTF-8 string.
+/// @param length Set to the number of bytes of the character.
+/// @param width Set to the columns the character occupies.
+/// @return The character, or an invalid byte as itself.
+wchar_t decode(const char* text, size_t size, std::mbstate_t& state,
+               size_t& length, int& width) noexcept
+{
+    wchar_t ch;
+    length = std::mbrtowc(&ch, text, size, &state);
+    if (length == static_cast<size_t>(-1) || length == static_cast<size_t>(-2))
+    {
+        state = std::mbstate_t{};
+        length = 1;
+        width = 1;
+        return static_cast<unsigned char>(*text);
+    }
+    if (length == 0)
+        length = 1;
+    width = wcwidth(ch);
+    if (width < 0)
+        width = 1;
+    return ch;
+}
+
+}; // namespace
+
+TextLayout::TextLayout(std::string text)
+    : text{std::move(text)}
+{
+    const std::string& s = this->text;
+    std::mbstate_t state{};
+    Word word{0, 0, 0, 0, false};
+    bool is_line_start = true;
+    bool is_in_spaces = false;
+    size_t i = 0;
+    while (i < s.size())
+    {
+        size_t length;
+        int width;
+        wchar_t ch = decode(s.data() + i, s.size() - i, state, length, width);
+        if (ch == L'\n')
+        {
+            if (!is_in_spaces)
+                word.end = i;
+            word.is_line_end = true;
+            words.push_back(word);
+            word = {static_cast<uint32_t>(i + 1), 0, 0, 0, false};
+            is_line_start = true;
+            is_in_spaces = false;
+        }
+        else if ((ch == L' ' || ch == L'\t') && !is_line_start)
+        {
+            // Spaces after a word are dropped where the line breaks.
+            if (!is_in_spaces)
+                word.end = i;
+            word.space_width += 1;
+            is_in_spaces = true;
+        }
+        else
+        {
+            // Indentation at the start of a line is kept with the first word.
+            if (is_in_spaces)
+            {
+                words.push_back(word);
+                word = {static_cast<uint32_t>(i), 0, 0, 0, false};
+                is_in_spaces = false;
+            }
+            word.width += ch == L'\t' ? 1 : width;
+            if (ch != L' ' && ch != L'\t')
+                is_line_start = false;
+        }
+        i += length;
+    }
+    if (!is_in_spaces)
+        word.end = s.size();
+
+    // A final newline does not start another line, but empty text is one
+    // empty line.
+    if (words.empty() || !words.back().is_line_end || word.end > word.begin)
+        words.push_back(word);
+}
+
+const std::vector<TextLayout::Line>& TextLayout::wrap(int width, size_t count)
+{
+    width = std::max(width, 1);
+    auto breaks = std::find_if(cache.begin(), cache.end(),
+                               [width](const Breaks& breaks)
+                               { return breaks.width == width; });
+    if (breaks == cache.end())
+    {
+        if (cache.size() < cached_widths)
+        {
+            breaks = cache.emplace(cache.end());
+        }
+        else
+        {
+            // Replaces the least recently used width.
+            breaks = std::min_element(cache.begin(), cache.end(),
+                                      [](const Breaks& a, const Breaks& b)
+                                      { return a.last_used < b.last_used; });
+            *breaks = Breaks{};
+        }
+        breaks->width = width;
+    }
+    breaks->last_used = ++uses;
+    extend(*breaks, count);
+    return breaks->lines;
+}
+
+int TextLayout::measure(std::string_view text) noexcept
+{
+    std::mbstate_t state{};
+    int total = 0;
+    size_t i = 0;
+    while (i < text.size())
+    {
+        size_t length;
+        int width;
+        decode(text.data() + i, text.size() - i, state, length, width);
+        total += width;
+        i += length;
+    }
+    return total;
+}
+
+void TextLayout::extend(Breaks& breaks, size_t count)
+{
+    const int width = breaks.width;
+    while (breaks.lines.size() < count && breaks.next_word < words.size())
+    {
+        size_t next = breaks.next_word;
+        uint32_t offset = breaks.next_offset;
+        Line line{offset ? offset : words[next].begin, 0, 0};
+        line.end = line.begin;
+        bool is_empty = true;
+        while (next < words.size())
+        {
+            const Word& word = words[next];
+            uint32_t start = offset ? offset : word.begin;
+            int word_width = offset
+                ? measure(std::string_view(text).substr(start,
+                                                        word.end - start))
+                : word.width;
+            int gap = is_empty ? 0 : words[next - 1].space_width;
+            if (!is_empty && line.width + gap + word_width > width)
+                break;
+
+            if (word_width > width)
+            {
+                // Splits a word which does not fit on a line of its own.
+                int used = 0;
+                offset = split(start, word.end, width, used);
+                line.end = offset;
+                line.width = used;
+                if (offset == word.end)
+                {
+                    offset = 0;
+                    ++next;
+                }
+                break;
+            }
+
+            line.width += gap + word_width;
+            line.end = word.end;
+            is_empty = false;
+            offset = 0;
+            ++next;
+            if (word.is_line_end)
+                break;
+        }
+        breaks.lines.push_back(line);
+        breaks.next_word = next;
+        breaks.next_offset = offset;
+    }
+}
+
+uint32_t TextLayout::split(uint32_t begin, uint32_t end, int width,
+                           int& used) const noexcept
+{
+    std::mbstate_t state{};
+    uint32_t i = begin;
+    while (i < end)
+    {
+        size_t length;
+        int ch_width;
+        decode(text.data() + i, end - i, state, length, ch_width);
+        // Places at least one character, and combining characters with the
+        // one they modify.
+        if (used + ch_width > width && i > begin)
+            break;
+        used += ch_width;
+        i += length;
+    }
+    return i;
+}
+
+}; // namespace gelcube
@@ -0,0 +1,124 @@
+/// @file text_layout.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Wraps text to a width in terminal columns.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_TEXT_LAYOUT_HH_
+#define GELCUBE_SRC_TEXT_LAYOUT_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace gelcube
+{
+
+/// @brief Wraps text to a width in terminal columns.
+/// Measures UTF-8 text by display width, so that double-width characters
+/// take two columns and combining characters stay with the character they
+/// modify, and breaks lines greedily at spaces, splitting words wider than a
+/// line between characters. The text is split into words once; the breaks
+/// for each width are computed only as far as the lines requested and kept
+/// for the most recently used widths, so resizing back and forth, or showing
+/// the start of a long text, costs a fraction of wrapping all of it.
+typedef class TextLayout
+{
+public:
+    /// @brief Line of wrapped text.
+    /// Byte range of the text, without the spaces at the break.
+    struct Line
+    {
+        uint32_t begin;
+        uint32_t end;
+        int width;
+    };
+
+    /// @brief Number of widths whose breaks are kept.
+    static const size_t cached_widths = 4;
+
+    /// @brief Constructs a new TextLayout object.
+    /// Splits the text into words. Newlines force breaks.
+    /// @param text UTF-8 text.
+    explicit TextLayout(std::string text);
+
+    /// @brief Gets the text being wrapped.
+    /// @return Text passed to the constructor.
+    inline const std::string& get_text() const noexcept
+    {
+        return text;
+    }
+
+    /// @brief Wraps the text to a width.
+    /// @param width Columns available to each line; at least one character
+    ///              is placed on every line, however narrow.
+    /// @param count Number of lines needed; breaks beyond them may not be
+    ///              computed.
+    /// @return Lines of wrapped text: at least count, unless the text has
+    ///         fewer. Valid until the next call.
+    const std::vector<Line>& wrap(int width, size_t count = SIZE_MAX);
+
+    /// @brief Measures the terminal columns a UTF-8 string occupies.
+    /// Characters which cannot be decoded or displayed count as one column.
+    /// @param text String to measure.
+    /// @return Width in columns.
+    static int measure(std::string_view text) noexcept;
+
+private:
+    /// @brief Run of characters followed by the spaces before the next.
+    struct Word
+    {
+        uint32_t begin;
+        uint32_t end;
+        int width;
+        // Width of the spaces after the word.
+        int space_width;
+        // Whether a newline ends the line after the word.
+        bool is_line_end;
+    };
+
+    /// @brief Breaks for a width, computed up to a point in the text.
+    struct Breaks
+    {
+        int width = 0;
+        std::vector<Line> lines;
+        // Where the next line starts: a word, and a byte offset within it if
+        // the word was split.
+        size_t next_word = 0;
+        uint32_t next_offset = 0;
+        uint64_t last_used = 0;
+    };
+
+    /// @brief Computes lines until there are enough or the text ends.
+    void extend(Breaks& breaks, size_t count);
+
+    /// @brief Places the part of a word which fits on a line.
+    /// @return Byte offset after the last character which fits.
+    uint32_t split(uint32_t begin, uint32_t end, int width,
+                   int& used) const noexcept;
+
+    std::string text;
+    std::vector<Word> words;
+    std::vector<Breaks> cache;
+    uint64_t uses = 0;
+} TextLayout;
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_TEXT_LAYOUT_HH_
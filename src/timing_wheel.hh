@@ -0,0 +1,162 @@
+/// @file timing_wheel.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Hierarchical timing wheel.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_TIMING_WHEEL_HH_
+#define GELCUBE_SRC_TIMING_WHEEL_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace gelcube
+{
+
+/// @brief Hierarchical timing wheel.
+/// Schedules payloads at integer times and fires them as time advances.
+/// Timers due within 64 ticks live in the innermost wheel; later timers live
+/// in coarser wheels and cascade inwards as their time approaches, so
+/// scheduling is O(1) and firing is O(1) amortized per timer regardless of
+/// how many timers are pending.
+/// @tparam T Payload type.
+template <typename T>
+class TimingWheel
+{
+public:
+    /// @brief Time in ticks.
+    typedef uint64_t Time;
+
+    /// @brief Schedules a payload.
+    /// Payloads due at or before the current time fire on the next tick.
+    /// @param due Time at which to fire.
+    /// @param payload Payload passed to the firing function.
+    void schedule(Time due, T payload)
+    {
+        if (due <= now)
+            due = now + 1;
+        place({due, std::move(payload)});
+        ++count;
+    }
+
+    /// @brief Advances time, firing every payload which becomes due.
+    /// Payloads fire in order of their due time.
+    /// @param to New current time; does nothing if not after the current time.
+    /// @param fire Callable taking (Time due, T&& payload).
+    template <typename Function>
+    void advance(Time to, Function&& fire)
+    {
+        while (now < to)
+        {
+            ++now;
+            cascade();
+
+            // Moves the slot out first so that firing may schedule timers.
+            std::vector<Entry> due;
+            due.swap(wheels[0][now & slot_mask]);
+            count -= due.size();
+            for (auto& entry : due)
+                fire(entry.due, std::move(entry.payload));
+
+            if (count == 0)
+            {
+                // Nothing can become due, so skips the remaining ticks.
+                now = to;
+            }
+        }
+    }
+
+    /// @brief Gets the current time.
+    /// @return Time of the last tick.
+    inline Time get_time() const noexcept
+    {
+        return now;
+    }
+
+    /// @brief Gets the number of pending payloads.
+    /// @return Number of payloads which have not fired.
+    inline size_t size() const noexcept
+    {
+        return count;
+    }
+
+private:
+    struct Entry
+    {
+        Time due;
+        T payload;
+    };
+
+    static constexpr unsigned bits_per_level = 6;
+    static constexpr size_t slots_per_level = size_t{1} << bits_per_level;
+    static constexpr Time slot_mask = slots_per_level - 1;
+    static constexpr unsigned levels = 4;
+
+    /// @brief Stores an entry in the wheel covering its distance from now.
+    void place(Entry entry)
+    {
+        Time distance = entry.due - now;
+        for (unsigned level = 0; level < levels; ++level)
+        {
+            if (distance < (Time{1} << (bits_per_level * (level + 1))))
+            {
+                size_t slot = (entry.due >> (bits_per_level * level))
+                              & slot_mask;
+                wheels[level][slot].push_back(std::move(entry));
+                return;
+            }
+        }
+        overflow.push_back(std::move(entry));
+    }
+
+    /// @brief Moves entries from coarser wheels into finer ones.
+    /// Called after every tick; does work only when a coarser wheel's slot
+    /// boundary is crossed.
+    void cascade()
+    {
+        for (unsigned level = 1; level <= levels; ++level)
+        {
+            Time boundary = Time{1} << (bits_per_level * level);
+            if (now & (boundary - 1))
+                return;
+
+            std::vector<Entry> entries;
+            if (level == levels)
+            {
+                entries.swap(overflow);
+            }
+            else
+            {
+                size_t slot = (now >> (bits_per_level * level)) & slot_mask;
+                entries.swap(wheels[level][slot]);
+            }
+            for (auto& entry : entries)
+                place(std::move(entry));
+        }
+    }
+
+    std::vector<Entry> wheels[levels][slots_per_level];
+    std::vector<Entry> overflow;
+    Time now = 0;
+    size_t count = 0;
+};
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_TIMING_WHEEL_HH_
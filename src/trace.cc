@@ -0,0 +1,262 @@
+/// @file trace.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Span tracing in the Chrome trace event format.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "trace.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <new>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <unistd.h>
+
+namespace gelcube
+{
+
+namespace
+{
+
+/// @brief Recorded span.
+/// Fields are atomic so that the trace can be written while the buffer's
+/// thread overwrites old spans; torn spans are detected and left out.
+struct Event
+{
+    std::atomic<const char*> name{nullptr};
+    std::atomic<const char*> detail{nullptr};
+    std::atomic<int64_t> start{0};
+    std::atomic<int64_t> duration{0};
+};
+
+/// @brief Ring buffer of the spans of one thread.
+/// Buffers are never freed, so that the spans of threads which have exited
+/// are still written.
+struct Buffer
+{
+    Event events[Trace::buffer_capacity];
+    // Number of spans ever recorded; the latest are at
+    // (written - 1) % buffer_capacity and before.
+    std::atomic<uint64_t> written{0};
+    std::atomic<const char*> thread_name{nullptr};
+    uint32_t id = 0;
+    Buffer* next = nullptr;
+};
+
+std::atomic<Buffer*> buffers{nullptr};
+std::atomic<uint32_t> buffer_count{0};
+thread_local Buffer* local_buffer = nullptr;
+
+std::chrono::steady_clock::time_point origin;
+
+/// @brief Gets the calling thread's buffer, creating it on first use.
+Buffer* get_buffer()
+{
+    if (local_buffer)
+        return local_buffer;
+    Buffer* buffer = new Buffer;
+    buffer->id = buffer_count.fetch_add(1, std::memory_order_relaxed) + 1;
+    buffer->next = buffers.load(std::memory_order_relaxed);
+    while (!buffers.compare_exchange_weak(buffer->next, buffer,
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed))
+    {
+    }
+    local_buffer = buffer;
+    return buffer;
+}
+
+/// @brief Appends a string as a JSON string literal.
+void append_string(std::string& out, const char* text)
+{
+    out += '"';
+    for (const char* c = text; *c != '\0'; ++c)
+    {
+        unsigned char byte = *c;
+        if (byte == '"' || byte == '\\')
+        {
+            out += '\\';
+            out += *c;
+        }
+        else if (byte < 0x20)
+        {
+            char escape[8];
+            std::snprintf(escape, sizeof(escape), "\\u%04x", byte);
+            out += escape;
+        }
+        else
+        {
+            out += *c;
+        }
+    }
+    out += '"';
+}
+
+}; // namespace
+
+std::atomic<bool> Trace::enabled{false};
+std::atomic<bool> Trace::write_requested{false};
+std::string Trace::path;
+
+void Trace::start(const std::string& path)
+{
+    Trace::path = path;
+    origin = std::chrono::steady_clock::now();
+    enabled.store(true, std::memory_order_relaxed);
+}
+
+void Trace::name_thread(const char* name) noexcept
+{
+    if (!is_enabled())
+        return;
+    try
+    {
+        get_buffer()->thread_name.store(name, std::memory_order_relaxed);
+    }
+    catch (std::bad_alloc&)
+    {
+    }
+}
+
+int64_t Trace::now() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - origin).count();
+}
+
+void Trace::record(const char* name, const char* detail, int64_t start,
+                   int64_t end) noexcept
+{
+    Buffer* buffer;
+    try
+    {
+        buffer = get_buffer();
+    }
+    catch (std::bad_alloc&)
+    {
+        return;
+    }
+
+    uint64_t index = buffer->written.load(std::memory_order_relaxed);
+    Event& event = buffer->events[index % buffer_capacity];
+    event.name.store(name, std::memory_order_relaxed);
+    event.detail.store(detail, std::memory_order_relaxed);
+    event.start.store(start, std::memory_order_relaxed);
+    event.duration.store(end - start, std::memory_order_relaxed);
+    buffer->written.store(index + 1, std::memory_order_release);
+}
+
+void Trace::write()
+{
+    std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    long pid = getpid();
+    bool is_first = true;
+    char number[96];
+    auto begin_event = [&](const char* name)
+    {
+        out += is_first ? "\n{\"name\":" : ",\n{\"name\":";
+        is_first = false;
+        append_string(out, name);
+    };
+
+    for (Buffer* buffer = buffers.load(std::memory_order_acquire); buffer;
+         buffer = buffer->next)
+    {
+        if (const char* name
+                = buffer->thread_name.load(std::memory_order_relaxed))
+        {
+            begin_event("thread_name");
+            std::snprintf(number, sizeof(number),
+                          ",\"ph\":\"M\",\"pid\":%ld,\"tid\":%u,"
+                          "\"args\":{\"name\":",
+                          pid, buffer->id);
+            out += number;
+            append_string(out, name);
+            out += "}}";
+        }
+
+        // Copies the spans, then drops any which the thread may have
+        // overwritten meanwhile.
+        uint64_t end = buffer->written.load(std::memory_order_acquire);
+        uint64_t first = end > buffer_capacity ? end - buffer_capacity : 0;
+        struct Copy
+        {
+            const char* name;
+            const char* detail;
+            int64_t start;
+            int64_t duration;
+        };
+        std::vector<Copy> copies;
+        copies.reserve(end - first);
+        for (uint64_t i = first; i < end; ++i)
+        {
+            const Event& event = buffer->events[i % buffer_capacity];
+            copies.push_back({event.name.load(std::memory_order_relaxed),
+                              event.detail.load(std::memory_order_relaxed),
+                              event.start.load(std::memory_order_relaxed),
+                              event.duration.load(std::memory_order_relaxed)});
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t after = buffer->written.load(std::memory_order_relaxed);
+        uint64_t valid = after >= buffer_capacity
+                             ? after - buffer_capacity + 1
+                             : 0;
+
+        for (uint64_t i = std::max(first, valid); i < end; ++i)
+        {
+            const Copy& copy = copies[i - first];
+            begin_event(copy.name);
+            std::snprintf(number, sizeof(number),
+                          ",\"cat\":\"gelcube\",\"ph\":\"X\",\"ts\":%.3f,"
+                          "\"dur\":%.3f,\"pid\":%ld,\"tid\":%u",
+                          copy.start / 1e3, copy.duration / 1e3, pid,
+                          buffer->id);
+            out += number;
+            if (copy.detail)
+            {
+                out += ",\"args\":{\"detail\":";
+                append_string(out, copy.detail);
+                out += '}';
+            }
+            out += '}';
+        }
+    }
+    out += "\n]}\n";
+
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file)
+        throw std::system_error(errno, std::generic_category(), path);
+    bool is_written = std::fwrite(out.data(), 1, out.size(), file)
+                      == out.size();
+    int error = errno;
+    if (std::fclose(file) != 0 && is_written)
+    {
+        is_written = false;
+        error = errno;
+    }
+    if (!is_written)
+        throw std::system_error(error, std::generic_category(), path);
+}
+
+}; // namespace gelcube
@@ -0,0 +1,133 @@
+/// @file trace.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Span tracing in the Chrome trace event format.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_TRACE_HH_
+#define GELCUBE_SRC_TRACE_HH_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace gelcube
+{
+
+/// @brief Records timed spans of work on every thread.
+/// Spans are recorded into a ring buffer per thread, which only its thread
+/// writes to, so recording takes no locks; the most recent spans of each
+/// thread are kept. The trace is written as Chrome trace event JSON, which
+/// Perfetto and chrome://tracing display as a timeline per thread. While
+/// tracing is disabled, a span costs one relaxed load and a branch.
+typedef class Trace
+{
+public:
+    /// @brief Times the enclosing scope.
+    typedef class Span
+    {
+    public:
+        /// @brief Starts a span, if tracing is enabled.
+        /// @param name Name of the span; must outlive the program, e.g. a
+        ///             string literal.
+        /// @param detail Text shown with the span, e.g. the title of a panel,
+        ///               or nullptr; must outlive the program.
+        inline explicit Span(const char* name,
+                             const char* detail = nullptr) noexcept
+            : name{name}, detail{detail}
+        {
+            if (enabled.load(std::memory_order_relaxed))
+                start = now();
+        }
+
+        inline ~Span()
+        {
+            if (start >= 0)
+                record(name, detail, start, now());
+        }
+
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+    private:
+        const char* name;
+        const char* detail;
+        int64_t start = -1;
+    } Span;
+
+    /// @brief Number of spans kept per thread.
+    static constexpr uint64_t buffer_capacity = uint64_t{1} << 15;
+
+    /// @brief Starts recording spans.
+    /// @param path File to write the trace to (see write()).
+    static void start(const std::string& path);
+
+    /// @brief Checks whether spans are being recorded.
+    /// @return true if started.
+    static inline bool is_enabled() noexcept
+    {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Names the calling thread in the trace.
+    /// @param name Name; must outlive the program, e.g. a string literal.
+    static void name_thread(const char* name) noexcept;
+
+    /// @brief Requests that the trace be written.
+    /// Async-signal-safe, for use as a signal handler.
+    /// @param sig_num Signal number for sighandler_t.
+    static inline void request_write(int sig_num = 0) noexcept
+    {
+        write_requested.store(true, std::memory_order_relaxed);
+    }
+
+    /// @brief Checks for and clears a request to write the trace.
+    /// @return true if request_write() was called since the last check.
+    static inline bool take_write_request() noexcept
+    {
+        return write_requested.exchange(false, std::memory_order_relaxed);
+    }
+
+    /// @brief Writes the spans recorded so far to the file given to start().
+    /// Spans may be recorded on other threads meanwhile; those still being
+    /// recorded are left out.
+    /// @throw std::system_error if the file cannot be written.
+    static void write();
+
+    /// @brief Stops recording spans.
+    static inline void stop() noexcept
+    {
+        enabled.store(false, std::memory_order_relaxed);
+    }
+
+private:
+    /// @brief Gets the time since tracing started.
+    /// @return Time in nanoseconds.
+    static int64_t now() noexcept;
+
+    /// @brief Appends a span to the calling thread's buffer.
+    static void record(const char* name, const char* detail, int64_t start,
+                       int64_t end) noexcept;
+
+    static std::atomic<bool> enabled;
+    static std::atomic<bool> write_requested;
+    static std::string path;
+} Trace;
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_TRACE_HH_
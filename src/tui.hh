@@ -55,6 +55,11 @@ private:
     /// without its window being initialized.
     class NoWindowException;
 
+    /// @brief Deletes ncurses windows owned by std::unique_ptr.
+    /// Windows are owned as std::unique_ptr<WINDOW, WindowDeleter> so that
+    /// they are deleted however their owner is destroyed or replaced.
+    struct WindowDeleter;
+
     /// @brief Wrapper for ncurses window.
     /// UI element with runtime-modifyable dimensions.
     class Panel;
@@ -67,7 +72,20 @@ private:
     /// Continuously handles the UI.
     class MainLoop;
 
+    /// @brief Line for typing a query which opens a matching character.
+    /// Shown on the bottom line of the terminal, over the panels.
+    class FilterBar;
+
+    /// @brief Presents the open character in the panels.
+    /// Maps character fields to the panels which display them.
+    class CharacterView;
+
     static Logger::Source log;
+
+    // Times the UI classes without a terminal (bench/gelcube.cc).
+    friend class Benchmarks;
+    // Checks that the UI's memory stays bounded (bench/soak.cc).
+    friend class Soak;
 } Tui;
 
 }; // namespace gelcube
@@ -0,0 +1,224 @@
+/// @file character_view.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Presents the open character in the panels.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "../character.hh"
+#include "../encounter.hh"
+#include "../initiative_tracker.hh"
+#include "../intl.hh"
+#include "../inventory.hh"
+#include "../roster.hh"
+#include "character_view.hh"
+#include "panel_manager.hh"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <initializer_list>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gelcube
+{
+
+namespace
+{
+
+/// @brief Checks whether a string starts with a prefix.
+inline bool starts_with(const std::string& s, const char* prefix) noexcept
+{
+    return s.rfind(prefix, 0) == 0;
+}
+
+/// @brief Checks whether a string is one of a set of keys.
+inline bool is_any_of(const std::string& s,
+                      std::initializer_list<const char*> keys) noexcept
+{
+    return std::any_of(keys.begin(), keys.end(),
+                       [&](const char* key) { return s == key; });
+}
+
+/// @brief Formats an amount in hundredths, omitting trailing zeros.
+std::string format_hundredths(int64_t amount)
+{
+    std::string result = amount < 0 ? "-" : "";
+    int64_t magnitude = std::llabs(amount);
+    result += std::to_string(magnitude / 100);
+    int64_t fraction = magnitude % 100;
+    if (fraction != 0)
+    {
+        result += '.';
+        result += static_cast<char>('0' + fraction / 10);
+        if (fraction % 10 != 0)
+            result += static_cast<char>('0' + fraction % 10);
+    }
+    return result;
+}
+
+}; // namespace
+
+size_t Tui::CharacterView::panel_for(const std::string& key) noexcept
+{
+    if (is_any_of(key, {"name", "race", "class", "level", "background",
+                        "alignment"}))
+    {
+        return PanelManager::name;
+    }
+    if (starts_with(key, "spell"))
+        return PanelManager::magic;
+    if (starts_with(key, "attack") || starts_with(key, "weapon"))
+        return PanelManager::attacks;
+    if (Inventory::is_item(key))
+        return PanelManager::inventory;
+    if (is_any_of(key, {"hp", "max_hp", "temp_hp", "ac", "initiative",
+                        "speed"})
+        || starts_with(key, Encounter::effect_prefix))
+    {
+        return PanelManager::combat;
+    }
+    return PanelManager::skills;
+}
+
+std::vector<std::string> Tui::CharacterView::lines(size_t index, int rows)
+{
+    if (index == PanelManager::combat && Encounter::is_active())
+        return turn_order(rows);
+    if (index == PanelManager::inventory)
+        return items(rows);
+
+    const Character* character = Roster::get_open();
+    if (!character)
+        return {};
+
+    if (index == PanelManager::name)
+    {
+        // Summarizes identity on a single line.
+        std::string line;
+        for (const char* key : {"name", "race", "class"})
+        {
+            if (const std::string* detail = character->get_detail(key))
+            {
+                if (!line.empty())
+                    line += ' ';
+                line += *detail;
+            }
+        }
+        if (const int* level = character->get_score("level"))
+            line += ' ' + std::to_string(*level);
+        return {line};
+    }
+
+    std::vector<std::string> result;
+    character->get_scores().for_each([&](const std::string& key, int value)
+    {
+        if (panel_for(key) == index)
+            result.push_back(key + ": " + std::to_string(value));
+    });
+    character->get_details().for_each([&](const std::string& key,
+                                          const std::string& value)
+    {
+        if (panel_for(key) == index)
+            result.push_back(key + ": " + value);
+    });
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::vector<std::string> Tui::CharacterView::items(int rows)
+{
+    const Inventory* inventory = Roster::get_open_inventory();
+    if (!inventory || inventory->size() == 0)
+        return {};
+
+    // Weights are in hundredths of a pound and values in copper pieces, so
+    // formatting in hundredths gives pounds and gold pieces.
+    const Inventory::Totals& totals = inventory->get_contents();
+    std::vector<std::string> result;
+    result.push_back(format_hundredths(totals.weight) + _(" lb, ")
+                     + format_hundredths(totals.value) + _(" gp, ")
+                     + std::to_string(totals.count) + _(" items"));
+
+    size_t count = static_cast<size_t>(std::max(rows - 1, 0));
+    inventory->visit(count, [&](Inventory::Id id, size_t depth)
+    {
+        const Inventory::Item& item = inventory->get(id);
+        std::string line(depth * 2, ' ');
+        line += item.name;
+        if (item.quantity != 1)
+            line += " x" + std::to_string(item.quantity);
+        line += " (" + format_hundredths(inventory->get_totals(id).weight)
+                + _(" lb)");
+        result.push_back(std::move(line));
+    });
+    return result;
+}
+
+std::vector<std::string> Tui::CharacterView::turn_order(int rows)
+{
+    const InitiativeTracker& tracker = Encounter::get_tracker();
+    std::vector<std::string> result;
+    result.push_back(_("Round ") + std::to_string(tracker.get_round()));
+    if (tracker.size() == 0)
+        return result;
+
+    size_t first = tracker.rank(tracker.current());
+    size_t count = std::min(tracker.size(),
+                            static_cast<size_t>(std::max(rows - 1, 0)));
+    for (size_t i = 0; i < count; ++i)
+    {
+        InitiativeTracker::Id id = tracker.at((first + i) % tracker.size());
+        const InitiativeTracker::Combatant& combatant = tracker.get(id);
+        std::string line = (i == 0 ? "> " : "  ")
+                           + std::to_string(combatant.initiative) + " "
+                           + combatant.name;
+
+        // Shows hit points, then lists the combatant's active effects
+        // without their prefix.
+        if (const Character* character = Roster::get(Encounter::get_path(id)))
+        {
+            if (const int* hp = character->get_score("hp"))
+            {
+                line += ' ' + std::to_string(*hp);
+                if (const int* max_hp = character->get_score("max_hp"))
+                    line += '/' + std::to_string(*max_hp);
+                line += _(" hp");
+            }
+            auto append = [&](const std::string& key)
+            {
+                if (starts_with(key, Encounter::effect_prefix))
+                {
+                    line += ' ';
+                    line += key.substr(std::char_traits<char>::length(
+                        Encounter::effect_prefix));
+                }
+            };
+            character->get_scores().for_each(
+                [&](const std::string& key, int) { append(key); });
+            character->get_details().for_each(
+                [&](const std::string& key, const std::string&)
+                { append(key); });
+        }
+        result.push_back(std::move(line));
+    }
+    return result;
+}
+
+}; // namespace gelcube
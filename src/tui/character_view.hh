@@ -0,0 +1,70 @@
+/// @file character_view.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Presents the open character in the panels.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_TUI_CHARACTER_VIEW_HH_
+#define GELCUBE_SRC_TUI_CHARACTER_VIEW_HH_
+
+#include "../tui.hh"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace gelcube
+{
+
+class Tui::CharacterView
+{
+public:
+    /// @brief Gets the panel which displays a character field.
+    /// Used to mark only the affected panels dirty when fields change.
+    /// @param key Name of a score or detail.
+    /// @return Index of the panel in the PanelManager's internal panels
+    ///         vector.
+    static size_t panel_for(const std::string& key) noexcept;
+
+    /// @brief Builds the content of a panel from the open character.
+    /// The Combat panel displays the turn order instead while an encounter is
+    /// running, and the Inventory panel displays the open character's items.
+    /// @param index Index of the panel in the PanelManager's internal panels
+    ///              vector.
+    /// @param rows Number of lines which fit in the panel.
+    /// @return Lines to display, empty if no character is open.
+    static std::vector<std::string> lines(size_t index, int rows);
+
+private:
+    /// @brief Builds the visible window of the open character's items.
+    /// The first line holds the carried totals; only the items which fit are
+    /// visited, so the cost does not depend on the size of the inventory.
+    /// @param rows Number of lines which fit in the panel.
+    /// @return Lines to display.
+    static std::vector<std::string> items(int rows);
+
+    /// @brief Builds the visible window of the encounter's turn order.
+    /// Only the combatants which fit are visited, starting with the combatant
+    /// whose turn it is.
+    /// @param rows Number of lines which fit in the panel.
+    /// @return Lines to display.
+    static std::vector<std::string> turn_order(int rows);
+};
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_TUI_CHARACTER_VIEW_HH_
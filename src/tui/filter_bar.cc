@@ -0,0 +1,148 @@
+/// @file filter_bar.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Line for typing a query which opens a matching character.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "../character_table.hh"
+#include "../intl.hh"
+#include "../query.hh"
+#include "../roster.hh"
+#include "../text_layout.hh"
+#include "filter_bar.hh"
+#include "key_bindings.hh"
+#include "panel_manager.hh"
+#include "window_deleter.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ncurses.h>
+
+namespace gelcube
+{
+
+namespace
+{
+
+const int escape = 27;
+
+}; // namespace
+
+bool Tui::FilterBar::active = false;
+std::string Tui::FilterBar::text;
+std::string Tui::FilterBar::message;
+std::unique_ptr<WINDOW, Tui::WindowDeleter> Tui::FilterBar::window;
+
+void Tui::FilterBar::close() noexcept
+{
+    active = false;
+    window.reset();
+    PanelManager::mark_all_dirty();
+}
+
+void Tui::FilterBar::handle(int ch)
+{
+    switch (ch)
+    {
+    case escape:
+        close();
+        return;
+    case '\n':
+    case '\r':
+    case KEY_ENTER:
+        apply();
+        return;
+    case KEY_BACKSPACE:
+    case 127:
+    case '\b':
+        // Removes a whole UTF-8 character.
+        while (!text.empty() && (text.back() & 0xc0) == 0x80)
+            text.pop_back();
+        if (!text.empty())
+            text.pop_back();
+        break;
+    default:
+        if (ch < ' ' || ch > 0xff)
+            return;
+        text += static_cast<char>(ch);
+        break;
+    }
+    message.clear();
+}
+
+void Tui::FilterBar::draw()
+{
+    if (LINES < 1 || COLS < 1)
+        return;
+    if (!window)
+    {
+        window.reset(newwin(1, COLS, LINES - 1, 0));
+        if (!window)
+            return;
+    }
+    else
+    {
+        wresize(window.get(), 1, COLS);
+        mvwin(window.get(), LINES - 1, 0);
+    }
+
+    WINDOW* bar = window.get();
+    werase(bar);
+    mvwaddch(bar, 0, 0, key_bindings::filter);
+    waddstr(bar, text.c_str());
+    if (!message.empty())
+    {
+        waddstr(bar, "  ");
+        wattron(bar, A_REVERSE);
+        waddstr(bar, message.c_str());
+        wattroff(bar, A_REVERSE);
+    }
+    wmove(bar, 0, std::min(1 + TextLayout::measure(text), COLS - 1));
+    touchwin(bar);
+    wnoutrefresh(bar);
+}
+
+void Tui::FilterBar::apply()
+{
+    std::vector<uint32_t> rows;
+    try
+    {
+        rows = Query(text).run(CharacterTable::from_roster());
+    }
+    catch (Query::ParseException& e)
+    {
+        message = e.what();
+        return;
+    }
+    if (rows.empty())
+    {
+        message = _("no characters match");
+        return;
+    }
+
+    // Moves through the matches when the same query is applied again.
+    auto next = std::upper_bound(rows.begin(), rows.end(),
+                                 Roster::get_open_index());
+    Roster::open(next == rows.end() ? rows.front() : *next);
+    close();
+}
+
+}; // namespace gelcube
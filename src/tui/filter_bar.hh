@@ -0,0 +1,97 @@
+/// @file filter_bar.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Line for typing a query which opens a matching character.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_TUI_FILTER_BAR_HH_
+#define GELCUBE_SRC_TUI_FILTER_BAR_HH_
+
+#include "../tui.hh"
+#include "window_deleter.hh"
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <ncurses.h>
+
+namespace gelcube
+{
+
+class Tui::FilterBar
+{
+public:
+    /// @brief Opens the bar.
+    /// Keeps the text of the last query, so that applying it again opens the
+    /// next match.
+    static inline void open() noexcept
+    {
+        active = true;
+        message.clear();
+    }
+
+    /// @brief Closes the bar.
+    /// Deletes its window and marks the panels under it for redrawing.
+    static void close() noexcept;
+
+    /// @brief Checks whether the bar is open.
+    /// @return true if keys are typed into the bar.
+    static inline bool is_open() noexcept
+    {
+        return active;
+    }
+
+    /// @brief Gets the text of the last query.
+    /// @return Text typed into the bar.
+    static inline const std::string& get_text() noexcept
+    {
+        return text;
+    }
+
+    /// @brief Sets the text of the last query, e.g. to resume a session.
+    /// @param query Text to show when the bar is next opened.
+    static inline void set_text(std::string_view query)
+    {
+        text = query;
+    }
+
+    /// @brief Handles a key typed into the bar.
+    /// Enter runs the query (see gelcube::Query) over the roster and opens
+    /// the first matching character after the open one, closing the bar;
+    /// Escape closes the bar. Errors are shown after the query.
+    /// @param ch Key read by ncurses.
+    static void handle(int ch);
+
+    /// @brief Draws the bar on the bottom line of the terminal.
+    /// Must be drawn after everything else, as it holds the cursor.
+    static void draw();
+
+private:
+    /// @brief Runs the query and opens the next match.
+    static void apply();
+
+    static bool active;
+    static std::string text;
+    // Error or status shown after the text.
+    static std::string message;
+    static std::unique_ptr<WINDOW, WindowDeleter> window;
+};
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_TUI_FILTER_BAR_HH_
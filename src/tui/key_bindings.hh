@@ -28,6 +28,13 @@ namespace key_bindings
 {
 
 const int quit = static_cast<int>('q');
+const int undo = static_cast<int>('u');
+const int redo = 0x12; // ^R
+const int encounter = static_cast<int>('i');
+const int next_turn = static_cast<int>('n');
+const int delay_turn = static_cast<int>('d');
+const int latency = static_cast<int>('l');
+const int filter = static_cast<int>('/');
 
 namespace modifiers
 {
@@ -18,96 +18,635 @@
 /// You should have received a copy of the GNU General Public License
 /// along with this program. If not, see <https://www.gnu.org/licenses/>.
 
+#include "../character_file.hh"
+#include "../content_cache.hh"
+#include "../encounter.hh"
+#include "../file_watcher.hh"
+#include "../frame_arena.hh"
+#include "../input_recording.hh"
 #include "../intl.hh"
+#include "../latency_histogram.hh"
+#include "../logger.hh"
+#include "../roster.hh"
+#include "../session_state.hh"
+#include "../session_client.hh"
 #include "../signal.hh"
+#include "../terminal_writer.hh"
+#include "../trace.hh"
+#include "../worker_pool.hh"
+#include "character_view.hh"
+#include "filter_bar.hh"
 #include "key_bindings.hh"
 #include "main_loop.hh"
 #include "panel_manager.hh"
+#include "window_deleter.hh"
 
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <chrono>
 #include <csignal>
+#include <exception>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <system_error>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include <ncurses.h>
+#include <poll.h>
+#include <unistd.h>
 
 namespace modifiers = gelcube::key_bindings::modifiers;
 
 namespace gelcube
 {
 
+namespace
+{
+
+// Interval between redraws of progress indicators.
+const int progress_interval_ms = 100;
+
+}; // namespace
+
 volatile sig_atomic_t Tui::MainLoop::done = false;
 bool Tui::MainLoop::invalid_resize = false;
 std::unordered_map<int, bool> Tui::MainLoop::modifier_map;
+std::vector<Tui::MainLoop::Source> Tui::MainLoop::sources;
+FileWatcher* Tui::MainLoop::file_watcher = nullptr;
+std::chrono::steady_clock::time_point Tui::MainLoop::input_time;
+LatencyHistogram Tui::MainLoop::latency;
+bool Tui::MainLoop::show_latency = false;
+std::unique_ptr<WINDOW, Tui::WindowDeleter> Tui::MainLoop::latency_overlay;
+std::string Tui::MainLoop::resume_path;
+std::vector<std::shared_ptr<WorkerPool::Task>> Tui::MainLoop::roster_loads;
 
 void Tui::MainLoop::start()
 {
-    std::vector<Signal*> signals = {
-        new Signal(stop, {SIGINT})
-    };
+    Signal interrupt(stop, {SIGINT});
+
+    // Writes the trace on demand, e.g. after a slow frame.
+    std::unique_ptr<Signal> trace_request;
+    if (Trace::is_enabled())
+    {
+        Trace::name_thread("ui");
+        trace_request.reset(new Signal(Trace::request_write, {SIGUSR1}));
+    }
+
+    // Watches the roster's directories for external changes.
+    std::unique_ptr<FileWatcher> watcher;
+    if (!Roster::get_directories().empty())
+    {
+        try
+        {
+            watcher = std::make_unique<FileWatcher>();
+            for (auto& directory : Roster::get_directories())
+                watcher->watch(directory);
+            file_watcher = watcher.get();
+            add_source(watcher->get_fd(), reload_changed_files);
+        }
+        catch (std::exception& e)
+        {
+            BOOST_LOG_SEV(log, LogLevel::warning)
+                << _("Cannot watch character files: ") << e.what();
+        }
+    }
+
+    // Completes background work on the UI thread.
+    if (WorkerPool::get_fd() >= 0)
+        add_source(WorkerPool::get_fd(), drain_completions);
+
+    // Shows the characters of the other programs in the session.
+    if (SessionClient::get_fd() >= 0)
+        add_source(SessionClient::get_fd(), receive_session_changes);
+    load_roster();
+
+    // Input is read only when available so that event sources are not
+    // starved by a blocking getch().
+    nodelay(stdscr, TRUE);
 
     try_panel_update();
+    restore_state();
+    TerminalWriter::update();
+
+    // Recorded and replayed sessions roll the same initiative.
+    if (InputRecording::get_mode() != InputRecording::Mode::off)
+        Encounter::seed(InputRecording::get_seed());
+    if (InputRecording::get_mode() == InputRecording::Mode::replay)
+    {
+        replay();
+        hide_latency_overlay();
+        FilterBar::close();
+        sources.clear();
+        file_watcher = nullptr;
+        return;
+    }
+    InputRecording::begin(LINES, COLS);
 
-    int ch;
     while (!done)
+        run_frame();
+
+    hide_latency_overlay();
+    FilterBar::close();
+    sources.clear();
+    file_watcher = nullptr;
+    roster_loads.clear();
+}
+
+void Tui::MainLoop::run_frame()
+{
+    wait_for_events();
+    Trace::Span span("MainLoop::run_frame");
+    uint64_t keys = 0;
+    int ch;
+    while (!done && (ch = getch()) != ERR)
     {
-        ch = getch();
-        if (!invalid_resize)
+        InputRecording::capture(ch, LINES, COLS);
+        dispatch(ch);
+        ++keys;
+    }
+    SessionClient::flush();
+    save_state();
+    if (!invalid_resize)
+        PanelManager::redraw_dirty();
+
+    // Drawn last so that they stay on top of the panels.
+    if (show_latency && !invalid_resize)
+        draw_latency_overlay();
+    if (FilterBar::is_open() && !invalid_resize)
+        FilterBar::draw();
+    TerminalWriter::update();
+    FrameArena::reset();
+
+    // Every key read in this frame reached the screen together, once the
+    // update has been sent to the terminal.
+    if (keys > 0)
+        record_latency(input_time, keys);
+
+    if (Trace::take_write_request())
+    {
+        try
         {
-            switch (ch)
+            Trace::write();
+        }
+        catch (std::system_error& e)
+        {
+            BOOST_LOG_SEV(log, LogLevel::warning)
+                << _("Cannot write trace: ") << e.what();
+        }
+    }
+}
+
+void Tui::MainLoop::wait_for_events(int max_timeout)
+{
+    // Replays ignore the keyboard, which poll() skips as a negative fd.
+    bool is_replay
+        = InputRecording::get_mode() == InputRecording::Mode::replay;
+    std::pmr::vector<pollfd> fds(sources.size() + 1, FrameArena::get());
+    fds[0] = {is_replay ? -1 : STDIN_FILENO, POLLIN, 0};
+    for (size_t i = 0; i < sources.size(); ++i)
+        fds[i + 1] = {sources[i].fd, POLLIN, 0};
+
+    // Changes which could not be sent are retried at the same interval.
+    int timeout = PanelManager::is_tracking() || SessionClient::has_pending()
+        ? progress_interval_ms : -1;
+    if (max_timeout >= 0)
+        timeout = timeout < 0 ? max_timeout : std::min(timeout, max_timeout);
+    int ready_count = poll(fds.data(), fds.size(), timeout);
+
+    // Stamps input as it arrives. Signals such as SIGWINCH interrupt poll()
+    // and are read as keys too.
+    if (ready_count < 0 || (fds[0].revents & POLLIN))
+        input_time = std::chrono::steady_clock::now();
+    if (ready_count < 0)
+        return;
+
+    // Handlers may remove sources, so the ready ones are collected first.
+    std::pmr::vector<void (*)()> ready(FrameArena::get());
+    for (size_t i = 0; i < sources.size(); ++i)
+    {
+        if (fds[i + 1].revents & (POLLIN | POLLHUP))
+            ready.push_back(sources[i].handler);
+    }
+    for (auto handler : ready)
+        handler();
+}
+
+void Tui::MainLoop::dispatch(int ch)
+{
+    Trace::Span span("MainLoop::dispatch");
+    // Keys other than resizes are typed into the open filter bar.
+    if (FilterBar::is_open() && ch != KEY_RESIZE && !invalid_resize)
+    {
+        FilterBar::handle(ch);
+
+        // The character the user opens is not replaced by the saved one.
+        if (!FilterBar::is_open())
+            resume_path.clear();
+        return;
+    }
+
+    if (!invalid_resize)
+    {
+        switch (ch)
+        {
+        // Resizes panels.
+        case KEY_RESIZE:
+            hide_latency_overlay();
+            try_panel_update();
+            break;
+
+        // Shows or hides input latency.
+        case key_bindings::latency:
+            show_latency = !show_latency;
+            if (!show_latency)
             {
-            // Resizes panels.
-            case KEY_RESIZE:
-                try_panel_update();
-                break;
+                hide_latency_overlay();
+                PanelManager::mark_all_dirty();
+            }
+            break;
 
-            // Exits the loop.
-            case key_bindings::quit:
-                stop();
-                break;
+        // Opens the filter bar.
+        case key_bindings::filter:
+            FilterBar::open();
+            break;
 
-            // Enters panel selection mode.
-            case modifiers::go:
-                check_start_panel_selection();
-                break;
+        // Exits the loop.
+        case key_bindings::quit:
+            stop();
+            break;
 
-            // Selects the current panel by index.
-            case static_cast<int>('1'):
-                check_select_panel(0);
-                break;
-            case static_cast<int>('2'):
-                check_select_panel(1);
-                break;
-            case static_cast<int>('3'):
-                check_select_panel(2);
-                break;
-            case static_cast<int>('4'):
-                check_select_panel(3);
-                break;
-            case static_cast<int>('5'):
-                check_select_panel(4);
-                break;
+        // Reverts or reapplies changes to the open character.
+        case key_bindings::undo:
+            show_change(Roster::undo());
+            break;
+        case key_bindings::redo:
+            show_change(Roster::redo());
+            break;
 
-            // Clears modifiers.
-            default:
-                check_select_panel(PanelManager::get_last_selected_index());
-                break;
+        // Manages the turn order of the encounter.
+        case key_bindings::encounter:
+            if (Encounter::is_active())
+                Encounter::end();
+            else
+                Encounter::start();
+            PanelManager::mark_dirty(PanelManager::combat);
+            break;
+        case key_bindings::next_turn:
+            // Redraws only the panels showing expired effects.
+            for (auto& change : Encounter::next_turn())
+                show_change(change);
+            PanelManager::mark_dirty(PanelManager::combat);
+            break;
+        case key_bindings::delay_turn:
+            Encounter::delay();
+            PanelManager::mark_dirty(PanelManager::combat);
+            break;
+
+        // Enters panel selection mode.
+        case modifiers::go:
+            check_start_panel_selection();
+            break;
+
+        // Selects the current panel by index.
+        case static_cast<int>('1'):
+            check_select_panel(0);
+            break;
+        case static_cast<int>('2'):
+            check_select_panel(1);
+            break;
+        case static_cast<int>('3'):
+            check_select_panel(2);
+            break;
+        case static_cast<int>('4'):
+            check_select_panel(3);
+            break;
+        case static_cast<int>('5'):
+            check_select_panel(4);
+            break;
+        case static_cast<int>('6'):
+            check_select_panel(5);
+            break;
+
+        // Clears modifiers.
+        default:
+            check_select_panel(PanelManager::get_last_selected_index());
+            break;
+        }
+    }
+    else if (ch == KEY_RESIZE)
+    {
+        // Recreates and updates panels if the last resize operation failed.
+        try
+        {
+            PanelManager::create();
+            PanelManager::update();
+            invalid_resize = false;
+        }
+        catch (SizeException& e)
+        {
+            PanelManager::destroy();
+        }
+    }
+}
+
+void Tui::MainLoop::replay()
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Starts from the state the recording started from: a loaded roster.
+    while (!done && PanelManager::is_tracking())
+    {
+        wait_for_events(progress_interval_ms);
+        if (!invalid_resize)
+            PanelManager::redraw_dirty();
+        TerminalWriter::update();
+        FrameArena::reset();
+    }
+
+    Clock::time_point start = Clock::now();
+    const InputRecording::Event* event;
+    while (!done && (event = InputRecording::next()))
+    {
+        // Handles events from other sources until the key is due.
+        if (InputRecording::is_realtime())
+        {
+            Clock::time_point due = start
+                + std::chrono::microseconds(event->time);
+            for (Clock::time_point now = Clock::now(); now < due;
+                 now = Clock::now())
+            {
+                auto wait = std::chrono::duration_cast<
+                    std::chrono::milliseconds>(due - now).count();
+                wait_for_events(static_cast<int>(wait) + 1);
+                if (!invalid_resize)
+                    PanelManager::redraw_dirty();
+                TerminalWriter::update();
+                FrameArena::reset();
             }
         }
-        else if (ch == KEY_RESIZE)
+        else
+        {
+            wait_for_events(0);
+        }
+
+        Clock::time_point received = Clock::now();
+        if (event->key == KEY_RESIZE)
+            resize_term(event->lines, event->columns);
+        dispatch(event->key);
+        if (!invalid_resize)
+            PanelManager::redraw_dirty();
+        if (show_latency && !invalid_resize)
+            draw_latency_overlay();
+        if (FilterBar::is_open() && !invalid_resize)
+            FilterBar::draw();
+        TerminalWriter::update();
+        FrameArena::reset();
+        InputRecording::add_latency(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                Clock::now() - received).count());
+        record_latency(received, 1);
+    }
+}
+
+void Tui::MainLoop::record_latency(
+    std::chrono::steady_clock::time_point arrival, uint64_t keys)
+{
+    auto elapsed = std::chrono::steady_clock::now() - arrival;
+    latency.record(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+        keys);
+}
+
+void Tui::MainLoop::draw_latency_overlay()
+{
+    std::pmr::string line(" p50 ", FrameArena::get());
+    format_latency(line, latency.percentile(50));
+    line += "  p99 ";
+    format_latency(line, latency.percentile(99));
+    line += "  max ";
+    format_latency(line, latency.get_max());
+    line += ' ';
+    int width = static_cast<int>(line.size());
+    if (width + 2 > COLS || LINES < 1)
+        return;
+
+    if (!latency_overlay)
+    {
+        latency_overlay.reset(newwin(1, width, LINES - 1, COLS - width - 1));
+        if (!latency_overlay)
+            return;
+        leaveok(latency_overlay.get(), TRUE);
+    }
+    else
+    {
+        // Percentiles may need more columns as they grow.
+        wresize(latency_overlay.get(), 1, width);
+        mvwin(latency_overlay.get(), LINES - 1, COLS - width - 1);
+    }
+
+    WINDOW* window = latency_overlay.get();
+    werase(window);
+    wattron(window, A_REVERSE);
+    mvwaddstr(window, 0, 0, line.c_str());
+    wattroff(window, A_REVERSE);
+    touchwin(window);
+    wnoutrefresh(window);
+}
+
+void Tui::MainLoop::hide_latency_overlay() noexcept
+{
+    latency_overlay.reset();
+}
+
+void Tui::MainLoop::format_latency(std::pmr::string& text,
+                                   uint64_t nanoseconds)
+{
+    char number[32];
+    if (nanoseconds < 1000000)
+        std::snprintf(number, sizeof(number), "%lluus",
+                      static_cast<unsigned long long>(nanoseconds / 1000));
+    else
+        std::snprintf(number, sizeof(number), "%.1fms", nanoseconds / 1e6);
+    text += number;
+}
+
+void Tui::MainLoop::restore_state()
+{
+    if (!SessionState::is_open())
+        return;
+
+    // Deselecting a panel makes it the previously selected one.
+    size_t selected = SessionState::get_selected_index();
+    size_t last_selected = SessionState::get_last_selected_index();
+    if (!invalid_resize && selected < PanelManager::panel_count
+        && last_selected < PanelManager::panel_count
+        && (selected != PanelManager::get_selected_index()
+            || last_selected != PanelManager::get_last_selected_index()))
+    {
+        PanelManager::deselect(PanelManager::get_selected_index());
+        PanelManager::deselect(last_selected);
+        PanelManager::select(selected);
+    }
+
+    show_latency = SessionState::get_show_latency();
+    FilterBar::set_text(SessionState::get_query());
+    resume_path = SessionState::get_open_path();
+}
+
+void Tui::MainLoop::save_state() noexcept
+{
+    if (!SessionState::is_open())
+        return;
+
+    // Panels are recreated with the first selected after a failed resize.
+    if (!invalid_resize)
+    {
+        SessionState::set_selection(PanelManager::get_selected_index(),
+                                    PanelManager::get_last_selected_index());
+    }
+    SessionState::set_show_latency(show_latency);
+    SessionState::set_query(FilterBar::get_text());
+
+    // Characters are loaded in the background, so the saved one is kept
+    // until it appears or the roster has loaded without it.
+    if (!resume_path.empty())
+    {
+        bool loading = false;
+        for (auto& task : roster_loads)
+            loading = loading || !task->is_done();
+        if (Roster::open(resume_path))
+            PanelManager::mark_all_dirty();
+        else if (loading)
+            return;
+        resume_path.clear();
+        roster_loads.clear();
+    }
+    const auto& entries = Roster::get_entries();
+    if (!entries.empty())
+        SessionState::set_open_path(entries[Roster::get_open_index()].path);
+}
+
+void Tui::MainLoop::load_roster()
+{
+    roster_loads.clear();
+    for (auto& directory : Roster::get_directories())
+    {
+        auto task = WorkerPool::submit([directory](WorkerPool::Task& task)
+            -> WorkerPool::Completion
         {
-            // Recreates and updates panels if the last resize operation failed.
-            try
+            Logger::Source log = Logger::source;
+            std::vector<std::string> files = Roster::list_files(directory);
+            auto characters = std::make_shared<
+                std::vector<std::pair<std::string, Character>>>();
+            ContentCache cache(directory);
+            for (size_t i = 0; i < files.size(); ++i)
             {
-                PanelManager::create();
-                PanelManager::update();
-                invalid_resize = false;
+                if (task.is_cancelled())
+                    return nullptr;
+                try
+                {
+                    characters->emplace_back(files[i],
+                                             cache.read(files[i]));
+                }
+                catch (CharacterFile::ReadException& e)
+                {
+                    BOOST_LOG_SEV(log, LogLevel::error) << e.what();
+                }
+                task.set_progress(static_cast<double>(i + 1) / files.size());
             }
-            catch (SizeException& e)
+            cache.publish();
+
+            return [characters]
             {
-                PanelManager::destroy();
+                for (auto& character : *characters)
+                {
+                    show_change(Roster::add(character.first,
+                                            std::move(character.second)));
+                }
+            };
+        });
+        PanelManager::track(PanelManager::name, task);
+        roster_loads.push_back(task);
+    }
+}
+
+void Tui::MainLoop::reload_changed_files()
+{
+    Trace::Span span("MainLoop::reload_changed_files");
+    for (auto& path : file_watcher->read_changes())
+        show_change(Roster::reload(path));
+    if (file_watcher->has_overflowed())
+        rescan_roster();
+}
+
+void Tui::MainLoop::rescan_roster()
+{
+    std::vector<std::string> paths;
+    for (auto& directory : Roster::get_directories())
+    {
+        try
+        {
+            std::vector<std::string> files = Roster::list_files(directory);
+            paths.insert(paths.end(), files.begin(), files.end());
+        }
+        catch (std::system_error& e)
+        {
+            BOOST_LOG_SEV(log, LogLevel::warning)
+                << _("Cannot rescan character files: ") << e.what();
+            return;
+        }
+    }
+
+    // Characters from the session are not the roster's to unload.
+    std::unordered_set<std::string> listed(paths.begin(), paths.end());
+    for (auto& entry : Roster::get_entries())
+    {
+        if (listed.count(entry.path))
+            continue;
+        for (auto& directory : Roster::get_directories())
+        {
+            if (entry.path.size() > directory.size()
+                && entry.path.compare(0, directory.size(), directory) == 0
+                && entry.path[directory.size()] == '/')
+            {
+                paths.push_back(entry.path);
+                break;
             }
         }
     }
+    for (auto& path : paths)
+        show_change(Roster::reload(path));
+}
+
+void Tui::MainLoop::receive_session_changes()
+{
+    Trace::Span span("MainLoop::receive_session_changes");
+    int fd = SessionClient::get_fd();
+    for (auto& change : SessionClient::receive())
+        show_change(change);
+    if (SessionClient::get_fd() < 0)
+        remove_source(fd);
+}
+
+void Tui::MainLoop::show_change(const Roster::Change& change)
+{
+    SessionClient::publish(change);
+    Encounter::update(change);
+    if (change.is_open)
+    {
+        for (auto& key : change.keys)
+            PanelManager::mark_dirty(CharacterView::panel_for(key));
+    }
+
+    // The turn order shows the hit points and effects of every combatant.
+    if (Encounter::is_active() && !change.keys.empty())
+        PanelManager::mark_dirty(PanelManager::combat);
 }
 
 }; // namespace gelcube
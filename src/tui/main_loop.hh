@@ -21,13 +21,25 @@
 #ifndef GELCUBE_SRC_TUI_MAIN_LOOP_HH_
 #define GELCUBE_SRC_TUI_MAIN_LOOP_HH_
 
+#include "../file_watcher.hh"
+#include "../latency_histogram.hh"
+#include "../roster.hh"
 #include "../tui.hh"
+#include "../worker_pool.hh"
 #include "key_bindings.hh"
 #include "panel_manager.hh"
+#include "window_deleter.hh"
 
+#include <algorithm>
+#include <chrono>
 #include <csignal>
 #include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <ncurses.h>
 
@@ -46,6 +58,26 @@ public:
     ///        window has not been created.
     static void start();
 
+    /// @brief Registers an event source polled alongside user input.
+    /// The handler is called on the UI thread whenever the file descriptor
+    /// becomes readable, before pending input is processed.
+    /// @param fd File descriptor to poll.
+    /// @param handler Function reading from the file descriptor.
+    static inline void add_source(int fd, void (*handler)())
+    {
+        sources.push_back({fd, handler});
+    }
+
+    /// @brief Unregisters an event source.
+    /// @param fd File descriptor passed to add_source().
+    static inline void remove_source(int fd)
+    {
+        sources.erase(std::remove_if(sources.begin(), sources.end(),
+                                     [fd](const Source& source)
+                                     { return source.fd == fd; }),
+                      sources.end());
+    }
+
     /// @brief Stops the main UI loop.
     /// Used internally as a signal handler and for exit actions.
     /// @param sig_num Signal number for sighandler_t.
@@ -55,6 +87,100 @@ public:
     }
 
 private:
+    /// @brief Event source polled alongside user input.
+    struct Source
+    {
+        int fd;
+        void (*handler)();
+    };
+
+    /// @brief Runs one iteration of the loop.
+    /// Waits for events, processes the input read, redraws what changed and
+    /// frees the frame's scratch memory (see gelcube::FrameArena).
+    static void run_frame();
+
+    /// @brief Blocks until input or an event source is ready.
+    /// Calls the handlers of all ready event sources. Returns early if
+    /// interrupted by a signal, e.g. SIGWINCH on terminal resize, or
+    /// periodically while panels display the progress of background tasks.
+    /// @param max_timeout Longest time to block in milliseconds, or -1 to
+    ///                    block until an event.
+    static void wait_for_events(int max_timeout = -1);
+
+    /// @brief Feeds the keys of a recording to dispatch().
+    /// Redraws after every key and records how long it took.
+    static void replay();
+
+    /// @brief Processes a single input character.
+    /// @param ch Character returned by getch().
+    /// @throw gelcube::Tui::NoWindowException if a panel is updated and its
+    ///        window has not been created.
+    static void dispatch(int ch);
+
+    /// @brief Records the time from input arriving to it being displayed.
+    /// @param arrival Time the input was read.
+    /// @param keys Number of keys read at that time.
+    static void record_latency(std::chrono::steady_clock::time_point arrival,
+                               uint64_t keys);
+
+    /// @brief Draws the percentiles of input latency in the lower
+    ///        right-hand corner of the screen.
+    static void draw_latency_overlay();
+
+    /// @brief Removes the latency overlay's window.
+    /// The panels beneath must be redrawn for it to disappear.
+    static void hide_latency_overlay() noexcept;
+
+    /// @brief Formats a latency for the overlay, e.g. "850us" or "3.1ms".
+    /// @param text String to append the latency to.
+    /// @param nanoseconds Latency to format.
+    static void format_latency(std::pmr::string& text, uint64_t nanoseconds);
+
+    /// @brief Loads the roster's directories in the background.
+    /// Characters are added to the roster on the UI thread once a whole
+    /// directory has been read, from its shared cache where the files are
+    /// unchanged (see gelcube::ContentCache). Progress is displayed on the
+    /// Name panel.
+    static void load_roster();
+
+    /// @brief Runs the completions of finished background tasks.
+    /// Handler for the worker pool event source.
+    static inline void drain_completions()
+    {
+        WorkerPool::drain();
+    }
+
+    /// @brief Reloads character files changed outside of the program.
+    /// Handler for the file watcher event source. Marks only the panels
+    /// displaying changed fields of the open character dirty.
+    static void reload_changed_files();
+
+    /// @brief Reloads every character file of the roster's directories.
+    /// Used when the file watcher lost events; files which no longer exist
+    /// are unloaded.
+    static void rescan_roster();
+
+    /// @brief Applies the changes received from the session hub.
+    /// Handler for the session client event source. Stops polling the hub if
+    /// it has gone away.
+    static void receive_session_changes();
+
+    /// @brief Shares a change with the session and marks the panels
+    ///        displaying it dirty.
+    /// @param change Change returned by the roster.
+    static void show_change(const Roster::Change& change);
+
+    /// @brief Restores the state saved by the last run, if a state file is
+    ///        kept (see gelcube::SessionState).
+    /// Selects the saved panel and restores the last query and the latency
+    /// overlay at once; the saved character is opened once it is loaded.
+    static void restore_state();
+
+    /// @brief Saves the state which changed since the last frame.
+    /// Opens the saved character instead while it is yet to be loaded.
+    /// Allocates nothing.
+    static void save_state() noexcept;
+
     /// @brief Updates PanelManager.
     /// Sets invalid_resize to true, destroys the PanelManager's panels, and
     /// prints a message if a SizeException is thrown.
@@ -71,6 +197,7 @@ private:
             invalid_resize = true;
             PanelManager::destroy();
             mvprintw(0, 0, _("Terminal too small to fit user interface."));
+            wnoutrefresh(stdscr);
         }
     }
 
@@ -108,10 +235,25 @@ private:
         }
     }
 
-    static int ch;
     static volatile sig_atomic_t done;
     static std::unordered_map<int, bool> modifier_map;
     static bool invalid_resize;
+    static std::vector<Source> sources;
+    static FileWatcher* file_watcher;
+    // Time at which the input being processed arrived.
+    static std::chrono::steady_clock::time_point input_time;
+    // Time from input arriving to the refresh displaying its effects.
+    static LatencyHistogram latency;
+    static bool show_latency;
+    static std::unique_ptr<WINDOW, WindowDeleter> latency_overlay;
+    // Path of the saved character, until it is opened, the user opens
+    // another or the roster has loaded without it.
+    static std::string resume_path;
+    // Background loads of the roster's directories started by load_roster().
+    static std::vector<std::shared_ptr<WorkerPool::Task>> roster_loads;
+
+    friend class Benchmarks;
+    friend class Soak;
 };
 
 }; // namespace gelcube
@@ -18,13 +18,20 @@
 /// You should have received a copy of the GNU General Public License
 /// along with this program. If not, see <https://www.gnu.org/licenses/>.
 
+#include "../trace.hh"
 #include "dimensions.hh"
 #include "no_window_exception.hh"
 #include "panel.hh"
 #include "size_exception.hh"
+#include "window_deleter.hh"
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdio>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 #include <ncurses.h>
 
@@ -33,35 +40,61 @@ namespace gelcube
 
 attr_t Tui::Panel::selected_title_attributes = A_BOLD | A_UNDERLINE;
 
-Tui::Panel::Panel(Dimensions* dimensions, const char* title, size_t index,
+Tui::Panel::Panel(Dimensions* dimensions, Symbol title, size_t index,
                   bool selected)
     : dimensions{dimensions}, title{title}, index{index}, selected{selected}
 {
 }
 
-Tui::Panel::~Panel()
+void Tui::Panel::create_window()
 {
-    if (window != nullptr)
+    if (dimensions->height > 0 && dimensions->width > 0)
+    {
+        window.reset(newwin(dimensions->height, dimensions->width,
+                            dimensions->y, dimensions->x));
+        composed = false;
+    }
+    else
     {
-        delwin(window);
+        throw SizeException();
     }
 }
 
-void Tui::Panel::create_window()
+void Tui::Panel::set_content(std::vector<std::string> lines)
 {
-    if (dimensions->height > 0 && dimensions->width > 0)
+    std::vector<TextLayout> layouts;
+    layouts.reserve(lines.size());
+    for (size_t i = 0; i < lines.size(); ++i)
     {
-        if (window != nullptr)
-        {
-            delwin(window);
-        }
-        window = newwin(dimensions->height, dimensions->width,
-                        dimensions->y, dimensions->x);
+        if (i < content.size() && content[i].get_text() == lines[i])
+            layouts.push_back(std::move(content[i]));
+        else
+            layouts.emplace_back(std::move(lines[i]));
     }
-    else
+    content = std::move(layouts);
+    composed = false;
+    dirty = true;
+}
+
+void Tui::Panel::compose()
+{
+    if (composed)
+        return;
+
+    size_t count = static_cast<size_t>(std::max(dimensions->height - 2, 0));
+    int columns = dimensions->width - 4;
+    rows.clear();
+    for (size_t i = 0; i < content.size() && rows.size() < count; ++i)
     {
-        throw SizeException();
+        std::string_view text = content[i].get_text();
+        const auto& wrapped = content[i].wrap(columns, count - rows.size());
+        for (size_t j = 0; j < wrapped.size() && rows.size() < count; ++j)
+        {
+            const TextLayout::Line& line = wrapped[j];
+            rows.push_back(text.substr(line.begin, line.end - line.begin));
+        }
     }
+    composed = true;
 }
 
 void Tui::Panel::draw()
@@ -70,28 +103,55 @@ void Tui::Panel::draw()
     {
         throw NoWindowException();
     }
+    Trace::Span span("Panel::draw", title.c_str());
+
+    werase(window.get());
 
     // Border.
-    box(window, 0, 0); // 0, 0 used for default border characters
+    box(window.get(), 0, 0); // 0, 0 used for default border characters
 
-    // Title.
-    if (selected)
+    // Title, if it fits between the corner and the index label.
+    if (title.get_width() <= dimensions->width - 8)
     {
-        wattron(window, selected_title_attributes);
+        if (selected)
+        {
+            wattron(window.get(), selected_title_attributes);
+        }
+        mvwaddstr(window.get(), 0, 2, title.c_str());
+        if (selected)
+        {
+            wattroff(window.get(), selected_title_attributes);
+        }
     }
-    mvwprintw(window, 0, 2, "%s", title);
-    if (selected)
+
+    // Labels are formatted on the stack, as the panel may be drawn on every
+    // frame.
+    char label[32];
+
+    // Index label.
+    std::snprintf(label, sizeof(label), "[%zu]", index);
+    mvwaddstr(window.get(), 0, dimensions->width - 4, label);
+
+    // Progress indicator.
+    if (progress >= 0)
     {
-        wattroff(window, selected_title_attributes);
+        std::snprintf(label, sizeof(label), "[%3d%%]", progress);
+        mvwaddstr(window.get(), dimensions->height - 1, 2, label);
     }
 
-    // Index label.
-    mvwprintw(window, 0, dimensions->width - 4, "[%zi]", index);
+    // Content.
+    compose();
+    for (size_t row = 0; row < rows.size(); ++row)
+    {
+        mvwaddnstr(window.get(), row + 1, 2, rows[row].data(),
+                   rows[row].size());
+    }
+    dirty = false;
 
     // Cursor position.
     if (selected)
     {
-	    wmove(window, cursor_position.y, cursor_position.x);
+	    wmove(window.get(), cursor_position.y, cursor_position.x);
     }
 }
 
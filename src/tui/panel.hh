@@ -21,13 +21,22 @@
 #ifndef GELCUBE_SRC_TUI_PANEL_HH_
 #define GELCUBE_SRC_TUI_PANEL_HH_
 
+#include "../symbol.hh"
+#include "../text_layout.hh"
+#include "../trace.hh"
 #include "../tui.hh"
 #include "dimensions.hh"
 #include "no_window_exception.hh"
 #include "position.hh"
 #include "size_exception.hh"
+#include "window_deleter.hh"
 
 #include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 #include <ncurses.h>
 
@@ -43,13 +52,9 @@ public:
     /// @param title Visible title.
     /// @param index Associated panel number in the UI.
     /// @param selected Sets the panel to (in)active.
-    Panel(Dimensions* dimensions, const char* title, size_t index,
+    Panel(Dimensions* dimensions, Symbol title, size_t index,
           bool selected = false);
 
-    /// @brief Destroys the Panel object.
-    /// Deletes the window associated with the panel.
-    ~Panel();
-
     /// @brief (Re)creates the panel's window.
     /// Dereferences the dimensions passed to the constructor. Must be called at
     /// least once before refreshing the panel in order for it to be displayed.
@@ -57,14 +62,23 @@ public:
     ///        dimensions is less than 1.
     void create_window();
 
-    /// @brief Draws the border.
-    /// Updates the panel's window object.
+    /// @brief Lays out the content inside the border.
+    /// Wraps the content to the current dimensions into an off-screen buffer
+    /// of rows, if it changed since it was last composed. Makes no ncurses
+    /// calls, so panels may be composed on different threads; a panel must not
+    /// be used by other threads while it is composed.
+    void compose();
+
+    /// @brief Draws the border and content.
+    /// Composes the content if needed, then copies it into the panel's window
+    /// object and clears the dirty flag. Must be called on the UI thread.
     /// @throw gelcube::Tui::NoWindowException if the window has not been
     ///        created.
     void draw();
 
     /// @brief Refreshes the panel contents.
-    /// Updates the displayed window. Must be called for the panel to be
+    /// Stages the window to be displayed at the end of the frame (see
+    /// gelcube::TerminalWriter::update()). Must be called for the panel to be
     /// displayed.
     /// @throw gelcube::Tui::NoWindowException if the window has not been
     ///        created.
@@ -75,7 +89,15 @@ public:
             throw NoWindowException();
         }
 
-        wrefresh(window);
+        Trace::Span span("Panel::refresh", title.c_str());
+        wnoutrefresh(window.get());
+    }
+
+    /// @brief Gets the title of the panel.
+    /// @return Title.
+    inline Symbol get_title() const noexcept
+    {
+        return title;
     }
 
     /// @brief Gets the selection status of the panel.
@@ -99,6 +121,42 @@ public:
         selected = false;
     }
 
+    /// @brief Sets the lines displayed inside the border.
+    /// Lines wider than the panel are wrapped, and those which do not fit are
+    /// left out. Lines which are unchanged keep the breaks computed for them,
+    /// so that redrawing at a new size only wraps what becomes visible. The
+    /// panel is marked dirty and the content will be displayed on the next
+    /// draw.
+    /// @param lines New content.
+    void set_content(std::vector<std::string> lines);
+
+    /// @brief Gets the number of content lines which fit inside the border.
+    /// @return Number of lines, based on the current dimensions.
+    inline int get_content_rows() const noexcept
+    {
+        return dimensions->height - 2;
+    }
+
+    /// @brief Sets the progress indicator displayed on the lower border.
+    /// The panel is marked dirty if the displayed value changes.
+    /// @param percent Progress of work in flight from 0 to 100, or a negative
+    ///                value to hide the indicator.
+    inline void set_progress(int percent) noexcept
+    {
+        if (percent != progress)
+        {
+            progress = percent;
+            dirty = true;
+        }
+    }
+
+    /// @brief Checks whether the panel must be redrawn.
+    /// @return true if the content changed since the last draw.
+    inline bool is_dirty() const noexcept
+    {
+        return dirty;
+    }
+
     /// @brief Sets the cursor position within the panel.
     /// The cursor position, relative to the upper left-hand corner of the
     /// panel's window, will be updated on the next draw.
@@ -127,11 +185,18 @@ public:
 private:
     static attr_t selected_title_attributes;
     Dimensions* dimensions;
-    const char* title;
+    Symbol title;
     size_t index;
     bool selected = false;
-    WINDOW* window = nullptr;
+    // Deleted with the panel.
+    std::unique_ptr<WINDOW, WindowDeleter> window;
     Position cursor_position = {1, 2};
+    std::vector<TextLayout> content;
+    // Rows of content as composed, referring to the text of content.
+    std::vector<std::string_view> rows;
+    bool composed = false;
+    int progress = -1;
+    bool dirty = true;
 };
 
 }; // namespace gelcube
@@ -19,11 +19,18 @@
 /// along with this program. If not, see <https://www.gnu.org/licenses/>.
 
 #include "../intl.hh"
+#include "../memory_accounting.hh"
+#include "../symbol.hh"
+#include "../trace.hh"
+#include "character_view.hh"
 #include "dimensions.hh"
 #include "panel_manager.hh"
 #include "panel.hh"
 
+#include <algorithm>
 #include <cstddef>
+#include <iterator>
+#include <memory>
 #include <vector>
 
 #include <ncurses.h>
@@ -32,22 +39,33 @@ namespace gelcube
 {
 
 Tui::Dimensions Tui::PanelManager::large_left, Tui::PanelManager::middle_upper,
-                Tui::PanelManager::large_right,
+                Tui::PanelManager::right_upper,
                 Tui::PanelManager::middle_middle,
-                Tui::PanelManager::middle_lower;
-std::vector<Tui::Panel*> Tui::PanelManager::panels;
+                Tui::PanelManager::middle_lower,
+                Tui::PanelManager::right_lower;
+std::vector<std::unique_ptr<Tui::Panel>> Tui::PanelManager::panels;
 size_t Tui::PanelManager::selected_index;
 size_t Tui::PanelManager::last_selected_index;
+bool Tui::PanelManager::stale[panel_count];
+std::vector<std::pair<size_t, std::shared_ptr<const WorkerPool::Task>>>
+    Tui::PanelManager::tracked;
 
 void Tui::PanelManager::create()
 {
-    panels = {
-        new Panel(&large_left, _("Magic"), 1, true),
-        new Panel(&middle_upper, _("Combat"), 2),
-        new Panel(&middle_middle, _("Name"), 3),
-        new Panel(&middle_lower, _("Attacks"), 4),
-        new Panel(&large_right, _("Skills"), 5)
-    };
+    panels.clear();
+    panels.reserve(panel_count);
+    panels.push_back(std::make_unique<Panel>(
+        &large_left, Symbol(_("Magic")), 1, true));
+    panels.push_back(std::make_unique<Panel>(
+        &middle_upper, Symbol(_("Combat")), 2));
+    panels.push_back(std::make_unique<Panel>(
+        &middle_middle, Symbol(_("Name")), 3));
+    panels.push_back(std::make_unique<Panel>(
+        &middle_lower, Symbol(_("Attacks")), 4));
+    panels.push_back(std::make_unique<Panel>(
+        &right_upper, Symbol(_("Skills")), 5));
+    panels.push_back(std::make_unique<Panel>(
+        &right_lower, Symbol(_("Inventory")), 6));
 
     selected_index = 0;
     last_selected_index = 0;
@@ -55,46 +73,54 @@ void Tui::PanelManager::create()
 
 void Tui::PanelManager::update()
 {
+    Trace::Span span("PanelManager::update");
     // Height.
     large_left.height = LINES;
-    middle_upper.height = 5;
-    large_right.height = large_left.height;
+    middle_upper.height = std::max(5, (LINES - 3) / 2);
+    right_upper.height = LINES / 2;
     middle_middle.height = 3;
     middle_lower.height = LINES - middle_upper.height
                                 - middle_middle.height;
-    if (middle_lower.height < 3)
+    right_lower.height = LINES - right_upper.height;
+    if (middle_lower.height < 3 || right_upper.height < 3)
     {
         throw SizeException();
     }
     // Width.
     large_left.width = COLS / 2.7;
     middle_upper.width = COLS - (2 * large_left.width);
-    large_right.width = large_left.width;
+    right_upper.width = large_left.width;
     middle_middle.width = middle_upper.width;
     middle_lower.width = middle_upper.width;
+    right_lower.width = right_upper.width;
     // Y.
     large_left.y = 0;
     middle_upper.y = 0;
-    large_right.y = 0;
+    right_upper.y = 0;
     middle_middle.y = middle_upper.height;
     middle_lower.y = middle_upper.height + middle_middle.height;
+    right_lower.y = right_upper.height;
     // X.
     large_left.x = 0;
     middle_upper.x = large_left.width;
-    large_right.x = large_left.width + middle_upper.width;
+    right_upper.x = large_left.width + middle_upper.width;
     middle_middle.x = large_left.width;
     middle_lower.x = large_left.width;
+    right_lower.x = right_upper.x;
 
-    // Completely (re)renders panels.
+    // Completely (re)renders panels, composing their content in parallel.
     // The currently selected panel must be refreshed last for the cursor
     // position to be correct.
     for (auto& panel : panels)
-    {
         panel->create_window();
-        panel->draw();
+    WorkerPool::run_parallel(panels.size(), compose);
+    for (size_t i = 0; i < panels.size(); ++i)
+    {
+        stale[i] = false;
+        panels[i]->draw();
     }
     curs_set(1);
-    refresh();
+    wnoutrefresh(stdscr);
     for (auto& panel : panels)
     {
         if (!panel->is_selected())
@@ -103,4 +129,76 @@ void Tui::PanelManager::update()
     panels.at(selected_index)->refresh();
 }
 
+void Tui::PanelManager::compose(size_t index)
+{
+    MemoryAccounting::Scope scope(MemoryAccounting::Tag::tui);
+    Panel& panel = *panels[index];
+    Trace::Span span("PanelManager::compose", panel.get_title().c_str());
+    panel.set_content(CharacterView::lines(index, panel.get_content_rows()));
+    panel.compose();
+}
+
+void Tui::PanelManager::redraw_dirty()
+{
+    if (panels.empty())
+        return;
+    Trace::Span span("PanelManager::redraw_dirty");
+
+    // Updates progress indicators, removing those of finished tasks.
+    for (auto it = tracked.begin(); it != tracked.end();)
+    {
+        Panel* panel = panels.at(it->first).get();
+        if (it->second->is_done())
+        {
+            panel->set_progress(-1);
+            it = tracked.erase(it);
+        }
+        else
+        {
+            panel->set_progress(it->second->get_progress() / 10);
+            ++it;
+        }
+    }
+
+    // Rebuilds outdated content in parallel; only drawing uses ncurses.
+    size_t stale_count = std::count(std::begin(stale), std::end(stale), true);
+    if (stale_count > 1)
+    {
+        size_t indices[panel_count];
+        size_t count = 0;
+        for (size_t i = 0; i < panels.size(); ++i)
+        {
+            if (stale[i])
+                indices[count++] = i;
+        }
+        WorkerPool::run_parallel(count, [&indices](size_t i)
+        {
+            compose(indices[i]);
+        });
+    }
+
+    bool redrawn = false;
+    for (size_t i = 0; i < panels.size(); ++i)
+    {
+        if (stale[i])
+        {
+            if (stale_count == 1)
+                compose(i);
+            stale[i] = false;
+        }
+        if (panels[i]->is_dirty())
+        {
+            panels[i]->draw();
+            if (i != selected_index)
+                panels[i]->refresh();
+            redrawn = true;
+        }
+    }
+
+    // The currently selected panel must be refreshed last for the cursor
+    // position to be correct.
+    if (redrawn)
+        panels.at(selected_index)->refresh();
+}
+
 }; // namespace gelcube
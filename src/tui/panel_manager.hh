@@ -22,10 +22,14 @@
 #define GELCUBE_SRC_TUI_PANEL_MANAGER_HH_
 
 #include "../tui.hh"
+#include "../worker_pool.hh"
 #include "dimensions.hh"
 #include "panel.hh"
 
+#include <cstddef>
 #include <cstdlib>
+#include <memory>
+#include <utility>
 #include <vector>
 
 namespace gelcube
@@ -34,21 +38,81 @@ namespace gelcube
 class Tui::PanelManager
 {
 public:
+    /// @brief Indices of the panels in the manager's internal panels vector.
+    enum PanelIndex : size_t
+    {
+        magic,
+        combat,
+        name,
+        attacks,
+        skills,
+        inventory,
+        panel_count
+    };
+
     /// @brief Creates all panels.
-    /// Initializes panels with titles and unspecified dimensions.
+    /// Initializes panels with titles and unspecified dimensions, replacing
+    /// and deleting any existing panels and their windows.
     static void create();
 
     /// @brief Updates the dimensions of all panels to fit the current
-    ///        terminal size; draws and refreshes the panels to display
-    ///        them.
+    ///        terminal size; rebuilds their content from the CharacterView,
+    ///        draws and refreshes the panels to display them.
+    /// Content is composed on the worker threads, if started (see
+    /// gelcube::WorkerPool::run_parallel()), then drawn on the calling
+    /// thread.
     /// @throw gelcube::Tui::SizeException if the terminal is too small to fit
     ///        the panels.
     /// @throw gelcube::Tui::NoWindowException if a panel is updated or
     ///        refreshed and the panel's window has not been created.
     static void update();
 
+    /// @brief Marks a panel's content as outdated.
+    /// The content is rebuilt from the CharacterView on the next call to
+    /// redraw_dirty().
+    /// @param index Index of the panel in the manager's internal panels
+    ///              vector.
+    static inline void mark_dirty(size_t index) noexcept
+    {
+        if (index < panel_count)
+            stale[index] = true;
+    }
+
+    /// @brief Marks every panel's content as outdated.
+    static inline void mark_all_dirty() noexcept
+    {
+        for (auto& panel_stale : stale)
+            panel_stale = true;
+    }
+
+    /// @brief Displays the progress of a background task on a panel.
+    /// The indicator is updated by redraw_dirty() and removed once the task is
+    /// done.
+    /// @param index Index of the panel in the manager's internal panels
+    ///              vector.
+    /// @param task Task in flight.
+    static inline void track(size_t index,
+                             std::shared_ptr<const WorkerPool::Task> task)
+    {
+        tracked.push_back({index, std::move(task)});
+    }
+
+    /// @brief Checks whether any panel displays the progress of a task.
+    /// @return true if progress indicators must be updated periodically.
+    static inline bool is_tracking() noexcept
+    {
+        return !tracked.empty();
+    }
+
+    /// @brief Redraws and refreshes only the panels marked dirty.
+    /// The content of panels marked outdated is rebuilt first, in parallel if
+    /// there are several. Does nothing if the panels have been destroyed.
+    /// @throw gelcube::Tui::NoWindowException if a dirty panel's window has
+    ///        not been created.
+    static void redraw_dirty();
+
     /// @brief Destroys all panels.
-    /// Calls the destructor of each panel in the manager.
+    /// Deletes each panel in the manager and its window.
     static inline void destroy() noexcept
     {
         panels.clear();
@@ -100,11 +164,23 @@ public:
     }
 
 private:
-    static Dimensions large_left, middle_upper, large_right, middle_middle,
-                        middle_lower;
-    static std::vector<Panel*> panels;
+    /// @brief Rebuilds a panel's content from the CharacterView and lays it
+    ///        out.
+    /// Safe to run concurrently for different panels while the UI thread
+    /// waits, as the CharacterView only reads the roster.
+    /// @param index Index of the panel in the manager's internal panels
+    ///              vector.
+    static void compose(size_t index);
+
+    static Dimensions large_left, middle_upper, right_upper, middle_middle,
+                        middle_lower, right_lower;
+    static std::vector<std::unique_ptr<Panel>> panels;
     static size_t selected_index;
     static size_t last_selected_index;
+    static bool stale[panel_count];
+    static std::vector<std::pair<size_t,
+                                 std::shared_ptr<const WorkerPool::Task>>>
+        tracked;
 };
 
 }; // namespace gelcube
@@ -18,14 +18,21 @@
 /// You should have received a copy of the GNU General Public License
 /// along with this program. If not, see <https://www.gnu.org/licenses/>.
 
+#include "../input_recording.hh"
 #include "../intl.hh"
 #include "../logger.hh"
+#include "../memory_accounting.hh"
+#include "../terminal_writer.hh"
 #include "../tui.hh"
+#include "../worker_pool.hh"
 #include "main_loop.hh"
 #include "panel_manager.hh"
 #include "size_exception.hh"
 
+#include <cstdio>
 #include <cstdlib>
+#include <iostream>
+#include <system_error>
 
 #include <ncurses.h>
 
@@ -36,13 +43,57 @@ Logger::Source Tui::log;
 
 int Tui::start() noexcept
 {
+    MemoryAccounting::Scope scope(MemoryAccounting::Tag::tui);
     log = Logger::source;
 
-    // Initializes ncurses screen.
-    initscr();
+    // Initializes ncurses screen. Replays draw to a screen which is never
+    // displayed, sized like the recorded terminal.
+    bool is_replay
+        = InputRecording::get_mode() == InputRecording::Mode::replay;
+    SCREEN* screen = nullptr;
+    FILE* null_output = nullptr;
+    if (is_replay)
+    {
+        null_output = std::fopen("/dev/null", "w");
+        const char* term = std::getenv("TERM");
+        screen = newterm(term && *term ? term : "xterm", null_output, stdin);
+        if (!screen)
+        {
+            BOOST_LOG_SEV(log, LogLevel::fatal)
+                << _("Cannot create headless screen");
+            std::fclose(null_output);
+            return EXIT_FAILURE;
+        }
+        resize_term(InputRecording::get_size().first,
+                    InputRecording::get_size().second);
+    }
+    else
+    {
+        // Queries the terminal before ncurses takes it over.
+        TerminalWriter::start();
+        initscr();
+    }
     noecho();
     cbreak();
 
+    // Starts background workers.
+    try
+    {
+        WorkerPool::start();
+    }
+    catch (std::system_error& e)
+    {
+        BOOST_LOG_SEV(log, LogLevel::fatal)
+            << _("Cannot start background workers: ") << e.what();
+        endwin();
+        if (is_replay)
+        {
+            delscreen(screen);
+            std::fclose(null_output);
+        }
+        return EXIT_FAILURE;
+    }
+
     // Initializes panels.
     PanelManager::create();
 
@@ -50,8 +101,21 @@ int Tui::start() noexcept
     MainLoop::start();
 
     // Ends the TUI.
+    WorkerPool::stop();
     PanelManager::destroy();
     endwin();
+    if (is_replay)
+    {
+        delscreen(screen);
+        std::fclose(null_output);
+        InputRecording::report(std::cout);
+    }
+    InputRecording::finish();
+    if (TerminalWriter::is_enabled())
+    {
+        TerminalWriter::stop();
+        TerminalWriter::report(std::cout);
+    }
 
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,43 @@
+/// @file window_deleter.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Deletes ncurses windows owned by std::unique_ptr.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_TUI_WINDOW_DELETER_HH_
+#define GELCUBE_SRC_TUI_WINDOW_DELETER_HH_
+
+#include "../tui.hh"
+
+#include <memory>
+
+#include <ncurses.h>
+
+namespace gelcube
+{
+
+struct Tui::WindowDeleter
+{
+    void operator()(WINDOW* window) const noexcept
+    {
+        delwin(window);
+    }
+};
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_TUI_WINDOW_DELETER_HH_
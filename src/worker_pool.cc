@@ -0,0 +1,310 @@
+/// @file worker_pool.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Runs prioritized work on background threads.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "intl.hh"
+#include "logger.hh"
+#include "trace.hh"
+#include "worker_pool.hh"
+
+#include <algorithm>
+#include <cerrno>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace gelcube
+{
+
+std::vector<std::thread> WorkerPool::threads;
+std::vector<WorkerPool::Job> WorkerPool::jobs;
+std::mutex WorkerPool::jobs_mutex;
+std::condition_variable WorkerPool::jobs_available;
+uint64_t WorkerPool::next_sequence = 0;
+bool WorkerPool::stopping = false;
+std::unique_ptr<MpscQueue<WorkerPool::Result>> WorkerPool::results;
+int WorkerPool::event_fd = -1;
+
+namespace
+{
+
+// Tasks currently being run by a worker, guarded by WorkerPool::jobs_mutex.
+std::vector<WorkerPool::Task*> running;
+
+/// @brief Indices shared between the threads of WorkerPool::run_parallel().
+struct ParallelRun
+{
+    std::atomic<size_t> next{0};
+    size_t count;
+    // Valid until every index has run.
+    const std::function<void(size_t)>* body;
+    std::mutex mutex;
+    std::condition_variable finished;
+    size_t finished_count = 0;
+    std::exception_ptr error;
+};
+
+/// @brief Runs indices until none are left to claim.
+void claim_indices(ParallelRun& run)
+{
+    size_t ran = 0;
+    for (size_t i = run.next.fetch_add(1, std::memory_order_relaxed);
+         i < run.count; i = run.next.fetch_add(1, std::memory_order_relaxed))
+    {
+        try
+        {
+            (*run.body)(i);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(run.mutex);
+            if (!run.error)
+                run.error = std::current_exception();
+        }
+        ++ran;
+    }
+    if (ran == 0)
+        return;
+
+    std::lock_guard<std::mutex> lock(run.mutex);
+    run.finished_count += ran;
+    if (run.finished_count == run.count)
+        run.finished.notify_all();
+}
+
+}; // namespace
+
+void WorkerPool::start(unsigned thread_count)
+{
+    event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (event_fd < 0)
+        throw std::system_error(errno, std::generic_category(), "eventfd");
+
+    results = std::make_unique<MpscQueue<Result>>();
+    stopping = false;
+
+    if (thread_count == 0)
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < thread_count; ++i)
+        threads.emplace_back(run);
+}
+
+void WorkerPool::stop() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex);
+        stopping = true;
+        for (auto task : running)
+            task->cancel();
+        for (auto& job : jobs)
+        {
+            job.task->cancel();
+            job.task->done.store(true, std::memory_order_release);
+        }
+        jobs.clear();
+    }
+    jobs_available.notify_all();
+
+    for (auto& thread : threads)
+        thread.join();
+    threads.clear();
+
+    // Completions of finished work are not run, but their tasks are reported
+    // cancelled, so that no one waits for them.
+    if (results)
+    {
+        Result result;
+        while (results->pop(result))
+        {
+            result.task->cancel();
+            result.task->done.store(true, std::memory_order_release);
+        }
+        results.reset();
+    }
+    if (event_fd >= 0)
+    {
+        close(event_fd);
+        event_fd = -1;
+    }
+}
+
+std::shared_ptr<WorkerPool::Task> WorkerPool::submit(Work work,
+                                                     Priority priority)
+{
+    auto task = std::make_shared<Task>();
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex);
+        jobs.push_back({priority, next_sequence++, std::move(work), task});
+        std::push_heap(jobs.begin(), jobs.end());
+    }
+    jobs_available.notify_one();
+    return task;
+}
+
+void WorkerPool::run_parallel(size_t count,
+                              const std::function<void(size_t)>& body)
+{
+    size_t helpers = std::min(count > 0 ? count - 1 : 0, threads.size());
+    if (helpers == 0)
+    {
+        for (size_t i = 0; i < count; ++i)
+            body(i);
+        return;
+    }
+
+    // Helpers which start after every index was claimed do nothing, so the
+    // shared state outlives this call.
+    auto run = std::make_shared<ParallelRun>();
+    run->count = count;
+    run->body = &body;
+    for (size_t i = 0; i < helpers; ++i)
+    {
+        submit([run](Task&) -> Completion
+        {
+            claim_indices(*run);
+            return {};
+        }, Priority::high);
+    }
+    claim_indices(*run);
+
+    std::unique_lock<std::mutex> lock(run->mutex);
+    run->finished.wait(lock, [&] { return run->finished_count == count; });
+    if (run->error)
+        std::rethrow_exception(run->error);
+}
+
+size_t WorkerPool::drain()
+{
+    if (!results)
+        return 0;
+
+    // Clears the eventfd before popping so that a completion pushed during
+    // the drain wakes the next poll.
+    uint64_t count;
+    while (read(event_fd, &count, sizeof(count)) > 0)
+    {
+    }
+
+    Trace::Span span("WorkerPool::drain");
+    size_t drained = 0;
+    Result result;
+    while (results->pop(result))
+    {
+        // A failed completion does not stop the others, and its task is
+        // still done.
+        try
+        {
+            if (!result.task->is_cancelled())
+                result.completion();
+        }
+        catch (std::exception& e)
+        {
+            Logger::Source log = Logger::source;
+            BOOST_LOG_SEV(log, LogLevel::error)
+                << _("Background task completion failed: ") << e.what();
+        }
+        catch (...)
+        {
+            Logger::Source log = Logger::source;
+            BOOST_LOG_SEV(log, LogLevel::error)
+                << _("Background task completion failed");
+        }
+        result.task->done.store(true, std::memory_order_release);
+        ++drained;
+    }
+    return drained;
+}
+
+void WorkerPool::run()
+{
+    // Log sources are not thread-safe, so each worker uses its own.
+    Logger::Source log = Logger::source;
+    Trace::name_thread("worker");
+
+    for (;;)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(jobs_mutex);
+            jobs_available.wait(lock, [] { return stopping || !jobs.empty(); });
+            if (stopping)
+                return;
+
+            // Moves the job out rather than copying its work under the lock.
+            std::pop_heap(jobs.begin(), jobs.end());
+            job = std::move(jobs.back());
+            jobs.pop_back();
+            running.push_back(job.task.get());
+        }
+
+        Completion completion;
+        if (!job.task->is_cancelled())
+        {
+            try
+            {
+                Trace::Span span("WorkerPool::task");
+                completion = job.work(*job.task);
+            }
+            catch (std::exception& e)
+            {
+                BOOST_LOG_SEV(log, LogLevel::error)
+                    << _("Background task failed: ") << e.what();
+            }
+            catch (...)
+            {
+                BOOST_LOG_SEV(log, LogLevel::error)
+                    << _("Background task failed");
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(jobs_mutex);
+            running.erase(std::find(running.begin(), running.end(),
+                                    job.task.get()));
+        }
+
+        if (completion && !job.task->is_cancelled())
+        {
+            results->push({std::move(completion), std::move(job.task)});
+            uint64_t one = 1;
+            if (write(event_fd, &one, sizeof(one)) < 0)
+            {
+                // The counter can only overflow after 2^64 - 1 wakeups.
+            }
+        }
+        else
+        {
+            job.task->done.store(true, std::memory_order_release);
+        }
+    }
+}
+
+}; // namespace gelcube
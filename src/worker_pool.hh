@@ -0,0 +1,202 @@
+/// @file worker_pool.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Runs prioritized work on background threads.
+/// @version 0.1
+/// @date 2026-10-18
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef GELCUBE_SRC_WORKER_POOL_HH_
+#define GELCUBE_SRC_WORKER_POOL_HH_
+
+#include "mpsc_queue.hh"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gelcube
+{
+
+/// @brief Runs prioritized work on background threads.
+/// Work runs on a shared pool of threads and returns a completion, which is
+/// queued on a lock-free MPSC queue and run on the thread calling drain(),
+/// normally the UI thread. An eventfd becomes readable whenever completions
+/// are pending, so the queue can be polled alongside other event sources.
+typedef class WorkerPool
+{
+public:
+    /// @brief Scheduling priority of a task.
+    /// Higher priority tasks are started first; tasks of equal priority are
+    /// started in submission order.
+    enum class Priority
+    {
+        low,
+        normal,
+        high
+    };
+
+    /// @brief Work in flight.
+    /// Shared between the submitter, which may cancel it or display its
+    /// progress, and the worker running it.
+    class Task
+    {
+    public:
+        /// @brief Requests cancellation.
+        /// A task which has not started is skipped; a running task stops at
+        /// its next call to is_cancelled(). Its completion is not run.
+        inline void cancel() noexcept
+        {
+            cancelled.store(true, std::memory_order_relaxed);
+        }
+
+        /// @brief Checks whether cancellation was requested.
+        /// Long-running work should check this periodically.
+        /// @return true if cancelled.
+        inline bool is_cancelled() const noexcept
+        {
+            return cancelled.load(std::memory_order_relaxed);
+        }
+
+        /// @brief Reports progress from the worker.
+        /// @param fraction Fraction of the work completed, from 0 to 1.
+        inline void set_progress(double fraction) noexcept
+        {
+            progress.store(static_cast<int>(fraction * 1000),
+                           std::memory_order_relaxed);
+        }
+
+        /// @brief Gets the reported progress.
+        /// @return Progress in thousandths.
+        inline int get_progress() const noexcept
+        {
+            return progress.load(std::memory_order_relaxed);
+        }
+
+        /// @brief Checks whether the task has finished.
+        /// A task is finished once its completion has run, or once it was
+        /// cancelled or failed.
+        /// @return true if finished.
+        inline bool is_done() const noexcept
+        {
+            return done.load(std::memory_order_acquire);
+        }
+
+    private:
+        friend WorkerPool;
+
+        std::atomic<bool> cancelled{false};
+        std::atomic<bool> done{false};
+        std::atomic<int> progress{0};
+    };
+
+    /// @brief Function run on the draining thread with the result of work.
+    typedef std::function<void()> Completion;
+
+    /// @brief Function run on a worker thread.
+    /// Returns the completion to run on the draining thread, which may be
+    /// empty.
+    typedef std::function<Completion(Task& task)> Work;
+
+    /// @brief Starts the worker threads.
+    /// @param thread_count Number of threads, or 0 to use one per hardware
+    ///                     thread.
+    /// @throw std::system_error if the eventfd or a thread cannot be created.
+    static void start(unsigned thread_count = 0);
+
+    /// @brief Stops the worker threads.
+    /// Cancels all tasks, waits for running work to return, and discards
+    /// pending completions without running them. Every task is then done and
+    /// cancelled, including those whose work had finished.
+    static void stop() noexcept;
+
+    /// @brief Queues work to run on a worker thread.
+    /// @param work Function to run.
+    /// @param priority Scheduling priority.
+    /// @return Task handle for cancellation and progress.
+    static std::shared_ptr<Task> submit(Work work,
+                                        Priority priority = Priority::normal);
+
+    /// @brief Runs a function for each index in parallel and waits for it.
+    /// Indices are claimed by the calling thread and by idle workers, so the
+    /// call makes progress even while every worker is busy. Runs everything
+    /// on the calling thread if the pool has not been started.
+    /// @param count Number of indices, from 0.
+    /// @param body Function run once for each index; must be safe to run
+    ///             concurrently for different indices.
+    /// @throw Any exception thrown by body, once every index has run.
+    static void run_parallel(size_t count,
+                             const std::function<void(size_t)>& body);
+
+    /// @brief Runs all pending completions on the calling thread.
+    /// Must only be called from a single thread. Exceptions thrown by a
+    /// completion are logged, and its task is done regardless.
+    /// @return Number of completions run.
+    static size_t drain();
+
+    /// @brief Gets the completion eventfd.
+    /// @return File descriptor which becomes readable when completions are
+    ///         pending, or -1 if the pool has not been started.
+    static inline int get_fd() noexcept
+    {
+        return event_fd;
+    }
+
+private:
+    struct Job
+    {
+        Priority priority;
+        uint64_t sequence;
+        Work work;
+        std::shared_ptr<Task> task;
+
+        bool operator<(const Job& other) const noexcept
+        {
+            // The heap of jobs keeps the greatest element first.
+            if (priority != other.priority)
+                return priority < other.priority;
+            return sequence > other.sequence;
+        }
+    };
+
+    struct Result
+    {
+        Completion completion;
+        std::shared_ptr<Task> task;
+    };
+
+    /// @brief Runs jobs until the pool is stopped.
+    static void run();
+
+    static std::vector<std::thread> threads;
+    // Heap ordered by Job::operator<.
+    static std::vector<Job> jobs;
+    static std::mutex jobs_mutex;
+    static std::condition_variable jobs_available;
+    static uint64_t next_sequence;
+    static bool stopping;
+    static std::unique_ptr<MpscQueue<Result>> results;
+    static int event_fd;
+} WorkerPool;
+
+}; // namespace gelcube
+
+#endif // GELCUBE_SRC_WORKER_POOL_HH_
@@ -0,0 +1,229 @@
+/// @file batch_mode.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Tests the pipeline of batch mode and its queues.
+/// @version 0.1
+/// @date 2026-10-19
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "../src/batch_mode.hh"
+#include "../src/bounded_queue.hh"
+#include "check.hh"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+using gelcube::BatchMode;
+using gelcube::BoundedQueue;
+
+namespace
+{
+
+void test_queue_order()
+{
+    // Each producer's elements arrive in the order it pushed them.
+    BoundedQueue<int> queue(4);
+    const int producers = 3;
+    const int count = 10000;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p)
+    {
+        threads.emplace_back([&queue, p]
+        {
+            for (int i = 0; i < count; ++i)
+                queue.push(p * count + i);
+        });
+    }
+
+    std::vector<int> last(producers, -1);
+    bool ordered = true;
+    int value;
+    for (int received = 0; received < producers * count; ++received)
+    {
+        queue.pop(value);
+        int producer = value / count;
+        ordered = ordered && value % count == last[producer] + 1;
+        last[producer] = value % count;
+    }
+    for (auto& thread : threads)
+        thread.join();
+    CHECK(ordered);
+}
+
+void test_queue_capacity_and_close()
+{
+    BoundedQueue<int> queue(2);
+    CHECK(queue.push(1));
+    CHECK(queue.push(2));
+
+    // A push waits while the queue is full.
+    std::atomic<bool> pushed{false};
+    std::thread producer([&]
+    {
+        queue.push(3);
+        pushed = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK(!pushed);
+    int value = 0;
+    CHECK(queue.pop(value) && value == 1);
+    producer.join();
+    CHECK(pushed);
+
+    // Closing wakes waiting consumers, which drain what is left.
+    BoundedQueue<int> empty(1);
+    std::atomic<bool> woken{false};
+    std::thread consumer([&]
+    {
+        int ignored;
+        woken = !empty.pop(ignored);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    empty.close();
+    consumer.join();
+    CHECK(woken);
+
+    queue.close();
+    CHECK(!queue.push(4));
+    CHECK(queue.pop(value) && value == 2);
+    CHECK(queue.pop(value) && value == 3);
+    CHECK(!queue.pop(value));
+
+    // Capacity is at least one.
+    BoundedQueue<int> zero(0);
+    CHECK(zero.push(5));
+    CHECK(zero.pop(value) && value == 5);
+}
+
+std::string directory;
+
+/// @brief Writes a character file.
+std::string write_character(const std::string& name, const std::string& text)
+{
+    std::string path = directory + "/" + name + ".character";
+    std::ofstream(path) << text;
+    return path;
+}
+
+void test_formats()
+{
+    BatchMode::Format format = BatchMode::Format::none;
+    CHECK(BatchMode::parse_format("json", format)
+          && format == BatchMode::Format::json);
+    CHECK(BatchMode::parse_format("csv", format)
+          && format == BatchMode::Format::csv);
+    CHECK(BatchMode::parse_format("txt", format)
+          && format == BatchMode::Format::text);
+    CHECK(BatchMode::parse_format("text", format)
+          && format == BatchMode::Format::text);
+    CHECK(!BatchMode::parse_format("xml", format));
+    CHECK(std::string(BatchMode::get_extension(BatchMode::Format::csv))
+          == ".csv");
+}
+
+void test_run()
+{
+    // Many valid files, with a few unreadable and invalid ones among them.
+    std::vector<std::string> paths;
+    for (int i = 0; i < 200; ++i)
+    {
+        paths.push_back(write_character(
+            "c" + std::to_string(i),
+            "name = Hero " + std::to_string(i) + "\nlevel = "
+                + std::to_string(1 + i % 20) + "\nstr = 12\n"));
+    }
+    paths[17] = directory + "/missing.character";
+    paths[60] = write_character("nameless", "level = 3\n");
+    paths[61] = write_character("overlevelled", "name = Big\nlevel = 25\n");
+    paths[150] = write_character("wounded",
+                                 "name = Hurt\nmax_hp = 10\nhp = 12\n");
+
+    BatchMode::Settings settings;
+    settings.format = BatchMode::Format::json;
+    settings.output_directory = directory + "/sheets";
+    settings.thread_count = 3;
+    settings.queue_capacity = 4;
+    std::ostringstream problems;
+    BatchMode::Stats stats = BatchMode::run(paths, settings, problems);
+    CHECK(stats.files == 200);
+    CHECK(stats.unreadable == 1);
+    CHECK(stats.invalid == 3);
+    CHECK(stats.exported == 196);
+
+    // Problems are reported in file order.
+    std::string report = problems.str();
+    size_t missing = report.find("missing.character");
+    size_t nameless = report.find("nameless.character: ");
+    size_t overlevelled = report.find("overlevelled.character: ");
+    size_t wounded = report.find("wounded.character: ");
+    CHECK(missing != std::string::npos && nameless != std::string::npos
+          && overlevelled != std::string::npos
+          && wounded != std::string::npos);
+    CHECK(missing < nameless && nameless < overlevelled
+          && overlevelled < wounded);
+
+    // Sheets are named after their files; invalid characters have none.
+    struct stat status;
+    CHECK(stat((settings.output_directory + "/c0.json").c_str(), &status) == 0
+          && status.st_size > 0);
+    CHECK(stat((settings.output_directory + "/overlevelled.json").c_str(),
+               &status) != 0);
+
+    // Validating alone writes nothing.
+    BatchMode::Settings validate;
+    validate.output_directory = directory + "/unused";
+    std::ostringstream ignored;
+    stats = BatchMode::run(paths, validate, ignored);
+    CHECK(stats.invalid == 3 && stats.exported == 0);
+    CHECK(stat(validate.output_directory.c_str(), &status) != 0);
+
+    for (int i = 0; i < 200; ++i)
+    {
+        unlink((directory + "/c" + std::to_string(i) + ".character").c_str());
+        unlink((settings.output_directory + "/c" + std::to_string(i)
+                + ".json").c_str());
+    }
+    for (const char* name : {"nameless", "overlevelled", "wounded"})
+        unlink((directory + "/" + name + ".character").c_str());
+    rmdir(settings.output_directory.c_str());
+}
+
+}; // namespace
+
+int main()
+{
+    char directory_template[] = "/tmp/gelcube-batch-XXXXXX";
+    if (!mkdtemp(directory_template))
+        return EXIT_FAILURE;
+    directory = directory_template;
+
+    test_queue_order();
+    test_queue_capacity_and_close();
+    test_formats();
+    test_run();
+
+    rmdir(directory.c_str());
+    return gelcube::check::get_status();
+}
@@ -0,0 +1,85 @@
+/// @file check.hh
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Assertions shared by the tests.
+/// @version 0.1
+/// @date 2026-10-19
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+#ifndef GELCUBE_TESTS_CHECK_HH_
+#define GELCUBE_TESTS_CHECK_HH_
+
+#include <cstdlib>
+#include <iostream>
+
+namespace gelcube
+{
+
+namespace check
+{
+
+/// @brief Number of checks which failed.
+inline int failures = 0;
+
+/// @brief Records the result of a check, reporting it if it failed.
+/// @param passed Whether the check passed.
+/// @param expression Text of the check.
+/// @param file Source file of the check.
+/// @param line Line of the check.
+inline void record(bool passed, const char* expression, const char* file,
+                   int line)
+{
+    if (passed)
+        return;
+    ++failures;
+    std::cerr << file << ':' << line << ": check failed: " << expression
+              << std::endl;
+}
+
+/// @brief Gets the exit status of a test.
+/// @return Success if no check failed.
+inline int get_status() noexcept
+{
+    if (failures > 0)
+        std::cerr << failures << " checks failed" << std::endl;
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+}; // namespace check
+
+}; // namespace gelcube
+
+/// @brief Checks that an expression is true, continuing the test either way.
+#define CHECK(expression)                                                     \
+    gelcube::check::record(static_cast<bool>(expression), #expression,       \
+                           __FILE__, __LINE__)
+
+/// @brief Checks that a statement throws an exception of a type.
+#define CHECK_THROWS(statement, exception)                                    \
+    do                                                                        \
+    {                                                                         \
+        bool thrown = false;                                                  \
+        try                                                                   \
+        {                                                                     \
+            statement;                                                        \
+        }                                                                     \
+        catch (const exception&)                                              \
+        {                                                                     \
+            thrown = true;                                                    \
+        }                                                                     \
+        gelcube::check::record(thrown, #statement " throws " #exception,     \
+                               __FILE__, __LINE__);                           \
+    } while (false)
+
+#endif // GELCUBE_TESTS_CHECK_HH_
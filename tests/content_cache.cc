@@ -0,0 +1,237 @@
+/// @file content_cache.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Tests sharing parsed character files through a cache.
+/// @version 0.1
+/// @date 2026-10-19
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "../src/character.hh"
+#include "../src/content_cache.hh"
+#include "check.hh"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using gelcube::Character;
+using gelcube::ContentCache;
+
+namespace
+{
+
+const size_t file_count = 20;
+
+std::string roster;
+std::string caches;
+
+/// @brief Writes a character file of the roster.
+void write_character(size_t i, int level)
+{
+    std::ofstream file(roster + "/c" + std::to_string(i) + ".character");
+    file << "name = Hero " << i << "\n"
+         << "class = " << (i % 2 ? "Wizard" : "Fighter") << "\n"
+         << "level = " << level << "\n"
+         << "str = " << 8 + i % 10 << "\n"
+         << "max_hp = 40\n"
+         << "hp = " << 10 + i << "\n"
+         << "item_backpack = Backpack; weight 5\n"
+         << "item_rope = Rope; weight 10; in backpack\n";
+}
+
+/// @brief Gets the path of the only cache file.
+std::string find_cache()
+{
+    std::string path;
+    DIR* directory = opendir(caches.c_str());
+    while (dirent* entry = readdir(directory))
+    {
+        if (entry->d_name[0] != '.')
+            path = caches + "/" + entry->d_name;
+    }
+    closedir(directory);
+    return path;
+}
+
+/// @brief Checks whether two characters have the same fields.
+bool equal(const Character& a, const Character& b)
+{
+    size_t differences = 0;
+    a.get_scores().diff(b.get_scores(),
+                        [&](const std::string&, const int*, const int*)
+                        {
+                            ++differences;
+                        });
+    a.get_details().diff(b.get_details(),
+                         [&](const gelcube::Content&, const gelcube::Content*,
+                             const gelcube::Content*)
+                         {
+                             ++differences;
+                         });
+    return differences == 0;
+}
+
+/// @brief Reads every file of the roster through its cache and publishes it.
+/// @param hits Set to the number of characters read from the cache.
+std::vector<Character> read_all(size_t& hits)
+{
+    ContentCache cache(roster);
+    std::vector<Character> characters;
+    for (size_t i = 0; i < file_count; ++i)
+    {
+        characters.push_back(cache.read(roster + "/c" + std::to_string(i)
+                                        + ".character"));
+    }
+    hits = cache.get_hits();
+    cache.publish();
+    return characters;
+}
+
+/// @brief Checks whether characters match those read from their files.
+bool match(const std::vector<Character>& characters,
+           const std::vector<Character>& expected)
+{
+    bool matches = characters.size() == expected.size();
+    for (size_t i = 0; matches && i < characters.size(); ++i)
+        matches = equal(characters[i], expected[i]);
+    return matches;
+}
+
+void test_reuse()
+{
+    size_t hits;
+    std::vector<Character> files = read_all(hits);
+    CHECK(hits == 0);
+    CHECK(!find_cache().empty());
+    CHECK(files[3].get_detail("name") && *files[3].get_detail("name")
+                                         == "Hero 3");
+
+    std::vector<Character> cached = read_all(hits);
+    CHECK(hits == file_count);
+    CHECK(match(cached, files));
+}
+
+void test_changed_file()
+{
+    // Rewritten with a new size, or replaced with a new inode.
+    write_character(5, 17);
+    std::string path = roster + "/c11.character";
+    write_character(11, 9);
+    std::rename(path.c_str(), (path + ".tmp").c_str());
+    std::rename((path + ".tmp").c_str(), path.c_str());
+
+    size_t hits;
+    std::vector<Character> characters = read_all(hits);
+    CHECK(hits == file_count - 2);
+    CHECK(characters[5].get_score("level")
+          && *characters[5].get_score("level") == 17);
+    CHECK(characters[11].get_score("level")
+          && *characters[11].get_score("level") == 9);
+
+    // Republished with the new versions.
+    std::vector<Character> cached = read_all(hits);
+    CHECK(hits == file_count);
+    CHECK(match(cached, characters));
+}
+
+void test_invalid_cache()
+{
+    size_t hits;
+    std::vector<Character> files = read_all(hits);
+    std::string path = find_cache();
+
+    // Damaged after the header.
+    std::string contents;
+    {
+        std::ifstream in(path, std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(in), {});
+    }
+    std::string damaged = contents;
+    damaged[damaged.size() - 3] ^= 0x5a;
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << damaged;
+    }
+    std::vector<Character> characters = read_all(hits);
+    CHECK(hits == 0);
+    CHECK(match(characters, files));
+
+    // Truncated, shorter than a header, and of another version.
+    truncate(path.c_str(), contents.size() / 2);
+    characters = read_all(hits);
+    CHECK(hits == 0);
+    CHECK(match(characters, files));
+    truncate(path.c_str(), 10);
+    characters = read_all(hits);
+    CHECK(hits == 0);
+    std::string version = contents;
+    version[8] ^= 0x7f;
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << version;
+    }
+    characters = read_all(hits);
+    CHECK(hits == 0);
+    CHECK(match(characters, files));
+
+    // Writable by others, so possibly forged.
+    read_all(hits);
+    path = find_cache();
+    chmod(path.c_str(), 0666);
+    characters = read_all(hits);
+    CHECK(hits == 0);
+    CHECK(match(characters, files));
+
+    // Caching disabled.
+    ContentCache::set_directory("");
+    characters = read_all(hits);
+    CHECK(hits == 0);
+    CHECK(match(characters, files));
+    ContentCache::set_directory(caches);
+}
+
+}; // namespace
+
+int main()
+{
+    char roster_template[] = "/tmp/gelcube-roster-XXXXXX";
+    char cache_template[] = "/tmp/gelcube-caches-XXXXXX";
+    if (!mkdtemp(roster_template) || !mkdtemp(cache_template))
+        return EXIT_FAILURE;
+    roster = roster_template;
+    caches = cache_template;
+    for (size_t i = 0; i < file_count; ++i)
+        write_character(i, 1 + i % 20);
+    ContentCache::set_directory(caches);
+
+    test_reuse();
+    test_changed_file();
+    test_invalid_cache();
+
+    for (size_t i = 0; i < file_count; ++i)
+        unlink((roster + "/c" + std::to_string(i) + ".character").c_str());
+    unlink(find_cache().c_str());
+    rmdir(roster.c_str());
+    rmdir(caches.c_str());
+    return gelcube::check::get_status();
+}
@@ -0,0 +1,211 @@
+/// @file delta.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Tests the binary encoding of changes to character state.
+/// @version 0.1
+/// @date 2026-10-19
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "../src/delta.hh"
+#include "check.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using gelcube::Delta;
+
+namespace
+{
+
+typedef Delta::Op Op;
+
+/// @brief Decodes every frame of an encoded batch.
+/// @param frames Encoded frames.
+/// @param frame_count Set to the number of frames.
+/// @return Decoded changes.
+std::vector<Op> decode_all(const std::string& frames, size_t& frame_count)
+{
+    std::vector<Op> ops;
+    frame_count = 0;
+    size_t offset = 0;
+    size_t payload_size;
+    while (Delta::next_frame(frames.data() + offset, frames.size() - offset,
+                             payload_size))
+    {
+        uint32_t origin = Delta::decode(
+            frames.data() + offset + Delta::header_size, payload_size, ops);
+        CHECK(origin == 70000);
+        offset += Delta::header_size + payload_size;
+        ++frame_count;
+    }
+    CHECK(offset == frames.size());
+    return ops;
+}
+
+void test_round_trip()
+{
+    Delta::Batch batch;
+    batch.add({Op::set_score, "alice", "strength", 10, {}});
+    // Only the latest change to a field is kept.
+    batch.add({Op::set_score, "alice", "strength", -3, {}});
+    batch.add({Op::set_detail, "alice", "name", 0, "Alice"});
+    batch.add({Op::erase, "alice", "hp", 0, {}});
+    batch.add({Op::set_score, "bob", "wisdom", 12, {}});
+    // Removal discards the earlier changes of a character.
+    batch.add({Op::remove, "bob", {}, 0, {}});
+    batch.add({Op::set_detail, "bob", "class", 0, "Cleric"});
+
+    std::string frames;
+    batch.encode(70000, frames);
+    size_t frame_count;
+    std::vector<Op> ops = decode_all(frames, frame_count);
+    CHECK(frame_count == 1);
+    CHECK(ops.size() == 5);
+
+    Delta::Batch decoded;
+    bool removal_first = true;
+    bool bob_seen = false;
+    for (auto& op : ops)
+    {
+        if (op.character == "bob")
+        {
+            removal_first = removal_first
+                && (bob_seen || op.kind == Op::remove);
+            bob_seen = true;
+        }
+        decoded.add(op);
+    }
+    CHECK(removal_first);
+
+    std::vector<Op> expected;
+    batch.for_each([&](const Op& op) { expected.push_back(op); });
+    std::vector<Op> actual;
+    decoded.for_each([&](const Op& op) { actual.push_back(op); });
+    CHECK(actual.size() == expected.size());
+    bool matches = true;
+    for (auto& op : expected)
+    {
+        bool found = false;
+        for (auto& other : actual)
+        {
+            found = found
+                || (other.kind == op.kind && other.character == op.character
+                    && other.key == op.key && other.score == op.score
+                    && other.detail == op.detail);
+        }
+        matches = matches && found;
+    }
+    CHECK(matches);
+}
+
+void test_split_frames()
+{
+    // Enough characters to exceed the size at which a new frame is started.
+    Delta::Batch batch;
+    const std::string text(200, 'x');
+    for (int i = 0; i < 3000; ++i)
+        batch.add({Op::set_detail, "npc" + std::to_string(i), "note", 0, text});
+    std::string frames;
+    batch.encode(70000, frames);
+    size_t frame_count;
+    std::vector<Op> ops = decode_all(frames, frame_count);
+    CHECK(frame_count > 1);
+    CHECK(ops.size() == 3000);
+}
+
+void test_next_frame()
+{
+    Delta::Batch batch;
+    batch.add({Op::set_score, "dave", "level", 4, {}});
+    std::string frames;
+    batch.encode(70000, frames);
+
+    // Every prefix short of the whole frame is incomplete.
+    size_t payload_size = 0;
+    bool incomplete = true;
+    for (size_t size = 0; size < frames.size(); ++size)
+        incomplete = incomplete
+            && !Delta::next_frame(frames.data(), size, payload_size);
+    CHECK(incomplete);
+    CHECK(Delta::next_frame(frames.data(), frames.size(), payload_size));
+    CHECK(payload_size == frames.size() - Delta::header_size);
+
+    // Lengths above the limit are rejected before the payload arrives.
+    uint32_t length = Delta::max_payload_size + 1;
+    std::string header;
+    for (size_t i = 0; i < Delta::header_size; ++i)
+        header += static_cast<char>((length >> (8 * i)) & 0xff);
+    CHECK_THROWS(Delta::next_frame(header.data(), header.size(),
+                                   payload_size),
+                 Delta::DecodeException);
+}
+
+void test_malformed()
+{
+    Delta::Batch batch;
+    batch.add({Op::set_detail, "erin", "name", 0, "Erin"});
+    std::string frames;
+    batch.encode(70000, frames);
+    const char* payload = frames.data() + Delta::header_size;
+    size_t size = frames.size() - Delta::header_size;
+    std::vector<Op> ops;
+
+    // Every truncation of the payload is rejected, past the three bytes of
+    // the origin, which alone are a frame without changes.
+    bool rejected = true;
+    for (size_t length = 4; length < size; ++length)
+    {
+        try
+        {
+            Delta::decode(payload, length, ops);
+            rejected = false;
+        }
+        catch (Delta::DecodeException&)
+        {
+        }
+    }
+    CHECK(rejected);
+
+    // Unknown kind of change.
+    std::string unknown(payload, size);
+    size_t kind = unknown.find("name") - 2;
+    CHECK(unknown[kind] == static_cast<char>(Op::set_detail));
+    unknown[kind] = 9;
+    CHECK_THROWS(Delta::decode(unknown.data(), unknown.size(), ops),
+                 Delta::DecodeException);
+
+    // Origin beyond 32 bits.
+    const std::string origin("\xff\xff\xff\xff\x7f", 5);
+    CHECK_THROWS(Delta::decode(origin.data(), origin.size(), ops),
+                 Delta::DecodeException);
+
+    // A varint longer than 64 bits.
+    const std::string overlong(11, '\xff');
+    CHECK_THROWS(Delta::decode(overlong.data(), overlong.size(), ops),
+                 Delta::DecodeException);
+}
+
+}; // namespace
+
+int main()
+{
+    test_round_trip();
+    test_split_frames();
+    test_next_frame();
+    test_malformed();
+    return gelcube::check::get_status();
+}
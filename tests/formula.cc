@@ -0,0 +1,188 @@
+/// @file formula.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Tests the parsing, compilation and evaluation of formulas.
+/// @version 0.1
+/// @date 2026-10-19
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "../src/character.hh"
+#include "../src/formula.hh"
+#include "check.hh"
+
+#include <climits>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+using gelcube::Character;
+using gelcube::Formula;
+
+namespace
+{
+
+/// @brief Evaluates a formula both compiled and by walking its tree.
+/// @return Value of the compiled formula, or INT_MIN if the two differ.
+int evaluate(const std::string& source, const Character& character)
+{
+    int compiled = Formula::compile(source).evaluate(character);
+    int walked = Formula::walk(*Formula::parse(source), character);
+    return compiled == walked ? compiled : INT_MIN;
+}
+
+void test_values()
+{
+    Character character;
+    character.set_score("level", 11);
+    character.set_score("proficiency", 2);
+    character.set_score("wis_mod", -3);
+    character.set_score("str", 25);
+
+    CHECK(evaluate("1 + 2 * 3", character) == 7);
+    CHECK(evaluate("(1 + 2) * 3", character) == 9);
+    CHECK(evaluate("10 - 4 - 3", character) == 3);
+    CHECK(evaluate("-7 / 2", character) == -4);
+    CHECK(evaluate("7 / -2", character) == -4);
+    CHECK(evaluate("6 / 2", character) == 3);
+    CHECK(evaluate("5 / 0", character) == 0);
+    CHECK(evaluate("--5", character) == 5);
+    CHECK(evaluate("min(3, 1, 2)", character) == 1);
+    CHECK(evaluate("max(0, (level - 5) / 2)", character) == 3);
+    CHECK(evaluate("proficiency + wis_mod, minimum 1", character) == 1);
+    CHECK(evaluate("str, maximum 20", character) == 20);
+    CHECK(evaluate("missing + 1", character) == 1);
+
+    // Dice take their average, rounded down, without an rng.
+    CHECK(evaluate("2d6", character) == 7);
+    CHECK(evaluate("d8", character) == 4);
+    CHECK(evaluate("(level / 4)d(2 * 2)", character) == 5);
+    CHECK(evaluate("0d6 + (-1)d6", character) == 0);
+    CHECK(evaluate("-1d6", character) == -3);
+
+    std::mt19937 rng(4);
+    Formula dice = Formula::compile("3d6 + 1");
+    bool is_in_range = true;
+    for (int i = 0; i < 1000; ++i)
+    {
+        int value = dice.evaluate(character, &rng);
+        is_in_range = is_in_range && value >= 4 && value <= 19;
+    }
+    CHECK(is_in_range);
+}
+
+void test_constants()
+{
+    int level = 5;
+    Formula formula = Formula::compile(
+        "level * 2 + str + dex",
+        [&](const std::string& name) -> const int*
+        {
+            return name == "level" ? &level : nullptr;
+        });
+    CHECK((formula.get_inputs() == std::vector<std::string>{"str", "dex"}));
+
+    int inputs[] = {3, 4};
+    CHECK(formula.evaluate(inputs) == 17);
+
+    // Constant subexpressions are folded away.
+    CHECK(Formula::compile("(2 + 3) * 4").size()
+          < Formula::compile("(a + 3) * 4").size());
+}
+
+/// @brief Generates a random formula of bounded depth.
+std::string generate(std::mt19937& rng, int depth)
+{
+    const char* fields[] = {"a", "b", "c", "missing"};
+    const char* operators[] = {" + ", " - ", " * ", " / "};
+    unsigned choice = depth <= 0 ? rng() % 2 : rng() % 7;
+    switch (choice)
+    {
+    case 0:
+        return std::to_string(static_cast<int>(rng() % 21) - 10);
+    case 1:
+        return fields[rng() % 4];
+    case 2:
+        return "-" + generate(rng, depth - 1);
+    case 3:
+        return "(" + generate(rng, depth - 1) + ")d("
+               + std::to_string(rng() % 12) + ")";
+    case 4:
+        return std::string(rng() % 2 ? "min(" : "max(")
+               + generate(rng, depth - 1) + ", " + generate(rng, depth - 1)
+               + ")";
+    default:
+        return "(" + generate(rng, depth - 1) + operators[rng() % 4]
+               + generate(rng, depth - 1) + ")";
+    }
+}
+
+void test_compiled_matches_walked()
+{
+    Character character;
+    character.set_score("a", 7);
+    character.set_score("b", -3);
+    character.set_score("c", 1000003);
+
+    std::mt19937 rng(5);
+    bool is_consistent = true;
+    for (int i = 0; i < 2000; ++i)
+    {
+        std::string source = generate(rng, 6);
+        if (i % 3 == 0)
+            source += ", minimum " + generate(rng, 2);
+        is_consistent = is_consistent
+                        && evaluate(source, character) != INT_MIN;
+    }
+    CHECK(is_consistent);
+}
+
+void test_errors()
+{
+    typedef Formula::SyntaxException SyntaxException;
+    CHECK_THROWS(Formula::compile(""), SyntaxException);
+    CHECK_THROWS(Formula::compile("1 +"), SyntaxException);
+    CHECK_THROWS(Formula::compile("(1"), SyntaxException);
+    CHECK_THROWS(Formula::compile("1)"), SyntaxException);
+    CHECK_THROWS(Formula::compile("1, sometimes 2"), SyntaxException);
+    CHECK_THROWS(Formula::compile("min(1,)"), SyntaxException);
+
+    std::string inputs = "f0";
+    for (size_t i = 1; i <= Formula::max_inputs; ++i)
+        inputs += " + f" + std::to_string(i);
+    CHECK_THROWS(Formula::compile(inputs), SyntaxException);
+
+    auto nest = [](size_t depth)
+    {
+        return std::string(depth, '(') + "1" + std::string(depth, ')');
+    };
+    CHECK(Formula::compile(nest(Formula::max_depth - 1)).evaluate(
+              Character()) == 1);
+    CHECK_THROWS(Formula::compile(nest(Formula::max_depth + 1)),
+                 SyntaxException);
+    CHECK_THROWS(Formula::compile(std::string(100000, '-') + "1"),
+                 SyntaxException);
+}
+
+}; // namespace
+
+int main()
+{
+    test_values();
+    test_constants();
+    test_compiled_matches_walked();
+    test_errors();
+    return gelcube::check::get_status();
+}
@@ -0,0 +1,160 @@
+/// @file initiative_tracker.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Tests the turn order of encounters.
+/// @version 0.1
+/// @date 2026-10-19
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "../src/initiative_tracker.hh"
+#include "check.hh"
+
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <tuple>
+#include <vector>
+
+using gelcube::InitiativeTracker;
+
+namespace
+{
+
+typedef InitiativeTracker::Id Id;
+
+/// @brief Gets the turn order by walking every position.
+std::vector<Id> get_order(const InitiativeTracker& tracker)
+{
+    std::vector<Id> order;
+    for (size_t i = 0; i < tracker.size(); ++i)
+        order.push_back(tracker.at(i));
+    return order;
+}
+
+void test_order_and_rounds()
+{
+    InitiativeTracker tracker;
+    CHECK(tracker.current() == InitiativeTracker::none);
+    CHECK(tracker.next() == InitiativeTracker::none);
+
+    Id goblin = tracker.add({"Goblin", 12, 14});
+    Id alice = tracker.add({"Alice", 18, 10});
+    Id bob = tracker.add({"Bob", 12, 16});
+    Id ogre = tracker.add({"Ogre", 12, 14});
+    tracker.restart();
+
+    // Higher initiative, then higher tiebreak, then first added acts first.
+    CHECK((get_order(tracker) == std::vector<Id>{alice, bob, goblin, ogre}));
+    CHECK(tracker.rank(goblin) == 2);
+    CHECK(tracker.current() == alice);
+    CHECK(tracker.get_round() == 1);
+
+    CHECK(tracker.next() == bob);
+    CHECK(tracker.next() == goblin);
+    CHECK(tracker.next() == ogre);
+    CHECK(tracker.get_round() == 1);
+    CHECK(tracker.next() == alice);
+    CHECK(tracker.get_round() == 2);
+
+    // Delaying passes the turn to whoever followed.
+    tracker.set_initiative(alice, 1);
+    CHECK(tracker.current() == bob);
+    CHECK((get_order(tracker) == std::vector<Id>{bob, goblin, ogre, alice}));
+
+    // Removing the last combatant on its turn starts a new round.
+    tracker.next();
+    tracker.next();
+    tracker.next();
+    CHECK(tracker.current() == alice);
+    tracker.remove(alice);
+    CHECK(tracker.current() == bob);
+    CHECK(tracker.get_round() == 3);
+    CHECK(tracker.size() == 3);
+
+    // A reused identifier still acts after combatants added before it.
+    Id newcomer = tracker.add({"Newcomer", 12, 14});
+    CHECK(newcomer == alice);
+    CHECK((get_order(tracker)
+           == std::vector<Id>{bob, goblin, ogre, newcomer}));
+    CHECK(tracker.get(newcomer).name == "Newcomer");
+}
+
+void test_random_operations()
+{
+    struct Expected
+    {
+        Id id;
+        int initiative;
+        int tiebreak;
+        size_t arrival;
+    };
+
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> score(1, 6);
+    InitiativeTracker tracker;
+    std::vector<Expected> expected;
+    size_t arrivals = 0;
+    bool is_consistent = true;
+    for (int i = 0; i < 5000; ++i)
+    {
+        int operation = rng() % 4;
+        if (expected.empty() || operation < 2)
+        {
+            int initiative = score(rng);
+            int tiebreak = score(rng);
+            Id id = tracker.add({"", initiative, tiebreak});
+            expected.push_back({id, initiative, tiebreak, arrivals++});
+        }
+        else if (operation == 2)
+        {
+            size_t index = rng() % expected.size();
+            tracker.remove(expected[index].id);
+            expected.erase(expected.begin() + index);
+        }
+        else
+        {
+            size_t index = rng() % expected.size();
+            expected[index].initiative = score(rng);
+            tracker.set_initiative(expected[index].id,
+                                   expected[index].initiative);
+        }
+
+        std::sort(expected.begin(), expected.end(),
+                  [](const Expected& a, const Expected& b)
+        {
+            return std::make_tuple(-a.initiative, -a.tiebreak, a.arrival)
+                   < std::make_tuple(-b.initiative, -b.tiebreak, b.arrival);
+        });
+        std::vector<Id> order;
+        for (auto& combatant : expected)
+            order.push_back(combatant.id);
+        is_consistent = is_consistent && get_order(tracker) == order;
+        for (size_t rank = 0; rank < order.size(); ++rank)
+            is_consistent = is_consistent && tracker.rank(order[rank]) == rank;
+        is_consistent = is_consistent
+                        && (order.empty()
+                            == (tracker.current() == InitiativeTracker::none));
+    }
+    CHECK(is_consistent);
+}
+
+}; // namespace
+
+int main()
+{
+    test_order_and_rounds();
+    test_random_operations();
+    return gelcube::check::get_status();
+}
@@ -0,0 +1,247 @@
+/// @file inventory.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Tests the container tree of inventories.
+/// @version 0.1
+/// @date 2026-10-19
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "../src/character.hh"
+#include "../src/inventory.hh"
+#include "check.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+using gelcube::Character;
+using gelcube::Inventory;
+
+namespace
+{
+
+typedef Inventory::Id Id;
+
+/// @brief Gets the container holding an item, root if carried directly.
+Id get_container(const Inventory& inventory, Id item)
+{
+    Id container = Inventory::none;
+    std::vector<Id> path;
+    inventory.visit(inventory.size(), [&](Id id, size_t depth)
+    {
+        path.resize(depth);
+        if (id == item)
+            container = depth == 0 ? Inventory::root : path.back();
+        path.push_back(id);
+    });
+    return container;
+}
+
+void test_parse()
+{
+    Inventory::Item rope = Inventory::parse(
+        "Rope ; weight 10; value 1 gp;in backpack ; glows");
+    CHECK(rope.name == "Rope");
+    CHECK(rope.weight == 1000);
+    CHECK(rope.value == 100);
+    CHECK(rope.quantity == 1);
+    CHECK(rope.container == "item_backpack");
+    CHECK(!rope.extradimensional);
+
+    Inventory::Item arrows = Inventory::parse(
+        "Arrow; weight 0.05 lb; value 5 cp; count 20; in item_quiver");
+    CHECK(arrows.weight == 5 && arrows.value == 5 && arrows.quantity == 20);
+    CHECK(arrows.container == "item_quiver");
+
+    CHECK(Inventory::parse("Coin; value 2 sp").value == 20);
+    CHECK(Inventory::parse("Coin; value 1 ep").value == 50);
+    CHECK(Inventory::parse("Coin; value 3 pp").value == 3000);
+    CHECK(Inventory::parse("Coin; count -4").quantity == 0);
+    CHECK(Inventory::parse("Bag of holding; extradimensional")
+              .extradimensional);
+
+    CHECK(Inventory::is_item("item_rope"));
+    CHECK(!Inventory::is_item("name"));
+}
+
+void test_containers()
+{
+    Inventory inventory;
+    inventory.set("item_rope", Inventory::parse(
+        "Rope; weight 10; value 1 gp; in backpack"));
+    // Carried directly until its container is added.
+    CHECK(get_container(inventory, inventory.find("item_rope"))
+          == Inventory::root);
+
+    inventory.set("item_backpack", Inventory::parse(
+        "Backpack; weight 5; value 2 gp"));
+    Id backpack = inventory.find("item_backpack");
+    Id rope = inventory.find("item_rope");
+    CHECK(get_container(inventory, rope) == backpack);
+    CHECK(inventory.get_contents(backpack).weight == 1000);
+    CHECK(inventory.get_totals(backpack).weight == 1500);
+    CHECK(inventory.get_totals(backpack).count == 2);
+    CHECK(inventory.get_contents().weight == 1500);
+    CHECK(inventory.get_contents().value == 300);
+    CHECK(inventory.get_contents().count == 2);
+
+    // Contents of an extradimensional container weigh nothing outside it.
+    inventory.set("item_bag", Inventory::parse(
+        "Bag of holding; weight 15; value 4000 gp; extradimensional"));
+    inventory.set("item_backpack", Inventory::parse(
+        "Backpack; weight 5; value 2 gp; in bag"));
+    CHECK(inventory.get_contents().weight == 1500);
+    CHECK(inventory.get_contents().value == 400300);
+    CHECK(inventory.get_contents(inventory.find("item_bag")).weight == 1500);
+
+    // Removing a container carries its contents directly until it returns.
+    inventory.erase("item_bag");
+    CHECK(inventory.find("item_bag") == Inventory::none);
+    CHECK(get_container(inventory, backpack) == Inventory::root);
+    CHECK(inventory.get_contents().weight == 1500);
+    inventory.set("item_bag", Inventory::parse(
+        "Bag of holding; weight 15; extradimensional"));
+    CHECK(get_container(inventory, backpack)
+          == inventory.find("item_bag"));
+    CHECK(inventory.get_contents().count == 3);
+
+    // An item cannot be put inside itself, even indirectly.
+    inventory.set("item_bag", Inventory::parse(
+        "Bag of holding; weight 15; extradimensional; in rope"));
+    CHECK(get_container(inventory, inventory.find("item_bag"))
+          == Inventory::root);
+    CHECK(inventory.get_contents().weight == 1500);
+    // Moving the rope out frees the bag to go inside it.
+    inventory.set("item_rope", Inventory::parse("Rope; weight 10"));
+    CHECK(get_container(inventory, inventory.find("item_bag"))
+          == inventory.find("item_rope"));
+    CHECK(inventory.get_contents().count == 3);
+    CHECK(inventory.size() == 3);
+}
+
+/// @brief Computes the totals of items from scratch.
+struct Reference
+{
+    std::map<std::string, Inventory::Item> items;
+
+    bool contains(const std::string& key) const
+    {
+        return items.count(key) > 0;
+    }
+
+    Inventory::Totals get_totals(const std::string& key) const
+    {
+        const Inventory::Item& item = items.at(key);
+        Inventory::Totals totals = get_contents(key);
+        if (item.extradimensional)
+            totals.weight = 0;
+        totals.weight += item.weight * item.quantity;
+        totals.value += item.value * item.quantity;
+        totals.count += 1;
+        return totals;
+    }
+
+    Inventory::Totals get_contents(const std::string& container) const
+    {
+        Inventory::Totals contents;
+        for (auto& entry : items)
+        {
+            const std::string& inside = entry.second.container;
+            bool is_content = container.empty()
+                ? inside.empty() || !contains(inside)
+                : inside == container;
+            if (!is_content)
+                continue;
+            Inventory::Totals totals = get_totals(entry.first);
+            contents.weight += totals.weight;
+            contents.value += totals.value;
+            contents.count += totals.count;
+        }
+        return contents;
+    }
+};
+
+bool equal(const Inventory::Totals& a, const Inventory::Totals& b)
+{
+    return a.weight == b.weight && a.value == b.value && a.count == b.count;
+}
+
+void test_random_changes()
+{
+    // Items only go inside items with lower numbers, so there are no cycles
+    // and the placement of every item does not depend on the order of
+    // changes.
+    const int item_count = 40;
+    std::mt19937 rng(6);
+    Character character;
+    Inventory inventory;
+    Reference reference;
+    bool is_consistent = true;
+    for (int i = 0; i < 3000; ++i)
+    {
+        int n = 1 + rng() % (item_count - 1);
+        std::string key = "item_" + std::to_string(n);
+        if (rng() % 4 == 0)
+        {
+            character.erase_detail(key);
+            reference.items.erase(key);
+        }
+        else
+        {
+            std::string value = "Thing; weight " + std::to_string(rng() % 20)
+                                + "; value " + std::to_string(rng() % 50)
+                                + " sp; count " + std::to_string(rng() % 4);
+            if (rng() % 4 != 0)
+                value += "; in " + std::to_string(rng() % n);
+            if (rng() % 8 == 0)
+                value += "; extradimensional";
+            character.set_detail(key, value);
+            reference.items[key] = Inventory::parse(value);
+        }
+        inventory.sync(character, {key, "name"});
+
+        is_consistent = is_consistent && inventory.size()
+                                             == reference.items.size();
+        is_consistent = is_consistent
+                        && equal(inventory.get_contents(),
+                                 reference.get_contents(""));
+        for (auto& entry : reference.items)
+        {
+            Id id = inventory.find(entry.first);
+            is_consistent = is_consistent && id != Inventory::none
+                            && equal(inventory.get_totals(id),
+                                     reference.get_totals(entry.first));
+        }
+    }
+    CHECK(is_consistent);
+
+    Inventory rebuilt;
+    rebuilt.rebuild(character);
+    CHECK(rebuilt.size() == inventory.size());
+    CHECK(equal(rebuilt.get_contents(), inventory.get_contents()));
+}
+
+}; // namespace
+
+int main()
+{
+    test_parse();
+    test_containers();
+    test_random_changes();
+    return gelcube::check::get_status();
+}
@@ -0,0 +1,216 @@
+/// @file json_reader.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Tests the streaming JSON reader.
+/// @version 0.1
+/// @date 2026-10-19
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "../src/json_reader.hh"
+#include "check.hh"
+
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using gelcube::JsonReader;
+
+namespace
+{
+
+typedef JsonReader::Event Event;
+typedef std::vector<std::pair<Event, std::string>> Events;
+
+/// @brief Reads every event of a text.
+/// @param buffer_size Number of bytes the reader reads at a time.
+Events read(const std::string& text, size_t buffer_size = 64 << 10)
+{
+    std::istringstream in(text);
+    JsonReader reader(in, buffer_size);
+    Events events;
+    for (Event event = reader.next(); event != Event::end;
+         event = reader.next())
+    {
+        bool has_text = event == Event::key || event == Event::string
+                        || event == Event::number || event == Event::boolean;
+        events.emplace_back(event, has_text ? reader.get_text() : "");
+    }
+    return events;
+}
+
+/// @brief Checks whether reading a text fails with a syntax error.
+bool is_malformed(const std::string& text)
+{
+    try
+    {
+        read(text);
+    }
+    catch (const JsonReader::SyntaxException&)
+    {
+        return true;
+    }
+    return false;
+}
+
+const std::string document
+    = "{\"name\": \"Alice\", \"scores\": {\"str\": 10, \"dex\": -2.5e3},\n"
+      "  \"tags\": [true, false, null, []], \"note\": \"tab\\tquote\\\" "
+      "\\u00e9\\ud83d\\ude00 and a long run of plain text to scan\"}\n"
+      "[1] \"two\" 3";
+
+void test_events()
+{
+    Events expected = {
+        {Event::begin_object, ""},
+        {Event::key, "name"},
+        {Event::string, "Alice"},
+        {Event::key, "scores"},
+        {Event::begin_object, ""},
+        {Event::key, "str"},
+        {Event::number, "10"},
+        {Event::key, "dex"},
+        {Event::number, "-2.5e3"},
+        {Event::end_object, ""},
+        {Event::key, "tags"},
+        {Event::begin_array, ""},
+        {Event::boolean, "true"},
+        {Event::boolean, "false"},
+        {Event::null, ""},
+        {Event::begin_array, ""},
+        {Event::end_array, ""},
+        {Event::end_array, ""},
+        {Event::key, "note"},
+        {Event::string, "tab\tquote\" \xc3\xa9\xf0\x9f\x98\x80 and a long "
+                        "run of plain text to scan"},
+        {Event::end_object, ""},
+        {Event::begin_array, ""},
+        {Event::number, "1"},
+        {Event::end_array, ""},
+        {Event::string, "two"},
+        {Event::number, "3"},
+    };
+    CHECK(read(document) == expected);
+
+    // Values split across reads of the stream are read alike.
+    bool is_consistent = true;
+    for (size_t buffer_size = 1; buffer_size <= 40; ++buffer_size)
+        is_consistent = is_consistent
+                        && read(document, buffer_size) == expected;
+    CHECK(is_consistent);
+
+    CHECK(read("").empty());
+    CHECK(read(" \n\t ").empty());
+}
+
+void test_containers_and_offset()
+{
+    std::istringstream in("{\"a\": [1]}");
+    JsonReader reader(in);
+    CHECK(reader.next() == Event::begin_object);
+    CHECK(reader.get_containers() == "{");
+    CHECK(reader.next() == Event::key);
+    CHECK(reader.next() == Event::begin_array);
+    CHECK(reader.get_containers() == "{[");
+    CHECK(reader.next() == Event::number);
+    CHECK(reader.next() == Event::end_array);
+    CHECK(reader.get_containers() == "{");
+    CHECK(reader.next() == Event::end_object);
+    CHECK(reader.get_containers().empty());
+    CHECK(reader.get_offset() == 10);
+    CHECK(reader.next() == Event::end);
+}
+
+void test_errors()
+{
+    CHECK(is_malformed("{\"a\" 1}"));
+    CHECK(is_malformed("[1 2]"));
+    CHECK(is_malformed("[1,]"));
+    CHECK(is_malformed("{\"a\": 1,}"));
+    CHECK(is_malformed("[1}"));
+    CHECK(is_malformed("]"));
+    CHECK(is_malformed("tru"));
+    CHECK(is_malformed("01"));
+    CHECK(is_malformed("[-]"));
+    CHECK(is_malformed("\"abc"));
+    CHECK(is_malformed("\"\\x\""));
+    CHECK(is_malformed("\"\\ud800\""));
+    CHECK(is_malformed("{\"a\": 1"));
+
+    CHECK(!is_malformed(std::string(JsonReader::max_depth, '[')
+                        + std::string(JsonReader::max_depth, ']')));
+    CHECK(is_malformed(std::string(JsonReader::max_depth + 1, '[')
+                       + std::string(JsonReader::max_depth + 1, ']')));
+    CHECK(is_malformed('"' + std::string(JsonReader::max_string_size + 1, 'a')
+                       + '"'));
+}
+
+void test_recover()
+{
+    std::istringstream in("[{\"a\": 1}, {\"b\" 2}, {\"c\": [\"]\", 3]}]");
+    JsonReader reader(in);
+    Events events;
+    for (;;)
+    {
+        Event event;
+        try
+        {
+            event = reader.next();
+        }
+        catch (const JsonReader::SyntaxException&)
+        {
+            events.emplace_back(Event::null, "error");
+            reader.recover(1);
+            continue;
+        }
+        if (event == Event::end)
+            break;
+        events.emplace_back(event, event == Event::key ? reader.get_text()
+                                                       : "");
+    }
+
+    // The malformed record is skipped and the rest is read as usual.
+    Events expected = {
+        {Event::begin_array, ""},
+        {Event::begin_object, ""},
+        {Event::key, "a"},
+        {Event::number, ""},
+        {Event::end_object, ""},
+        {Event::begin_object, ""},
+        {Event::key, "b"},
+        {Event::null, "error"},
+        {Event::begin_object, ""},
+        {Event::key, "c"},
+        {Event::begin_array, ""},
+        {Event::string, ""},
+        {Event::number, ""},
+        {Event::end_array, ""},
+        {Event::end_object, ""},
+        {Event::end_array, ""},
+    };
+    CHECK(events == expected);
+}
+
+}; // namespace
+
+int main()
+{
+    test_events();
+    test_containers_and_offset();
+    test_errors();
+    test_recover();
+    return gelcube::check::get_status();
+}
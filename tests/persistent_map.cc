@@ -0,0 +1,262 @@
+/// @file persistent_map.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Tests the persistent hash array mapped trie.
+/// @version 0.1
+/// @date 2026-10-19
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "../src/persistent_map.hh"
+#include "check.hh"
+
+#include <cstddef>
+#include <random>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using gelcube::PersistentMap;
+
+namespace
+{
+
+/// @brief Hashes every key alike, so that all entries collide.
+struct ConstantHash
+{
+    size_t operator()(int) const noexcept
+    {
+        return 42;
+    }
+};
+
+/// @brief Checks that a map holds exactly the entries of a reference.
+template <typename Map>
+bool matches(const Map& map, const std::unordered_map<int, int>& expected)
+{
+    if (map.size() != expected.size())
+        return false;
+    for (auto& entry : expected)
+    {
+        const int* value = map.find(entry.first);
+        if (!value || *value != entry.second)
+            return false;
+    }
+    size_t visited = 0;
+    bool is_consistent = true;
+    map.for_each([&](int key, int value)
+    {
+        auto found = expected.find(key);
+        is_consistent = is_consistent && found != expected.end()
+                        && found->second == value;
+        ++visited;
+    });
+    return is_consistent && visited == expected.size();
+}
+
+void test_versions()
+{
+    PersistentMap<std::string, int> empty;
+    CHECK(empty.empty());
+    CHECK(empty.find("str") == nullptr);
+
+    auto one = empty.insert("str", 10);
+    auto two = one.insert("dex", 14);
+    auto replaced = two.insert("str", 18);
+    auto erased = replaced.erase("dex");
+
+    CHECK(empty.empty());
+    CHECK(one.size() == 1 && *one.find("str") == 10);
+    CHECK(one.find("dex") == nullptr);
+    CHECK(two.size() == 2 && *two.find("str") == 10);
+    CHECK(replaced.size() == 2 && *replaced.find("str") == 18);
+    CHECK(*replaced.find("dex") == 14);
+    CHECK(erased.size() == 1 && erased.find("dex") == nullptr);
+    CHECK(*erased.find("str") == 18);
+
+    CHECK(one.is_identical(one));
+    CHECK(!one.is_identical(two));
+    CHECK(two.erase("con").is_identical(two));
+    CHECK(two.erase("con").size() == 2);
+}
+
+void test_collisions()
+{
+    PersistentMap<int, int, ConstantHash> map;
+    std::unordered_map<int, int> expected;
+    for (int i = 0; i < 20; ++i)
+    {
+        map = map.insert(i, i * i);
+        expected[i] = i * i;
+    }
+    CHECK(matches(map, expected));
+
+    auto before = map;
+    for (int i = 0; i < 20; i += 2)
+    {
+        map = map.erase(i);
+        expected.erase(i);
+    }
+    CHECK(matches(map, expected));
+    CHECK(before.size() == 20 && *before.find(4) == 16);
+}
+
+void test_random_operations()
+{
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> key(0, 2000);
+    std::uniform_int_distribution<int> operation(0, 3);
+
+    PersistentMap<int, int> map;
+    std::unordered_map<int, int> expected;
+    std::vector<std::pair<PersistentMap<int, int>,
+                          std::unordered_map<int, int>>> versions;
+    for (int i = 0; i < 20000; ++i)
+    {
+        int k = key(rng);
+        if (operation(rng) == 0)
+        {
+            map = map.erase(k);
+            expected.erase(k);
+        }
+        else
+        {
+            map = map.insert(k, i);
+            expected[k] = i;
+        }
+        if (i % 2000 == 0)
+            versions.emplace_back(map, expected);
+    }
+    CHECK(matches(map, expected));
+    // Earlier versions are unaffected by later changes.
+    for (auto& version : versions)
+        CHECK(matches(version.first, version.second));
+}
+
+/// @brief Gets the keys whose values differ between two versions.
+template <typename Map>
+std::set<int> diff(const Map& map, const Map& other)
+{
+    std::set<int> keys;
+    bool is_consistent = true;
+    map.diff(other, [&](int key, const int* value, const int* other_value)
+    {
+        is_consistent = is_consistent && keys.insert(key).second
+                        && value == map.find(key)
+                        && other_value == other.find(key)
+                        && (!value || !other_value || *value != *other_value);
+    });
+    CHECK(is_consistent);
+    return keys;
+}
+
+/// @brief Gets the keys whose values differ by comparing every entry.
+std::set<int> compare(const std::unordered_map<int, int>& map,
+                      const std::unordered_map<int, int>& other)
+{
+    std::set<int> keys;
+    for (auto& entry : map)
+    {
+        auto found = other.find(entry.first);
+        if (found == other.end() || found->second != entry.second)
+            keys.insert(entry.first);
+    }
+    for (auto& entry : other)
+    {
+        if (!map.count(entry.first))
+            keys.insert(entry.first);
+    }
+    return keys;
+}
+
+void test_diff()
+{
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> key(0, 3000);
+    PersistentMap<int, int> map;
+    PersistentMap<int, int, ConstantHash> colliding;
+    std::unordered_map<int, int> expected;
+    for (int i = 0; i < 2000; ++i)
+    {
+        int k = key(rng);
+        map = map.insert(k, k);
+        expected[k] = k;
+        if (i < 50)
+            colliding = colliding.insert(k, k);
+    }
+    CHECK(diff(map, map).empty());
+
+    // Each round derives a version by a few changes, including setting
+    // values they already had, and one from scratch with the same entries.
+    for (int round = 0; round < 200; ++round)
+    {
+        auto changed = map;
+        auto changed_colliding = colliding;
+        std::unordered_map<int, int> changed_expected = expected;
+        int changes = 1 + rng() % (round % 10 == 0 ? 500 : 5);
+        for (int i = 0; i < changes; ++i)
+        {
+            int k = key(rng);
+            switch (rng() % 3)
+            {
+            case 0:
+                changed = changed.erase(k);
+                changed_colliding = changed_colliding.erase(k);
+                changed_expected.erase(k);
+                break;
+            case 1:
+                changed = changed.insert(k, k);
+                changed_colliding = changed_colliding.insert(k, k);
+                changed_expected[k] = k;
+                break;
+            default:
+                changed = changed.insert(k, -k);
+                changed_colliding = changed_colliding.insert(k, -k);
+                changed_expected[k] = -k;
+            }
+        }
+        std::set<int> keys = compare(expected, changed_expected);
+        CHECK(diff(map, changed) == keys);
+        CHECK(diff(changed, map) == keys);
+
+        std::unordered_map<int, int> colliding_expected;
+        std::unordered_map<int, int> changed_colliding_expected;
+        colliding.for_each([&](int k, int v) { colliding_expected[k] = v; });
+        changed_colliding.for_each([&](int k, int v)
+        {
+            changed_colliding_expected[k] = v;
+        });
+        CHECK(diff(colliding, changed_colliding)
+              == compare(colliding_expected, changed_colliding_expected));
+    }
+
+    PersistentMap<int, int> rebuilt;
+    for (auto& entry : expected)
+        rebuilt = rebuilt.insert(entry.first, entry.second);
+    CHECK(diff(map, rebuilt).empty());
+    CHECK(diff(map, PersistentMap<int, int>()).size() == expected.size());
+    CHECK(diff(PersistentMap<int, int>(), map).size() == expected.size());
+}
+
+}; // namespace
+
+int main()
+{
+    test_versions();
+    test_collisions();
+    test_random_operations();
+    test_diff();
+    return gelcube::check::get_status();
+}
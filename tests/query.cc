@@ -0,0 +1,250 @@
+/// @file query.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Tests parsing and running queries over a table of characters.
+/// @version 0.1
+/// @date 2026-10-19
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "../src/character_table.hh"
+#include "../src/query.hh"
+#include "../src/symbol.hh"
+#include "../src/worker_pool.hh"
+#include "check.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using gelcube::CharacterTable;
+using gelcube::Query;
+using gelcube::Symbol;
+using gelcube::WorkerPool;
+
+namespace
+{
+
+/// @brief Fields of a row, kept alongside the table to check queries by
+///        hand.
+struct Row
+{
+    std::unordered_map<std::string, int32_t> scores;
+    std::unordered_map<std::string, std::string> details;
+};
+
+const char* const classes[] = {"Wizard", "cleric", "ROGUE", "fighter"};
+
+/// @brief Fills a table with rows whose fields are sometimes missing.
+std::vector<Row> fill(CharacterTable& table, size_t count, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::vector<Row> rows(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        table.add_row();
+        if (rng() % 8 != 0)
+        {
+            rows[i].scores["level"] = 1 + rng() % 20;
+            table.set_score(i, Symbol("level"), rows[i].scores["level"]);
+        }
+        if (rng() % 4 != 0)
+        {
+            rows[i].scores["hp"] = static_cast<int32_t>(rng() % 200) - 20;
+            table.set_score(i, Symbol("hp"), rows[i].scores["hp"]);
+        }
+        if (rng() % 5 != 0)
+        {
+            rows[i].details["class"] = classes[rng() % 4];
+            table.set_detail(i, Symbol("class"),
+                             CharacterTable::fold(rows[i].details["class"]));
+        }
+    }
+    return rows;
+}
+
+/// @brief Comparison of one field, checked by hand.
+struct Test
+{
+    std::string key;
+    Query::Op op;
+    bool is_score;
+    int32_t score;
+    std::string detail;
+
+    bool matches(const Row& row) const
+    {
+        if (!is_score)
+        {
+            auto found = row.details.find(key);
+            if (found == row.details.end())
+                return false;
+            bool equal = CharacterTable::fold(found->second) == detail;
+            return op == Query::Op::equal ? equal : !equal;
+        }
+        auto found = row.scores.find(key);
+        if (found == row.scores.end())
+            return false;
+        int32_t value = found->second;
+        switch (op)
+        {
+        case Query::Op::equal:
+            return value == score;
+        case Query::Op::not_equal:
+            return value != score;
+        case Query::Op::less:
+            return value < score;
+        case Query::Op::less_equal:
+            return value <= score;
+        case Query::Op::greater:
+            return value > score;
+        case Query::Op::greater_equal:
+            return value >= score;
+        }
+        return false;
+    }
+};
+
+const char* const operators[] = {"=", "!=", "<", "<=", ">", ">="};
+
+/// @brief Runs random queries of one to three comparisons against a table
+///        and checks each against the rows.
+void check_queries(const CharacterTable& table, const std::vector<Row>& rows,
+                   unsigned seed)
+{
+    std::mt19937 rng(seed);
+    bool all_match = true;
+    for (int i = 0; i < 200; ++i)
+    {
+        std::string text;
+        std::vector<Test> tests;
+        size_t count = 1 + rng() % 3;
+        for (size_t j = 0; j < count; ++j)
+        {
+            Test test;
+            if (rng() % 3 == 0)
+            {
+                test.key = "class";
+                test.op = rng() % 2 ? Query::Op::equal : Query::Op::not_equal;
+                test.is_score = false;
+                // Case in the query is folded like the values.
+                std::string value = classes[rng() % 4];
+                test.detail = CharacterTable::fold(value);
+                text += test.key + (test.op == Query::Op::equal ? "=" : "!=")
+                    + value;
+            }
+            else
+            {
+                test.key = rng() % 2 ? "level" : "hp";
+                size_t op = rng() % 6;
+                test.op = static_cast<Query::Op>(op);
+                test.is_score = true;
+                test.score = static_cast<int32_t>(rng() % 220) - 30;
+                text += test.key + " " + operators[op] + " "
+                    + std::to_string(test.score);
+            }
+            if (j + 1 < count)
+                text += rng() % 2 ? " and " : " AND ";
+            tests.push_back(test);
+        }
+
+        std::vector<uint32_t> expected;
+        for (size_t row = 0; row < rows.size(); ++row)
+        {
+            bool match = true;
+            for (auto& test : tests)
+                match = match && test.matches(rows[row]);
+            if (match)
+                expected.push_back(row);
+        }
+        std::vector<uint32_t> actual = Query(text).run(table);
+        if (actual != expected)
+        {
+            std::cerr << "query: " << text << std::endl;
+            all_match = false;
+        }
+    }
+    CHECK(all_match);
+}
+
+void test_filter()
+{
+    // Not a whole number of blocks, so that the padding is filtered too.
+    CharacterTable table;
+    std::vector<Row> rows = fill(table, 1000, 1);
+    check_queries(table, rows, 2);
+
+    // Fields no row has, and the empty query.
+    CHECK(Query("speed>0").run(table).empty());
+    CHECK(Query("race=elf").run(table).empty());
+    CHECK(Query("race!=elf").run(table).empty());
+    CHECK(Query("").run(table).size() == rows.size());
+    CHECK(Query("  ").run(table).size() == rows.size());
+
+    // Quoted numbers and values with spaces compare details.
+    CharacterTable text_table;
+    text_table.add_row();
+    text_table.set_detail(0, Symbol("title"), "the 5th");
+    text_table.set_detail(0, Symbol("rank"), "5");
+    CHECK(Query("title=\"The 5th\"").run(text_table).size() == 1);
+    CHECK(Query("rank=\"5\"").run(text_table).size() == 1);
+    CHECK(Query("rank=5").run(text_table).empty());
+}
+
+void test_indexed()
+{
+    CharacterTable table;
+    std::vector<Row> rows = fill(table, 5000, 3);
+    table.build_index(Symbol("level"));
+    table.build_index(Symbol("hp"));
+    check_queries(table, rows, 4);
+}
+
+void test_parallel()
+{
+    // More rows than one worker's share of the blocks.
+    WorkerPool::start(2);
+    CharacterTable table;
+    std::vector<Row> rows = fill(table, 70000, 5);
+    check_queries(table, rows, 6);
+    WorkerPool::stop();
+}
+
+void test_parse_errors()
+{
+    CHECK_THROWS(Query("=5"), Query::ParseException);
+    CHECK_THROWS(Query("level"), Query::ParseException);
+    CHECK_THROWS(Query("level~5"), Query::ParseException);
+    CHECK_THROWS(Query("level="), Query::ParseException);
+    CHECK_THROWS(Query("class=\"wizard"), Query::ParseException);
+    CHECK_THROWS(Query("class<wizard"), Query::ParseException);
+    CHECK_THROWS(Query("level=5 or level=6"), Query::ParseException);
+    CHECK_THROWS(Query("level=5 and"), Query::ParseException);
+    CHECK_THROWS(Query("level=5 level=6"), Query::ParseException);
+}
+
+}; // namespace
+
+int main()
+{
+    test_filter();
+    test_indexed();
+    test_parallel();
+    test_parse_errors();
+    return gelcube::check::get_status();
+}
@@ -0,0 +1,216 @@
+/// @file session_state.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Tests keeping the state of the TUI in a mapped file.
+/// @version 0.1
+/// @date 2026-10-19
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "../src/session_state.hh"
+#include "check.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+using gelcube::SessionState;
+
+namespace
+{
+
+std::string directory;
+std::string path;
+
+// Layout of the file: a 24 byte header, the index of the current slot, then
+// the two slots.
+const size_t current_offset = 24;
+const size_t slots_offset = 28;
+const size_t slot_size = 5 * sizeof(uint32_t) + SessionState::max_path_size
+                         + SessionState::max_query_size;
+
+std::string read_file()
+{
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), {});
+}
+
+void write_file(const std::string& contents)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << contents;
+}
+
+/// @brief Checks whether the state is the default one.
+bool is_default()
+{
+    return SessionState::get_selected_index() == 0
+           && SessionState::get_last_selected_index() == 0
+           && !SessionState::get_show_latency()
+           && SessionState::get_open_path().empty()
+           && SessionState::get_query().empty();
+}
+
+/// @brief Saves a state which is not the default.
+void save_state(const std::string& query)
+{
+    SessionState::set_selection(3, 1);
+    SessionState::set_show_latency(true);
+    SessionState::set_open_path("/roster/alice.character");
+    SessionState::set_query(query);
+}
+
+/// @brief Checks whether the state saved by save_state() was kept.
+bool is_saved(const std::string& query)
+{
+    return SessionState::get_selected_index() == 3
+           && SessionState::get_last_selected_index() == 1
+           && SessionState::get_show_latency()
+           && SessionState::get_open_path() == "/roster/alice.character"
+           && SessionState::get_query() == query;
+}
+
+void test_persistence()
+{
+    // Not mapped: nothing is kept.
+    CHECK(!SessionState::is_open());
+    SessionState::set_query("level>5");
+    CHECK(is_default());
+
+    // The directories leading to the file are created.
+    CHECK(SessionState::open(path));
+    CHECK(SessionState::is_open());
+    CHECK(is_default());
+    save_state("class=wizard");
+    CHECK(is_saved("class=wizard"));
+    SessionState::close();
+    CHECK(!SessionState::is_open());
+
+    CHECK(SessionState::open(path));
+    CHECK(is_saved("class=wizard"));
+
+    // Values too long to keep are saved as empty.
+    SessionState::set_open_path(std::string(SessionState::max_path_size + 1,
+                                            'a'));
+    CHECK(SessionState::get_open_path().empty());
+    SessionState::set_query(std::string(SessionState::max_query_size, 'q'));
+    CHECK(SessionState::get_query().size() == SessionState::max_query_size);
+    SessionState::close();
+}
+
+void test_torn_write()
+{
+    CHECK(SessionState::open(path));
+    save_state("first");
+    save_state("second");
+    SessionState::close();
+
+    // A change interrupted before its slot was made current is lost, and the
+    // state before it is read back whole.
+    std::string contents = read_file();
+    CHECK(contents.size() >= slots_offset + 2 * slot_size);
+    uint32_t current = static_cast<unsigned char>(contents[current_offset]);
+    CHECK(current <= 1);
+    size_t other = slots_offset + (1 - current) * slot_size;
+    for (size_t i = 0; i < slot_size; ++i)
+        contents[other + i] = static_cast<char>(0xa5);
+    write_file(contents);
+
+    CHECK(SessionState::open(path));
+    CHECK(is_saved("second"));
+    SessionState::close();
+}
+
+void test_invalid_file()
+{
+    CHECK(SessionState::open(path));
+    save_state("kept");
+    SessionState::close();
+    const std::string valid = read_file();
+
+    // Files which cannot have been written whole are reset to the default.
+    std::string contents = valid;
+    contents[0] = 'x';
+    write_file(contents);
+    CHECK(SessionState::open(path) && is_default());
+    SessionState::close();
+
+    contents = valid;
+    contents[current_offset] = 2;
+    write_file(contents);
+    CHECK(SessionState::open(path) && is_default());
+    SessionState::close();
+
+    write_file(valid.substr(0, valid.size() / 2));
+    CHECK(SessionState::open(path) && is_default());
+    SessionState::close();
+
+    contents = valid;
+    uint32_t current = static_cast<unsigned char>(valid[current_offset]);
+    size_t size = slots_offset + current * slot_size + 3 * sizeof(uint32_t);
+    contents[size + 1] = 0x7f;
+    write_file(contents);
+    CHECK(SessionState::open(path) && is_default());
+    SessionState::close();
+
+    write_file(valid);
+    CHECK(SessionState::open(path) && is_saved("kept"));
+    SessionState::close();
+}
+
+void test_single_owner()
+{
+    // Another process cannot keep the file while this one does.
+    CHECK(SessionState::open(path));
+    pid_t child = fork();
+    if (child == 0)
+        _exit(SessionState::open(path) ? 1 : 0);
+    int status = -1;
+    waitpid(child, &status, 0);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    CHECK(SessionState::is_open());
+    SessionState::close();
+
+    child = fork();
+    if (child == 0)
+        _exit(SessionState::open(path) ? 0 : 1);
+    waitpid(child, &status, 0);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+}; // namespace
+
+int main()
+{
+    char directory_template[] = "/tmp/gelcube-state-XXXXXX";
+    if (!mkdtemp(directory_template))
+        return EXIT_FAILURE;
+    directory = directory_template;
+    path = directory + "/gelcube/session";
+
+    test_persistence();
+    test_torn_write();
+    test_invalid_file();
+    test_single_owner();
+
+    unlink(path.c_str());
+    rmdir((directory + "/gelcube").c_str());
+    rmdir(directory.c_str());
+    return gelcube::check::get_status();
+}
@@ -0,0 +1,159 @@
+/// @file text_layout.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Tests wrapping text to a width in terminal columns.
+/// @version 0.1
+/// @date 2026-10-19
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "../src/text_layout.hh"
+#include "check.hh"
+
+#include <clocale>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using gelcube::TextLayout;
+
+namespace
+{
+
+/// @brief Wraps text and gets the text of each line.
+std::vector<std::string> wrap(TextLayout& layout, int width,
+                              size_t count = SIZE_MAX)
+{
+    std::vector<std::string> lines;
+    for (auto& line : layout.wrap(width, count))
+    {
+        lines.push_back(layout.get_text().substr(line.begin,
+                                                 line.end - line.begin));
+    }
+    return lines;
+}
+
+/// @brief Checks that the width of every line is measured and fits, unless
+///        the line is a single character placed however narrow the width.
+bool fits(TextLayout& layout, int width)
+{
+    bool fit = true;
+    for (auto& line : layout.wrap(width))
+    {
+        std::string text = layout.get_text().substr(line.begin,
+                                                    line.end - line.begin);
+        fit = fit && line.width == TextLayout::measure(text)
+              && (line.width <= width || line.end - line.begin <= 4);
+    }
+    return fit;
+}
+
+void test_words()
+{
+    TextLayout layout("the quick  brown fox jumps");
+    CHECK((wrap(layout, 10)
+           == std::vector<std::string>{"the quick", "brown fox", "jumps"}));
+    CHECK((wrap(layout, 100)
+           == std::vector<std::string>{"the quick  brown fox jumps"}));
+    // The spaces at a break are dropped, whatever their width.
+    CHECK((wrap(layout, 11)
+           == std::vector<std::string>{"the quick", "brown fox", "jumps"}));
+    CHECK(fits(layout, 10));
+
+    // Words wider than a line are split between characters.
+    TextLayout word("abcdefghij klm");
+    CHECK((wrap(word, 4)
+           == std::vector<std::string>{"abcd", "efgh", "ij", "klm"}));
+    CHECK((wrap(word, 0) == wrap(word, 1)));
+    CHECK(wrap(word, 1).size() == 13);
+}
+
+void test_lines()
+{
+    // Newlines force breaks, and blank lines are kept.
+    TextLayout layout("first line\n\n  indented second\nthird\n");
+    CHECK((wrap(layout, 40)
+           == std::vector<std::string>{"first line", "", "  indented second",
+                                       "third"}));
+    CHECK((wrap(layout, 10)
+           == std::vector<std::string>{"first line", "", "  indented",
+                                       "second", "third"}));
+    CHECK((wrap(layout, 9)
+           == std::vector<std::string>{"first", "line", "", "  indente",
+                                       "d second", "third"}));
+
+    TextLayout empty("");
+    CHECK(wrap(empty, 10).size() == 1);
+    CHECK(wrap(empty, 10)[0].empty());
+}
+
+void test_wide_characters()
+{
+    // Double-width characters take two columns, and combining characters
+    // stay with the character before them.
+    CHECK(TextLayout::measure("\xe6\x97\xa5\xe6\x9c\xac") == 4);
+    CHECK(TextLayout::measure("e\xcc\x81") == 1);
+    CHECK(TextLayout::measure("\xff") == 1);
+
+    TextLayout wide("\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e");
+    CHECK((wrap(wide, 3)
+           == std::vector<std::string>{"\xe6\x97\xa5", "\xe6\x9c\xac",
+                                       "\xe8\xaa\x9e"}));
+    CHECK(wrap(wide, 4).size() == 2);
+    // Every line has a character, even if it does not fit.
+    CHECK(wrap(wide, 1).size() == 3);
+
+    TextLayout accents("caf" "e\xcc\x81" "e\xcc\x81");
+    CHECK((wrap(accents, 4)
+           == std::vector<std::string>{"cafe\xcc\x81", "e\xcc\x81"}));
+    CHECK(fits(accents, 4));
+}
+
+void test_partial_and_cached()
+{
+    std::string text;
+    for (int i = 0; i < 500; ++i)
+        text += "word" + std::to_string(i) + (i % 37 == 36 ? "\n" : " ");
+
+    // Breaks computed a few lines at a time, and kept for several widths,
+    // match those of the whole text at once.
+    TextLayout layout(text);
+    const int widths[] = {20, 33, 7, 80, 20, 51, 33, 3, 20};
+    bool matches = true;
+    for (int width : widths)
+    {
+        TextLayout whole(text);
+        std::vector<std::string> expected = wrap(whole, width);
+        std::vector<std::string> first = wrap(layout, width, 5);
+        matches = matches && first.size() >= 5
+                  && std::vector<std::string>(first.begin(), first.begin() + 5)
+                     == std::vector<std::string>(expected.begin(),
+                                                 expected.begin() + 5);
+        matches = matches && wrap(layout, width) == expected;
+        matches = matches && fits(layout, width);
+    }
+    CHECK(matches);
+}
+
+}; // namespace
+
+int main()
+{
+    std::setlocale(LC_ALL, "C.UTF-8");
+    test_words();
+    test_lines();
+    test_wide_characters();
+    test_partial_and_cached();
+    return gelcube::check::get_status();
+}
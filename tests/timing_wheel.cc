@@ -0,0 +1,120 @@
+/// @file timing_wheel.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Tests the hierarchical timing wheel.
+/// @version 0.1
+/// @date 2026-10-19
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "../src/timing_wheel.hh"
+#include "check.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using gelcube::TimingWheel;
+
+namespace
+{
+
+typedef TimingWheel<size_t>::Time Time;
+
+void test_firing_times()
+{
+    // Spans every level of the wheel and the overflow beyond it.
+    const Time horizon = Time{1} << 26;
+    std::mt19937_64 rng(2);
+    std::vector<Time> dues;
+    TimingWheel<size_t> wheel;
+    for (size_t i = 0; i < 5000; ++i)
+    {
+        Time due = 1 + rng() % (i % 2 == 0 ? 200 : horizon);
+        dues.push_back(due);
+        wheel.schedule(due, i);
+    }
+    CHECK(wheel.size() == dues.size());
+
+    std::vector<bool> fired(dues.size(), false);
+    bool is_on_time = true;
+    bool is_ordered = true;
+    Time last = 0;
+    auto fire = [&](Time due, size_t index)
+    {
+        is_on_time = is_on_time && due == dues[index]
+                     && wheel.get_time() == due && !fired[index];
+        is_ordered = is_ordered && due >= last;
+        last = due;
+        fired[index] = true;
+    };
+    // Advances in uneven steps, so that some land on cascade boundaries.
+    for (Time to = 0; to < horizon; to += 1 + rng() % 100000)
+        wheel.advance(to, fire);
+    wheel.advance(horizon, fire);
+
+    CHECK(is_on_time);
+    CHECK(is_ordered);
+    CHECK(wheel.size() == 0);
+    bool all_fired = true;
+    for (bool f : fired)
+        all_fired = all_fired && f;
+    CHECK(all_fired);
+}
+
+void test_past_and_nested()
+{
+    TimingWheel<int> wheel;
+    std::vector<int> fired;
+    wheel.advance(100, [&](Time, int payload) { fired.push_back(payload); });
+    CHECK(wheel.get_time() == 100);
+
+    // Due in the past fires on the next tick.
+    wheel.schedule(50, 1);
+    wheel.schedule(101, 2);
+    wheel.schedule(300, 3);
+    wheel.advance(101, [&](Time due, int payload)
+    {
+        fired.push_back(payload);
+        // Timers scheduled while firing fire later.
+        if (payload == 1)
+            wheel.schedule(due + 10, 4);
+    });
+    CHECK((fired == std::vector<int>{1, 2}));
+    CHECK(wheel.size() == 2);
+
+    wheel.advance(111, [&](Time due, int payload)
+    {
+        fired.push_back(payload);
+        CHECK(due == 111);
+    });
+    CHECK((fired == std::vector<int>{1, 2, 4}));
+
+    // Advancing backwards does nothing.
+    wheel.advance(5, [&](Time, int payload) { fired.push_back(payload); });
+    CHECK(wheel.get_time() == 111);
+    wheel.advance(1000, [&](Time, int payload) { fired.push_back(payload); });
+    CHECK((fired == std::vector<int>{1, 2, 4, 3}));
+    CHECK(wheel.size() == 0 && wheel.get_time() == 1000);
+}
+
+}; // namespace
+
+int main()
+{
+    test_firing_times();
+    test_past_and_nested();
+    return gelcube::check::get_status();
+}
@@ -0,0 +1,266 @@
+/// @file worker_pool.cc
+/// @author Natalie Wiggins (islifepeachy@outlook.com)
+/// @brief Tests the pool of background threads.
+/// @version 0.1
+/// @date 2026-10-19
+///
+/// @copyright Copyright (c) 2022 The Gelatinous Cube Authors.
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <https://www.gnu.org/licenses/>.
+
+#include "../src/worker_pool.hh"
+#include "check.hh"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include <poll.h>
+
+using gelcube::WorkerPool;
+
+namespace
+{
+
+typedef std::shared_ptr<WorkerPool::Task> TaskPtr;
+
+/// @brief Drains completions as they arrive until a task is done.
+/// @return false if it took more than ten seconds.
+bool wait_until_done(const TaskPtr& task)
+{
+    auto deadline = std::chrono::steady_clock::now()
+        + std::chrono::seconds(10);
+    while (!task->is_done())
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+            return false;
+        pollfd events = {WorkerPool::get_fd(), POLLIN, 0};
+        poll(&events, 1, 10);
+        WorkerPool::drain();
+    }
+    return true;
+}
+
+/// @brief Holds a worker busy until released.
+class Gate
+{
+public:
+    /// @brief Submits work which waits for the gate to open.
+    TaskPtr block()
+    {
+        return WorkerPool::submit([this](WorkerPool::Task&)
+            -> WorkerPool::Completion
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            entered = true;
+            changed.notify_all();
+            changed.wait(lock, [this] { return is_open; });
+            return {};
+        }, WorkerPool::Priority::high);
+    }
+
+    /// @brief Waits for the worker to be held.
+    void wait_entered()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this] { return entered; });
+    }
+
+    void open()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        is_open = true;
+        changed.notify_all();
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool entered = false;
+    bool is_open = false;
+};
+
+void test_priorities()
+{
+    WorkerPool::start(1);
+    Gate gate;
+    TaskPtr blocker = gate.block();
+    gate.wait_entered();
+
+    // Queued while the only worker is busy, so they start in order of
+    // priority, then of submission.
+    std::vector<int> order;
+    std::vector<TaskPtr> tasks;
+    auto submit = [&](int id, WorkerPool::Priority priority)
+    {
+        tasks.push_back(WorkerPool::submit([&order, id](WorkerPool::Task&)
+            -> WorkerPool::Completion
+        {
+            return [&order, id] { order.push_back(id); };
+        }, priority));
+    };
+    submit(1, WorkerPool::Priority::low);
+    submit(2, WorkerPool::Priority::normal);
+    submit(3, WorkerPool::Priority::high);
+    submit(4, WorkerPool::Priority::normal);
+    submit(5, WorkerPool::Priority::high);
+    gate.open();
+
+    bool finished = true;
+    for (auto& task : tasks)
+        finished = wait_until_done(task) && finished;
+    CHECK(finished);
+    CHECK((order == std::vector<int>{3, 5, 2, 4, 1}));
+    CHECK(blocker->is_done());
+    WorkerPool::stop();
+}
+
+void test_failures()
+{
+    WorkerPool::start(2);
+    int completed = 0;
+
+    // Work which throws anything leaves its task done, with no completion.
+    TaskPtr failed = WorkerPool::submit([](WorkerPool::Task&)
+        -> WorkerPool::Completion
+    {
+        throw std::runtime_error("work failed");
+    });
+    TaskPtr thrown = WorkerPool::submit([](WorkerPool::Task&)
+        -> WorkerPool::Completion
+    {
+        throw 42;
+    });
+    CHECK(wait_until_done(failed));
+    CHECK(wait_until_done(thrown));
+
+    // A completion which throws does not stop the others.
+    TaskPtr bad = WorkerPool::submit([](WorkerPool::Task&)
+        -> WorkerPool::Completion
+    {
+        return [] { throw std::runtime_error("completion failed"); };
+    });
+    TaskPtr good = WorkerPool::submit([&completed](WorkerPool::Task&)
+        -> WorkerPool::Completion
+    {
+        return [&completed] { ++completed; };
+    });
+    CHECK(wait_until_done(bad));
+    CHECK(wait_until_done(good));
+    CHECK(completed == 1);
+    WorkerPool::stop();
+}
+
+void test_cancellation()
+{
+    WorkerPool::start(1);
+    Gate gate;
+    gate.block();
+    gate.wait_entered();
+
+    bool ran = false;
+    TaskPtr cancelled = WorkerPool::submit([&ran](WorkerPool::Task&)
+        -> WorkerPool::Completion
+    {
+        ran = true;
+        return [] {};
+    });
+    cancelled->cancel();
+    CHECK(cancelled->is_cancelled());
+
+    // Never started, but still finished.
+    TaskPtr pending = WorkerPool::submit([](WorkerPool::Task&)
+        -> WorkerPool::Completion
+    {
+        return [] {};
+    });
+    gate.open();
+    CHECK(wait_until_done(cancelled));
+    CHECK(!ran);
+    WorkerPool::stop();
+    CHECK(pending->is_done());
+
+    // Work whose completion has not run when the pool stops is done and
+    // cancelled, whether or not it started.
+    WorkerPool::start(1);
+    Gate second;
+    second.block();
+    second.wait_entered();
+    TaskPtr queued = WorkerPool::submit([](WorkerPool::Task&)
+        -> WorkerPool::Completion
+    {
+        return [] {};
+    });
+    second.open();
+    WorkerPool::stop();
+    CHECK(queued->is_done() && queued->is_cancelled());
+}
+
+void test_run_parallel()
+{
+    // Runs on the calling thread without a pool.
+    std::vector<int> counts(1000, 0);
+    WorkerPool::run_parallel(counts.size(), [&](size_t i) { ++counts[i]; });
+    bool once = true;
+    for (int count : counts)
+        once = once && count == 1;
+    CHECK(once);
+
+    WorkerPool::start(3);
+    std::vector<std::atomic<int>> shared(100000);
+    WorkerPool::run_parallel(shared.size(), [&](size_t i)
+    {
+        shared[i].fetch_add(1, std::memory_order_relaxed);
+    });
+    once = true;
+    for (auto& count : shared)
+        once = once && count.load() == 1;
+    CHECK(once);
+
+    // Every index runs before an exception is rethrown.
+    std::atomic<size_t> ran{0};
+    CHECK_THROWS(WorkerPool::run_parallel(1000, [&](size_t i)
+    {
+        ran.fetch_add(1, std::memory_order_relaxed);
+        if (i % 100 == 7)
+            throw std::runtime_error("index failed");
+    }), std::runtime_error);
+    CHECK(ran.load() == 1000);
+
+    // Progresses while every worker is busy.
+    Gate gate;
+    std::vector<TaskPtr> blockers;
+    for (int i = 0; i < 3; ++i)
+        blockers.push_back(gate.block());
+    std::atomic<size_t> sum{0};
+    WorkerPool::run_parallel(100, [&](size_t i) { sum += i; });
+    CHECK(sum.load() == 4950);
+    gate.open();
+    WorkerPool::stop();
+}
+
+}; // namespace
+
+int main()
+{
+    test_priorities();
+    test_failures();
+    test_cancellation();
+    test_run_parallel();
+    return gelcube::check::get_status();
+}